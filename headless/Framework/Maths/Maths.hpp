@@ -0,0 +1,32 @@
+/* OVERVIEW
+ * - Headless stand-in for the game framework's Framework::Maths helpers used by the Terrain
+*/
+
+#ifndef FRAMEWORK_MATHS_MATHS_HPP
+#define FRAMEWORK_MATHS_MATHS_HPP
+#pragma once
+
+#include <glm/glm/vec2.hpp>
+#include <glm/glm/vec3.hpp>
+
+namespace Framework {
+	namespace Maths {
+
+		inline double barycentric(glm::dvec3 p1, glm::dvec3 p2, glm::dvec3 p3, glm::dvec2 pos)
+			/* Called by External::Terrain::getHeight
+			 * Interpolates the y values of the three triangle vertices at the horizontal (x, z) position pos
+			*/
+		{
+			const double
+				det = (p2.z - p3.z) * (p1.x - p3.x) + (p3.x - p2.x) * (p1.z - p3.z),
+				l1 = ((p2.z - p3.z) * (pos.x - p3.x) + (p3.x - p2.x) * (pos.y - p3.z)) / det,
+				l2 = ((p3.z - p1.z) * (pos.x - p3.x) + (p1.x - p3.x) * (pos.y - p3.z)) / det,
+				l3 = 1.0 - l1 - l2;
+
+			return l1 * p1.y + l2 * p2.y + l3 * p3.y;
+		}
+
+	}
+}
+
+#endif
@@ -0,0 +1,117 @@
+#include "Noise.h"
+
+#include <cmath>
+
+namespace Framework {
+	namespace Maths {
+
+		namespace {
+			//Ken Perlin's reference permutation, repeated so that lookups never need to wrap
+			const unsigned char permutation[512] = {
+				151,160,137,91,90,15,131,13,201,95,96,53,194,233,7,225,140,36,103,30,69,142,8,99,37,240,21,10,23,190,6,148,
+				247,120,234,75,0,26,197,62,94,252,219,203,117,35,11,32,57,177,33,88,237,149,56,87,174,20,125,136,171,168,68,175,
+				74,165,71,134,139,48,27,166,77,146,158,231,83,111,229,122,60,211,133,230,220,105,92,41,55,46,245,40,244,102,143,54,
+				65,25,63,161,1,216,80,73,209,76,132,187,208,89,18,169,200,196,135,130,116,188,159,86,164,100,109,198,173,186,3,64,
+				52,217,226,250,124,123,5,202,38,147,118,126,255,82,85,212,207,206,59,227,47,16,58,17,182,189,28,42,223,183,170,213,
+				119,248,152,2,44,154,163,70,221,153,101,155,167,43,172,9,129,22,39,253,19,98,108,110,79,113,224,232,178,185,112,104,
+				218,246,97,228,251,34,242,193,238,210,144,12,191,179,162,241,81,51,145,235,249,14,239,107,49,192,214,31,181,199,106,157,
+				184,84,204,176,115,121,50,45,127,4,150,254,138,236,205,93,222,114,67,29,24,72,243,141,128,195,78,66,215,61,156,180,
+				151,160,137,91,90,15,131,13,201,95,96,53,194,233,7,225,140,36,103,30,69,142,8,99,37,240,21,10,23,190,6,148,
+				247,120,234,75,0,26,197,62,94,252,219,203,117,35,11,32,57,177,33,88,237,149,56,87,174,20,125,136,171,168,68,175,
+				74,165,71,134,139,48,27,166,77,146,158,231,83,111,229,122,60,211,133,230,220,105,92,41,55,46,245,40,244,102,143,54,
+				65,25,63,161,1,216,80,73,209,76,132,187,208,89,18,169,200,196,135,130,116,188,159,86,164,100,109,198,173,186,3,64,
+				52,217,226,250,124,123,5,202,38,147,118,126,255,82,85,212,207,206,59,227,47,16,58,17,182,189,28,42,223,183,170,213,
+				119,248,152,2,44,154,163,70,221,153,101,155,167,43,172,9,129,22,39,253,19,98,108,110,79,113,224,232,178,185,112,104,
+				218,246,97,228,251,34,242,193,238,210,144,12,191,179,162,241,81,51,145,235,249,14,239,107,49,192,214,31,181,199,106,157,
+				184,84,204,176,115,121,50,45,127,4,150,254,138,236,205,93,222,114,67,29,24,72,243,141,128,195,78,66,215,61,156,180
+			};
+		}
+
+		double Noise::perlin(double x, double y) {
+			const double
+				floorX = std::floor(x),
+				floorY = std::floor(y);
+
+			//Wrap the integer lattice coordinates into the permutation table (done in 64 bits, as callers use large offsets)
+			const int
+				xi = static_cast<int>(static_cast<long long>(floorX) & 255),
+				yi = static_cast<int>(static_cast<long long>(floorY) & 255);
+
+			const double
+				xf = x - floorX,
+				yf = y - floorY,
+				u = fade(xf),
+				v = fade(yf);
+
+			const int
+				aa = permutation[permutation[xi] + yi],
+				ab = permutation[permutation[xi] + yi + 1],
+				ba = permutation[permutation[xi + 1] + yi],
+				bb = permutation[permutation[xi + 1] + yi + 1];
+
+			const double
+				x1 = gradient(aa, xf, yf) + u * (gradient(ba, xf - 1.0, yf) - gradient(aa, xf, yf)),
+				x2 = gradient(ab, xf, yf - 1.0) + u * (gradient(bb, xf - 1.0, yf - 1.0) - gradient(ab, xf, yf - 1.0));
+
+			return x1 + v * (x2 - x1);
+		}
+
+		double Noise::octavePerlin(double x, double y, double octaves, double persistence) {
+			double
+				total = 0.0,
+				frequency = 1.0,
+				amplitude = 1.0,
+				maxValue = 0.0;
+
+			for (int i = 0; i < octaves; i++) {
+				total += perlin(x * frequency, y * frequency) * amplitude;
+				maxValue += amplitude;
+				amplitude *= persistence;
+				frequency *= 2.0;
+			}
+
+			return total / maxValue;
+		}
+
+		double Noise::multiFractalRidged(double x, double y, double octaves, double lacunarity, double gain) {
+			double
+				total = 0.0,
+				frequency = 1.0,
+				amplitude = 0.5,
+				weight = 1.0,
+				signal = 0.0;
+
+			for (int i = 0; i < octaves; i++) {
+				signal = 1.0 - std::abs(perlin(x * frequency, y * frequency));
+				signal *= signal * weight;
+
+				weight = signal * gain;
+				weight = weight < 0.0 ? 0.0 : weight > 1.0 ? 1.0 : weight;
+
+				total += signal * amplitude;
+				frequency *= lacunarity;
+				amplitude *= 0.5;
+			}
+
+			return total;
+		}
+
+		double Noise::fade(double t) {
+			return t * t * t * (t * (t * 6.0 - 15.0) + 10.0);
+		}
+
+		double Noise::gradient(int hash, double x, double y) {
+			switch (hash & 7) {
+			case 0:  return  x + y;
+			case 1:  return -x + y;
+			case 2:  return  x - y;
+			case 3:  return -x - y;
+			case 4:  return  x;
+			case 5:  return -x;
+			case 6:  return  y;
+			default: return -y;
+			}
+		}
+
+	}
+}
@@ -0,0 +1,31 @@
+/* CLASS OVERVIEW
+ * - Headless stand-in for the game framework's Framework::Maths::Noise
+ * - Deterministic 2D gradient (Perlin) noise, plus fractal sums of it, used by the terrain generation layers
+*/
+
+#ifndef FRAMEWORK_MATHS_NOISE_H
+#define FRAMEWORK_MATHS_NOISE_H
+#pragma once
+
+namespace Framework {
+	namespace Maths {
+		class Noise {
+		public:
+			//Single octave of gradient noise, roughly in the range -1.0 -> 1.0
+			static double perlin(double x, double y);
+
+			//Sum of octaves of perlin(), each scaled in amplitude by persistence and doubled in frequency, normalised
+			static double octavePerlin(double x, double y, double octaves, double persistence);
+
+			//Ridged multifractal noise (Musgrave), in the range 0.0 -> ~1.0
+			static double multiFractalRidged(double x, double y, double octaves, double lacunarity, double gain);
+
+		private:
+			static double fade(double t);
+			static double gradient(int hash, double x, double y);
+
+		};
+	}
+}
+
+#endif
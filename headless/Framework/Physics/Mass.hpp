@@ -0,0 +1,34 @@
+/* CLASS OVERVIEW
+ * - Headless stand-in for the game framework's Framework::Physics::Mass
+ * - Stores a mass value and the position of the centre of mass in local (body) space
+*/
+
+#ifndef FRAMEWORK_PHYSICS_MASS_HPP
+#define FRAMEWORK_PHYSICS_MASS_HPP
+#pragma once
+
+#include <glm/glm/vec3.hpp>
+
+namespace Framework {
+	namespace Physics {
+		class Mass {
+		private:
+			double mValue = 1.0;         //kg
+
+			glm::dvec3 mCentre_local;    //Local-space position of the centre of mass
+
+		public:
+			Mass() = default;
+			Mass(double value, glm::dvec3 centre_local = glm::dvec3(0.0)) : mValue(value), mCentre_local(centre_local) { }
+			~Mass() = default;
+
+			inline double getValue() const { return mValue; }
+			inline glm::dvec3 getCentre() const { return mCentre_local; }
+			inline void setValue(double value) { mValue = value; }
+			inline void setCentre(glm::dvec3 centre_local) { mCentre_local = centre_local; }
+
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,54 @@
+#include "RigidBody.h"
+
+namespace Framework {
+	namespace Physics {
+
+		RigidBody::RigidBody(IntegrationMethod integrationMethod) :
+			mIntegrationMethod(integrationMethod)
+		{
+			mState.reset();
+		}
+
+		void RigidBody::integrate(double t, double dt)
+			/* Called by the derived class' update function
+			 * Advances mState by dt seconds
+			*/
+		{
+			switch (mIntegrationMethod) {
+			case IntegrationMethod::EULER: euler(t, dt); break;
+			}
+		}
+
+		void RigidBody::euler(double t, double dt)
+			/* Called by RigidBody::integrate
+			 * Semi-implicit Euler: momenta are advanced first, and the new velocities are used to advance position/orientation
+			*/
+		{
+			using namespace glm;
+
+			const dvec3
+				force_world = getForce_world(mState, t),
+				torque_world = getTorque_world(mState, t);
+
+			mAcceleration = force_world / mState.getMass().getValue();
+
+			const dvec3
+				momentum_world = mState.getMomentum_world() + force_world * dt,
+				angularMomentum_world = mState.getAngularMomentum_world() + torque_world * dt,
+				velocity_world = momentum_world / mState.getMass().getValue(),
+				angularVelocity_world = mState.calcAngularVelocity_world(angularMomentum_world);
+
+			const dquat
+				orientation_world = mState.getOrientation_world(),
+				spin_world = dquat(0.0, angularVelocity_world.x, angularVelocity_world.y, angularVelocity_world.z) * orientation_world * 0.5;
+
+			mState.setPrimary_world(
+				mState.getPosition_world() + velocity_world * dt,
+				momentum_world,
+				orientation_world + spin_world * dt,
+				angularMomentum_world
+			);
+		}
+
+	}
+}
@@ -0,0 +1,45 @@
+/* CLASS OVERVIEW
+ * - Headless stand-in for the game framework's Framework::Physics::RigidBody
+ * - Owns a State, and advances it through time using the force and torque provided by a derived class
+ * - Only explicit Euler integration is provided, which is the only method the simulation uses
+*/
+
+#ifndef FRAMEWORK_PHYSICS_RIGIDBODY_H
+#define FRAMEWORK_PHYSICS_RIGIDBODY_H
+#pragma once
+
+#include "State.hpp"
+
+namespace Framework {
+	namespace Physics {
+		class RigidBody {
+		public:
+			enum class IntegrationMethod { EULER };
+
+		protected:
+			State mState;
+
+			glm::dvec3 mAcceleration = glm::dvec3(0.0);    //World-space, from the most recent integration step
+
+			IntegrationMethod mIntegrationMethod = IntegrationMethod::EULER;
+
+		public:
+			RigidBody(IntegrationMethod integrationMethod);
+			virtual ~RigidBody() = default;
+
+			inline glm::dvec3 getAcceleration_world() const { return mAcceleration; }
+
+		protected:
+			void integrate(double t, double dt);
+
+			virtual glm::dvec3 getForce_world(State& state, double t) = 0;
+			virtual glm::dvec3 getTorque_world(State& state, double t) = 0;
+
+		private:
+			void euler(double t, double dt);
+
+		};
+	}
+}
+
+#endif
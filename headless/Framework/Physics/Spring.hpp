@@ -0,0 +1,55 @@
+/* CLASS OVERVIEW
+ * - Headless stand-in for the game framework's Framework::Physics::Spring
+ * - A one-dimensional damped spring (Hooke's law plus a linear damping term)
+*/
+
+#ifndef FRAMEWORK_PHYSICS_SPRING_HPP
+#define FRAMEWORK_PHYSICS_SPRING_HPP
+#pragma once
+
+#include <glm/glm/vec3.hpp>
+#include <glm/glm/geometric.hpp>
+
+namespace Framework {
+	namespace Physics {
+		class Spring {
+		private:
+			double
+				mSpringConstant = 0.0, //N/m
+				mRestLength = 0.0,     //m
+				mDamping = 0.0,        //Ns/m
+				mCurrentLength = 0.0,  //m
+				mForce = 0.0;          //N, positive when the spring is compressed
+
+		public:
+			Spring(double springConstant, double restLength, double damping) :
+				mSpringConstant(springConstant),
+				mRestLength(restLength),
+				mDamping(damping),
+				mCurrentLength(restLength)
+			{ }
+
+			~Spring() = default;
+
+			void update(double newLength, double velocity)
+				/* Called by Internal::Suspension
+				 * velocity is the rate of change of the spring's length, used for damping
+				*/
+			{
+				mCurrentLength = newLength;
+				mForce = -mSpringConstant * (mCurrentLength - mRestLength) - mDamping * velocity;
+			}
+
+			inline double getForce() const { return mForce; }
+			inline double getRestLength() const { return mRestLength; }
+			inline double getCurrentLength() const { return mCurrentLength; }
+			inline double getSpringConstant() const { return mSpringConstant; }
+			inline double getDamping() const { return mDamping; }
+			inline void setSpringConstant(double springConstant) { mSpringConstant = springConstant; }
+			inline void setDamping(double damping) { mDamping = damping; }
+
+		};
+	}
+}
+
+#endif
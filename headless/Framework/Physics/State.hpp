@@ -0,0 +1,126 @@
+/* CLASS OVERVIEW
+ * - Headless stand-in for the game framework's Framework::Physics::State
+ * - Stores the primary (position, momentum, orientation, angular momentum) and secondary (velocities, transforms) physical
+ *   state of a rigid body
+ * - Secondary quantities are recalculated whenever a primary quantity changes
+*/
+
+#ifndef FRAMEWORK_PHYSICS_STATE_HPP
+#define FRAMEWORK_PHYSICS_STATE_HPP
+#pragma once
+
+#include <glm/glm/vec3.hpp>
+#include <glm/glm/vec4.hpp>
+#include <glm/glm/mat3x3.hpp>
+#include <glm/glm/mat4x4.hpp>
+#include <glm/glm/geometric.hpp>
+#include <glm/glm/gtc/quaternion.hpp>
+#include <glm/glm/gtc/matrix_transform.hpp>
+
+#include "Mass.hpp"
+
+namespace Framework {
+	namespace Physics {
+		class State {
+		private:
+			Mass mMass;
+
+			glm::dmat3
+				mInertiaTensor_local = glm::dmat3(1.0),
+				mInverseInertiaTensor_local = glm::dmat3(1.0);
+
+			//Primary
+			glm::dvec3
+				mPosition_world,
+				mMomentum_world,
+				mAngularMomentum_world;
+
+			glm::dquat mOrientation_world;
+
+			//Secondary
+			glm::dvec3
+				mVelocity_world,
+				mAngularVelocity_world;
+
+			glm::dmat4
+				mLocalToWorld_position = glm::dmat4(1.0),
+				mLocalToWorld_direction = glm::dmat4(1.0),
+				mWorldToLocal_direction = glm::dmat4(1.0);
+
+		public:
+			State() = default;
+			~State() = default;
+
+			void reset()
+				/* Called by Internal::Car::resetToTrackPosition
+				 * Removes all motion and orientation, but keeps mass properties
+				*/
+			{
+				mPosition_world = mMomentum_world = mAngularMomentum_world = glm::dvec3(0.0);
+				mOrientation_world = glm::dquat(1.0, 0.0, 0.0, 0.0);
+				recalc();
+			}
+
+			void recalc()
+				/* Called whenever a primary quantity changes
+				*/
+			{
+				mOrientation_world = glm::normalize(mOrientation_world);
+				mVelocity_world = mMomentum_world / mMass.getValue();
+
+				mLocalToWorld_direction = glm::mat4_cast(mOrientation_world);
+				mWorldToLocal_direction = glm::transpose(mLocalToWorld_direction);
+				mLocalToWorld_position = glm::translate(glm::dmat4(1.0), mPosition_world) * mLocalToWorld_direction;
+
+				mAngularVelocity_world = calcAngularVelocity_world(mAngularMomentum_world);
+			}
+
+			glm::dvec3 calcAngularVelocity_world(glm::dvec3 angularMomentum_world) const
+				/* Called by
+				 * - State::recalc
+				 * - RigidBody::euler
+				 * Uses the current orientation to take the angular momentum into local space, where the inertia tensor is defined
+				*/
+			{
+				glm::dmat3 rotation = glm::dmat3(mLocalToWorld_direction);
+				return rotation * (mInverseInertiaTensor_local * (glm::transpose(rotation) * angularMomentum_world));
+			}
+
+			void setPrimary_world(glm::dvec3 position, glm::dvec3 momentum, glm::dquat orientation, glm::dvec3 angularMomentum)
+				/* Called by RigidBody::euler
+				 * Sets all primary quantities at once, so that secondary quantities are only recalculated once per step
+				*/
+			{
+				mPosition_world = position;
+				mMomentum_world = momentum;
+				mOrientation_world = orientation;
+				mAngularMomentum_world = angularMomentum;
+				recalc();
+			}
+
+			inline Mass& getMass() { return mMass; }
+			inline const Mass& getMass() const { return mMass; }
+			inline glm::dmat3 getInertiaTensor_local() const { return mInertiaTensor_local; }
+			inline glm::dvec3 getPosition_world() const { return mPosition_world; }
+			inline glm::dvec3 getMomentum_world() const { return mMomentum_world; }
+			inline glm::dvec3 getVelocity_world() const { return mVelocity_world; }
+			inline glm::dvec3 getAngularMomentum_world() const { return mAngularMomentum_world; }
+			inline glm::dvec3 getAngularVelocity_world() const { return mAngularVelocity_world; }
+			inline glm::dquat getOrientation_world() const { return mOrientation_world; }
+			inline glm::dmat4 getLocalToWorld_position() const { return mLocalToWorld_position; }
+			inline glm::dmat4 getLocalToWorld_direction() const { return mLocalToWorld_direction; }
+			inline glm::dmat4 getWorldToLocal_direction() const { return mWorldToLocal_direction; }
+
+			inline void setMassValue_local(double value) { mMass.setValue(value); recalc(); }
+			inline void setInertiaTensor_local(glm::dmat3 inertia) { mInertiaTensor_local = inertia; mInverseInertiaTensor_local = glm::inverse(inertia); recalc(); }
+			inline void setPosition_world(glm::dvec3 position) { mPosition_world = position; recalc(); }
+			inline void setMomentum_world(glm::dvec3 momentum) { mMomentum_world = momentum; recalc(); }
+			inline void setVelocity_world(glm::dvec3 velocity) { mMomentum_world = velocity * mMass.getValue(); recalc(); }
+			inline void setAngularMomentum_world(glm::dvec3 angularMomentum) { mAngularMomentum_world = angularMomentum; recalc(); }
+			inline void setOrientation_world(glm::dquat orientation) { mOrientation_world = orientation; recalc(); }
+
+		};
+	}
+}
+
+#endif
@@ -12,6 +12,10 @@
 #include <Framework/Camera/PerspectiveCamera.h>
 #include <Framework/Input/Input.h>
 
+namespace External {
+	class Terrain;
+}
+
 namespace Visual {
 	class SimulationCamera {
 	protected:
@@ -46,12 +50,12 @@ namespace Visual {
 		FPVCamera(glm::vec3 position_OGL, glm::vec3 direction_OGL, float near, float far, float aspect, float FOV);
 		~FPVCamera() = default;
 
-		void update(float windowAspect, float dt);
+		void update(float windowAspect, float dt, const External::Terrain& terrain);
 		void handleInput(float dt);
 
 	private:
 		void handleMovementInput(float dt);
-		glm::dvec3 afterPositionConstraints(glm::dvec3 input);
+		glm::dvec3 afterPositionConstraints(glm::dvec3 previous, glm::dvec3 input, const External::Terrain& terrain);
 
 	};
 
@@ -0,0 +1,88 @@
+/* CLASS OVERVIEW
+ * - A closed-loop driver that follows the track's centreline (TrackCentreline) on its own, for reproducible laps in
+ *   benchmarks and regression runs with nobody at the keyboard
+ * - Steers by pure pursuit: it aims at the point on the line a look-ahead distance (growing with speed) beyond the
+ *   car's nearest point, turning the steering wheel to put the car on the arc through that point
+ * - Holds the speed of a profile planned once from the line's curvature: the fastest the car can take each point with
+ *   at most maxLateralAccel, lowered before each corner so that it is reached braking at no more than maxDeceleration.
+ *   Throttle and brake are proportional to the error from it
+ * - The Plan holds the profile and is shared between every AutoDriver on the same line with the same settings, so each
+ *   car only adds the segment it was nearest last step. A step costs a few segment tests and two interpolations, with
+ *   no allocation
+*/
+
+#ifndef AUTODRIVER_H
+#define AUTODRIVER_H
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <glm/glm/vec3.hpp>
+#include <glm/glm/gtc/quaternion.hpp>
+
+#include "DriverInputs.h"
+#include "TrackCentreline.h"
+
+namespace Internal {
+	class AutoDriver : public DriverInputSource {
+	public:
+		struct Settings {
+			double
+				lookAheadTime = 0.5,         //s, of travel at the car's speed to the point aimed at
+				minLookAhead = 5.0,          //m
+				maxLookAhead = 30.0,         //m
+				maxSpeed = 25.0,             //m/s
+				turningSpeed = 5.0,          //m/s, at most, while turning round to an aim point behind the car
+				maxLateralAccel = 5.0,       //m/s^2, in corners
+				maxDeceleration = 4.0,       //m/s^2, braking for corners
+				speedGain = 0.5,             //Throttle (or brake) per m/s off the planned speed
+				profileInterval = 1.0,       //m, between the planned speeds
+				relocateDistance = 15.0;     //m from the line beyond which the car is searched for across the whole track
+		};
+
+		class Plan {
+		private:
+			const External::TrackCentreline& mCentreline;
+			const Settings mSettings;
+			std::vector<double> mSpeeds;     //m/s, every profileInterval along the line from its start
+
+		public:
+			Plan(const External::TrackCentreline& centreline, const Settings& settings);
+
+			double getSpeed(double distance) const;
+
+			inline const External::TrackCentreline& getCentreline() const { return mCentreline; }
+			inline const Settings& getSettings() const { return mSettings; }
+			inline const std::vector<double>& getSpeeds() const { return mSpeeds; }
+
+		};
+
+	private:
+		std::shared_ptr<const Plan> mPlan;
+
+		bool mStarted = false;               //Whether the car has been found on the line yet
+		size_t mSegment = 0;                 //Of the centreline, nearest the car last step
+		double
+			mLineDistance = 0.0,             //m, along the centreline, last step
+			mLateralOffset = 0.0,            //m, right of the centreline, last step
+			mTargetSpeed = 0.0;              //m/s, last step
+
+	public:
+		explicit AutoDriver(const External::TrackCentreline& centreline);
+		AutoDriver(const External::TrackCentreline& centreline, const Settings& settings);
+		explicit AutoDriver(std::shared_ptr<const Plan> plan);
+
+		void read(const Car& car, double t, double dt, DriverInputs& inputs) override;
+		void drive(glm::dvec3 position_world, glm::dvec3 velocity_world, glm::dquat orientation_world, double wheelBase, double steeringRatio, DriverInputs& inputs);
+		void reset();
+
+		inline const std::shared_ptr<const Plan>& getPlan() const { return mPlan; }
+		inline double getLineDistance() const { return mLineDistance; }
+		inline double getLateralOffset() const { return mLateralOffset; }
+		inline double getTargetSpeed() const { return mTargetSpeed; }
+
+	};
+}
+
+#endif
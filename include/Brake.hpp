@@ -9,7 +9,9 @@
 namespace Internal {
 	class Brake {
 	private:
-		const double mDistToWheelCentre = 0.16;  //m
+		static constexpr double
+			mDistToWheelCentre = 0.16,      //m
+			mMaxCompressionForce = 9000.0;  //N
 
 		double
 			mCompressionForce = 0.0,  //Nm
@@ -27,12 +29,22 @@ namespace Internal {
 			//This function uses the travel percentage to generate a compression force.
 			//This is just the *magnitude*, independent of direction: the WheelInterface uses this value as it knows about direction.
 
-			mCompressionForce = mTravelPercentage * 9000.0;
+			mCompressionForce = mTravelPercentage * mMaxCompressionForce;
 			mTorqueMagnitude = mCompressionForce * mDistToWheelCentre;
 		}
 
+		static double calcTorqueMagnitude(double travelPercentage)
+			/* Called by
+			 * - Brake::update (equivalent)
+			 * - VehicleBatch::updateWheels
+			*/
+		{
+			return travelPercentage * mMaxCompressionForce * mDistToWheelCentre;
+		}
+
 		inline void setTravelPercentage(double newTravelPercent) { mTravelPercentage = newTravelPercent < 0.0 ? 0.0 : newTravelPercent > 1.0 ? 1.0 : newTravelPercent; }
 		inline double getTorqueMagnitude() const { return mTorqueMagnitude; }
+		inline double getTravelPercentage() const { return mTravelPercentage; }
 
 	};
 }
@@ -10,19 +10,23 @@
 
 #include <memory>
 #include <Framework/Physics/RigidBody.h>
-#include <Framework/Input/Input.h>
 
 #include "Environment.h"
 #include "WheelSystem.h"
 #include "ControlSystem.h"
+#include "DriverInputs.h"
 
 namespace Internal {
 	class Car : public Framework::Physics::RigidBody {
 	protected:
+		std::shared_ptr<const External::Environment> mEnvironment;
 		ControlSystem mControlSystem;
 		WheelSystem mWheelSystem;
 		std::unique_ptr<TorqueGenerator> mTorqueGenerator;
 
+		std::shared_ptr<DriverInputSource> mInputSource; //nullptr leaves the controls as they are set
+		DriverInputs mInputs;                            //As last read from mInputSource
+
 		glm::dvec3
 			mAerodynamicDrag_world,	//N
 			mTotalForce_world,		//N
@@ -36,17 +40,33 @@ namespace Internal {
 
 	public:
 		Car();
+		explicit Car(std::shared_ptr<const External::Environment> environment);
 		~Car() = default;
 
 		void update(double t, double dt);
-		void checkInput(double dt);
+		void applyInputs(const DriverInputs& inputs, double dt);
+		inline void setInputSource(std::shared_ptr<DriverInputSource> source) { mInputSource = std::move(source); mInputs = DriverInputs(); }
 		void resetToTrackPosition();
+		void setTyreParams(std::shared_ptr<const PacejkaParams> params);
+		void setMass(double mass);
+		void setSuspension(double springConstant, double damping);
+		inline void setDrag(double dragCoefficient, double frontalArea) { mDragCoefficient = dragCoefficient; mFrontalArea = frontalArea; }
 
+		inline const External::Environment& getEnvironment() const { return *mEnvironment; }
+		inline const std::shared_ptr<const External::Environment>& getSharedEnvironment() const { return mEnvironment; }
 		inline Framework::Physics::State& getState() { return mState; }
+		inline const Framework::Physics::State& getState() const { return mState; }
 		inline WheelSystem& getWheelSystem() { return mWheelSystem; }
+		inline const WheelSystem& getWheelSystem() const { return mWheelSystem; }
 		inline ControlSystem& getControlSystem() { return mControlSystem; }
+		inline const ControlSystem& getControlSystem() const { return mControlSystem; }
+		inline const std::shared_ptr<DriverInputSource>& getInputSource() const { return mInputSource; }
+		inline const DriverInputs& getInputs() const { return mInputs; }
 		inline TorqueGenerator& getTorqueGenerator() { return *mTorqueGenerator.get(); }
+		inline const TorqueGenerator& getTorqueGenerator() const { return *mTorqueGenerator.get(); }
 		inline glm::dvec3 getAeroDrag_world() { return mAerodynamicDrag_world; }
+		inline double getFrontalArea() const { return mFrontalArea; }
+		inline double getDragCoefficient() const { return mDragCoefficient; }
 
 	private:
 		void updateTotalForce_world();
@@ -1,7 +1,7 @@
 /* CLASS OVERVIEW
  * - References different sub components of the Car whose state updates depend on user input
- * - A layer between user input and the Car
- * - Where a relatively large amount of input handling takes place
+ * - A layer between the driver's inputs (DriverInputs, from whichever DriverInputSource drives the Car) and the Car
+ * - Applies the inputs once per physics step
 */
 
 #ifndef CONTROLSYSTEM_H
@@ -9,9 +9,9 @@
 #pragma once
 
 #include <vector>
-#include <Framework/Input/Input.h>
 
 #include "TorqueGenerator.hpp"
+#include "DriverInputs.h"
 
 namespace Internal {
 	class Brake;
@@ -26,8 +26,6 @@ namespace Internal {
 		std::vector<Brake*> mBrakes;
 		TorqueGenerator* mTorqueGenerator = nullptr;
 
-		const double mSteeringRate = 5000.0;
-
 		double
 			mSteeringRatio = 0.0,
 			mMaxAbsWheelAngle = 0.0,	     //degs
@@ -41,20 +39,24 @@ namespace Internal {
 		~ControlSystem() = default;
 
 		void update(double wheelBase, double frontAxleTrack);
-		void handleInput(double dt);
+		void applyInputs(const DriverInputs& inputs, double dt);
 		void attachWheels(Wheel* left, Wheel* right);
 		void setMaxAbsWheelAngle(double maxAbsAngle);
+		void setSteeringRatio(double newRatio);
+		void setBrakeTravel(double travelPercentage);
+
+		static void calcWheelAngles(double steeringWheelAngle, double steeringRatio, double wheelBase, double frontAxleTrack, double& leftWheelAngle, double& rightWheelAngle);
 
 		inline double getSteeringWheelAngle() const { return mSteeringWheelAngle; }
-		inline void setSteeringRatio(double newRatio) { mSteeringRatio = newRatio; }
+		inline double getSteeringRatio() const { return mSteeringRatio; }
+		inline double getMaxAbsSteeringWheelAngle() const { return mMaxAbsSteeringWheelAngle; }
+		inline void setSteeringWheelAngle(double newAngle) { mSteeringWheelAngle = newAngle > mMaxAbsSteeringWheelAngle ? mMaxAbsSteeringWheelAngle : newAngle < -mMaxAbsSteeringWheelAngle ? -mMaxAbsSteeringWheelAngle : newAngle; }
 		inline void attachTorqueGenerator(TorqueGenerator* torqueGenerator) { mTorqueGenerator = torqueGenerator; }
 		inline void attachBrakes(std::vector<Brake*> brakes) { mBrakes = brakes; }
 		inline bool brakesOn() const { return mBrakesOn; }
 
 	private:
 		void updateSteeringAngle(double wheelBase, double frontAxleTrack);
-		void handleSteeringInput(double dt);
-		void handleSpeedInput();
 
 	};
 }
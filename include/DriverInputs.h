@@ -0,0 +1,188 @@
+/* CLASS(ES) OVERVIEW
+ * - DriverInputs: what a driver does to the Car in one physics step (steering wheel, pedals, reverse and reset),
+ *   consumed by Car::applyInputs each step
+ * - DriverInputSource: where a Car's inputs come from, read once per physics step rather than per frame, so a run
+ *   steps the same whatever the frame rate, and needs no window when the source is not the keyboard:
+ *   - ScriptedInputSource: keyframes in time (e.g. a step steer or sine steer manoeuvre)
+ *   - ControllerInputSource: a closed-loop controller, given the Car's state each step
+ *   - TraceInputSource: an input trace recorded earlier, streamed from a memory-mapped file
+ *   - RecordingInputSource: passes on another source's inputs, writing them to an input trace
+ *   - KeyboardInputSource: the arrow keys, End and R (only in builds with a window)
+ * - An input trace is a header then one fixed-size record per step whose inputs changed, in time order. A record's
+ *   inputs hold until the next record, and its reverse and reset events happen once, at its time
+*/
+
+#ifndef DRIVERINPUTS_H
+#define DRIVERINPUTS_H
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <functional>
+
+#include "MappedFile.h"
+
+namespace Internal {
+	class Car;
+
+	struct DriverInputs {
+		bool steerByRate = false;        //Whether the steering wheel is turned at steeringWheelRate rather than set to steeringWheelAngle
+		double
+			steeringWheelAngle = 0.0,    //degs, positive to the right
+			steeringWheelRate = 0.0,     //degs/s
+			throttle = 0.0,              //0.0 -> 1.0
+			brake = 0.0;                 //0.0 -> 1.0, of brake travel
+		bool
+			toggleReverse = false,       //Events, for this step only
+			reset = false;
+	};
+
+	class DriverInputSource {
+	public:
+		virtual ~DriverInputSource() = default;
+
+		//t is the time at the start of the step about to be taken, of dt seconds. inputs holds the last step's inputs,
+		//with its events cleared
+		virtual void read(const Car& car, double t, double dt, DriverInputs& inputs) = 0;
+
+	};
+
+	class ScriptedInputSource : public DriverInputSource {
+	public:
+		struct Keyframe {
+			double time;                 //s
+			DriverInputs inputs;
+		};
+
+	private:
+		std::vector<Keyframe> mKeyframes;
+		bool mInterpolated;              //Whether steering and pedals move linearly between keyframes rather than jumping
+
+		size_t mNext = 0;                //The first keyframe not yet reached
+		double mLastTime = 0.0;          //s
+
+	public:
+		explicit ScriptedInputSource(std::vector<Keyframe> keyframes, bool interpolated = false);
+
+		static ScriptedInputSource makeStepSteer(double throttle, double stepTime, double steeringWheelAngle);
+		static ScriptedInputSource makeSineSteer(double throttle, double startTime, double amplitude, double frequency, double duration);
+
+		void read(const Car& car, double t, double dt, DriverInputs& inputs) override;
+
+		inline const std::vector<Keyframe>& getKeyframes() const { return mKeyframes; }
+
+	};
+
+	class ControllerInputSource : public DriverInputSource {
+	public:
+		using Controller = std::function<void(const Car& car, double t, double dt, DriverInputs& inputs)>;
+
+	private:
+		Controller mController;
+
+	public:
+		explicit ControllerInputSource(Controller controller);
+
+		void read(const Car& car, double t, double dt, DriverInputs& inputs) override;
+
+	};
+
+	class TraceInputSource : public DriverInputSource {
+	public:
+		static constexpr unsigned int TRACE_VERSION = 2;
+
+		//Every field little- or big-endian as the machine that wrote it, as given by the header's byte order
+		struct Record {
+			//Inputs are kept at full precision, so a run driven by a controller (e.g. an AutoDriver) plays back exactly
+			double
+				time,                    //s
+				steering,                //degs, or degs/s with STEER_BY_RATE
+				throttle,
+				brake;
+			uint32_t
+				flags,
+				reserved;
+		};
+
+		enum Flags : uint32_t {
+			STEER_BY_RATE = 1,
+			TOGGLE_REVERSE = 2,
+			RESET = 4
+		};
+
+	private:
+		MappedFile mFile;
+		const Record* mRecords = nullptr;
+		size_t mRecordCount = 0;
+
+		size_t mNext = 0;                //The first record not yet reached
+		double mLastTime = 0.0;          //s
+
+	public:
+		TraceInputSource() = default;
+
+		bool open(const std::string& path);
+		void read(const Car& car, double t, double dt, DriverInputs& inputs) override;
+
+		inline bool isOpen() const { return mRecords != nullptr; }
+		inline size_t getRecordCount() const { return mRecordCount; }
+		inline const Record* getRecords() const { return mRecords; }
+
+		static Record toRecord(double t, const DriverInputs& inputs);
+		static void fromRecord(const Record& record, DriverInputs& inputs);
+
+	};
+
+	class RecordingInputSource : public DriverInputSource {
+	private:
+		std::shared_ptr<DriverInputSource> mSource;
+		FILE* mFile = nullptr;
+		uint64_t mRecordCount = 0;
+
+		TraceInputSource::Record mLastRecord = {};
+
+	public:
+		explicit RecordingInputSource(std::shared_ptr<DriverInputSource> source);
+		~RecordingInputSource();
+
+		RecordingInputSource(const RecordingInputSource&) = delete;
+		RecordingInputSource& operator=(const RecordingInputSource&) = delete;
+
+		bool open(const std::string& path);
+		bool close();
+		void read(const Car& car, double t, double dt, DriverInputs& inputs) override;
+
+		inline bool isOpen() const { return mFile != nullptr; }
+		inline size_t getRecordCount() const { return (size_t)mRecordCount; }
+
+	};
+
+#ifndef VDS_HEADLESS
+	class KeyboardInputSource : public DriverInputSource {
+	private:
+		const double mSteeringRate = 5000.0; //degs/s
+
+		//Latched once per frame by poll, and read by each of the frame's physics steps; presses are kept until read
+		bool
+			mSteerRight = false,
+			mSteerLeft = false,
+			mAccelerate = false,
+			mBrake = false,
+			mToggleReverse = false,
+			mReset = false;
+
+	public:
+		KeyboardInputSource() = default;
+
+		void poll();
+		void read(const Car& car, double t, double dt, DriverInputs& inputs) override;
+
+	};
+#endif
+}
+
+#endif
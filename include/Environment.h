@@ -1,13 +1,15 @@
 /* CLASS OVERVIEW
- * - Encapsulates a static Terrain instance
- * - Contains purely static data
- * - Can be easily accessed by #including this file anywhere
+ * - The world a Car is simulated in: a Terrain, plus the gravitational acceleration and air density acting on it
+ * - Injected into a Car at construction and shared (read-only) by everything that simulates or draws it, so several
+ *   simulations can run concurrently in one process, each on its own Environment
+ * - getDefault() lazily builds one shared Environment on first use (not before main), for Cars constructed without one
 */
 
 #ifndef ENVIRONMENT_H
 #define ENVIRONMENT_H
 #pragma once
 
+#include <memory>
 #include <glm/glm/vec2.hpp>
 #include <glm/glm/vec3.hpp>
 #include <glm/glm/geometric.hpp>
@@ -16,12 +18,27 @@
 
 namespace External {
 	class Environment {
+	private:
+		Terrain mTerrain;
+
+		double
+			mGravityAccel = 9.80665, //m/s^2  - gravitational acceleration at sea level
+			mAirDensity = 1.225;     //kg/m^3 - air density at sea level
+
 	public:
-		static Terrain mTerrain;
+		Environment() = default;
+		Environment(double gravityAccel, double airDensity);
+		explicit Environment(const Terrain::Settings& terrainSettings, double gravityAccel = 9.80665, double airDensity = 1.225);
+		~Environment() = default;
+
+		Environment(const Environment&) = delete;
+		Environment& operator=(const Environment&) = delete;
+
+		inline const Terrain& getTerrain() const { return mTerrain; }
+		inline double getGravityAccel() const { return mGravityAccel; }
+		inline double getAirDensity() const { return mAirDensity; }
 
-		static const double
-			mGravityAccel,
-			mAirDensity;
+		static std::shared_ptr<const Environment> getDefault();
 
 	};
 }
@@ -24,6 +24,7 @@ namespace Visual {
 	class EnvironmentModel {
 	private:
 		Framework::ResourceSet& mResourceBucket;
+		const External::Environment& mEnvironment;
 		Framework::Model3D mModel;
 		std::unique_ptr<Framework::Graphics::SkyBox> mSkyBox;
 		std::unique_ptr<TerrainModel> mTerrainModel;
@@ -42,7 +43,7 @@ namespace Visual {
 			mSunDirection = glm::normalize(glm::vec3(10.0f, 5.0f, 0.0f));
 
 	public:
-		EnvironmentModel(Framework::ResourceSet& resourceBucket);
+		EnvironmentModel(Framework::ResourceSet& resourceBucket, const External::Environment& environment);
 		~EnvironmentModel() = default;
 
 		void render(Framework::Graphics::Renderer& renderer);
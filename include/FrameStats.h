@@ -0,0 +1,108 @@
+/* CLASS OVERVIEW
+ * - Per-frame timings of the application's main loop, kept for the last FRAME_COUNT frames in a ring buffer: physics
+ *   steps run, time spent in physics, rendering and the UI, total frame time and heap allocations
+ * - Filled by VehicleSimulation as the frame runs (phases are timed with ScopedTimer) and read by UILayer's
+ *   Performance panel. Not thread-safe: both run on the main thread
+ * - Each phase has a budget in ms; frames over budget are counted so overruns show even when they are rare
+ * - Allocations are counted by the application's replacement operator new calling countAllocation
+*/
+
+#ifndef FRAMESTATS_H
+#define FRAMESTATS_H
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+namespace Internal {
+	class FrameStats {
+	public:
+		static constexpr size_t FRAME_COUNT = 240;
+
+		enum Phase : unsigned char {
+			PHYSICS,
+			RENDER,
+			UI,
+			FRAME,
+			PHASE_COUNT
+		};
+
+		//All floats, so each column can be plotted directly from the ring with a stride of sizeof(Frame)
+		struct Frame {
+			float
+				physicsSteps = 0.0f,
+				physics = 0.0f,          //ms
+				render = 0.0f,           //ms, excluding the UI
+				ui = 0.0f,               //ms
+				frame = 0.0f,            //ms, from the end of the previous frame
+				allocations = 0.0f;
+		};
+
+		struct Summary {
+			float
+				mean = 0.0f,
+				p50 = 0.0f,
+				p99 = 0.0f,
+				max = 0.0f;
+			unsigned int overBudget = 0;  //Frames in the ring over the phase's budget
+		};
+
+		//Adds the time from its construction to its destruction to a phase of the current frame
+		class ScopedTimer {
+		private:
+			FrameStats& mStats;
+			Phase mPhase;
+			std::chrono::steady_clock::time_point mBegin;
+
+		public:
+			inline ScopedTimer(FrameStats& stats, Phase phase) : mStats(stats), mPhase(phase), mBegin(std::chrono::steady_clock::now()) { }
+			inline ~ScopedTimer() { mStats.addTime(mPhase, std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - mBegin).count()); }
+
+			ScopedTimer(const ScopedTimer&) = delete;
+			ScopedTimer& operator=(const ScopedTimer&) = delete;
+		};
+
+	private:
+		static std::atomic<unsigned long long> mAllocationCount;
+
+		Frame
+			mFrames[FRAME_COUNT],
+			mCurrent;
+
+		size_t
+			mNext = 0,         //Ring index the next finished frame is written to
+			mRecorded = 0;     //Frames written, up to FRAME_COUNT
+
+		unsigned long long mAllocationsAtFrameStart = 0;
+		std::chrono::steady_clock::time_point mFrameStart;
+
+		float mBudget[PHASE_COUNT] = { 8.0f, 6.0f, 2.0f, 1000.0f / 60.0f }; //ms
+
+	public:
+		FrameStats();
+		~FrameStats() = default;
+
+		void addTime(Phase phase, float ms);
+		void endFrame();
+		void clear();
+
+		Summary summarise(Phase phase) const;
+		static float getValue(const Frame& frame, Phase phase);
+
+		inline void countPhysicsStep() { mCurrent.physicsSteps += 1.0f; }
+		inline static void countAllocation() { mAllocationCount.fetch_add(1, std::memory_order_relaxed); }
+
+		//Oldest first: frame i of getRecorded() is getFrames()[(getOldest() + i) % FRAME_COUNT]
+		inline const Frame* getFrames() const { return mFrames; }
+		inline size_t getOldest() const { return mRecorded < FRAME_COUNT ? 0 : mNext; }
+		inline size_t getRecorded() const { return mRecorded; }
+		inline const Frame& getLatest() const { return mFrames[(mNext + FRAME_COUNT - 1) % FRAME_COUNT]; }
+
+		inline float getBudget(Phase phase) const { return mBudget[phase]; }
+		inline float* getBudgetHandle(Phase phase) { return &mBudget[phase]; }
+
+	};
+}
+
+#endif
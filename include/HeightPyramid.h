@@ -0,0 +1,62 @@
+/* CLASS OVERVIEW
+ * - The lowest and highest heights within each cell of a quadtree over a square block of terrain (the whole of a
+ *   Terrain, or one streamed tile), so raycasts can skip every cell a ray passes clear over (or under) without looking
+ *   at its triangles
+ * - A cell of level k is 2^k x 2^k terrain squares (fewer at the block's far edges). Only levels from BASE_LEVEL up are
+ *   stored, as floats rounded outwards so they always contain the heights; the cells below are ranged from the heights
+ *   as they are visited. That keeps the pyramid to well under a byte per height sample
+ * - raycast descends through the cells the ray crosses, nearest first, down to single squares, whose two triangles
+ *   are intersected exactly. How far a ray reaches costs only a level or so per doubling, not a square at a time
+*/
+
+#ifndef HEIGHTPYRAMID_H
+#define HEIGHTPYRAMID_H
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <glm/glm/vec3.hpp>
+
+#include "TerrainData.h"
+
+namespace External {
+	class HeightPyramid {
+	public:
+		struct HeightRange {
+			float
+				lowest,                  //m
+				highest;                 //m
+		};
+
+		struct Hit {
+			double distance;             //Along the ray, in multiples of its direction
+			size_t triIndex;             //Into the block's per-triangle data
+		};
+
+		//Cells of 4 x 4 squares are the smallest stored
+		static constexpr unsigned int BASE_LEVEL = 2;
+
+	private:
+		unsigned int mSquares = 0;                  //Along each side of the block
+		std::vector<unsigned int> mLevelCells;      //Along each side, of each stored level from BASE_LEVEL up to a single cell
+		std::vector<size_t> mLevelOffsets;          //Into mRanges, of each stored level
+		std::vector<HeightRange> mRanges;           //[level][cellX][cellZ]
+
+	public:
+		void build(const TerrainData& data, unsigned int squares);
+		bool raycast(const TerrainData& data, glm::dvec3 origin, glm::dvec3 direction, double maxDistance, Hit& hit) const;
+
+		inline size_t getBytes() const { return mRanges.size() * sizeof(HeightRange); }
+		static size_t calcBytes(unsigned int squares);
+
+	private:
+		HeightRange getRange(const TerrainData& data, unsigned int level, unsigned int cellX, unsigned int cellZ) const;
+		bool raycastCell(const TerrainData& data, const glm::dvec3& origin, const glm::dvec3& direction, unsigned int level, unsigned int cellX, unsigned int cellZ,
+			double enter, double exit, Hit& hit) const;
+		bool raycastSquare(const TerrainData& data, const glm::dvec3& origin, const glm::dvec3& direction, unsigned int squareX, unsigned int squareZ,
+			double enter, double exit, Hit& hit) const;
+
+	};
+}
+
+#endif
@@ -0,0 +1,100 @@
+/* CLASS OVERVIEW
+ * - Times a car round the track: its progress along the TrackCentreline, sector splits, lap times, and track-limit
+ *   violations (too many of its wheels off tarmac at once)
+ * - update is called after every physics step with the car's position and the surface type (TerrainType) under each
+ *   wheel. The position is projected onto the centreline by searching from the segment found last step, so each step
+ *   costs a few segment tests; only a car that has left the line far behind (e.g. reset elsewhere) is found again
+ *   through the centreline's spatial index
+ * - Progress is measured from the start line (Settings::startDistance along the centreline), unwrapped, so going
+ *   backwards over the line takes it below zero rather than completing a lap. Lap n (1, 2, ...) is completed the first
+ *   time progress reaches n lengths of the track; timing starts the first time it reaches 0, so the first lap is the
+ *   first flying lap. Crossing times are interpolated within the step, for timing finer than the step size
+ * - Laps and their sectors are kept in the order they were completed. No memory is allocated except to keep a lap
+*/
+
+#ifndef LAPTIMER_H
+#define LAPTIMER_H
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <glm/glm/vec2.hpp>
+
+#include "TrackCentreline.h"
+
+namespace Internal {
+	class Car;
+
+	class LapTimer {
+	public:
+		struct Settings {
+			unsigned int
+				sectors = 3,                 //Of equal length along the centreline
+				wheelsOffForViolation = 4;   //Wheels off tarmac at once that break the track limits
+			double
+				startDistance = 0.0,         //m, of the start line along the centreline
+				relocateDistance = 15.0;     //m from the line beyond which the car is searched for across the whole track
+		};
+
+		struct Lap {
+			double time;                     //s
+			std::vector<double> sectorTimes; //s
+			unsigned int trackLimitViolations;
+		};
+
+	private:
+		const External::TrackCentreline& mCentreline;
+		const Settings mSettings;
+		const double
+			mLength,                         //m, of the centreline
+			mSectorLength;                   //m
+
+		bool mStarted = false;               //Whether a position has been given yet
+		size_t mSegment = 0;                 //Of the centreline, nearest the car last step
+		double
+			mLineDistance = 0.0,             //m, along the centreline, last step
+			mLateralOffset = 0.0,            //m, right of the centreline, last step
+			mProgress = 0.0,                 //m, unwrapped, from the start line
+			mLapStartTime = 0.0,             //s
+			mSplitTime = 0.0,                //s, when the last sector ended
+			mLastTime = 0.0;                 //s, of the last step
+
+		//The next sector boundary to be crossed, at mNextSplit * mSectorLength of progress. Every mSettings.sectors-th
+		//is the start line
+		long long mNextSplit = 0;
+
+		bool mTiming = false;                //Whether a lap is running
+		bool mOffTrack = false;              //Whether the wheels were off last step
+		unsigned int mTotalViolations = 0;
+
+		Lap mCurrentLap;
+		std::vector<Lap> mLaps;
+
+	public:
+		explicit LapTimer(const External::TrackCentreline& centreline);
+		LapTimer(const External::TrackCentreline& centreline, const Settings& settings);
+
+		void update(const Car& car, double t);
+		void update(double t, glm::dvec2 position_world, const unsigned char* surfaceTypes, unsigned int wheelCount);
+		void reset();
+
+		double getProgressPercent() const;
+		double getBestLapTime() const;
+		inline double getProgress() const { return mProgress; }
+		inline double getLateralOffset() const { return mLateralOffset; }
+		inline size_t getSegment() const { return mSegment; }
+		inline bool isTiming() const { return mTiming; }
+		inline bool isOffTrack() const { return mOffTrack; }
+		inline const Lap& getCurrentLap() const { return mCurrentLap; }
+		inline const std::vector<Lap>& getLaps() const { return mLaps; }
+		inline unsigned int getTotalViolations() const { return mTotalViolations; }
+		inline const Settings& getSettings() const { return mSettings; }
+
+	private:
+		void locate(glm::dvec2 position_world);
+		void crossSplits(double previousProgress, double t);
+
+	};
+}
+
+#endif
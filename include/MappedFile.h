@@ -0,0 +1,52 @@
+/* CLASS OVERVIEW
+ * - A whole file mapped read-only into memory (mmap, or a file mapping on Windows), unmapped on destruction
+ * - Pages are read from disk (or the page cache) as they are first touched, so opening even a large file is cheap and
+ *   several processes mapping the same file share its memory
+ * - Or a file being written, mapped read-write: stores to the mapping go to the page cache, and are written to disk by
+ *   the OS in the background. resize grows (or shrinks) the file and maps it again, so the data may move
+*/
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+namespace Internal {
+	class MappedFile {
+	private:
+		const void* mData = nullptr;
+		size_t mSize = 0;                //bytes
+		bool mWritable = false;
+
+#ifdef _WIN32
+		void
+			*mFileHandle = nullptr,
+			*mMappingHandle = nullptr;
+#else
+		int mFileDescriptor = -1;        //Kept open only while writable, for resize
+#endif
+
+	public:
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool openReadOnly(const std::string& path);
+		bool openReadWrite(const std::string& path, size_t size);
+		bool resize(size_t size);
+		void close();
+
+		inline bool isOpen() const { return mData != nullptr; }
+		inline bool isWritable() const { return mWritable; }
+		inline const void* getData() const { return mData; }
+		inline void* getWritableData() const { return mWritable ? const_cast<void*>(mData) : nullptr; }
+		inline size_t getSize() const { return mSize; }
+
+	};
+}
+
+#endif
@@ -0,0 +1,231 @@
+/* CLASS(ES) OVERVIEW
+ * - Vectorised evaluation of Pacejka's Magic Formula, used by PacejkaMagicFormula::evaluate
+ * - PacejkaKernels::Coefficients is a double-precision copy of the a/b parameters, taken once per evaluate call
+ * - PacejkaKernels::evaluateBatch is written once against a small set of vector operations (Ops), and each
+ *   instruction set provides its own Ops in its own translation unit, which is the only code compiled for that set
+ * - exp, sin and atan are the Cephes double-precision approximations, accurate to a few ulp over the
+ *   ranges the Magic Formula produces (|exp argument| < 708, |sin argument| < 1e8)
+*/
+
+#ifndef PACEJKAKERNELS_H
+#define PACEJKAKERNELS_H
+#pragma once
+
+#include <cstddef>
+
+namespace Internal {
+	namespace PacejkaKernels {
+		struct Coefficients {
+			double
+				a[18],  //Lateral
+				b[14];  //Longitudinal
+		};
+
+		//Each returns false (and does nothing) if it was not compiled in
+		bool evaluateAvx2(const Coefficients& coefficients, const double* verticalLoads_N, const double* slipPercents, const double* slipAngles_degs, const double* camberAngles_degs, size_t count, double* longitudinalForces, double* lateralForces);
+		bool evaluateAvx512(const Coefficients& coefficients, const double* verticalLoads_N, const double* slipPercents, const double* slipAngles_degs, const double* camberAngles_degs, size_t count, double* longitudinalForces, double* lateralForces);
+
+		bool cpuSupportsAvx2();
+		bool cpuSupportsAvx512();
+
+		template<typename Ops>
+		struct Maths {
+			typedef typename Ops::V V;
+			typedef typename Ops::M M;
+
+			static inline V polevl(V x, const double* coefficients, int degree)
+			{
+				V result = Ops::set1(coefficients[0]);
+				for (int i = 1; i <= degree; i++)
+					result = Ops::fmadd(result, x, Ops::set1(coefficients[i]));
+				return result;
+			}
+
+			static inline V p1evl(V x, const double* coefficients, int degree)
+			{
+				V result = Ops::add(x, Ops::set1(coefficients[0]));
+				for (int i = 1; i < degree; i++)
+					result = Ops::fmadd(result, x, Ops::set1(coefficients[i]));
+				return result;
+			}
+
+			static inline V sign(V x)
+			{
+				const V zero = Ops::set1(0.0), one = Ops::set1(1.0);
+				return Ops::sub(Ops::select(Ops::cmpGt(x, zero), one, zero), Ops::select(Ops::cmpLt(x, zero), one, zero));
+			}
+
+			static inline V exp(V x)
+			{
+				static const double
+					P[] = { 1.26177193074810590878E-4, 3.02994407707441961300E-2, 9.99999999999999999910E-1 },
+					Q[] = { 3.00198505138664455042E-6, 2.52448340349684104192E-3, 2.27265548208155028766E-1, 2.00000000000000000009E0 };
+
+				x = Ops::min(Ops::max(x, Ops::set1(-708.0)), Ops::set1(708.0));
+
+				const V n = Ops::floor(Ops::fmadd(x, Ops::set1(1.4426950408889634073599), Ops::set1(0.5)));
+				x = Ops::sub(x, Ops::mul(n, Ops::set1(6.93145751953125E-1)));
+				x = Ops::sub(x, Ops::mul(n, Ops::set1(1.42860682030941723212E-6)));
+
+				const V
+					xx = Ops::mul(x, x),
+					px = Ops::mul(x, polevl(xx, P, 2)),
+					r = Ops::div(px, Ops::sub(polevl(xx, Q, 3), px));
+
+				return Ops::mul(Ops::fmadd(r, Ops::set1(2.0), Ops::set1(1.0)), Ops::pow2n(n));
+			}
+
+			static inline V sin(V x)
+			{
+				static const double
+					sincof[] = { 1.58962301576546568060E-10, -2.50507477628578072866E-8, 2.75573136213857245213E-6, -1.98412698295895385996E-4, 8.33333333332211858878E-3, -1.66666666666666307295E-1 },
+					coscof[] = { -1.13585365213876817300E-11, 2.08757008419747316778E-9, -2.75573141792967388112E-7, 2.48015872888517045348E-5, -1.38888888888730564116E-3, 4.16666666666665929218E-2 };
+
+				const V
+					zero = Ops::set1(0.0),
+					one = Ops::set1(1.0),
+					ax = Ops::abs(x);
+
+				//Octant j, rounded up to an even number so that z lies in [-pi/4, pi/4]
+				V y = Ops::floor(Ops::mul(ax, Ops::set1(1.27323954473516268615)));
+				const V odd = Ops::sub(y, Ops::mul(Ops::set1(2.0), Ops::floor(Ops::mul(y, Ops::set1(0.5)))));
+				y = Ops::add(y, odd);
+
+				V j = Ops::sub(y, Ops::mul(Ops::set1(8.0), Ops::floor(Ops::mul(y, Ops::set1(0.125)))));
+				const M flip = Ops::cmpGt(j, Ops::set1(3.0));
+				j = Ops::select(flip, Ops::sub(j, Ops::set1(4.0)), j);
+
+				const V
+					z = Ops::sub(Ops::sub(Ops::sub(ax, Ops::mul(y, Ops::set1(7.85398125648498535156E-1))), Ops::mul(y, Ops::set1(3.77489470793079817668E-8))), Ops::mul(y, Ops::set1(2.69515142907905952645E-15))),
+					zz = Ops::mul(z, z),
+					cosPart = Ops::add(Ops::sub(one, Ops::mul(zz, Ops::set1(0.5))), Ops::mul(Ops::mul(zz, zz), polevl(zz, coscof, 5))),
+					sinPart = Ops::fmadd(Ops::mul(z, zz), polevl(zz, sincof, 5), z),
+					result = Ops::select(Ops::cmpEq(j, Ops::set1(2.0)), cosPart, sinPart);
+
+				const M negative = Ops::maskXor(flip, Ops::cmpLt(x, zero));
+				return Ops::select(negative, Ops::neg(result), result);
+			}
+
+			static inline V atan(V x)
+			{
+				static const double
+					P[] = { -8.750608600031904122785E-1, -1.615753718733365076637E1, -7.500855792314704667340E1, -1.228866684490136173410E2, -6.485021904942025371773E1 },
+					Q[] = { 2.485846490142306297962E1, 1.650270098316988542046E2, 4.328810604912902668951E2, 4.853903996359136964868E2, 1.945506571482613964425E2 };
+
+				const double moreBits = 6.123233995736765886130E-17;
+
+				const V
+					zero = Ops::set1(0.0),
+					one = Ops::set1(1.0),
+					ax = Ops::abs(x);
+
+				const M
+					large = Ops::cmpGt(ax, Ops::set1(2.41421356237309504880)),
+					medium = Ops::maskAndNot(large, Ops::cmpGt(ax, Ops::set1(0.66)));
+
+				const V
+					xr = Ops::select(large, Ops::div(Ops::neg(one), ax), Ops::select(medium, Ops::div(Ops::sub(ax, one), Ops::add(ax, one)), ax)),
+					y = Ops::select(large, Ops::set1(1.57079632679489661923), Ops::select(medium, Ops::set1(7.85398163397448309616E-1), zero)),
+					extra = Ops::select(large, Ops::set1(moreBits), Ops::select(medium, Ops::set1(0.5 * moreBits), zero)),
+					z = Ops::mul(xr, xr),
+					ratio = Ops::div(Ops::mul(z, polevl(z, P, 4)), p1evl(z, Q, 5)),
+					result = Ops::add(y, Ops::add(Ops::fmadd(xr, ratio, xr), extra));
+
+				return Ops::select(Ops::cmpLt(x, zero), Ops::neg(result), result);
+			}
+
+			static inline V longitudinalForce(const Coefficients& c, V load_kN, V slipAsPercent)
+				/* Equivalent of PacejkaMagicFormula::calcLongitudinalForce
+				*/
+			{
+				const double* b = c.b;
+				const V
+					zero = Ops::set1(0.0),
+					one = Ops::set1(1.0),
+					loadSquared_kN = Ops::mul(load_kN, load_kN),
+
+					C = Ops::set1(b[0]),
+					D = Ops::mul(load_kN, Ops::fmadd(Ops::set1(b[1]), load_kN, Ops::set1(b[2]))),
+					BCD = Ops::mul(Ops::fmadd(Ops::set1(b[0]), loadSquared_kN, Ops::mul(Ops::set1(b[4]), load_kN)), exp(Ops::mul(Ops::set1(-b[5]), load_kN))),
+					B = Ops::div(BCD, Ops::mul(C, D)),
+					H = Ops::fmadd(Ops::set1(b[9]), load_kN, Ops::set1(b[10])),
+					E = Ops::mul(Ops::fmadd(Ops::set1(b[6]), loadSquared_kN, Ops::fmadd(Ops::set1(b[7]), load_kN, Ops::set1(b[8]))), Ops::sub(one, Ops::mul(Ops::set1(b[13]), sign(Ops::add(slipAsPercent, H))))),
+					V_ = Ops::fmadd(Ops::set1(b[11]), load_kN, Ops::set1(b[12])),
+					Bx1 = Ops::mul(B, Ops::add(slipAsPercent, H)),
+					force = Ops::fmadd(D, sin(Ops::mul(C, atan(Ops::sub(Bx1, Ops::mul(E, Ops::sub(Bx1, atan(Bx1))))))), V_);
+
+				const M inactive = Ops::maskOr(Ops::cmpEq(load_kN, zero), Ops::cmpEq(slipAsPercent, zero));
+				return Ops::select(inactive, zero, force);
+			}
+
+			static inline V lateralForce(const Coefficients& c, V load_kN, V slipAngle_degs, V camberAngle_degs)
+				/* Equivalent of PacejkaMagicFormula::calcLateralForce
+				*/
+			{
+				const double* a = c.a;
+				const V
+					zero = Ops::set1(0.0),
+					one = Ops::set1(1.0),
+
+					C = Ops::set1(a[0]),
+					D = Ops::mul(Ops::mul(load_kN, Ops::fmadd(Ops::set1(a[1]), load_kN, Ops::set1(a[2]))), Ops::sub(one, Ops::mul(Ops::set1(a[15]), Ops::mul(camberAngle_degs, camberAngle_degs)))),
+					BCD = Ops::mul(Ops::mul(Ops::set1(a[3]), sin(Ops::mul(atan(Ops::div(load_kN, Ops::set1(a[4]))), Ops::set1(2.0)))), Ops::sub(one, Ops::mul(Ops::set1(a[5]), Ops::abs(camberAngle_degs)))),
+					B = Ops::div(BCD, Ops::mul(C, D)),
+					H = Ops::fmadd(Ops::set1(a[10]), camberAngle_degs, Ops::fmadd(Ops::set1(a[8]), load_kN, Ops::set1(a[9]))),
+					E = Ops::mul(Ops::fmadd(Ops::set1(a[6]), load_kN, Ops::set1(a[7])), Ops::sub(one, Ops::mul(Ops::fmadd(Ops::set1(a[16]), camberAngle_degs, Ops::set1(a[17])), sign(Ops::add(slipAngle_degs, H))))),
+					V_ = Ops::add(Ops::fmadd(Ops::set1(a[11]), load_kN, Ops::set1(a[12])), Ops::mul(Ops::mul(Ops::fmadd(Ops::set1(a[13]), load_kN, Ops::set1(a[14])), camberAngle_degs), load_kN)),
+					Bx1 = Ops::mul(B, Ops::add(slipAngle_degs, H)),
+					force = Ops::fmadd(D, sin(Ops::mul(C, atan(Ops::sub(Bx1, Ops::mul(E, Ops::sub(Bx1, atan(Bx1))))))), V_);
+
+				const M inactive = Ops::maskOr(Ops::cmpEq(load_kN, zero), Ops::cmpEq(slipAngle_degs, zero));
+				return Ops::select(inactive, zero, force);
+			}
+		};
+
+		template<typename Ops>
+		inline void evaluateBatch(const Coefficients& coefficients, const double* verticalLoads_N, const double* slipPercents, const double* slipAngles_degs, const double* camberAngles_degs, size_t count, double* longitudinalForces, double* lateralForces)
+			/* Called by the per-instruction-set kernels
+			 * The tail (count not a multiple of the vector width) is copied through zero-padded buffers, where zero load produces zero force
+			*/
+		{
+			typedef typename Ops::V V;
+			const size_t width = Ops::width;
+
+			size_t i = 0;
+			for (; i + width <= count; i += width) {
+				const V load_kN = Ops::div(Ops::load(verticalLoads_N + i), Ops::set1(1000.0));
+				Ops::store(longitudinalForces + i, Maths<Ops>::longitudinalForce(coefficients, load_kN, Ops::load(slipPercents + i)));
+				Ops::store(lateralForces + i, Maths<Ops>::lateralForce(coefficients, load_kN, Ops::load(slipAngles_degs + i), Ops::load(camberAngles_degs + i)));
+			}
+
+			if (i < count) {
+				double
+					loads[Ops::width] = {},
+					slips[Ops::width] = {},
+					angles[Ops::width] = {},
+					cambers[Ops::width] = {},
+					longitudinal[Ops::width],
+					lateral[Ops::width];
+
+				const size_t remaining = count - i;
+				for (size_t k = 0; k < remaining; k++) {
+					loads[k] = verticalLoads_N[i + k];
+					slips[k] = slipPercents[i + k];
+					angles[k] = slipAngles_degs[i + k];
+					cambers[k] = camberAngles_degs[i + k];
+				}
+
+				const V load_kN = Ops::div(Ops::load(loads), Ops::set1(1000.0));
+				Ops::store(longitudinal, Maths<Ops>::longitudinalForce(coefficients, load_kN, Ops::load(slips)));
+				Ops::store(lateral, Maths<Ops>::lateralForce(coefficients, load_kN, Ops::load(angles), Ops::load(cambers)));
+
+				for (size_t k = 0; k < remaining; k++) {
+					longitudinalForces[i + k] = longitudinal[k];
+					lateralForces[i + k] = lateral[k];
+				}
+			}
+		}
+	}
+}
+
+#endif
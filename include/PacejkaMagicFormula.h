@@ -1,33 +1,56 @@
 /* CLASS OVERVIEW
  * - Implementation of Pacejka's Magic Formula for calculating tyre force (lon and lat) from slip (ratio and angle),
  *   a detailed description of which can be found at http://www.edy.es/dev/docs/pacejka-94-parameters-explained-a-comprehensive-guide/
+ * - updateForces evaluates one tyre; evaluate evaluates any number of tyres in one pass, using AVX-512 or AVX2 when
+ *   the CPU supports them (see PacejkaKernels.hpp) and the scalar formula otherwise
+ * - The scalar formula is the reference: updateForces, and evaluate at SimdLevel::SCALAR, give identical results
+ * - Coefficients come from a PacejkaParams set: by default the published one (following UILayer edits), or one given
+ *   to this instance with setParams
+ * - Terms that depend only on the load (D, BCD, E, ...) are kept between updates, and only recalculated when the
+ *   load moves by more than the set's loadTolerance_N
 */
 
 #ifndef PACEJKAMAGICFORMULA_H
 #define PACEJKAMAGICFORMULA_H
 #pragma once
 
-namespace Internal {
-	struct Slip;
+#include <cmath>
+#include <memory>
+#include <cstddef>
+
+#include "PacejkaParams.h"
 
+namespace Internal {
 	class PacejkaMagicFormula {
 	public:
-		//Longitudinal parameters
-		static float b0, b1, b2, b3, b4, b5, b6, b7, b8, b9, b10, b11, b12, b13;
+		enum class SimdLevel : unsigned char { SCALAR, AVX2, AVX512 };
 
-		//Lateral parameters
-		static float a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17;
+		//The parts of the formula that depend only on the vertical load (and the coefficients)
+		struct LoadTerms {
+			double
+				load_kN = 0.0,
+				longitudinalD = 0.0,       //Peak
+				longitudinalB = 0.0,       //Stiffness
+				longitudinalE = 0.0,       //Curvature, before the b13 shift
+				longitudinalH = 0.0,       //Horizontal shift
+				longitudinalV = 0.0,       //Vertical shift
+				lateralD = 0.0,            //Peak, before camber
+				lateralBCD = 0.0,          //Cornering stiffness, before camber
+				lateralE = 0.0,            //Curvature, before camber
+				lateralH = 0.0,            //Horizontal shift, before camber
+				lateralV = 0.0,            //Vertical shift, before camber
+				lateralCamberV = 0.0;      //Multiplied by camber * load for the camber part of the vertical shift
+		};
 
 	private:
-		float
-			C = 0.0,
-			D = 0.0,
-			BCD = 0.0,
-			B = 0.0,
-			E = 0.0,
-			H = 0.0,
-			V = 0.0,
-			Bx1 = 0.0;
+		static SimdLevel mSimdLevel;
+
+		std::shared_ptr<const PacejkaParams> mParams;
+		unsigned int mPublishedVersion = 0;
+		bool mFollowsPublished = true;
+
+		LoadTerms mLoadTerms;
+		bool mLoadTermsValid = false;
 
 		double
 			mLongitudinalForce = 0.0,
@@ -38,18 +61,29 @@ namespace Internal {
 		~PacejkaMagicFormula() = default;
 
 		void updateForces(double verticalLoad_N, double slipPercent0_to_100, double slipAngle_degs, double camberAngle_degs);
-		static void setToRoadTyreParams();
-		static void setToDriftingTyreParams();
+		static void evaluate(const PacejkaParams& params, const double* verticalLoads_N, const double* slipPercents0_to_100, const double* slipAngles_degs, const double* camberAngles_degs, size_t count, double* longitudinalForces, double* lateralForces);
+
+		void setParams(std::shared_ptr<const PacejkaParams> params);
+		const std::shared_ptr<const PacejkaParams>& updateParams();
 
 		inline double getLongitudinalForce() const { return mLongitudinalForce; }
 		inline double getLateralForce() const { return mLateralForce; }
+		inline const std::shared_ptr<const PacejkaParams>& getParams() const { return mParams; }
+		inline bool followsPublishedParams() const { return mFollowsPublished; }
 
-	private:
-		void updateLongitudinalForce(double load_kN, double slipAsPercent);
-		void updateLateralForce(double load_kN, double slipAngle_degs, double camberAngle_degs);
+		static SimdLevel getSupportedSimdLevel();
+		static void setSimdLevel(SimdLevel level);
+		inline static SimdLevel getSimdLevel() { return mSimdLevel; }
 
+		static LoadTerms calcLoadTerms(const PacejkaParams& params, double load_kN);
+		static double calcLongitudinalForce(const PacejkaParams& params, const LoadTerms& terms, double slipAsPercent);
+		static double calcLateralForce(const PacejkaParams& params, const LoadTerms& terms, double slipAngle_degs, double camberAngle_degs);
+		inline static double calcLongitudinalForce(const PacejkaParams& params, double load_kN, double slipAsPercent) { return calcLongitudinalForce(params, calcLoadTerms(params, load_kN), slipAsPercent); }
+		inline static double calcLateralForce(const PacejkaParams& params, double load_kN, double slipAngle_degs, double camberAngle_degs) { return calcLateralForce(params, calcLoadTerms(params, load_kN), slipAngle_degs, camberAngle_degs); }
+
+	private:
 		//Implementation of the mathematical sign() function
-		inline int sign(double val) { return (0.0 < val) - (val < 0.0); }
+		inline static int sign(double val) { return (0.0 < val) - (val < 0.0); }
 
 	};
 }
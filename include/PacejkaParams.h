@@ -0,0 +1,79 @@
+/* CLASS OVERVIEW
+ * - One complete set of Pacejka Magic Formula coefficients (a tyre compound), held by value
+ * - Tyres refer to a set through std::shared_ptr<const PacejkaParams>: a set is never modified once shared, so any
+ *   number of tyres, on any number of threads, can read it without locking
+ * - The published set is the one edited by UILayer. publish swaps in a new set atomically; tyres that follow it
+ *   (the default) pick it up at their next update, while tyres given their own set are unaffected
+ * - A description of every coefficient can be found at http://www.edy.es/dev/docs/pacejka-94-parameters-explained-a-comprehensive-guide/
+*/
+
+#ifndef PACEJKAPARAMS_H
+#define PACEJKAPARAMS_H
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+namespace Internal {
+	class PacejkaParams {
+	public:
+		//Longitudinal parameters          //guide's default values
+		float
+			b0 = 1.4f,                     //1.65
+			b1 = 80.0f,                    //0
+			b2 = 1700.0f,                  //1100
+			b3 = 0.0f,                     //0
+			b4 = 300.0f,                   //300
+			b5 = 1.0f,                     //0
+			b6 = 0.0f,                     //0
+			b7 = 0.0f,                     //0
+			b8 = -2.0f,                    //-2
+			b9 = 0.0f,                     //0
+			b10 = 0.0f,                    //0
+			b11 = 0.0f,                    //0
+			b12 = 0.0f,                    //0
+			b13 = 0.0f;                    //0
+
+		//Lateral parameters
+		float
+			a0 = 1.4f,                     //1.4
+			a1 = 80.0f,                    //0
+			a2 = 1700.0f,                  //1100
+			a3 = 1100.0f,                  //1100
+			a4 = 50.0f,                    //10
+			a5 = 0.0f,                     //0
+			a6 = 0.0f,                     //0
+			a7 = -2.0f,                    //-2
+			a8 = 0.0f,                     //0
+			a9 = 0.0f,                     //0
+			a10 = 0.0f,                    //0
+			a11 = 0.0f,                    //0
+			a12 = 0.0f,                    //0
+			a13 = 0.0f,                    //0
+			a14 = 0.0f,                    //0
+			a15 = 0.0f,                    //0
+			a16 = 0.0f,                    //0
+			a17 = 0.0f;                    //0
+
+		//Load change (N) below which PacejkaMagicFormula::updateForces reuses its load-dependent terms.
+		//0.0 recomputes them whenever the load changes at all, which gives exactly the formula's result
+		double loadTolerance_N = 0.0;
+
+	private:
+		static std::atomic<unsigned int> mPublishedVersion;
+
+	public:
+		static PacejkaParams driftingTyre();
+		static PacejkaParams roadTyre();
+
+		static std::shared_ptr<const PacejkaParams> getPublished();
+		static void publish(const PacejkaParams& params);
+		inline static unsigned int getPublishedVersion() { return mPublishedVersion.load(std::memory_order_acquire); }
+
+	private:
+		static std::shared_ptr<const PacejkaParams>& publishedSlot();
+
+	};
+}
+
+#endif
@@ -0,0 +1,106 @@
+/* CLASS OVERVIEW
+ * - Design-of-experiments runner: varies chosen Car parameters over ranges, runs one headless Car per sample, and
+ *   reports one Result per run
+ * - Samples are generated in the unit cube (full-factorial grid, Latin hypercube or Sobol sequence) and then scaled
+ *   to each parameter's range; parameters that are not varied keep the stock Car's value
+ * - Runs are independent (each owns its Car, and tyre sets and the Environment are shared and immutable), so they are spread
+ *   over all cores with a WorkStealingPool. Each run's result depends only on its sample, not on the thread count
+ *   or on which thread ran it
+*/
+
+#ifndef PARAMETERSWEEP_H
+#define PARAMETERSWEEP_H
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+
+#include "PacejkaParams.h"
+
+namespace External {
+	class Environment;
+}
+
+namespace Internal {
+	class WorkStealingPool;
+
+	class ParameterSweep {
+	public:
+		enum Parameter : unsigned char { MASS, SPRING_CONSTANT, DAMPING, DRAG_COEFFICIENT, FRONTAL_AREA, STEERING_RATIO, TYRE_SET, PARAMETER_COUNT };
+		enum class Sampling : unsigned char { GRID, LATIN_HYPERCUBE, SOBOL };
+
+		//Every parameter of one run (TYRE_SET is an index into the sweep's tyre sets)
+		struct Sample {
+			double values[PARAMETER_COUNT];
+		};
+
+		//Driver inputs are held constant for the whole run
+		struct Scenario {
+			double
+				duration = 10.0,               //s
+				updateDelta = 1.0 / 1000.0,    //s
+				throttle = 1.0,                //0.0 -> 1.0
+				steeringWheelAngle = 0.0;      //degs
+		};
+
+		struct Result {
+			size_t run = 0;
+			Sample sample;
+
+			double
+				distanceTravelled = 0.0,       //m, horizontal
+				maxSpeed = 0.0,                //m/s
+				finalSpeed = 0.0,              //m/s
+				maxLateralAcceleration = 0.0,  //m/s^2, car-space
+				maxWheelAngle = 0.0,           //degs, of either front wheel
+				finalX = 0.0,                  //m
+				finalZ = 0.0;                  //m
+
+			bool rolledOver = false;           //Upside down at the end of the run
+		};
+
+	private:
+		struct Range {
+			Parameter parameter;
+			double
+				min,
+				max;
+		};
+
+		Sample mDefaults;
+		std::vector<Range> mRanges;
+		std::vector<std::shared_ptr<const PacejkaParams>> mTyreSets;
+		std::shared_ptr<const External::Environment> mEnvironment;
+
+	public:
+		ParameterSweep();
+		~ParameterSweep() = default;
+
+		void vary(Parameter parameter, double min, double max);
+		void setTyreSets(const std::vector<std::shared_ptr<const PacejkaParams>>& tyreSets);
+		inline void setEnvironment(std::shared_ptr<const External::Environment> environment) { mEnvironment = std::move(environment); }
+
+		std::vector<Sample> generate(Sampling sampling, size_t runs, unsigned int gridLevels, uint64_t seed) const;
+		std::vector<Result> run(const std::vector<Sample>& samples, const Scenario& scenario, WorkStealingPool& pool) const;
+		Result runOne(size_t run, const Sample& sample, const Scenario& scenario) const;
+
+		inline size_t getVariedCount() const { return mRanges.size(); }
+		inline const Sample& getDefaults() const { return mDefaults; }
+
+		static std::vector<double> generateUnitSamples(Sampling sampling, unsigned int dimensions, size_t runs, unsigned int gridLevels, uint64_t seed);
+		static const char* getParameterName(Parameter parameter);
+		static void writeCsvHeader(FILE* file);
+		static void writeCsvRow(FILE* file, const Result& result);
+
+	private:
+		static void generateGrid(unsigned int dimensions, unsigned int levels, std::vector<double>& unitSamples);
+		static void generateLatinHypercube(unsigned int dimensions, size_t runs, uint64_t seed, std::vector<double>& unitSamples);
+		static void generateSobol(unsigned int dimensions, size_t runs, std::vector<double>& unitSamples);
+
+	};
+}
+
+#endif
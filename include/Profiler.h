@@ -0,0 +1,87 @@
+/* CLASS OVERVIEW
+ * - Scoped timing of the simulation and render phases, exported as Chrome trace JSON (chrome://tracing or
+ *   ui.perfetto.dev)
+ * - VDS_PROFILE_SCOPE("Name") times from that line to the end of the enclosing scope. Unless VDS_PROFILE is defined
+ *   (the CMake option of the same name) the macro expands to nothing, so instrumented code is unchanged in normal builds
+ * - Each thread records into its own fixed-capacity ring which no other thread writes to, so recording takes no
+ *   locks. A full ring wraps, overwriting its oldest events (which are counted), so a trace always holds the most
+ *   recent window of a long session. Exporting checks each ring's counters after copying it and leaves out any event
+ *   overwritten meanwhile. Rings live until the program exits
+ * - Scope names must be string literals (or otherwise outlive the Profiler), as only the pointer is stored
+*/
+
+#ifndef PROFILER_H
+#define PROFILER_H
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef VDS_PROFILE
+#define VDS_PROFILE_CONCAT_INNER(a, b) a##b
+#define VDS_PROFILE_CONCAT(a, b) VDS_PROFILE_CONCAT_INNER(a, b)
+#define VDS_PROFILE_SCOPE(name) const Internal::Profiler::Scope VDS_PROFILE_CONCAT(profileScope_, __LINE__)(name)
+#else
+#define VDS_PROFILE_SCOPE(name)
+#endif
+
+namespace Internal {
+	class Profiler {
+	public:
+		struct Event {
+			const char* name;
+			int64_t
+				begin,     //ns since the Profiler's epoch
+				end;       //ns since the Profiler's epoch
+		};
+
+		//Records one Event covering its own lifetime, if the Profiler was enabled when it was constructed
+		class Scope {
+		private:
+			const char* mName;
+			int64_t mBegin;  //ns, or -1 when not recording
+
+		public:
+			inline explicit Scope(const char* name) : mName(name), mBegin(Profiler::isEnabled() ? Profiler::now() : -1) { }
+			inline ~Scope() { if (mBegin >= 0) Profiler::record(mName, mBegin, Profiler::now()); }
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+		};
+
+	private:
+		struct ThreadBuffer;
+		struct Registry;
+
+		static std::atomic<bool> mEnabled;
+		static std::atomic<size_t> mThreadCapacity;
+
+		static Registry& getRegistry();
+		static ThreadBuffer& getThreadBuffer();
+
+	public:
+		static void record(const char* name, int64_t begin, int64_t end);
+		static int64_t now();
+
+		static bool writeChromeTrace(const char* path);
+		static void clear();
+
+		static void setThreadCapacity(size_t events);
+		static size_t getEventCount();
+		static size_t getWrappedCount();
+
+		inline static void setEnabled(bool enabled) { mEnabled.store(enabled, std::memory_order_relaxed); }
+		inline static bool isEnabled() { return mEnabled.load(std::memory_order_relaxed); }
+
+		inline static constexpr bool isCompiledIn() {
+#ifdef VDS_PROFILE
+			return true;
+#else
+			return false;
+#endif
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,116 @@
+/* CLASS OVERVIEW
+ * - A simulated lidar mounted on a Car: a fan of rays in fixed directions relative to the sensor (columns of azimuth,
+ *   each of rings of elevation), cast against the terrain of the car's Environment
+ * - Each scan returns a packed point cloud, in the sensor's own space (the car's axes: x right, y up, -z forward), of
+ *   the rays that hit within maxRange, each labelled with its ring, column and surface type (TerrainType)
+ * - The columns are cast in parallel on a WorkStealingPool, each through Terrain::raycast (and so its height pyramid)
+ * - scan casts on the calling thread and the pool's workers, and returns the cloud. startScan instead takes the car's
+ *   pose and returns straight away, leaving the scan to a background thread (started on the first call), so the car
+ *   can go on being updated; takeScan later collects the cloud. A scan asked for while one is running is dropped
+*/
+
+#ifndef RANGESENSOR_H
+#define RANGESENSOR_H
+#pragma once
+
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <condition_variable>
+#include <glm/glm/vec3.hpp>
+#include <glm/glm/mat4x4.hpp>
+#include <glm/glm/gtc/quaternion.hpp>
+
+#include "Environment.h"
+#include "WorkStealingPool.h"
+
+namespace Internal {
+	class Car;
+
+	class RangeSensor {
+	public:
+		struct Settings {
+			glm::dvec3 position_car = glm::dvec3(0.0, 1.6, 0.0);                   //m, where it is mounted
+			glm::dquat orientation_car = glm::dquat(1.0, 0.0, 0.0, 0.0);           //Of the sensor's axes relative to the car's
+			unsigned int
+				columns = 1024,              //Of azimuth, spread evenly over horizontalFieldOfView (at most 65536)
+				rings = 128;                 //Of elevation, spread evenly from lowestElevation to highestElevation (at most 256)
+			double
+				horizontalFieldOfView = 360.0,   //degs, centred on forward
+				lowestElevation = -25.0,         //degs
+				highestElevation = 5.0,          //degs
+				maxRange = 120.0;                //m
+			unsigned int threads = 0;        //0 = one per hardware thread
+		};
+
+		//16 bytes, so a cloud can be handed on as it is
+		struct Point {
+			float position_sensor[3];        //m
+			uint16_t column;
+			uint8_t ring;
+			uint8_t surfaceType;             //TerrainType
+		};
+
+		struct PointCloud {
+			double time = 0.0;               //s, of the car's pose it was scanned from
+			glm::dmat4 sensorToWorld = glm::dmat4(1.0);
+			size_t rayCount = 0;
+			std::vector<Point> points;       //Of the rays that hit, by column and then ring
+		};
+
+	private:
+		const Settings mSettings;
+		const unsigned int
+			mColumns,                        //mSettings' counts, within their limits
+			mRings;                          //^
+		std::vector<glm::dvec3> mDirections_sensor;  //Of every ray, [column][ring]
+		WorkStealingPool mPool;
+
+		//Background scans (startScan), run one at a time by mScanThread
+		struct Request {
+			double time;
+			glm::dmat4 sensorToWorld;
+			std::shared_ptr<const External::Environment> environment;
+		};
+
+		std::mutex mMutex;
+		std::condition_variable mWake;
+		std::thread mScanThread;
+		Request mRequest;
+		PointCloud
+			mScanning,                       //Being filled by mScanThread
+			mFinished;                       //The latest finished, until taken
+		bool
+			mRequested = false,
+			mBusy = false,
+			mFinishedReady = false,
+			mStopping = false;
+
+	public:
+		RangeSensor();
+		explicit RangeSensor(const Settings& settings);
+		~RangeSensor();
+
+		RangeSensor(const RangeSensor&) = delete;
+		RangeSensor& operator=(const RangeSensor&) = delete;
+
+		void scan(const Car& car, double t, PointCloud& cloud);
+		bool startScan(const Car& car, double t);
+		bool takeScan(PointCloud& cloud);
+		void waitForScan();
+
+		glm::dmat4 calcSensorToWorld(const Car& car) const;
+		inline size_t getRayCount() const { return mDirections_sensor.size(); }
+		inline const Settings& getSettings() const { return mSettings; }
+
+	private:
+		void castRays(const External::Terrain& terrain, PointCloud& cloud);
+		void runScanThread();
+
+	};
+}
+
+#endif
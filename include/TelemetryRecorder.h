@@ -0,0 +1,153 @@
+/* CLASS OVERVIEW
+ * - Records a Car's telemetry every physics step to a binary log: its state, steering and throttle, and for each
+ *   wheel the quantities shown in the UI's wheel telemetry (load, slip ratio and angle, tyre force, suspension length,
+ *   angular velocity and steering angle)
+ * - record copies one Sample into a single-producer, single-consumer ring and returns; it takes no lock, makes no
+ *   system call and allocates nothing, so recording every step adds little to the step. If the ring is full the
+ *   sample is dropped (and counted) rather than the simulation waiting
+ * - A background writer thread empties the ring every writeInterval into the log, a file mapped read-write
+ *   (MappedFile) that is grown by doubling its blocks, and trimmed to those written once closed
+ * - The log describes itself: a header, then a directory of its columns (name, unit, element type, and where each is
+ *   in a block), then blocks of blockRecords records. Within a block each column's values are together, in record
+ *   order, so one quantity can be read over a run without touching the others. The header's record count is brought
+ *   up to date after every write, so the log can be read while it is being recorded, and everything up to the last
+ *   write survives a crash
+*/
+
+#ifndef TELEMETRYRECORDER_H
+#define TELEMETRYRECORDER_H
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <condition_variable>
+
+#include "MappedFile.h"
+
+namespace Internal {
+	class Car;
+
+	class TelemetryRecorder {
+	public:
+		static constexpr unsigned int FILE_VERSION = 1;
+		static constexpr unsigned int WHEELS = 4; //Front left, front right, rear left, rear right
+
+		struct Settings {
+			size_t
+				ringCapacity = 8192,         //Samples, rounded up to a power of 2
+				blockRecords = 4096;         //Records per block of the log
+			double writeInterval = 0.005;    //s, between the writer thread emptying the ring
+		};
+
+		struct WheelSample {
+			float
+				load,                        //N
+				slipRatio,
+				slipAngle,                   //degs
+				lateralForce,                //N, of the tyre
+				longitudinalForce,           //N, of the tyre
+				suspensionLength,            //m
+				angularVelocity,             //rads/s
+				steeringAngle;               //degs
+		};
+
+		struct Sample {
+			double
+				time,                        //s
+				position_world[3],           //m
+				velocity_world[3],           //m/s
+				orientation_world[4],        //Quaternion (w, x, y, z)
+				angularVelocity_world[3],    //rads/s
+				acceleration_world[3],       //m/s^2
+				steeringWheelAngle,          //degs
+				throttle;                    //0.0 -> 1.0
+			WheelSample wheels[WHEELS];
+		};
+
+		enum class ColumnType : uint32_t { FLOAT64, FLOAT32 };
+
+		//Start of every log, followed by columnCount ColumnHeaders and then, from dataOffset, the blocks
+		struct FileHeader {
+			char magic[8];
+			uint32_t
+				version,
+				byteOrder,                   //Of the machine that wrote the log, as the first four bytes of 0x01020304
+				columnCount,
+				blockRecords;
+			uint64_t
+				recordCount,
+				droppedCount,                //Samples the ring had no room for
+				blockBytes,
+				dataOffset;                  //Bytes from the start of the log to the first block
+		};
+
+		struct ColumnHeader {
+			char
+				name[48],                    //e.g. "wheel.fl.load"
+				unit[16];
+			ColumnType type;
+			uint32_t elementBytes;
+			uint64_t blockOffset;            //Bytes from the start of a block to the column's first value
+		};
+
+	private:
+		const Settings mSettings;
+		const size_t mRingMask;
+
+		std::vector<Sample> mRing;
+		alignas(64) std::atomic<size_t> mHead;   //Next sample to be recorded, only stored by the recording thread
+		alignas(64) std::atomic<size_t> mTail;   //Next sample to be written, only stored by the writer thread
+		alignas(64) std::atomic<size_t> mDroppedCount;   //Only stored by the recording thread
+
+		//The log, only touched by the writer thread while it runs
+		MappedFile mFile;
+		std::vector<ColumnHeader> mColumns;
+		std::vector<size_t> mSampleOffsets;      //Of each column's value in a Sample, in bytes
+		size_t
+			mBlockBytes = 0,
+			mDataOffset = 0,
+			mMappedBlocks = 0;
+		uint64_t mRecordCount = 0;
+		bool mWriteFailed = false;
+
+		std::mutex mMutex;
+		std::condition_variable mWake;
+		std::thread mWriterThread;
+		bool mStopping = false;
+
+	public:
+		TelemetryRecorder();
+		explicit TelemetryRecorder(const Settings& settings);
+		~TelemetryRecorder();
+
+		TelemetryRecorder(const TelemetryRecorder&) = delete;
+		TelemetryRecorder& operator=(const TelemetryRecorder&) = delete;
+
+		bool open(const std::string& path);
+		bool close();
+		bool record(const Car& car, double t);
+		bool record(const Sample& sample);
+
+		static void capture(const Car& car, double t, Sample& sample);
+
+		inline bool isOpen() const { return mWriterThread.joinable(); }
+		inline size_t getDroppedCount() const { return mDroppedCount.load(std::memory_order_relaxed); }
+		inline size_t getRecordedCount() const { return mHead.load(std::memory_order_relaxed); }
+		inline uint64_t getWrittenCount() const { return mRecordCount; }      //Once closed
+		inline const Settings& getSettings() const { return mSettings; }
+
+	private:
+		Sample* claim();
+		void runWriterThread();
+		size_t writeSamples();
+		void writeHeader();
+
+	};
+}
+
+#endif
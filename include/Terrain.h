@@ -2,14 +2,38 @@
  * - Responsible for generating, storing, and providing acces to 3 buffers of data (mHeights, mNormals, mSurfaceTypes)
  * - Generation of these buffers uses multiple TerrainGenLayer objects
  * - The majority of the code in this class is executed at load-time
+ * - sampleContact(s) returns everything the physics needs under a point (height, normal, surface type) from a single
+ *   index calculation; getHeight and getNormal_world share the same calculation
+ * - Generation is fully determined by Settings::seed. With a cache directory set, the buffers are saved to a binary
+ *   file named after the seed, size and a hash of the generation layers' configuration, and later Terrains with the
+ *   same key map that file (MappedFile) instead of generating. The buffers are then read directly from the mapping
+ * - Generation is split into tiles of rows run on a WorkStealingPool, one layer at a time: all height layers, then the
+ *   normals, then the surface types, each waiting for the one before. Every value depends only on the layers before
+ *   it, never on the tiling, so the result is bit-identical to generating on one thread
+ * - Streamed terrain (Settings::streamed) is never generated as a whole. It has no edges: its squares are generated a
+ *   tile at a time, wherever they are needed (TerrainTileCache), identical to the same squares of the whole terrain.
+ *   The queries are unchanged, each resolving its square through the calling thread's hot tile
+ * - Settings::compact stores quantised heights and packed per-triangle records instead of doubles (see TerrainData),
+ *   for the whole terrain, its cache file, or each streamed tile. Quantisation is per ROWS_PER_TILE rows of heights, or
+ *   per streamed tile
+ * - raycast intersects a ray with the surface, skipping the space it passes clear of using a HeightPyramid (built the
+ *   first time the whole terrain is raycast, or with each streamed tile), so its cost grows with the log of the ray's
+ *   length rather than with the squares it crosses
+ * - The track's centreline (TrackCentreline) is kept, whether the terrain was generated or loaded, for code following
+ *   the track at run-time
 */
 
 #ifndef TERRAIN_H
 #define TERRAIN_H
 #pragma once
 
+#include <string>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <cstddef>
 #include <glm/glm/vec3.hpp>
 #include <glm/glm/vec2.hpp>
 #include <glm/glm/geometric.hpp>
@@ -18,38 +42,144 @@
 
 #include "TerrainGenLayers.hpp"
 #include "Track.h"
+#include "MappedFile.h"
+#include "TerrainData.h"
+#include "HeightPyramid.h"
+#include "TerrainTileCache.h"
 
-namespace Visual {
-	class TerrainModel;
+namespace Internal {
+	class WorkStealingPool;
 }
 
 namespace External {
 	class Terrain {
-		friend class Visual::TerrainModel;
+	public:
+		struct Settings {
+			unsigned long long seed = 1;
+			unsigned int size = 291;     //Height samples along each side (metres + 1), rounded up to an odd number of at least 3
+			std::string cacheDirectory;  //Where generated terrain is saved to and loaded from (created if needed); empty for no cache
+			unsigned int generationThreads = 0; //0 = one per hardware thread
+			bool streamed = false;       //Generate tiles around where the terrain is queried, instead of all of it up front
+			size_t tileMemoryBudget = 256 << 20; //bytes of streamed tiles kept in memory
+			bool compact = false;        //16-bit heights and 32-bit triangle records (TerrainData) instead of doubles
+		};
+
+		struct Contact {
+			double height;               //m
+			glm::dvec3 normal_world;
+			unsigned char surfaceType;   //TerrainType
+			size_t triIndex;             //Into the per-triangle arrays (mNormals, mSurfaceTypes, mTriangles, or a streamed tile's)
+		};
+
+		struct RayHit {
+			double distance;             //m, along the ray
+			glm::dvec3 position_world;
+			glm::dvec3 normal_world;
+			unsigned char surfaceType;   //TerrainType
+		};
+
+		//How far around a position passed to prefetch its tiles are generated ahead of being needed
+		static constexpr double PREFETCH_DISTANCE = 128.0; //m
+
+		//The furthest streamed terrain is raycast, as a ray that misses would otherwise generate tiles without end
+		static constexpr double MAX_STREAMED_RAY_DISTANCE = 4096.0; //m
+
 	private:
+		//The terrain square a point lies over, and where within that square it lies
+		struct SquareIndex {
+			const TerrainData* data;     //The buffers the square is in: the whole terrain's, or a streamed tile's
+			size_t
+				heightsIndexBL_X,        //Heights treated as a 2D array: [heightsIndexBL_X][...]
+				heightsIndexBL;          //Into the heights, of the square's bottom left point
+			glm::dvec2 withinSquare;     //0.0 -> 1.0 on both axes
+		};
+
+
+		//Part of every cache file's key. Must be increased whenever generation changes in a way the layers' config hashes
+		//cannot see (e.g. the noise functions, or the layout of the cache file itself)
+		static constexpr unsigned int CACHE_VERSION = 1;
+
+		//Rows of height samples (or terrain squares) generated as one task
+		static constexpr unsigned int ROWS_PER_TILE = 8;
+
+		//Compact heights share an offset and scale per ROWS_PER_TILE rows, so each row tile is quantised on its own
+		static constexpr unsigned int QUANTISATION_SHIFT = 3;
+		static_assert(1u << QUANTISATION_SHIFT == ROWS_PER_TILE, "Compact heights are quantised one row tile at a time");
+
 		//Width of the terrain square in height sample points e.g. 7 for 6m x 6m terrain.
-		const unsigned short mSize = 291;
+		//All index arithmetic is done in size_t, as mSize * mSize overflows 32 bits for sizes above 46341
+		const unsigned int mSize;
 
+		Settings mSettings;
+		unsigned long long mConfigHash = 0;  //Of CACHE_VERSION and every generation layer's configuration
+		bool mLoadedFromCache = false;
+
+		//Generated buffers (empty while the terrain is read from the cache file instead). Compact terrain is generated
+		//into the first three and then packed into the last three
 		std::vector<double> mHeights;
 		std::vector<glm::dvec3> mNormals;
 		std::vector<unsigned char> mSurfaceTypes;
+		std::vector<uint16_t> mQuantisedHeights;
+		std::vector<HeightQuantisation> mHeightQuantisations;
+		std::vector<uint32_t> mTriangles;
 		std::vector<std::unique_ptr<TerrainGenLayer>> mGenerationLayers;
+		const Track* mTrack = nullptr;   //One of mGenerationLayers, kept for its centreline
+
+		//Streamed terrain only. Declared after the layers, so its prefetch thread is stopped before they are destroyed
+		std::unique_ptr<TerrainTileCache> mTiles;
+
+		Internal::MappedFile mCacheFile;
+
+		//Every read goes through this: into the buffers above, or into mCacheFile
+		TerrainData mData;
+
+		//Of the whole terrain (streamed tiles have their own), built by the first raycast
+		mutable HeightPyramid mPyramid;
+		mutable std::mutex mPyramidMutex;
+		mutable std::atomic<bool> mPyramidBuilt;
 
 	public:
 		Terrain();
+		explicit Terrain(const Settings& settings);
 		~Terrain() = default;
 
+		Terrain(const Terrain&) = delete;
+		Terrain& operator=(const Terrain&) = delete;
+
 		void generate();
-		double getHeight(glm::dvec2 horizontalSamplePoint);
-		glm::dvec3 getNormal_world(glm::dvec2 horizontalSamplePoint);
+		std::string getCachePath() const;
+		double getHeight(glm::dvec2 horizontalSamplePoint) const;
+		glm::dvec3 getNormal_world(glm::dvec2 horizontalSamplePoint) const;
+		Contact sampleContact(glm::dvec2 horizontalSamplePoint) const;
+		void sampleContacts(const glm::dvec2* horizontalSamplePoints, size_t count, Contact* contacts) const;
+		void prefetch(glm::dvec2 horizontalPosition) const;
+		bool raycast(glm::dvec3 origin_world, glm::dvec3 direction_world, double maxDistance, RayHit& hit) const;
 
-		inline const unsigned short getSize() const { return mSize; }
+		inline unsigned int getSize() const { return mSize; }
+		inline unsigned long long getSeed() const { return mSettings.seed; }
+		inline unsigned long long getConfigHash() const { return mConfigHash; }
+		inline bool isLoadedFromCache() const { return mLoadedFromCache; }
+		inline bool isStreamed() const { return mTiles != nullptr; }
+		inline bool isCompact() const { return mSettings.compact; }
+		size_t getMemoryBytes() const;
+		inline TerrainTileCache* getTileCache() const { return mTiles.get(); }
+		inline const TrackCentreline& getTrackCentreline() const { return mTrack->getCentreline(); }
 
 	private:
-		void generateHeightData();
-		void generateNormalData();
-		void generateSurfaceTypeData();
-		unsigned int calc_PerTriAttribute_Index(glm::dvec2 horizontalSamplePoint);
+		bool loadCache();
+		bool saveCache() const;
+		void generateHeightData(Internal::WorkStealingPool& pool);
+		void generateNormalData(Internal::WorkStealingPool& pool);
+		static void generateNormalRows(const double* heights, glm::dvec3* normals, unsigned int samplesPerRow, unsigned int firstRow, unsigned int endRow);
+		void generateTile(TerrainTileCache::Tile& tile) const;
+		void generateSurfaceTypeData(Internal::WorkStealingPool& pool);
+		void compactRows(unsigned int firstRow, unsigned int endRow);
+		static void runInRowTiles(Internal::WorkStealingPool& pool, unsigned int rowCount, const std::function<void(unsigned int firstRow, unsigned int endRow)>& run);
+		SquareIndex calcSquareIndex(glm::dvec2 horizontalSamplePoint) const;
+		SquareIndex calcTileSquareIndex(glm::dvec2 horizontalSamplePoint) const;
+		double calcHeight(const SquareIndex& square) const;
+		Contact calcContact(const SquareIndex& square) const;
+		static size_t calc_PerTriAttribute_Index(const SquareIndex& square);
 
 	};
 }
@@ -0,0 +1,80 @@
+/* CLASS OVERVIEW
+ * - A read-only view of the buffers of a block of terrain (the whole of a Terrain, or one streamed tile), stored in
+ *   one of two ways:
+ *   - full precision: a double per height sample, a dvec3 normal and a byte of surface type per triangle
+ *   - compact: a 16-bit height per sample, scaled by an offset and scale shared by a block of rows, and one 32-bit
+ *     record per triangle holding its octahedral-encoded normal (12 bits per axis) and its surface type (8 bits).
+ *     About 6x smaller, with heights within half a quantisation step (scale / 2) and normals within 0.1 degrees
+ * - Terrain's queries read through here, so they work the same on either
+*/
+
+#ifndef TERRAINDATA_H
+#define TERRAINDATA_H
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <glm/glm/vec3.hpp>
+#include <glm/glm/geometric.hpp>
+
+namespace External {
+	//height = offset + scale * quantised height
+	struct HeightQuantisation {
+		double
+			offset,                      //m
+			scale;                       //m per step
+	};
+
+	struct TerrainData {
+		size_t samplesPerRow = 0;        //Of heights (one more than the squares)
+
+		//Full precision (nullptr when compact)
+		const double* heights = nullptr;
+		const glm::dvec3* normals = nullptr;
+		const unsigned char* surfaceTypes = nullptr;
+
+		//Compact (nullptr when full precision)
+		const uint16_t* quantisedHeights = nullptr;
+		const HeightQuantisation* quantisations = nullptr;   //One per 2^quantisationShift rows of heights
+		const uint32_t* triangles = nullptr;
+		unsigned int quantisationShift = 0;
+
+		inline double getHeight(size_t heightsIndex, size_t row) const {
+			if (heights)
+				return heights[heightsIndex];
+
+			const HeightQuantisation& quantisation = quantisations[row >> quantisationShift];
+			return quantisation.offset + quantisation.scale * quantisedHeights[heightsIndex];
+		}
+
+		inline glm::dvec3 getNormal(size_t triIndex) const { return normals ? normals[triIndex] : unpackNormal(triangles[triIndex]); }
+		inline unsigned char getSurfaceType(size_t triIndex) const { return surfaceTypes ? surfaceTypes[triIndex] : (unsigned char)(triangles[triIndex] >> 24); }
+
+		static HeightQuantisation quantiseHeights(const double* heights, size_t count, uint16_t* quantised);
+		static uint32_t packTriangle(const glm::dvec3& normal, unsigned char surfaceType);
+
+		static inline glm::dvec3 unpackNormal(uint32_t triangle)
+			/* Called by TerrainData::getNormal
+			 * Inverse of packTriangle's octahedral encoding: (u, v) on the octahedron |x| + |y| + |z| = 1, with the lower
+			 * half (y < 0) folded out over the corners
+			*/
+		{
+			double
+				u = (triangle & 0xfff) * (2.0 / 4095.0) - 1.0,
+				v = ((triangle >> 12) & 0xfff) * (2.0 / 4095.0) - 1.0;
+
+			const double y = 1.0 - std::abs(u) - std::abs(v);
+			if (y < 0.0) {
+				const double foldedU = (1.0 - std::abs(v)) * (u < 0.0 ? -1.0 : 1.0);
+				v = (1.0 - std::abs(u)) * (v < 0.0 ? -1.0 : 1.0);
+				u = foldedU;
+			}
+
+			return glm::normalize(glm::dvec3(u, y, v));
+		}
+
+	};
+}
+
+#endif
@@ -2,6 +2,13 @@
 * - A TerrainGenLayer adds one layer of modification to data buffers passed to it (heights and surface types).
 * - RoughSand derives from TerrainGenLayer and modifies the heights buffer using Perlin noise
 * - All code in this class is executed at load-time
+* - Each layer hashes the parameters that shape its output (getConfigHash), so cached terrain is only reused by a
+*   Terrain built from the same layers. Randomness comes only from the seed a layer is constructed with
+* - Layers are run over a range of rows (first index of the buffer as a 2D array) at a time, by several threads at
+*   once, so a call may only write within its rows. It may read anything the previous layers wrote
+* - Streamed terrain is instead generated one tile at a time (runTileHeights, runTileSurfaceTypes), anywhere in the
+*   world and from any thread, so those calls must not modify the layer. A tile must come out exactly as the same
+*   squares of the whole terrain would, so that neighbouring tiles (and the whole terrain) agree
 */
 
 #ifndef TERRAINGENLAYERS_H
@@ -10,7 +17,8 @@
 
 #include <cmath>
 #include <vector>
-#include <chrono>
+#include <random>
+#include <cstddef>
 #include <Framework/Maths/Noise.h>
 #include <glm/glm/vec2.hpp>
 #include <glm/glm/gtc/constants.hpp>
@@ -18,71 +26,152 @@
 namespace External {
 	enum TerrainType { GRASS, TARMAC, ERROR_TYPE };
 
+	//A square block of height samples, and of the terrain squares between them, e.g. one tile of streamed terrain
+	struct TerrainRegion {
+		int
+			firstX,                  //m, world position of the first (bottom left) height sample
+			firstZ;                  //^
+		unsigned int samples;        //Height samples along each side (one more than the squares)
+	};
+
 	class TerrainGenLayer {
 	public:
-		virtual void runHeights(std::vector<double>& previousLayerHeights) = 0;
-		virtual void runSurfaceTypes(std::vector<unsigned char>& previousLayerSurfaceTypes) = 0;
+		virtual ~TerrainGenLayer() = default;
+
+		//Rows of height samples [firstRow, endRow)
+		virtual void runHeights(std::vector<double>& previousLayerHeights, unsigned int firstRow, unsigned int endRow) = 0;
+		//Rows of terrain squares [firstRow, endRow), each holding two triangles per square
+		virtual void runSurfaceTypes(std::vector<unsigned char>& previousLayerSurfaceTypes, unsigned int firstRow, unsigned int endRow) = 0;
+		//All of one tile, whose buffers hold only that tile (tile.samples * tile.samples heights)
+		virtual void runTileHeights(std::vector<double>& previousLayerHeights, const TerrainRegion& tile) const = 0;
+		virtual void runTileSurfaceTypes(std::vector<unsigned char>& previousLayerSurfaceTypes, const TerrainRegion& tile) const = 0;
+		virtual unsigned long long getConfigHash() const = 0;
+
+		static unsigned long long hashBytes(unsigned long long hash, const void* bytes, size_t count)
+			/* Called by the layers' getConfigHash, and Terrain
+			 * FNV-1a, continuing from hash (start from FNV_OFFSET_BASIS)
+			*/
+		{
+			for (size_t i = 0; i < count; i++)
+				hash = (hash ^ static_cast<const unsigned char*>(bytes)[i]) * 0x100000001b3ull;
+
+			return hash;
+		}
+
+		static constexpr unsigned long long FNV_OFFSET_BASIS = 0xcbf29ce484222325ull;
 
 	};
 
 	class RoughGround : public TerrainGenLayer {
+	private:
+		const double
+			mHillAmplitude = 8.0,    //m
+			mHillFrequency = 0.1,
+			mMoundAmplitude = 0.5,   //m
+			mMoundFrequency = 1.0;
+
+		int
+			mOffsetX = 0, //Where in the (repeating) noise the terrain starts, chosen by the seed
+			mOffsetZ = 0; //^
+
 	public:
-		virtual void runHeights(std::vector<double>& previousLayerHeights)
+		explicit RoughGround(unsigned long long seed)
+			/* Called by Terrain::Terrain
+			 * The offsets are the top 16 bits of mt19937_64 draws, which the standard fixes exactly, so a seed gives
+			 * the same terrain on every platform
+			*/
+		{
+			std::mt19937_64 random(seed);
+			mOffsetX = (int)(random() >> 48);
+			mOffsetZ = (int)(random() >> 48);
+		}
+
+		virtual void runHeights(std::vector<double>& previousLayerHeights, unsigned int firstRow, unsigned int endRow)
 			/* Called by Terrain::generateHeightData
 			* Modifies the data in previousLayerHeights by adding to it
 			*/
 		{
-			//This ensures that the terrain is random for each run
-			srand(time(NULL));
-
 			const int
 				terrainSize = sqrt(previousLayerHeights.size()),
-				halfTerrainSize = 0.5 * terrainSize,
-				randomXOffset = rand(),
-				randomZOffset = rand();
+				halfTerrainSize = 0.5 * terrainSize;
 
-			int currentHeightIndex = 0;
+			size_t currentHeightIndex = 0;
 
-			double
-				perlinCorrectX = 0.0, //Corrects for the fact that 1 Perlin noise 'unit' will be 16 meters
-				perlinCorrectZ = 0.0, //^
-				total = 0,            //A total value, used each iteration, to summate layers of Perlin noise
-				amplitude = 0,		  //Used in the Perlin noise calculation
-				frequency = 0;		  //^
-
-			//Iterate over all heights in the buffer passed in
-			for (int x = -halfTerrainSize; x <= halfTerrainSize; x++) {
+			//Iterate over all heights in the rows passed in
+			for (int x = (int)firstRow - halfTerrainSize; x < (int)endRow - halfTerrainSize; x++) {
 				for (int z = -halfTerrainSize; z <= halfTerrainSize; z++) {
-					currentHeightIndex = (x + halfTerrainSize) * terrainSize + (z + halfTerrainSize);
+					currentHeightIndex = (size_t)(x + halfTerrainSize) * terrainSize + (z + halfTerrainSize);
 
-					perlinCorrectX = randomXOffset + x / 16.0;
-					perlinCorrectZ = randomZOffset + z / 16.0;
-
-					//Reset the total
-					total = 0.0;
-
-					//Add low frequency hills
-					amplitude = 8.0;
-					frequency = 0.1;
-					total += -abs(Framework::Maths::Noise::octavePerlin(perlinCorrectX * frequency, perlinCorrectZ * frequency, 3.0, 1.1) * amplitude);
+					//Set the current value in the buffer to the height of the ground here
+					previousLayerHeights[currentHeightIndex] = calcHeight(x, z);
+				}
+			}
+		}
 
-					//Add higher frequency mounds of earth
-					amplitude = 0.5;
-					frequency = 1.0;
-					total += -Framework::Maths::Noise::multiFractalRidged(perlinCorrectX * frequency, perlinCorrectZ * frequency, 2.0, 1.0, 1.0) * amplitude;
+		virtual void runTileHeights(std::vector<double>& previousLayerHeights, const TerrainRegion& tile) const
+			/* Called by Terrain::generateTile
+			* The noise is defined everywhere, so tiles can be generated however far from the origin they are
+			*/
+		{
+			size_t currentHeightIndex = 0;
 
-					//Set the current value in the buffer to this new total
-					previousLayerHeights[(x + halfTerrainSize) * terrainSize + (z + halfTerrainSize)] = total;
+			for (unsigned int x = 0; x < tile.samples; x++) {
+				for (unsigned int z = 0; z < tile.samples; z++) {
+					currentHeightIndex = (size_t)x * tile.samples + z;
+					previousLayerHeights[currentHeightIndex] = calcHeight(tile.firstX + (int)x, tile.firstZ + (int)z);
 				}
 			}
 		}
 
-		virtual void runSurfaceTypes(std::vector<unsigned char>& previousLayerSurfaceTypes)
+		virtual void runSurfaceTypes(std::vector<unsigned char>& previousLayerSurfaceTypes, unsigned int firstRow, unsigned int endRow)
 			/*Called by Terrain::generateSurfaceTypeData
 			* The terrain is grass by default, so the RoughGround does not need to modify it
 			*/
 		{ }
 
+		virtual void runTileSurfaceTypes(std::vector<unsigned char>& previousLayerSurfaceTypes, const TerrainRegion& tile) const
+			/*Called by Terrain::generateTile
+			*/
+		{ }
+
+		virtual unsigned long long getConfigHash() const
+			/* Called by Terrain::Terrain
+			*/
+		{
+			const double parameters[4] = { mHillAmplitude, mHillFrequency, mMoundAmplitude, mMoundFrequency };
+			return hashBytes(FNV_OFFSET_BASIS, parameters, sizeof(parameters));
+		}
+
+	private:
+		double calcHeight(int x, int z) const
+			/* Called by
+			 * - RoughGround::runHeights
+			 * - RoughGround::runTileHeights
+			 * The height of the ground at the height sample (x, z)
+			*/
+		{
+			const double
+				perlinCorrectX = mOffsetX + x / 16.0, //Corrects for the fact that 1 Perlin noise 'unit' will be 16 meters
+				perlinCorrectZ = mOffsetZ + z / 16.0; //^
+
+			double
+				total = 0.0,          //Summates the layers of Perlin noise
+				amplitude = 0.0,      //Used in the Perlin noise calculation
+				frequency = 0.0;      //^
+
+			//Add low frequency hills
+			amplitude = mHillAmplitude;
+			frequency = mHillFrequency;
+			total += -std::abs(Framework::Maths::Noise::octavePerlin(perlinCorrectX * frequency, perlinCorrectZ * frequency, 3.0, 1.1) * amplitude);
+
+			//Add higher frequency mounds of earth
+			amplitude = mMoundAmplitude;
+			frequency = mMoundFrequency;
+			total += -Framework::Maths::Noise::multiFractalRidged(perlinCorrectX * frequency, perlinCorrectZ * frequency, 2.0, 1.0, 1.0) * amplitude;
+
+			return total;
+		}
+
 	};
 
 }
@@ -1,5 +1,7 @@
 /* CLASS OVERVIEW
  * Generates a graphical model of the Terrain, to be rendered within the Environment
+ * - Only the central MAX_MODEL_SQUARES x MAX_MODEL_SQUARES squares of larger terrain are modelled, keeping the vertex count
+ *   within what the 32-bit index buffer (and the GPU) can hold
 */
 
 #ifndef TERRAINMODEL_H
@@ -16,12 +18,16 @@
 namespace Visual {
 	class TerrainModel {
 	private:
+		static constexpr int MAX_MODEL_SQUARES = 1024;
+
 		Framework::ResourceSet& mResourceBucket;
+		const External::Terrain& mTerrain;
 		Framework::Model3D mModel;
 		Framework::Graphics::Shader* mShader = nullptr;
+		const int mHalfModelSize;        //Squares modelled either side of the origin, on both axes
 
 	public:
-		TerrainModel(Framework::ResourceSet& resourceBucket, Framework::Graphics::Shader* terrainShader);
+		TerrainModel(Framework::ResourceSet& resourceBucket, Framework::Graphics::Shader* terrainShader, const External::Terrain& terrain);
 		~TerrainModel() = default;
 
 		void render(Framework::Graphics::Renderer& renderer);
@@ -0,0 +1,111 @@
+/* CLASS OVERVIEW
+ * - Holds the tiles of streamed terrain that are in memory. Each tile is TILE_SQUARES x TILE_SQUARES terrain squares:
+ *   their heights (including the far edges, shared with the next tiles), normals, surface types and height pyramid
+ * - A tile is generated when it is first needed, on the thread that needs it, unless prefetch has already queued it
+ *   for the background thread. Once the tiles held take more than the memory budget, the least recently used are
+ *   evicted, so the world is never resident as a whole
+ * - Each thread keeps the last tile it looked up (the hot tile), so repeated queries within one tile, e.g. by the
+ *   wheels of one car, do not take the lock. The hot tile is kept alive by its thread even if it is evicted meanwhile
+*/
+
+#ifndef TERRAINTILECACHE_H
+#define TERRAINTILECACHE_H
+#pragma once
+
+#include <list>
+#include <cmath>
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <condition_variable>
+#include <glm/glm/vec3.hpp>
+
+#include "TerrainData.h"
+#include "HeightPyramid.h"
+#include "TerrainGenLayers.hpp"
+
+namespace External {
+	class TerrainTileCache {
+	public:
+		static constexpr int TILE_SQUARES = 256;
+
+		struct Tile {
+			TerrainRegion region;                  //TILE_SQUARES + 1 samples, starting at a multiple of TILE_SQUARES
+			TerrainData data;                      //Into whichever of the buffers below are used
+
+			std::vector<double> heights;
+			std::vector<glm::dvec3> normals;       //Two per square, as Terrain::mNormals
+			std::vector<unsigned char> surfaceTypes;
+
+			//Compact tiles (with one quantisation for the whole tile)
+			std::vector<uint16_t> quantisedHeights;
+			HeightQuantisation quantisation;
+			std::vector<uint32_t> triangles;
+
+			HeightPyramid pyramid;                 //For Terrain::raycast
+
+			size_t getBytes() const;
+		};
+
+		typedef std::function<void(Tile& tile)> Generator;
+
+	private:
+		typedef unsigned long long Key;
+
+		struct Entry {
+			std::shared_ptr<const Tile> tile;
+			std::list<Key>::iterator recentlyUsed;  //Position in mRecentlyUsed
+		};
+
+		const Generator mGenerator;
+		const size_t mMemoryBudget;                 //bytes
+
+		//Identifies this cache (and its contents since the last clear) to the threads' hot tiles
+		std::atomic<unsigned long long> mId;
+
+		std::mutex mMutex;
+		std::unordered_map<Key, Entry> mTiles;
+		std::list<Key> mRecentlyUsed;               //Most recently used first
+		size_t mResidentBytes = 0;                  //Of the tiles in mTiles
+		std::atomic<size_t> mGeneratedCount;
+
+		//Tiles queued by prefetch, generated one at a time by mPrefetchThread (started on the first prefetch)
+		std::deque<Key> mPrefetchQueue;
+		std::condition_variable mPrefetchWake;
+		std::thread mPrefetchThread;
+		bool mStopping = false;
+
+	public:
+		TerrainTileCache(const Generator& generator, size_t memoryBudget);
+		~TerrainTileCache();
+
+		TerrainTileCache(const TerrainTileCache&) = delete;
+		TerrainTileCache& operator=(const TerrainTileCache&) = delete;
+
+		const Tile& getTile(int tileX, int tileZ);
+		void prefetch(int firstTileX, int firstTileZ, int lastTileX, int lastTileZ);
+		void clear();
+		size_t getResidentCount();
+		size_t getResidentBytes();
+
+		inline size_t getGeneratedCount() const { return mGeneratedCount.load(); }
+		inline size_t getMemoryBudget() const { return mMemoryBudget; }
+		static size_t getTileBytes(bool compact);
+		static inline int getTileCoordinate(double position_world) { return (int)floor(position_world / TILE_SQUARES); }
+
+	private:
+		std::shared_ptr<const Tile> findOrGenerate(Key key);
+		std::shared_ptr<const Tile> insert(Key key, const std::shared_ptr<const Tile>& tile);
+		void runPrefetchThread();
+		static inline Key makeKey(int tileX, int tileZ) { return ((Key)(unsigned int)tileX << 32) | (unsigned int)tileZ; }
+
+	};
+}
+
+#endif
@@ -38,18 +38,31 @@ namespace Internal {
 		void update()
 			/* Called by Car::update
 			*/
+		{
+			mOutputTorque = calcOutputTorque(mRPM, mThrottle, mReverseMode, mMaxOutputForwardTorque, mMaxOutputReverseTorque);
+		}
+
+		static double calcOutputTorque(double RPM, double throttle, bool reverseMode, double maxForwardTorque, double maxReverseTorque)
+			/* Called by
+			 * - TorqueGenerator::update
+			 * - VehicleBatch::updateTorqueGenerators
+			*/
 		{
 			//Prevents the torque generator from rotating so quickly that brakes become ineffective
-			if (mReverseMode)
-				mOutputTorque = -(std::max)((1.0 - pow(mRPM / 1000.0, 2.0)), 0.0) * mMaxOutputReverseTorque * mThrottle;
+			if (reverseMode)
+				return -(std::max)((1.0 - pow(RPM / 1000.0, 2.0)), 0.0) * maxReverseTorque * throttle;
 			else
-				mOutputTorque = (std::max)((1.0 - pow(mRPM / 4000.0, 2.0)), 0.0) * mMaxOutputForwardTorque * mThrottle;
+				return (std::max)((1.0 - pow(RPM / 4000.0, 2.0)), 0.0) * maxForwardTorque * throttle;
 		}
 
 		inline void updateRPM(double newRPM) { mRPM = newRPM; }
 		inline void setThrottle(double newThrottle) { mThrottle = newThrottle < 0.0 ? 0.0 : newThrottle > 1.0 ? 1.0 : newThrottle; }
 		inline void toggleReverse() { mReverseMode = !mReverseMode; }
 		inline double getOutputTorque() const { return mOutputTorque; }
+		inline double getRPM() const { return mRPM; }
+		inline double getThrottle() const { return mThrottle; }
+		inline double getMaxOutputForwardTorque() const { return mMaxOutputForwardTorque; }
+		inline double getMaxOutputReverseTorque() const { return mMaxOutputReverseTorque; }
 		inline bool reverseModeOn() const { return mReverseMode; }
 
 	};
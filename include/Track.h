@@ -1,13 +1,24 @@
 /* CLASS OVERVIEW
  * - Imprints the recessed shape and surface of a race track into the terrain
  * - All code in this class is executed at load-time
+ * - The track is scaled to fill the terrain, whatever its size. Its width is fixed (in metres), while the border left
+ *   clear around it grows with larger terrain, and the track is walked in more, shorter steps
+ * - The track is walked once, on construction, into the squares its centreline passes through. Each call to run over a
+ *   part of the terrain (rows, or a tile of streamed terrain) visits each point within half the track's width of them
+ *   once, rasterising the track a row at a time: the point's distance to the nearest centreline square gives its depth
+ *   in the track's bowl shape, and makes its square tarmac
+ * - The walk's positions are also kept, as a TrackCentreline, for following the track once the terrain is generated
 */
 
 #ifndef TRACK_H
 #define TRACK_H
 #pragma once
 
+#include <cmath>
+#include <cstdio>
+#include <vector>
 #include <algorithm>
+#include <glm/glm/vec2.hpp>
 #include <glm/glm/gtx/rotate_vector.hpp>
 #include <glm/glm/trigonometric.hpp>
 #include <glm/glm/geometric.hpp>
@@ -15,6 +26,7 @@
 #include <Framework/Maths/Noise.h>
 
 #include "TerrainGenLayers.hpp"
+#include "TrackCentreline.h"
 
 namespace External {
 	class Track : public TerrainGenLayer {
@@ -32,7 +44,21 @@ namespace External {
 
 		std::vector<glm::dvec2> mPoints_graph;
 
-		std::vector<unsigned char> mTempSurfaceTypes;
+		//Kept after generation, for following the track at run-time
+		TrackCentreline mCentreline;
+
+		//The squares (their bottom left points) the centreline passes through, sorted by x and then z, each once
+		std::vector<glm::ivec2> mCentrelineSquares;
+
+		//The buffers the track is imprinted into, and the part of them it may write to
+		struct ImprintTarget {
+			double* heights;             //nullptr to leave the heights alone
+			unsigned char* surfaceTypes; //nullptr to leave the surface types alone
+			TerrainRegion buffer;        //Where in the world the buffers lie
+			int
+				firstRow,                //World x of the rows that may be written [firstRow, endRow)
+				endRow;                  //^
+		};
 
 		const unsigned int
 			mTerrainSize_heightSamples = 0,
@@ -40,7 +66,9 @@ namespace External {
 			mWidth = 20,
 			mTerrainBorderPadding = 10;
 
-		unsigned int mSizeLimit = 0;
+		unsigned int
+			mSizeLimit = 0,
+			mStepsPerSample = 1;         //Steps taken along the track per pilot sample, so that steps stay short on large terrain
 
 		const double mMaxDepth = 2.0;
 
@@ -56,14 +84,20 @@ namespace External {
 		Track(const unsigned int terrainSize_heightSamples);
 		~Track() = default;
 
-		virtual void runHeights(std::vector<double>& previousLayerHeights);
-		virtual void runSurfaceTypes(std::vector<unsigned char>& previousLayerSurfaceTypes);
+		virtual void runHeights(std::vector<double>& previousLayerHeights, unsigned int firstRow, unsigned int endRow);
+		virtual void runSurfaceTypes(std::vector<unsigned char>& previousLayerSurfaceTypes, unsigned int firstRow, unsigned int endRow);
+		virtual void runTileHeights(std::vector<double>& previousLayerHeights, const TerrainRegion& tile) const;
+		virtual void runTileSurfaceTypes(std::vector<unsigned char>& previousLayerSurfaceTypes, const TerrainRegion& tile) const;
+		virtual unsigned long long getConfigHash() const;
+
+		inline const TrackCentreline& getCentreline() const { return mCentreline; }
 
 	private:
 		void addAllPoints();
 		void addPoint_graph(double percent, double angle);
-		double lookUpAngleAtPercent_graph(double percent);
-		void imprintCircle(std::vector<double>& toImprintHeights, int centreX, int centreZ);
+		double lookUpAngleAtPercent_graph(double percent) const;
+		void findCentrelineSquares();
+		void imprintRows(const ImprintTarget& target) const;
 		void runPilotVersion();
 		void updateStartingPosition();
 
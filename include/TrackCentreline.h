@@ -0,0 +1,87 @@
+/* CLASS OVERVIEW
+ * - The centreline of a race track: a closed polyline in the world's horizontal plane (x, z), kept after the terrain
+ *   is generated so the track can be followed, timed and driven on at run-time
+ * - Each vertex stores its distance along the loop (from the first vertex), the unit tangent, and the signed curvature
+ *   (positive turning right, seen from above)
+ * - sampleAtDistance finds the segment a distance lies on by binary search over the vertices' distances, and
+ *   interpolates between its ends. Distances wrap round the loop
+ * - findNearest finds the point on the line nearest a position. The segments are binned by their middles into a
+ *   uniform grid of cells, and the cells are searched in rings around the position's cell until no nearer segment can
+ *   be in the rings not yet searched
+ * - findNearestFrom follows a position that moves a little at a time (e.g. a car, step by step) along the line from
+ *   the segment found last time, only falling back to findNearest when the position turns up far from it
+*/
+
+#ifndef TRACKCENTRELINE_H
+#define TRACKCENTRELINE_H
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <glm/glm/vec2.hpp>
+
+namespace External {
+	class TrackCentreline {
+	public:
+		struct Sample {
+			glm::dvec2 position_world;   //m, (x, z)
+			glm::dvec2 tangent_world;    //Unit, along the direction of travel
+			double
+				distance,                //m, along the loop from its first vertex
+				curvature;               //1/m, positive turning right
+			size_t segment;              //Index of the segment's first vertex
+		};
+
+		struct Nearest {
+			Sample sample;               //The point on the line nearest the position
+			double lateralOffset;        //m, of the position from the line, positive to the right of the direction of travel
+		};
+
+		//Width (and depth) of a spatial index cell
+		static constexpr double CELL_SIZE = 16.0; //m
+
+	private:
+		std::vector<glm::dvec2>
+			mPositions_world,            //Of the vertices. The last segment joins the last vertex back to the first
+			mTangents_world;             //^
+		std::vector<double>
+			mDistances,                  //^, with the loop's length appended
+			mCurvatures;                 //^ (without)
+
+		//The segments whose middles are in each cell of the grid, [x][z], as the ranges of mCellSegments from mCellStarts
+		glm::dvec2 mGridOrigin_world = glm::dvec2(0.0);
+		double mLongestSegment = 0.0;    //m
+		int
+			mGridCellsX = 0,
+			mGridCellsZ = 0;
+		std::vector<size_t>
+			mCellStarts,
+			mCellSegments;
+
+	public:
+		TrackCentreline() = default;
+		explicit TrackCentreline(const std::vector<glm::dvec2>& loop_world);
+
+		Sample sampleAtDistance(double distance) const;
+		Nearest findNearest(glm::dvec2 position_world) const;
+		Nearest findNearestOnSegment(glm::dvec2 position_world, size_t segment) const;
+		Nearest findNearestFrom(glm::dvec2 position_world, size_t segment, double searchDistance) const;
+		double calcDistanceSquared(glm::dvec2 position_world, size_t segment) const;
+		size_t findSegment(double distance) const;
+		double wrapDistance(double distance) const;
+
+		inline double getLength() const { return mDistances.empty() ? 0.0 : mDistances.back(); }
+		inline size_t getSegmentCount() const { return mPositions_world.size(); }
+		inline bool isEmpty() const { return mPositions_world.size() < 2; }
+		size_t getBytes() const;
+
+	private:
+		void buildGrid();
+		void findCell(glm::dvec2 position_world, int& cellX, int& cellZ) const;
+		Sample interpolate(size_t segment, double along) const;
+		inline size_t nextVertex(size_t vertex) const { return vertex + 1 < mPositions_world.size() ? vertex + 1 : 0; }
+
+	};
+}
+
+#endif
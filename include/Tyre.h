@@ -3,12 +3,16 @@
  * - Slip can be passed around as a single object
  * - Tyre calculates, updates and provides access to two force components
  * - Tyre encapsulates a PacejkaMagicFormula and Slip
+ * - Tyre forces come from the Magic Formula itself, or (ForceModel::TABLE) from the interpolated TyreForceTable
+ * - Each Tyre follows the published PacejkaParams set unless given its own with setParams
 */
 
 #ifndef TYRE_H
 #define TYRE_H
 #pragma once
 
+#include <cmath>
+#include <memory>
 #include <algorithm>
 #include <glm/glm/vec2.hpp>
 #include <glm/glm/trigonometric.hpp>
@@ -18,6 +22,7 @@
 
 namespace Internal {
 	class Wheel;
+	class TyreForceTable;
 
 	struct Slip {
 	private:
@@ -41,7 +46,7 @@ namespace Internal {
 
 			//Lateral
 			mLateralSlipSpeed = tyreVel_lat_long.x;
-			mAngle_degs = tyreVel_lat_long.y == 0.0 ? (tyreVel_lat_long.x > 0.0 ? -90.0 : 90.0) : glm::degrees(atan(mLateralSlipSpeed / abs(tyreVel_lat_long.y)));
+			mAngle_degs = tyreVel_lat_long.y == 0.0 ? (tyreVel_lat_long.x > 0.0 ? -90.0 : 90.0) : glm::degrees(atan(mLateralSlipSpeed / std::abs(tyreVel_lat_long.y)));
 		}
 
 		inline void reset() { mLongitudinal = mAngle_degs = 0.0; }
@@ -54,12 +59,18 @@ namespace Internal {
 
 	class Tyre {
 		friend class Wheel;
+	public:
+		enum class ForceModel : unsigned char { ANALYTIC, TABLE };
+
 	private:
+		static ForceModel mForceModel;
+
 		Slip mSlip;
 
 		glm::dvec2 mTotalForce_wheel;        //Wheel-space, x = lateral, y = longitudinal
 
 		PacejkaMagicFormula mForceCalculator;
+		std::shared_ptr<const TyreForceTable> mForceTable;   //For ForceModel::TABLE, built from the same parameter set
 
 		const double
 			mRubberDensity = 650.0,          //kg/m^3
@@ -77,12 +88,18 @@ namespace Internal {
 		~Tyre() = default;
 
 		void update(glm::dvec2 wheelVelocity_wheel, double verticalLoad, double camberAngle, double wheelRimRadius, double wheelRotSpeed_radPerSec);
+		inline void setParams(std::shared_ptr<const PacejkaParams> params) { mForceCalculator.setParams(std::move(params)); }
 
 		inline glm::dvec2 getTotalForce_wheel() const { return mTotalForce_wheel; }
 		inline double getDepth() const { return mDepth; }
 		inline double getAxialInertia() const { return mAxialInertia; }
+		inline double getRollResistCoefficient() const { return mRollResistCoefficient; }
+		inline const PacejkaMagicFormula& getForceCalculator() const { return mForceCalculator; }
 		inline Slip getSlip() const { return mSlip; }
 
+		inline static ForceModel getForceModel() { return mForceModel; }
+		inline static void setForceModel(ForceModel forceModel) { mForceModel = forceModel; }
+
 	};
 }
 
@@ -0,0 +1,109 @@
+/* CLASS OVERVIEW
+ * - An optional, cheaper replacement for evaluating PacejkaMagicFormula directly (see Tyre::ForceModel::TABLE)
+ * - Holds two grids sampled from the Magic Formula at zero camber: longitudinal force over (load, slip %) and
+ *   lateral force over (load, slip angle), read back with bilinear or bicubic (Catmull-Rom) interpolation
+ * - The slip axes are warped (u = asinh(x / scale)), so sample spacing is proportional to the slip itself: fine
+ *   around zero and coarse far out, covering slips of 0.01% to 20000% (wheelspin) with a few hundred samples
+ * - A table is built for one PacejkaParams set and never changes afterwards, so it can be shared between threads.
+ *   getFor hands out one table per set (a newly published set, e.g. after a UILayer slider moves, gets a new table)
+ * - Inputs outside the grids (camber != 0, load above the maximum, slip beyond the maximum) use the formula itself
+*/
+
+#ifndef TYREFORCETABLE_H
+#define TYREFORCETABLE_H
+#pragma once
+
+#include <cmath>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstddef>
+
+#include "PacejkaMagicFormula.h"
+
+namespace Internal {
+	class TyreForceTable {
+	public:
+		enum class Interpolation : unsigned char { BILINEAR, BICUBIC };
+
+		struct Settings {
+			unsigned int
+				loadSamples = 64,
+				slipSamples = 512,
+				slipAngleSamples = 256;
+
+			double
+				maxLoad_N = 20000.0,
+				maxSlipPercent = 20000.0,
+				maxSlipAngle_degs = 90.0,
+				slipWarpScale = 1.0,         //%, below which sample spacing stops shrinking
+				slipAngleWarpScale = 0.5;    //degs
+
+			Interpolation interpolation = Interpolation::BICUBIC;
+		};
+
+		//Largest difference from the formula, measured at the centre of every grid cell (where interpolation error peaks)
+		struct MaxError {
+			double
+				longitudinal_N = 0.0,
+				lateral_N = 0.0,
+				longitudinalRelative = 0.0,  //As a fraction of the largest longitudinal force in the grid
+				lateralRelative = 0.0;       //As a fraction of the largest lateral force in the grid
+		};
+
+	private:
+		struct Axis {
+			unsigned int mSamples = 0;
+			double
+				mMax = 0.0,        //Largest input covered
+				mWarpScale = 1.0,
+				mMaxU = 0.0,       //Warped position of mMax
+				mStepU = 0.0;
+
+			void configure(unsigned int samples, double max, double warpScale);
+			double valueAt(double index) const;
+			inline double warp(double x) const { return std::asinh(x / mWarpScale); }
+		};
+
+		std::shared_ptr<const PacejkaParams> mParams;
+		Settings mSettings;
+		Axis
+			mSlipAxis,
+			mSlipAngleAxis;
+		double mLoadStep = 0.0;
+
+		std::vector<double>
+			mLongitudinalForces,   //loadSamples rows of slipSamples
+			mLateralForces;        //loadSamples rows of slipAngleSamples
+
+		//Tables handed out by getFor, while anything still holds them
+		static std::mutex mSharedMutex;
+		static std::vector<std::weak_ptr<const TyreForceTable>> mShared;
+		static Settings mSharedSettings;
+		static std::atomic<unsigned int> mBuildCount;
+
+	public:
+		TyreForceTable(std::shared_ptr<const PacejkaParams> params, const Settings& settings);
+		~TyreForceTable() = default;
+
+		static std::shared_ptr<const TyreForceTable> getFor(const std::shared_ptr<const PacejkaParams>& params);
+		static void setSharedSettings(const Settings& settings);
+		static Settings getSharedSettings();
+		inline static unsigned int getBuildCount() { return mBuildCount.load(); }
+
+		void lookup(double verticalLoad_N, double slipPercent0_to_100, double slipAngle_degs, double camberAngle_degs, double& longitudinalForce, double& lateralForce) const;
+		void evaluate(const double* verticalLoads_N, const double* slipPercents0_to_100, const double* slipAngles_degs, const double* camberAngles_degs, size_t count, double* longitudinalForces, double* lateralForces) const;
+		MaxError measureMaxError() const;
+
+		inline const Settings& getSettings() const { return mSettings; }
+		inline const std::shared_ptr<const PacejkaParams>& getParams() const { return mParams; }
+
+	private:
+		void build();
+		double interpolate(const std::vector<double>& grid, const Axis& axis, double verticalLoad_N, double x) const;
+
+	};
+}
+
+#endif
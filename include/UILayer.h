@@ -12,6 +12,7 @@
 #include <glm/glm/vec3.hpp>
 
 #include "CameraSystem.h"
+#include "FrameStats.h"
 
 namespace Internal {
 	class Car;
@@ -21,6 +22,7 @@ namespace Visual {
 	class UILayer {
 	private:
 		Internal::Car& mDataSource;
+		Internal::FrameStats& mFrameStats;
 
 		Framework::Graphics::Shader& mCarModelShader;
 
@@ -34,10 +36,11 @@ namespace Visual {
 			mShowDriverInfo = true,
 			mShowCarCustomise = false,
 			mShowTyreParams = false,
-			mShowHelpInfo = true;
+			mShowHelpInfo = true,
+			mShowPerformance = false;
 
 	public:
-		UILayer(Internal::Car& simDataSource, Framework::Graphics::Shader& carModelShader, CameraSystem& cameraSystem, float& simulationSpeedHandle, bool& debugModeHandle);
+		UILayer(Internal::Car& simDataSource, Internal::FrameStats& frameStats, Framework::Graphics::Shader& carModelShader, CameraSystem& cameraSystem, float& simulationSpeedHandle, bool& debugModeHandle);
 		~UILayer() = default;
 
 		void render();
@@ -55,6 +58,8 @@ namespace Visual {
 		void debug_allWheelTelemetry() const;
 		void tyreParameters() const;
 		void upsideDownWarning() const;
+		void performancePanel();
+		void performance_phaseTiming(const char* name, Internal::FrameStats::Phase phase, const float* values, int count, int offset);
 
 	};
 }
@@ -0,0 +1,212 @@
+/* CLASS OVERVIEW
+ * - Simulates many cars at once, with each physical quantity stored in one contiguous array (struct-of-arrays)
+ * - Vehicles are copied out of fully assembled Car objects, so configuration and initial state match Car exactly
+ * - step() advances every vehicle through the same sequence of phases as Car::update, one phase at a time over all vehicles
+ * - Tyre forces are evaluated in one PacejkaMagicFormula::evaluate call per run of consecutive wheels sharing a
+ *   PacejkaParams set, i.e. one call for the whole batch when every vehicle has the same tyres
+ *   (TyreForceTable::evaluate when Tyre::ForceModel::TABLE is selected)
+ * - With PacejkaMagicFormula::SimdLevel::SCALAR the results are bit-for-bit identical to Car::update, as long as the
+ *   tyres' loadTolerance_N is 0 (the batch always recalculates the load-dependent terms)
+*/
+
+#ifndef VEHICLEBATCH_H
+#define VEHICLEBATCH_H
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <glm/glm/vec2.hpp>
+#include <glm/glm/vec3.hpp>
+#include <glm/glm/mat3x3.hpp>
+#include <glm/glm/mat4x4.hpp>
+#include <glm/glm/gtc/quaternion.hpp>
+
+#include "PacejkaMagicFormula.h"
+#include "Terrain.h"
+
+namespace External {
+	class Environment;
+}
+
+namespace Internal {
+	class Car;
+	class TyreForceTable;
+	struct DriverInputs;
+
+	class VehicleBatch {
+	public:
+		static const unsigned char mWheelsPerVehicle = 4;
+
+	private:
+		//Per vehicle: chassis (primary state)
+		std::vector<glm::dvec3>
+			mPosition_world,
+			mMomentum_world,
+			mAngularMomentum_world;
+
+		std::vector<glm::dquat> mOrientation_world;
+
+		//Per vehicle: chassis (secondary state, derived from the primary state by recalcSecondary)
+		std::vector<glm::dvec3>
+			mVelocity_world,
+			mAngularVelocity_world,
+			mAcceleration_world,
+			mAerodynamicDrag_world,
+			mWheelForce_world,
+			mWheelTorque_world;
+
+		std::vector<glm::dmat4>
+			mLocalToWorld_position,
+			mLocalToWorld_direction,
+			mWorldToLocal_direction;
+
+		//Per vehicle: mass properties and body parameters
+		std::vector<double>
+			mMass,                       //kg
+			mFrontalArea,                //m^2
+			mDragCoefficient;            //dimensionless
+
+		std::vector<glm::dvec3> mMassCentre_car;
+		std::vector<glm::dmat3> mInverseInertiaTensor_local;
+
+		//Per vehicle: the Environment of the Car it was copied from
+		std::vector<std::shared_ptr<const External::Environment>> mEnvironment;
+
+		//Per vehicle: wheel system geometry
+		std::vector<double>
+			mWheelBase,                  //m
+			mFrontAxleLength,            //m
+			mRearAxleLength,             //m
+			mFrontAxleLongDisplacement,  //m
+			mRearAxleLongDisplacement;   //m
+
+		//Per vehicle: driver controls
+		std::vector<double>
+			mSteeringWheelAngle,         //degs
+			mSteeringRatio,
+			mMaxAbsSteeringWheelAngle,   //degs
+			mThrottle;                   //0.0 -> 1.0
+
+		//Per vehicle: torque generator and axles
+		std::vector<double>
+			mMaxForwardTorque,           //Nm
+			mMaxReverseTorque,           //Nm
+			mGeneratorRPM,
+			mGeneratorTorque,            //Nm
+			mFrontAxleTorque,            //Nm
+			mRearAxleTorque;             //Nm
+
+		std::vector<unsigned char> mReverseMode;
+
+		//Per wheel (index = vehicle * mWheelsPerVehicle + WheelSystem wheel index)
+		std::vector<glm::dvec3>
+			mTerrainNormal_world,        //Under the wheel, sampled during the wheel interface update
+			mInterfacePosition_car,      //Car-space, fixed attachment point of the wheel interface
+			mWheelPosition_car,          //Car-space, moves vertically with the suspension
+			mWheelPosition_world,
+			mWheelVelocity_world,
+			mWheelVelocity_car,          //Rotated into car space with the transpose of the car's rotation
+			mSuspensionForce_world,
+			mTyreForce_world;
+
+		std::vector<glm::dvec2> mTyreForce_wheel;   //x = lateral, y = longitudinal
+
+		std::vector<double>
+			mAngularAcceleration,        //rad/s^2
+			mAngularVelocity,            //rad/s
+			mAngularPosition,            //rad
+			mSteeringAngle,              //degs
+			mBrakeTravel,                //0.0 -> 1.0
+			mBrakeTorque,                //Nm
+			mSpringConstant,             //N/m
+			mDamping,                    //Ns/m
+			mSpringRestLength,           //m
+			mSpringLength,               //m
+			mSpringForce,                //N
+			mLoad,                       //N
+			mSlipLongitudinal,
+			mSlipAngle,                  //degs
+			mRimRadius,                  //m
+			mTyreDepth,                  //m
+			mAxialInertia,               //kg m^2
+			mRollResistCoefficient,
+			mRollResistForce,            //N
+			mCamberAngle,                //degs
+			mTyreSlipPercent,            //Inputs to, and outputs from, PacejkaMagicFormula::evaluate
+			mTyreLongitudinalForce,      //N
+			mTyreLateralForce;           //N
+
+		std::vector<char> mRotationDirection;
+		std::vector<unsigned char>
+			mCollisionRegistered,
+			mSurfaceType;                //TerrainType, sampled with mTerrainNormal_world
+
+		//Per wheel: tyre parameter sets (wheels that follow the published set are refreshed when it changes)
+		std::vector<std::shared_ptr<const PacejkaParams>> mTyreParams;
+		std::vector<unsigned char> mTyreFollowsPublished;
+		unsigned int mPublishedVersion = 0;
+		bool mTyreParamsStale = true;
+
+		std::shared_ptr<const TyreForceTable> mForceTable;   //Most recently used, for ForceModel::TABLE
+
+	public:
+		VehicleBatch() = default;
+		~VehicleBatch() = default;
+
+		size_t addVehicle(Car& source);
+		void reserve(size_t vehicleCount);
+		void step(double dt);
+
+		inline size_t size() const { return mMass.size(); }
+
+		//Driver inputs
+		void setSteeringWheelAngle(size_t vehicle, double angle);
+		void setBrakeTravel(size_t vehicle, double travelPercentage);
+		inline void setThrottle(size_t vehicle, double throttle) { mThrottle[vehicle] = throttle < 0.0 ? 0.0 : throttle > 1.0 ? 1.0 : throttle; }
+		inline void toggleReverse(size_t vehicle) { mReverseMode[vehicle] = !mReverseMode[vehicle]; }
+		void applyInputs(size_t vehicle, const DriverInputs& inputs, double dt);
+
+		//Per-vehicle parameters, for variant studies
+		void setMass(size_t vehicle, double mass);
+		void setSuspension(size_t vehicle, double springConstant, double damping);
+		inline void setDrag(size_t vehicle, double dragCoefficient, double frontalArea) { mDragCoefficient[vehicle] = dragCoefficient; mFrontalArea[vehicle] = frontalArea; }
+		void setTyreParams(size_t vehicle, std::shared_ptr<const PacejkaParams> params);
+
+		//Results
+		inline glm::dvec3 getPosition_world(size_t vehicle) const { return mPosition_world[vehicle]; }
+		inline glm::dvec3 getMomentum_world(size_t vehicle) const { return mMomentum_world[vehicle]; }
+		inline glm::dvec3 getVelocity_world(size_t vehicle) const { return mVelocity_world[vehicle]; }
+		inline glm::dvec3 getAngularMomentum_world(size_t vehicle) const { return mAngularMomentum_world[vehicle]; }
+		inline glm::dquat getOrientation_world(size_t vehicle) const { return mOrientation_world[vehicle]; }
+		inline glm::dvec3 getAcceleration_world(size_t vehicle) const { return mAcceleration_world[vehicle]; }
+		inline double getWheelAngularVelocity(size_t vehicle, unsigned char wheel) const { return mAngularVelocity[vehicle * mWheelsPerVehicle + wheel]; }
+		inline double getSuspensionLength(size_t vehicle, unsigned char wheel) const { return mSpringLength[vehicle * mWheelsPerVehicle + wheel]; }
+		inline double getLoad(size_t vehicle, unsigned char wheel) const { return mLoad[vehicle * mWheelsPerVehicle + wheel]; }
+		inline double getSlipLongitudinal(size_t vehicle, unsigned char wheel) const { return mSlipLongitudinal[vehicle * mWheelsPerVehicle + wheel]; }
+		inline double getSlipAngle_degs(size_t vehicle, unsigned char wheel) const { return mSlipAngle[vehicle * mWheelsPerVehicle + wheel]; }
+		inline glm::dvec2 getTyreForce_wheel(size_t vehicle, unsigned char wheel) const { return mTyreForce_wheel[vehicle * mWheelsPerVehicle + wheel]; }
+		inline unsigned char getSurfaceType(size_t vehicle, unsigned char wheel) const { return mSurfaceType[vehicle * mWheelsPerVehicle + wheel]; }
+
+	private:
+		void updateSteeringAngles();
+		void updateTorqueGenerators();
+		void updateAxles();
+		void updateWheels(double dt);
+		void updateTyreParams();
+		void updateTyreForces();
+		void updateWheelTotals();
+		void integrate(double dt);
+		void positionConstraints();
+		void recalcSecondary(size_t vehicle);
+
+		double recalcCarCmHeightAboveGround(size_t vehicle) const;
+		double recalcLoad(size_t vehicle, unsigned char wheel, glm::dvec3 carAcceleration_car, double carCMHeightAboveGround) const;
+		void updateWheelInterface(size_t vehicle, size_t wheel, double load, const External::Terrain::Contact& terrainContact, double dt);
+		void updateWheel(size_t wheel, double terrainOverlap, double transferredTorque, double dt);
+		void updateTyreForce_world(size_t vehicle, size_t wheel, glm::dvec3 terrainNormalUnderWheel);
+
+	};
+}
+
+#endif
@@ -1,6 +1,8 @@
 /* CLASS OVERVIEW
  * The root class for the application
  * Owns the physics simulation (in the form of the mCar object) and its visual representation (mVisuals)
+ * The car is driven from the keyboard through mKeyboard, polled once per frame and read by every physics step
+ * Times each frame's physics steps, rendering and UI into mFrameStats, shown by the UI's Performance panel
 */
 
 #ifndef VEHICLESIMULATION_H
@@ -10,6 +12,7 @@
 #include <Framework/Framework.h>
 
 #include "Car.h"
+#include "FrameStats.h"
 #include "VisualShell.h"
 
 class VehicleSimulation : public Framework::Application {
@@ -17,12 +20,14 @@ private:
 	std::unique_ptr<Visual::VisualShell> mVisuals;
 
 	Internal::Car mCar;
+	std::shared_ptr<Internal::KeyboardInputSource> mKeyboard;
+	Internal::FrameStats mFrameStats;
 
 	float mSimulationSpeed = 1.0;
 
 public:
 	VehicleSimulation();
-	~VehicleSimulation() = default;
+	~VehicleSimulation();
 
 private:
 	void onLoad();
@@ -33,6 +33,7 @@ namespace Visual {
 			mDebugLayerRenderer;
 
 		Internal::Car& mDataSource;
+		Internal::FrameStats& mFrameStats;
 
 		//temp
 		std::unique_ptr<Framework::OrthographicCamera> orthoCam;
@@ -50,7 +51,7 @@ namespace Visual {
 		float& mSimulationSpeedHandle;
 
 	public:
-		VisualShell(Internal::Car& dataSource, Framework::Window& window, float& simSpeedHandle);
+		VisualShell(Internal::Car& dataSource, Internal::FrameStats& frameStats, Framework::Window& window, float& simSpeedHandle);
 		~VisualShell() = default;
 
 		void update(float dt);
@@ -41,13 +41,14 @@ namespace Internal {
 		~Wheel() = default;
 
 		//Note: roadVel_car and load should be glm::dvec2(0.0) if vehicle is airborne
-		void update(glm::dmat4 carToWorldRotation_car, glm::dvec3 terrainNormalUnderWheel, glm::dvec2 wheelVel_car, double load, double totalInputTorque, double dt);
+		void update(const glm::dmat4& carToWorldRotation_car, glm::dvec3 terrainNormalUnderWheel, glm::dvec2 wheelVel_car, double load, double totalInputTorque, double dt);
 		void reset();
 
 		inline glm::dvec3 getBasePosition_car() const { return mBasePosition_car; }
 		inline glm::dvec3 getPosition_car() const { return mPosition_car; }
 		inline glm::dvec3 getContactPatchPosition_car() const { return mPosition_car - glm::dvec3(0.0, mRimRadius + mTyre.mDepth, 0.0); }
 		inline glm::dvec3 getTyreForce_world() const { return mTyreForce_world; }
+		inline double getAngularAcceleration() const { return mAngularAcceleration; }
 		inline double getAngularVelocity() const { return mAngularVelocity; }
 		inline double getRPM() const { return mAngularVelocity / glm::two_pi<double>(); }
 		inline double getAngularPosition() const { return mAngularPosition; }
@@ -56,6 +57,7 @@ namespace Internal {
 		inline double getSteeringAngle() const { return mSteeringAngle; }
 		inline char getRotationDirection() const { return mRotationDirection; }
 		inline Tyre& getTyre() { return mTyre; }
+		inline const Tyre& getTyre() const { return mTyre; }
 
 		inline void resetToBasePosition() { mPosition_car = mBasePosition_car; }
 		inline void setPosition_car(glm::dvec3 pos_car) { mPosition_car = pos_car; }
@@ -64,7 +66,7 @@ namespace Internal {
 
 	private:
 		void updateAngularMotion(double totalTorque, double dt);
-		void updateTyreForce_world(glm::dmat4 carToWorldRotation_car, glm::dvec3 terrainNormalUnderWheel);
+		void updateTyreForce_world(const glm::dmat4& carToWorldRotation_car, glm::dvec3 terrainNormalUnderWheel);
 
 	};
 }
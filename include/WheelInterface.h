@@ -16,6 +16,8 @@
 #include "Axle.hpp"
 #include "Brake.hpp"
 #include "Suspension.hpp"
+#include "WheelKinematics.hpp"
+#include "Terrain.h"
 
 namespace Internal {
 	class WheelInterface {
@@ -32,27 +34,32 @@ namespace Internal {
 
 		double mLoad = 0.0; //N
 
+		unsigned char mSurfaceType = External::TerrainType::GRASS; //Under the wheel
+
 		bool mCollisionRegistered = false;
 
 	public:
 		WheelInterface(Axle& connectedAxle);
 		~WheelInterface() = default;
 
-		void update(Framework::Physics::State& carState, double load, double dt);
+		void update(const WheelKinematics& kinematics, const glm::dmat4& carToWorldRotation_car, double load, const External::Terrain::Contact& terrainContact, double dt);
 		void setPosition_car(glm::dvec3 newPosition_car);
 		void reset();
 
 		inline Wheel& getWheel() { return mWheel; }
+		inline const Wheel& getWheel() const { return mWheel; }
 		inline Brake& getBrake() { return mBrake; }
 		inline Suspension& getSuspension() { return mSuspension; }
+		inline const Suspension& getSuspension() const { return mSuspension; }
 		inline glm::dvec3 getPosition_car() const { return mPosition_car; }
 		inline glm::dvec3 getPosition_world() const { return mPosition_world; }
 		inline glm::dvec3 getVelocity_world() const { return mVelocity_world; }
 		inline double getLoad() const { return mLoad; }
+		inline unsigned char getSurfaceType() const { return mSurfaceType; }
 		inline bool collisionRegistered() const { return mCollisionRegistered; }
 
 	private:
-		void updateWheel(glm::dmat4 carToWorldRotation_car, glm::dvec3 terrainNormalUnderWheel, double terrainOverlap, double dt);
+		void updateWheel(const glm::dmat4& carToWorldRotation_car, glm::dvec3 wheelVelocity_car, glm::dvec3 terrainNormalUnderWheel, double terrainOverlap, double dt);
 
 	};
 }
@@ -0,0 +1,24 @@
+/* CLASS OVERVIEW
+ * - Where one wheel is and how it is moving, for the current step
+ * - Filled in once per step for all four wheels by WheelSystem::updateKinematics, straight after the car's State has
+ *   been integrated, and read by every consumer (wheel interface update, load transfer, tyre slip) in place of each
+ *   one re-deriving it from the car's matrices
+*/
+
+#ifndef WHEELKINEMATICS_H
+#define WHEELKINEMATICS_H
+#pragma once
+
+#include <glm/glm/vec3.hpp>
+
+namespace Internal {
+	struct WheelKinematics {
+		glm::dvec3
+			interfacePosition_world = glm::dvec3(0.0),   //Fixed attachment point of the WheelInterface
+			velocity_world = glm::dvec3(0.0),            //Of the attachment point
+			velocity_car = glm::dvec3(0.0),              //velocity_world rotated into car space
+			wheelOrigin_world = glm::dvec3(0.0);         //Wheel centre, including the suspension travel left by the previous step
+	};
+}
+
+#endif
@@ -8,12 +8,18 @@
 #define WHEELSYSTEM_H
 #pragma once
 
+#include <cmath>
 #include <vector>
 #include <algorithm>
+#include <glm/glm/vec2.hpp>
 #include <glm/glm/vec3.hpp>
 
 #include "WheelInterface.h"
 
+namespace External {
+	class Environment;
+}
+
 namespace Internal {
 	class ControlSystem;
 
@@ -38,6 +44,10 @@ namespace Internal {
 
 		std::vector<WheelInterface> mWheelInterfaces;
 
+		//This step's kinematics of each wheel, and the horizontal points under them to sample the terrain at (indexed as mWheelInterfaces)
+		WheelKinematics mKinematics[4];
+		glm::dvec2 mContactPoints_world[4];
+
 		Axle
 			mFrontAxle,
 			mRearAxle;
@@ -46,7 +56,7 @@ namespace Internal {
 		WheelSystem();
 		~WheelSystem() = default;
 
-		void update(Framework::Physics::State& carState, glm::dvec3 carAcceleration_car, double dt);
+		void update(Framework::Physics::State& carState, glm::dvec3 carAcceleration_car, const External::Environment& environment, double dt);
 		void bindControlSystem(ControlSystem& controlSystem);
 		void reset();
 
@@ -55,6 +65,8 @@ namespace Internal {
 		inline WheelInterface* getWheelInterface(unsigned char index) { return (index >= 0 && index < mWheelInterfaces.size()) ? &mWheelInterfaces[index] : (WheelInterface*)nullptr; }
 		inline WheelInterface* operator[](unsigned char index) { return (index >= 0 && index < mWheelInterfaces.size()) ? &mWheelInterfaces[index] : (WheelInterface*)nullptr; }
 		inline std::vector<WheelInterface>& getAllWheelInterfaces() { return mWheelInterfaces; }
+		inline const std::vector<WheelInterface>& getAllWheelInterfaces() const { return mWheelInterfaces; }
+		inline const WheelKinematics& getKinematics(unsigned char index) const { return mKinematics[index]; }
 		inline Axle& getAxle(AxlePos pos) { return pos == AxlePos::FRONT ? mFrontAxle : mRearAxle; }
 		inline glm::dvec3 getTotalForce_world() const { return mTotalForce_world; }
 		inline glm::dvec3 getTotalTorque_world() const { return mTotalTorque_world; }
@@ -64,11 +76,12 @@ namespace Internal {
 	private:
 		void positionWheelInterfaces();
 		void updateAxles();
-		void updateAllWheelInterfaces(Framework::Physics::State& carState, glm::dvec3 carAcceleration_car, double dt);
-		double recalcLoad(AxlePos position, Side side, Framework::Physics::Mass& carMass_car, glm::dvec3 carAcceleration_car, double carCMHeightAboveGround);
+		void updateKinematics(Framework::Physics::State& carState);
+		void updateAllWheelInterfaces(Framework::Physics::State& carState, glm::dvec3 carAcceleration_car, const External::Environment& environment, double dt);
+		double recalcLoad(AxlePos position, Side side, Framework::Physics::Mass& carMass_car, glm::dvec3 carAcceleration_car, double carCMHeightAboveGround, double gravityAccel);
 		double recalcCarCmHeightAboveGround(Framework::Physics::State& carState);
 		void updateTotalForce_world();
-		void updateTotalTorque_world(glm::dvec3 carPosition_world, glm::dmat4 carToWorldTransform_car);
+		void updateTotalTorque_world(glm::dvec3 carPosition_world, const glm::dmat4& carToWorldTransform_car);
 
 		inline AxlePos calcAxleFromIndex(unsigned char index) const { return index < 2 ? FRONT : REAR; }
 		inline Side calcSideFromIndex(unsigned char index) const { return index % 2 == 0 ? LEFT : RIGHT; }
@@ -0,0 +1,54 @@
+/* CLASS OVERVIEW
+ * - Runs a number of independent, indexed tasks (e.g. the runs of a ParameterSweep) on a set of worker threads
+ * - Each worker starts with an equal, contiguous range of task indices and works through it from the front. A worker
+ *   whose range runs dry steals the back half of another worker's remaining range, so tasks of uneven cost still keep
+ *   every thread busy until the last few tasks
+ * - Each range has its own lock. A worker only ever holds one lock at a time, and taking a task from its own range is
+ *   an uncontended lock, which is negligible next to a task the size of a simulation run
+*/
+
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <functional>
+
+namespace Internal {
+	class WorkStealingPool {
+	public:
+		typedef std::function<void(size_t task, unsigned int worker)> Task;
+
+	private:
+		//Tasks [mBegin, mEnd) still to be run by one worker; on its own cache line, as every worker polls its own
+		struct alignas(64) Range {
+			std::mutex mMutex;
+			size_t
+				mBegin = 0,
+				mEnd = 0;
+		};
+
+		unsigned int mThreadCount = 1;
+		std::atomic<size_t> mStealCount;
+
+	public:
+		explicit WorkStealingPool(unsigned int threadCount = 0);
+		~WorkStealingPool() = default;
+
+		void run(size_t taskCount, const Task& task);
+
+		inline unsigned int getThreadCount() const { return mThreadCount; }
+		inline size_t getStealCount() const { return mStealCount.load(); }
+
+	private:
+		void work(std::vector<Range>& ranges, unsigned int worker, const Task& task);
+		static bool takeFront(Range& range, size_t& task);
+		static bool stealBack(Range& victim, Range& thief);
+
+	};
+}
+
+#endif
@@ -1,5 +1,5 @@
 #include "AllCameras.h"
-#include "Environment.h"
+#include "Terrain.h"
 
 namespace Visual {
 
@@ -28,7 +28,7 @@ namespace Visual {
 		mPitch = degrees(asin(normalize(direction_OGL).y));
 	}
 
-	void FPVCamera::update(float windowAspect, float dt)
+	void FPVCamera::update(float windowAspect, float dt, const External::Terrain& terrain)
 		/* Called by CameraSystem::update
 		*/
 	{
@@ -36,10 +36,11 @@ namespace Visual {
 		mPerspectiveCamera.setAspect(windowAspect);
 
 		//Recalculates position
+		const glm::vec3 previousPosition_OGL = mPosition_OGL;
 		mPosition_OGL += mVelocity_OGL * dt;
 
 		//Ensures that the new position is not below the terrain, or outside its borders
-		mPosition_OGL = afterPositionConstraints(mPosition_OGL);
+		mPosition_OGL = afterPositionConstraints(previousPosition_OGL, mPosition_OGL, terrain);
 
 		//Updates the internal position of the camera with this new position
 		mPerspectiveCamera.setPosition(mPosition_OGL);
@@ -73,19 +74,26 @@ namespace Visual {
 		if (Input::isKeyPressed(GLFW_KEY_LEFT_SHIFT)) mVelocity_OGL.y -= mMovementSpeed * dt;
 	}
 
-	glm::dvec3 FPVCamera::afterPositionConstraints(glm::dvec3 input)
+	glm::dvec3 FPVCamera::afterPositionConstraints(glm::dvec3 previous, glm::dvec3 input, const External::Terrain& terrain)
 		/* Called by FPVCamera::update
 		*/
 	{
 		glm::dvec3 output = input;
 
 		//Terrain surface constraint
-		double terrainHeight = External::Environment::mTerrain.getHeight(glm::dvec2(input.x, input.z));
+		double terrainHeight = terrain.getHeight(glm::dvec2(input.x, input.z));
 		if (input.y < terrainHeight + 0.1f)
 			output.y = terrainHeight + 0.1f;
+		else {
+			//Moving fast enough to pass right through a crest since the last update, and out above the ground beyond it,
+			//stops the camera where it met the crest instead
+			External::Terrain::RayHit hit;
+			if (terrain.raycast(previous, input - previous, glm::length(input - previous), hit))
+				output = hit.position_world + hit.normal_world * 0.1;
+		}
 
 		//Terrain border constraints
-		double halfTerrainSize = floor(External::Environment::mTerrain.getSize() * 0.5);
+		double halfTerrainSize = floor(terrain.getSize() * 0.5);
 		if (input.x < -halfTerrainSize) output.x = -halfTerrainSize;
 		else if (input.x > halfTerrainSize) output.x = halfTerrainSize;
 		if (input.z < -halfTerrainSize) output.z = -halfTerrainSize;
@@ -0,0 +1,160 @@
+#include "AutoDriver.h"
+#include "Car.h"
+
+#include <cmath>
+#include <algorithm>
+#include <glm/glm/geometric.hpp>
+#include <glm/glm/trigonometric.hpp>
+#include <glm/glm/gtc/constants.hpp>
+
+namespace Internal {
+
+	AutoDriver::Plan::Plan(const External::TrackCentreline& centreline, const Settings& settings) :
+		/* Called by
+		 * - AutoDriver::AutoDriver
+		 * - code driving many cars round the same track, to share one plan between their AutoDrivers
+		 * The centreline must outlive the plan (it belongs to the cars' Environment's Terrain)
+		*/
+		mCentreline(centreline),
+		mSettings(settings)
+	{
+		if (centreline.isEmpty())
+			return;
+
+		const size_t count = std::max((size_t)1, (size_t)ceil(centreline.getLength() / std::max(settings.profileInterval, 0.01)));
+		const double interval = centreline.getLength() / count;
+
+		//The fastest each point can be taken, from the tightest curvature over the interval that follows it (so a
+		//corner between two points is not missed)
+		mSpeeds.resize(count);
+		for (size_t i = 0; i < count; i++) {
+			double curvature = 0.0;
+			for (double along = 0.0; along < interval; along += 0.25 * interval)
+				curvature = std::max(curvature, fabs(centreline.sampleAtDistance(i * interval + along).curvature));
+
+			mSpeeds[i] = curvature > 0.0 ? std::min(settings.maxSpeed, sqrt(settings.maxLateralAccel / curvature)) : settings.maxSpeed;
+		}
+
+		//Lowered to brake in time for what follows. Braking zones can run back over the start of the loop, so it is gone
+		//round twice
+		for (unsigned int pass = 0; pass < 2; pass++)
+			for (size_t i = count; i-- > 0;) {
+				const double following = mSpeeds[i + 1 < count ? i + 1 : 0];
+				mSpeeds[i] = std::min(mSpeeds[i], sqrt(following * following + 2.0 * settings.maxDeceleration * interval));
+			}
+	}
+
+	double AutoDriver::Plan::getSpeed(double distance) const
+		/* Called by
+		 * - AutoDriver::drive
+		 * - code reporting on the plan
+		 * At distance along the line, between the planned speeds either side
+		*/
+	{
+		if (mSpeeds.empty())
+			return 0.0;
+
+		const double
+			position = mCentreline.wrapDistance(distance) * mSpeeds.size() / mCentreline.getLength(),
+			fraction = position - floor(position);
+		const size_t
+			i = std::min((size_t)position, mSpeeds.size() - 1),
+			next = i + 1 < mSpeeds.size() ? i + 1 : 0;
+
+		return mSpeeds[i] + (mSpeeds[next] - mSpeeds[i]) * fraction;
+	}
+
+	AutoDriver::AutoDriver(const External::TrackCentreline& centreline) :
+		/* Called by code driving a car round the track with the default settings
+		*/
+		AutoDriver(centreline, Settings())
+	{ }
+
+	AutoDriver::AutoDriver(const External::TrackCentreline& centreline, const Settings& settings) :
+		/* Called by
+		 * - AutoDriver::AutoDriver
+		 * - code driving a car round the track with its own plan
+		*/
+		AutoDriver(std::make_shared<const Plan>(centreline, settings))
+	{ }
+
+	AutoDriver::AutoDriver(std::shared_ptr<const Plan> plan) :
+		/* Called by
+		 * - AutoDriver::AutoDriver
+		 * - code driving many cars round the same track (e.g. vds-run --auto-drive), sharing one plan
+		*/
+		mPlan(std::move(plan))
+	{ }
+
+	void AutoDriver::read(const Car& car, double t, double dt, DriverInputs& inputs)
+		/* Called by Car::update
+		*/
+	{
+		const Framework::Physics::State& state = car.getState();
+		drive(state.getPosition_world(), state.getVelocity_world(), state.getOrientation_world(), car.getWheelSystem().getWheelBase(),
+			car.getControlSystem().getSteeringRatio(), inputs);
+	}
+
+	void AutoDriver::drive(glm::dvec3 position_world, glm::dvec3 velocity_world, glm::dquat orientation_world, double wheelBase, double steeringRatio, DriverInputs& inputs)
+		/* Called by
+		 * - AutoDriver::read
+		 * - code driving a car simulated some other way (e.g. a vehicle of a VehicleBatch), before each step
+		 * Sets the steering wheel angle, throttle and brake. An aim point behind the car (e.g. facing the wrong way round
+		 * the track) is turned towards at full lock, at no more than turningSpeed
+		*/
+	{
+		const External::TrackCentreline& centreline = mPlan->getCentreline();
+		const Settings& settings = mPlan->getSettings();
+
+		if (centreline.isEmpty()) {
+			inputs.throttle = 0.0;
+			inputs.brake = 1.0;
+			return;
+		}
+
+		const glm::dvec2 position(position_world.x, position_world.z);
+		const External::TrackCentreline::Nearest nearest = mStarted ? centreline.findNearestFrom(position, mSegment, settings.relocateDistance) :
+			centreline.findNearest(position);
+
+		mStarted = true;
+		mSegment = nearest.sample.segment;
+		mLineDistance = nearest.sample.distance;
+		mLateralOffset = nearest.lateralOffset;
+
+		//Car's space: x right, -z forward
+		const glm::dvec3
+			forward_world = orientation_world * glm::dvec3(0.0, 0.0, -1.0),
+			right_world = orientation_world * glm::dvec3(1.0, 0.0, 0.0);
+		const double speed = glm::dot(velocity_world, forward_world);
+
+		const double lookAhead = std::min(std::max(settings.lookAheadTime * speed, settings.minLookAhead), settings.maxLookAhead);
+		const glm::dvec2 toTarget = centreline.sampleAtDistance(mLineDistance + lookAhead).position_world - position;
+		const double
+			ahead = toTarget.x * forward_world.x + toTarget.y * forward_world.z,
+			across = toTarget.x * right_world.x + toTarget.y * right_world.z;
+
+		//The arc from the rear axle through the aim point, and the front wheel angle (of a bicycle of the same wheelbase)
+		//that follows it
+		double wheelAngle = across < 0.0 ? -0.5 * glm::pi<double>() : 0.5 * glm::pi<double>();
+		if (ahead > 0.0)
+			wheelAngle = atan(wheelBase * 2.0 * across / (ahead * ahead + across * across));
+
+		mTargetSpeed = ahead > 0.0 ? mPlan->getSpeed(mLineDistance) : std::min(mPlan->getSpeed(mLineDistance), settings.turningSpeed);
+
+		const double speedError = mTargetSpeed - speed;
+		inputs.steerByRate = false;
+		inputs.steeringWheelAngle = glm::degrees(wheelAngle) * steeringRatio;
+		inputs.throttle = std::min(std::max(settings.speedGain * speedError, 0.0), 1.0);
+		inputs.brake = std::min(std::max(-settings.speedGain * speedError, 0.0), 1.0);
+	}
+
+	void AutoDriver::reset()
+		/* Called by code driving a car, when the car is reset
+		 * Forgets where the car was, so it is searched for across the whole track next step
+		*/
+	{
+		mStarted = false;
+		mSegment = 0;
+		mLineDistance = mLateralOffset = mTargetSpeed = 0.0;
+	}
+}
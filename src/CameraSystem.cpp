@@ -14,7 +14,7 @@ namespace Visual {
 		/* Called by VisualShell::update
 		*/
 	{
-		FPV_CAM->update(windowAspect, dt);
+		FPV_CAM->update(windowAspect, dt, cameraTarget.getEnvironment().getTerrain());
 
 		//The front wheel camera and the driver camera are each bound to the car in some way
 		glm::mat4 carToWorldTransform = cameraTarget.getState().getLocalToWorld_position();
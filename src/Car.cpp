@@ -1,12 +1,23 @@
 #include "Car.h"
+#include "Profiler.h"
+
+#include <limits>
 
 namespace Internal {
 
 	Car::Car() :
 		/* Called during VehicleSimulation::VehicleSimulation
-		 * Fully sets up this object ready for the start of the simulation
+		 * Simulates on the shared default Environment
+		*/
+		Car(External::Environment::getDefault())
+	{ }
+
+	Car::Car(std::shared_ptr<const External::Environment> environment) :
+		/* Called by Car::Car, and by code running simulations on their own Environments (e.g. ParameterSweep::runOne)
+		 * Fully sets up this object ready for the start of the simulation, bound to the given Environment for its lifetime
 		*/
-		RigidBody(Framework::Physics::RigidBody::IntegrationMethod::EULER)
+		RigidBody(Framework::Physics::RigidBody::IntegrationMethod::EULER),
+		mEnvironment(environment ? std::move(environment) : External::Environment::getDefault())
 	{
 		assemble();
 		resetToTrackPosition();
@@ -18,36 +29,56 @@ namespace Internal {
 		 * Updates member objects and then updates own internal physical state
 		*/
 	{
+		VDS_PROFILE_SCOPE("Car::update");
+
+		//Driver's inputs for this step
+		if (mInputSource) {
+			mInputs.toggleReverse = mInputs.reset = false;
+			mInputSource->read(*this, t, dt, mInputs);
+			applyInputs(mInputs, dt);
+		}
+
 		//Member objects updated
-		mControlSystem.update(mWheelSystem.getWheelBase(), mWheelSystem.getAxle(WheelSystem::AxlePos::FRONT).getLength());
-		mTorqueGenerator->update();
-		mWheelSystem.update(mState, mAcceleration, dt);
+		{
+			VDS_PROFILE_SCOPE("ControlSystem::update");
+			mControlSystem.update(mWheelSystem.getWheelBase(), mWheelSystem.getAxle(WheelSystem::AxlePos::FRONT).getLength());
+		}
+		{
+			VDS_PROFILE_SCOPE("TorqueGenerator::update");
+			mTorqueGenerator->update();
+		}
+		mWheelSystem.update(mState, mAcceleration, *mEnvironment, dt);
 
 		//State advanced by dt seconds
-		integrate(t, dt);
-
-		positionConstraints();
+		{
+			VDS_PROFILE_SCOPE("Car::integrate");
+			integrate(t, dt);
+		}
+		{
+			VDS_PROFILE_SCOPE("Car::positionConstraints");
+			positionConstraints();
+		}
 	}
 
-	void Car::checkInput(double dt)
-		/* Called by VehicleSimulation::onInputCheck
+	void Car::applyInputs(const DriverInputs& inputs, double dt)
+		/* Called by
+		 * - Car::update, with the inputs read from mInputSource
+		 * - code driving the Car a step at a time without a DriverInputSource
 		 * Passes main input handling responsibility to mControlSystem
 		*/
 	{
-		using namespace Framework;
-
-		mControlSystem.handleInput(dt);
-
-		if (Input::isKeyPressed(GLFW_KEY_R)) {
+		if (inputs.reset) {
 			resetToTrackPosition();
 			mWheelSystem.reset();
 		}
+
+		mControlSystem.applyInputs(inputs, dt);
 	}
 
 	void Car::resetToTrackPosition()
 		/* Called by
 		 * - Car::Car
-		 * - Car::checkInput
+		 * - Car::applyInputs
 		 * - UILayer::mainControlPanel
 		*/
 	{
@@ -55,6 +86,36 @@ namespace Internal {
 		mState.setPosition_world(glm::dvec3(10.0, -1.0, 0.0));
 	}
 
+	void Car::setTyreParams(std::shared_ptr<const PacejkaParams> params)
+		/* Called by code giving this car its own tyres (e.g. parameter studies)
+		 * nullptr puts all four tyres back on the published parameter set
+		*/
+	{
+		for (WheelInterface& wheelInterface : mWheelSystem.getAllWheelInterfaces())
+			wheelInterface.getWheel().getTyre().setParams(params);
+	}
+
+	void Car::setMass(double mass)
+		/* Called by code varying the car (e.g. ParameterSweep)
+		 * Same mass model as Car::assemble: the inertia tensor follows the mass
+		*/
+	{
+		mState.setMassValue_local(mass);
+		mState.setInertiaTensor_local(glm::dmat3(mass));
+	}
+
+	void Car::setSuspension(double springConstant, double damping)
+		/* Called by code varying the car (e.g. ParameterSweep)
+		 * Applies the same spring to all four wheels
+		*/
+	{
+		for (WheelInterface& wheelInterface : mWheelSystem.getAllWheelInterfaces()) {
+			Framework::Physics::Spring& spring = wheelInterface.getSuspension().getSpring();
+			spring.setSpringConstant(springConstant);
+			spring.setDamping(damping);
+		}
+	}
+
 	void Car::updateTotalForce_world()
 		/* Called by Car::getForce_world
 		 * Responsible for summating all forces affecting the Car
@@ -66,9 +127,9 @@ namespace Internal {
 		glm::dvec3 velocity_world = mState.getVelocity_world();
 
 		if(glm::length(velocity_world))
-			mAerodynamicDrag_world = -0.5 * pow(glm::length(velocity_world), 2.0) * mDragCoefficient * mFrontalArea * External::Environment::mAirDensity * glm::normalize(velocity_world);
+			mAerodynamicDrag_world = -0.5 * pow(glm::length(velocity_world), 2.0) * mDragCoefficient * mFrontalArea * mEnvironment->getAirDensity() * glm::normalize(velocity_world);
 
-		mTotalForce_world += glm::dvec3(0.0, mState.getMass().getValue() * -External::Environment::mGravityAccel, 0.0); //Gravity
+		mTotalForce_world += glm::dvec3(0.0, mState.getMass().getValue() * -mEnvironment->getGravityAccel(), 0.0); //Gravity
 		mTotalForce_world += mWheelSystem.getTotalForce_world();                                                        //Wheel interfaces
 		mTotalForce_world += mAerodynamicDrag_world;                                                                    //Aerodynamic drag
 	}
@@ -103,11 +164,11 @@ namespace Internal {
 
 	void Car::positionConstraints()
 		/* Called by Car::update
-		 * Point collision with the terrain's surface, and a boundary constraint at edges of the terrain
+		 * Point collision with the terrain's surface, and a boundary constraint at edges of the terrain (streamed terrain
+		 * has none, and instead has the tiles around the car generated ahead of it)
 		 * Corrective action after physics state update
 		*/
 	{
-		using namespace External;
 		using namespace glm;
 
 		dvec3
@@ -116,7 +177,8 @@ namespace Internal {
 			newPosition = positionInitial,
 			newVelocity = velocityInitial;
 
-		const double planeHeight = Environment::mTerrain.getHeight(dvec2(positionInitial.x, positionInitial.z));
+		const External::Terrain& terrain = mEnvironment->getTerrain();
+		const double planeHeight = terrain.getHeight(dvec2(positionInitial.x, positionInitial.z));
 
 		//Terrain collision
 		if (positionInitial.y < planeHeight) {
@@ -125,8 +187,10 @@ namespace Internal {
 			newVelocity.y *= -0.3;
 		}
 
+		terrain.prefetch(dvec2(positionInitial.x, positionInitial.z));
+
 		//Playable region limits
-		double halfTerrainSize = floor(Environment::mTerrain.getSize() * 0.5);
+		double halfTerrainSize = terrain.isStreamed() ? std::numeric_limits<double>::infinity() : floor(terrain.getSize() * 0.5);
 		if (positionInitial.x < -halfTerrainSize) {
 			newPosition.x = -halfTerrainSize;
 
@@ -11,13 +11,22 @@ namespace Internal {
 		updateSteeringAngle(wheelBase, frontAxleTrack);
 	}
 
-	void ControlSystem::handleInput(double dt)
-		/* Called by Car::checkInput
-		 * Called once per Car update
+	void ControlSystem::applyInputs(const DriverInputs& inputs, double dt)
+		/* Called by Car::applyInputs
+		 * Called once per Car update, before ControlSystem::update
+		 * Steering is clamped to the wheel's lock either way. The reverse toggle is an event, acted on once
 		*/
 	{
-		handleSteeringInput(dt);
-		handleSpeedInput();
+		if (inputs.steerByRate)
+			setSteeringWheelAngle(mSteeringWheelAngle + inputs.steeringWheelRate * dt);
+		else
+			setSteeringWheelAngle(inputs.steeringWheelAngle);
+
+		mTorqueGenerator->setThrottle(inputs.throttle);
+		setBrakeTravel(inputs.brake);
+
+		if (inputs.toggleReverse)
+			mTorqueGenerator->toggleReverse();
 	}
 
 	void ControlSystem::attachWheels(Wheel* left, Wheel* right)
@@ -38,93 +47,70 @@ namespace Internal {
 		mMaxAbsSteeringWheelAngle = maxAbsAngle * mSteeringRatio;
 	}
 
-	void ControlSystem::updateSteeringAngle(double wheelBase, double frontAxleTrack)
-		/* Called by ControlSystem::update
-		 * Responsible for updating the steering angles of both attached wheels
+	void ControlSystem::setSteeringRatio(double newRatio)
+		/* Called by
+		 * - Car::assemble
+		 * - code varying the steering (e.g. ParameterSweep::runOne)
+		 * The steering wheel's lock follows the ratio, so the wheels' lock stays the same
 		*/
 	{
-		using namespace glm;
-
-		//Using the current steering wheel's angle, this can set the deflection angles of the two front wheels
-		//accounting for Ackermann geometry and the steering ratio.
-		double
-			leftWheelAngle = 0.0,
-			rightWheelAngle = 0.0;
-
-		//Turning right
-		if (mSteeringWheelAngle > 0.0) {
-			rightWheelAngle = -mSteeringWheelAngle / mSteeringRatio;
-			leftWheelAngle = -degrees(asin(wheelBase / sqrt(pow((((wheelBase * sin(radians(90.0 - abs(rightWheelAngle)))) / (sin(radians(abs(rightWheelAngle))))) + frontAxleTrack), 2) + pow(wheelBase, 2))));
-		}
-		//Turning left
-		else if (mSteeringWheelAngle < 0.0) {
-			leftWheelAngle = -mSteeringWheelAngle / mSteeringRatio;
-			rightWheelAngle = degrees(asin(wheelBase / sqrt(pow((((wheelBase * sin(radians(90.0 - leftWheelAngle))) / (sin(radians(leftWheelAngle)))) + frontAxleTrack), 2) + pow(wheelBase, 2))));
-		}
-
-		//Car's wheels are toe-out during steering, hence why two different angles are required
-		mLeftWheel->setSteeringAngle(leftWheelAngle);
-		mRightWheel->setSteeringAngle(rightWheelAngle);
+		mSteeringRatio = newRatio;
+		mMaxAbsSteeringWheelAngle = mMaxAbsWheelAngle * newRatio;
+		setSteeringWheelAngle(mSteeringWheelAngle);
 	}
 
-	void ControlSystem::handleSteeringInput(double dt)
-		/* Called by ControlSystem::handleInput
-		 * Responsible for handling the input for just the steering wheel
+	void ControlSystem::setBrakeTravel(double travelPercentage)
+		/* Called by
+		 * - ControlSystem::applyInputs
+		 * - code driving the Car without a DriverInputSource (e.g. vds-run, tests)
+		 * Applies the same travel to all attached brakes
 		*/
 	{
-		bool
-			steerLeft = Framework::Input::isKeyPressed(GLFW_KEY_RIGHT),
-			steerRight = Framework::Input::isKeyPressed(GLFW_KEY_LEFT);
-
-		if (steerLeft || steerRight) {
-			double targetAngle = 0.0;
-
-			if (steerLeft) {
-				targetAngle = mSteeringWheelAngle + mSteeringRate * dt;
-				mSteeringWheelAngle = targetAngle > mMaxAbsSteeringWheelAngle ? mMaxAbsSteeringWheelAngle : targetAngle;
-			}
-			if (steerRight) {
-				targetAngle = mSteeringWheelAngle - mSteeringRate * dt;
-				mSteeringWheelAngle = targetAngle < -mMaxAbsSteeringWheelAngle ? -mMaxAbsSteeringWheelAngle : targetAngle;
-			}
-		}
-		else {
-			double steeringFraction = abs(mSteeringWheelAngle) / mMaxAbsSteeringWheelAngle;
+		for (Brake* b : mBrakes)
+			b->setTravelPercentage(travelPercentage);
 
-			if (mSteeringWheelAngle < 0.0)
-				mSteeringWheelAngle += mSteeringRate * steeringFraction * dt;
-			else
-				mSteeringWheelAngle -= mSteeringRate * steeringFraction * dt;
-		}
+		mBrakesOn = travelPercentage > 0.0;
 	}
 
-	void ControlSystem::handleSpeedInput()
-		/* Called by ControlSystem::handleInput
-		 * Responsible for handling the input for changing the speed of the Car
+	void ControlSystem::calcWheelAngles(double steeringWheelAngle, double steeringRatio, double wheelBase, double frontAxleTrack, double& leftWheelAngle, double& rightWheelAngle)
+		/* Called by
+		 * - ControlSystem::updateSteeringAngle
+		 * - VehicleBatch::updateSteeringAngles
+		 * Using a steering wheel angle, calculates the deflection angles of the two front wheels
+		 * accounting for Ackermann geometry and the steering ratio.
 		*/
 	{
-		//Neutralise everything before input is checked
-		mTorqueGenerator->setThrottle(0.0);
+		using namespace glm;
 
-		for (Brake* b : mBrakes)
-			b->setTravelPercentage(0.0);
+		leftWheelAngle = 0.0;
+		rightWheelAngle = 0.0;
 
-		mBrakesOn = false;
+		//Turning right
+		if (steeringWheelAngle > 0.0) {
+			rightWheelAngle = -steeringWheelAngle / steeringRatio;
+			leftWheelAngle = -degrees(asin(wheelBase / sqrt(pow((((wheelBase * sin(radians(90.0 - std::abs(rightWheelAngle)))) / (sin(radians(std::abs(rightWheelAngle))))) + frontAxleTrack), 2) + pow(wheelBase, 2))));
+		}
+		//Turning left
+		else if (steeringWheelAngle < 0.0) {
+			leftWheelAngle = -steeringWheelAngle / steeringRatio;
+			rightWheelAngle = degrees(asin(wheelBase / sqrt(pow((((wheelBase * sin(radians(90.0 - leftWheelAngle))) / (sin(radians(leftWheelAngle)))) + frontAxleTrack), 2) + pow(wheelBase, 2))));
+		}
+	}
 
-		//Checking switch to reverse mode
-		if (Framework::Input::isKeyReleased(GLFW_KEY_END))
-			mTorqueGenerator->toggleReverse();
+	void ControlSystem::updateSteeringAngle(double wheelBase, double frontAxleTrack)
+		/* Called by ControlSystem::update
+		 * Responsible for updating the steering angles of both attached wheels
+		*/
+	{
+		double
+			leftWheelAngle = 0.0,
+			rightWheelAngle = 0.0;
 
-		//Accelerator pedal input
-		if (Framework::Input::isKeyPressed(GLFW_KEY_UP))
-			mTorqueGenerator->setThrottle(1.0);
+		calcWheelAngles(mSteeringWheelAngle, mSteeringRatio, wheelBase, frontAxleTrack, leftWheelAngle, rightWheelAngle);
 
-		//Brake input (All brakes are activated)
-		if (Framework::Input::isKeyPressed(GLFW_KEY_DOWN)) {
-			mBrakesOn = true;
-			for (Brake* b : mBrakes)
-				b->setTravelPercentage(1.0);
-		}
+		//Car's wheels are toe-out during steering, hence why two different angles are required
+		mLeftWheel->setSteeringAngle(leftWheelAngle);
+		mRightWheel->setSteeringAngle(rightWheelAngle);
 	}
 
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "DebugCarModel.h"
 #include "Car.h"
+#include "Profiler.h"
 
 namespace Visual {
 
@@ -16,6 +17,8 @@ namespace Visual {
 		/* Called by VisualShell::renderAll
 		*/
 	{
+		VDS_PROFILE_SCOPE("DebugCarModel::render");
+
 		update();
 		mModel.sendRenderCommands(renderer);
 	}
@@ -378,11 +381,14 @@ namespace Visual {
 		unsigned int indexTracker = 0;
 
 		double terrainHeight = 0.0;
+		Terrain::Contact terrainContact;
+		const Terrain& terrain = mCarData.getEnvironment().getTerrain();
 
 		for (unsigned int i = 0; i < mCarData.getWheelSystem().getAllWheelInterfaces().size(); i++) {
 			currentWheelInterface = mCarData.getWheelSystem()[i];
 			temp = currentWheelInterface->getPosition_world();
-			terrainHeight = Environment::mTerrain.getHeight(dvec2(temp.x, temp.z));
+			terrainContact = terrain.sampleContact(dvec2(temp.x, temp.z));
+			terrainHeight = terrainContact.height;
 
 			//Wheel-to-ground displacement
 			{
@@ -405,7 +411,7 @@ namespace Visual {
 			//Terrain normal
 			{
 				mVectorGroup[i * mNumVectorsPerWheelInterface + 3]->setPosition_world(dvec3(temp.x, terrainHeight, temp.z));
-				mVectorGroup[i * mNumVectorsPerWheelInterface + 3]->setDirection_world(Environment::mTerrain.getNormal_world(dvec2(temp.x, temp.z)));
+				mVectorGroup[i * mNumVectorsPerWheelInterface + 3]->setDirection_world(terrainContact.normal_world);
 			}
 
 			indexTracker += mNumVectorsPerWheelInterface;
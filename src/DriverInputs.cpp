@@ -0,0 +1,365 @@
+#include "DriverInputs.h"
+#include "Car.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <glm/glm/gtc/constants.hpp>
+#ifndef VDS_HEADLESS
+#include <Framework/Input/Input.h>
+#endif
+
+namespace Internal {
+
+	namespace {
+		//Start of every input trace, followed by its records
+		struct TraceHeader {
+			char magic[8];
+			uint32_t
+				version,
+				byteOrder,       //TRACE_BYTE_ORDER as written, so traces from a machine of the other endianness are rejected
+				recordSize,
+				reserved;
+			uint64_t
+				recordCount,     //0 while still being written, when the file's size is used instead
+				padding;
+		};
+
+		const char TRACE_MAGIC[8] = { 'V', 'D', 'S', 'I', 'N', 'P', 'U', 'T' };
+		const uint32_t TRACE_BYTE_ORDER = 0x01020304;
+
+		//Keyframes and records are reached at their own time, or within this of it (s), so one taken at t is reached by
+		//a step starting at t however t was summed
+		const double REACHED_TOLERANCE = 1e-9;
+
+		template <typename GetTime, typename OnReached>
+		size_t advance(size_t count, size_t& next, double& lastTime, double t, GetTime getTime, OnReached onReached)
+			/* Called by
+			 * - ScriptedInputSource::read
+			 * - TraceInputSource::read
+			 * Moves next on past every entry reached by t, calling onReached with each, and returns the last reached (or
+			 * count, if none has been). Going back in time finds the place again, without repeating events
+			*/
+		{
+			if (t < lastTime) {
+				next = 0;
+				while (next < count && getTime(next) <= t + REACHED_TOLERANCE)
+					next++;
+			}
+			else
+				while (next < count && getTime(next) <= t + REACHED_TOLERANCE)
+					onReached(next++);
+
+			lastTime = t;
+			return next > 0 ? next - 1 : count;
+		}
+
+		void takeEvents(const DriverInputs& reached, DriverInputs& inputs) {
+			inputs.toggleReverse = inputs.toggleReverse != reached.toggleReverse;
+			inputs.reset = inputs.reset || reached.reset;
+		}
+	}
+
+	ScriptedInputSource::ScriptedInputSource(std::vector<Keyframe> keyframes, bool interpolated) :
+		/* Called by code driving a Car through a manoeuvre (e.g. tests, ScriptedInputSource::makeStepSteer)
+		 * Keyframes are put in time order. With interpolated, steering and pedals move linearly from each keyframe to the
+		 * next; otherwise each keyframe's inputs hold until the next
+		*/
+		mKeyframes(std::move(keyframes)),
+		mInterpolated(interpolated)
+	{
+		std::stable_sort(mKeyframes.begin(), mKeyframes.end(), [](const Keyframe& a, const Keyframe& b) { return a.time < b.time; });
+	}
+
+	ScriptedInputSource ScriptedInputSource::makeStepSteer(double throttle, double stepTime, double steeringWheelAngle)
+		/* Called by code testing the Car's handling
+		 * Straight ahead at a steady throttle, then the steering wheel turned at once to steeringWheelAngle at stepTime
+		*/
+	{
+		DriverInputs straight;
+		straight.throttle = throttle;
+
+		DriverInputs steered = straight;
+		steered.steeringWheelAngle = steeringWheelAngle;
+
+		return ScriptedInputSource({ { 0.0, straight }, { stepTime, steered } });
+	}
+
+	ScriptedInputSource ScriptedInputSource::makeSineSteer(double throttle, double startTime, double amplitude, double frequency, double duration)
+		/* Called by code testing the Car's handling
+		 * Straight ahead at a steady throttle, then from startTime the steering wheel turned amplitude degs either way at
+		 * frequency Hz for duration seconds, and then straight again. Made of 32 keyframes a period, interpolated
+		*/
+	{
+		DriverInputs inputs;
+		inputs.throttle = throttle;
+
+		std::vector<Keyframe> keyframes = { { 0.0, inputs } };
+
+		const double interval = 1.0 / (32.0 * frequency);
+		const size_t count = (size_t)ceil(duration / interval);
+
+		for (size_t i = 0; i <= count; i++) {
+			const double time = std::min(i * interval, duration);
+			inputs.steeringWheelAngle = i < count ? amplitude * sin(2.0 * glm::pi<double>() * frequency * time) : 0.0;
+			keyframes.push_back({ startTime + time, inputs });
+		}
+
+		return ScriptedInputSource(std::move(keyframes), true);
+	}
+
+	void ScriptedInputSource::read(const Car& car, double t, double dt, DriverInputs& inputs)
+		/* Called by Car::update
+		 * Before the first keyframe, the inputs are left as they are
+		*/
+	{
+		const size_t count = mKeyframes.size();
+		const size_t reached = advance(count, mNext, mLastTime, t,
+			[this](size_t i) { return mKeyframes[i].time; },
+			[this, &inputs](size_t i) { takeEvents(mKeyframes[i].inputs, inputs); });
+
+		if (reached == count)
+			return;
+
+		const DriverInputs& from = mKeyframes[reached].inputs;
+		const bool toggleReverse = inputs.toggleReverse, reset = inputs.reset;
+
+		inputs = from;
+		inputs.toggleReverse = toggleReverse;
+		inputs.reset = reset;
+
+		if (mInterpolated && reached + 1 < count) {
+			const Keyframe& to = mKeyframes[reached + 1];
+			const double
+				span = to.time - mKeyframes[reached].time,
+				fraction = span > 0.0 ? std::min(std::max((t - mKeyframes[reached].time) / span, 0.0), 1.0) : 0.0;
+
+			inputs.steeringWheelAngle += (to.inputs.steeringWheelAngle - from.steeringWheelAngle) * fraction;
+			inputs.steeringWheelRate += (to.inputs.steeringWheelRate - from.steeringWheelRate) * fraction;
+			inputs.throttle += (to.inputs.throttle - from.throttle) * fraction;
+			inputs.brake += (to.inputs.brake - from.brake) * fraction;
+		}
+	}
+
+	ControllerInputSource::ControllerInputSource(Controller controller) :
+		/* Called by code driving a Car in closed loop (e.g. tests)
+		*/
+		mController(std::move(controller))
+	{ }
+
+	void ControllerInputSource::read(const Car& car, double t, double dt, DriverInputs& inputs)
+		/* Called by Car::update
+		*/
+	{
+		if (mController)
+			mController(car, t, dt, inputs);
+	}
+
+	bool TraceInputSource::open(const std::string& path)
+		/* Called by code replaying a recorded drive (e.g. vds-run --input-trace)
+		 * Maps the trace at path and plays it from the start. Fails, leaving nothing open, on a missing file or one that
+		 * is not an input trace of this version and byte order
+		*/
+	{
+		mRecords = nullptr;
+		mRecordCount = mNext = 0;
+		mLastTime = 0.0;
+
+		if (!mFile.openReadOnly(path))
+			return false;
+
+		TraceHeader header;
+		if (mFile.getSize() < sizeof(header)) {
+			mFile.close();
+			return false;
+		}
+
+		memcpy(&header, mFile.getData(), sizeof(header));
+		if (memcmp(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0 || header.version != TRACE_VERSION || header.byteOrder != TRACE_BYTE_ORDER ||
+			header.recordSize != sizeof(Record)) {
+			mFile.close();
+			return false;
+		}
+
+		const size_t recordsInFile = (mFile.getSize() - sizeof(header)) / sizeof(Record);
+
+		mRecords = reinterpret_cast<const Record*>(static_cast<const char*>(mFile.getData()) + sizeof(header));
+		mRecordCount = header.recordCount > 0 ? (size_t)std::min<uint64_t>(header.recordCount, recordsInFile) : recordsInFile;
+		return true;
+	}
+
+	void TraceInputSource::read(const Car& car, double t, double dt, DriverInputs& inputs)
+		/* Called by Car::update
+		 * Only the records reached since the last step are touched, so playing a long trace reads it through once, in
+		 * order. Before the first record, the inputs are left as they are
+		*/
+	{
+		DriverInputs events;
+		const size_t reached = advance(mRecordCount, mNext, mLastTime, t,
+			[this](size_t i) { return mRecords[i].time; },
+			[this, &events](size_t i) {
+				DriverInputs recorded;
+				fromRecord(mRecords[i], recorded);
+				takeEvents(recorded, events);
+			});
+
+		if (reached == mRecordCount)
+			return;
+
+		//The held record's own events happened when it was reached
+		fromRecord(mRecords[reached], inputs);
+		inputs.toggleReverse = events.toggleReverse;
+		inputs.reset = events.reset;
+	}
+
+	TraceInputSource::Record TraceInputSource::toRecord(double t, const DriverInputs& inputs)
+		/* Called by RecordingInputSource::read
+		*/
+	{
+		Record record = {};
+		record.time = t;
+		record.steering = inputs.steerByRate ? inputs.steeringWheelRate : inputs.steeringWheelAngle;
+		record.throttle = inputs.throttle;
+		record.brake = inputs.brake;
+		record.flags = (inputs.steerByRate ? STEER_BY_RATE : 0u) | (inputs.toggleReverse ? TOGGLE_REVERSE : 0u) | (inputs.reset ? RESET : 0u);
+
+		return record;
+	}
+
+	void TraceInputSource::fromRecord(const Record& record, DriverInputs& inputs)
+		/* Called by TraceInputSource::read
+		 * Replaces all of inputs, events included
+		*/
+	{
+		inputs = DriverInputs();
+		inputs.steerByRate = (record.flags & STEER_BY_RATE) != 0;
+		(inputs.steerByRate ? inputs.steeringWheelRate : inputs.steeringWheelAngle) = record.steering;
+		inputs.throttle = record.throttle;
+		inputs.brake = record.brake;
+		inputs.toggleReverse = (record.flags & TOGGLE_REVERSE) != 0;
+		inputs.reset = (record.flags & RESET) != 0;
+	}
+
+	RecordingInputSource::RecordingInputSource(std::shared_ptr<DriverInputSource> source) :
+		/* Called by code recording a drive (e.g. vds-run --record-inputs)
+		 * Passes on source's inputs; with nullptr, records the last step's inputs again each step
+		*/
+		mSource(std::move(source))
+	{ }
+
+	RecordingInputSource::~RecordingInputSource()
+		/* Called when the recording's owner is destroyed
+		*/
+	{
+		close();
+	}
+
+	bool RecordingInputSource::open(const std::string& path)
+		/* Called by code recording a drive, before the first step
+		 * Starts a new trace at path, replacing any file there and closing any trace already being written
+		*/
+	{
+		close();
+
+		mFile = fopen(path.c_str(), "wb");
+		if (!mFile)
+			return false;
+
+		TraceHeader header = {};
+		memcpy(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+		header.version = TraceInputSource::TRACE_VERSION;
+		header.byteOrder = TRACE_BYTE_ORDER;
+		header.recordSize = sizeof(TraceInputSource::Record);
+
+		if (fwrite(&header, sizeof(header), 1, mFile) != 1) {
+			fclose(mFile);
+			mFile = nullptr;
+			return false;
+		}
+
+		mRecordCount = 0;
+		return true;
+	}
+
+	bool RecordingInputSource::close()
+		/* Called by
+		 * - RecordingInputSource::~RecordingInputSource
+		 * - code recording a drive, once it is over
+		 * Writes the record count into the header. Fails if any of the trace could not be written
+		*/
+	{
+		if (!mFile)
+			return true;
+
+		bool written = !ferror(mFile) && fseek(mFile, offsetof(TraceHeader, recordCount), SEEK_SET) == 0 &&
+			fwrite(&mRecordCount, sizeof(mRecordCount), 1, mFile) == 1;
+		written = fclose(mFile) == 0 && written;
+
+		mFile = nullptr;
+		return written;
+	}
+
+	void RecordingInputSource::read(const Car& car, double t, double dt, DriverInputs& inputs)
+		/* Called by Car::update
+		 * A record is written only when the inputs differ from the last one written, or carry an event
+		*/
+	{
+		if (mSource)
+			mSource->read(car, t, dt, inputs);
+
+		if (!mFile)
+			return;
+
+		const TraceInputSource::Record record = TraceInputSource::toRecord(t, inputs);
+		const bool changed = mRecordCount == 0 || record.steering != mLastRecord.steering || record.throttle != mLastRecord.throttle ||
+			record.brake != mLastRecord.brake || record.flags != mLastRecord.flags || (record.flags & ~TraceInputSource::STEER_BY_RATE) != 0;
+
+		if (changed && fwrite(&record, sizeof(record), 1, mFile) == 1) {
+			mLastRecord = record;
+			mRecordCount++;
+		}
+	}
+
+#ifndef VDS_HEADLESS
+	void KeyboardInputSource::poll()
+		/* Called by VehicleSimulation::onInputCheck
+		 * Called once per frame, before the frame's physics steps
+		*/
+	{
+		using namespace Framework;
+
+		mSteerRight = Input::isKeyPressed(GLFW_KEY_RIGHT);
+		mSteerLeft = Input::isKeyPressed(GLFW_KEY_LEFT);
+		mAccelerate = Input::isKeyPressed(GLFW_KEY_UP);
+		mBrake = Input::isKeyPressed(GLFW_KEY_DOWN);
+
+		mToggleReverse = mToggleReverse || Input::isKeyReleased(GLFW_KEY_END);
+		mReset = mReset || Input::isKeyPressed(GLFW_KEY_R);
+	}
+
+	void KeyboardInputSource::read(const Car& car, double t, double dt, DriverInputs& inputs)
+		/* Called by Car::update
+		 * The steering wheel turns while an arrow key is held, and otherwise returns to the centre, faster the further it
+		 * is turned
+		*/
+	{
+		const ControlSystem& controlSystem = car.getControlSystem();
+		const double
+			angle = controlSystem.getSteeringWheelAngle(),
+			maxAbsAngle = controlSystem.getMaxAbsSteeringWheelAngle();
+
+		inputs.steerByRate = true;
+		if (mSteerRight || mSteerLeft)
+			inputs.steeringWheelRate = (mSteerRight ? mSteeringRate : 0.0) - (mSteerLeft ? mSteeringRate : 0.0);
+		else
+			inputs.steeringWheelRate = maxAbsAngle > 0.0 ? -mSteeringRate * angle / maxAbsAngle : 0.0;
+
+		inputs.throttle = mAccelerate ? 1.0 : 0.0;
+		inputs.brake = mBrake ? 1.0 : 0.0;
+		inputs.toggleReverse = mToggleReverse;
+		inputs.reset = mReset;
+
+		mToggleReverse = mReset = false;
+	}
+#endif
+}
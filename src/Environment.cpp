@@ -2,9 +2,27 @@
 
 namespace External {
 
-	Terrain Environment::mTerrain;
+	Environment::Environment(double gravityAccel, double airDensity) :
+		/* Called by code setting up a simulation away from sea level (or off-world)
+		*/
+		mGravityAccel(gravityAccel),
+		mAirDensity(airDensity)
+	{ }
 
-	const double
-		Environment::mGravityAccel = 9.80665, //m/s^2  - gravitational acceleration at sea level
-		Environment::mAirDensity = 1.225;     //kg/m^3 - air density at sea level
-}
\ No newline at end of file
+	Environment::Environment(const Terrain::Settings& terrainSettings, double gravityAccel, double airDensity) :
+		/* Called by code choosing its terrain (e.g. vds-run with --terrain-seed or --terrain-cache)
+		*/
+		mTerrain(terrainSettings),
+		mGravityAccel(gravityAccel),
+		mAirDensity(airDensity)
+	{ }
+
+	std::shared_ptr<const Environment> Environment::getDefault()
+		/* Called by Internal::Car::Car, for Cars constructed without an Environment
+		 * Built on first call (thread-safe), so no Terrain is generated before main
+		*/
+	{
+		static const std::shared_ptr<const Environment> defaultEnvironment = std::make_shared<const Environment>();
+		return defaultEnvironment;
+	}
+}
@@ -2,10 +2,12 @@
 
 namespace Visual {
 
-	EnvironmentModel::EnvironmentModel(Framework::ResourceSet& resourceBucket) :
+	EnvironmentModel::EnvironmentModel(Framework::ResourceSet& resourceBucket, const External::Environment& environment) :
 		/* Called by VisualShell::load
+		 * Draws the Environment the simulated Car is bound to
 		*/
-		mResourceBucket(resourceBucket)
+		mResourceBucket(resourceBucket),
+		mEnvironment(environment)
 	{
 		loadResources();
 	}
@@ -35,7 +37,7 @@ namespace Visual {
 		mTerrainShader->addUniformWithDefault("skyColour", mSkyColour);
 
 		//TerrainModel object
-		mTerrainModel = std::make_unique<TerrainModel>(mResourceBucket, mTerrainShader);
+		mTerrainModel = std::make_unique<TerrainModel>(mResourceBucket, mTerrainShader, mEnvironment.getTerrain());
 
 		//SkyBox object
 		mSkyBox = std::make_unique<Framework::Graphics::SkyBox>("res/shaders/skyBox.vert", "res/shaders/skyBox.frag");
@@ -0,0 +1,107 @@
+#include "FrameStats.h"
+
+#include <algorithm>
+
+namespace Internal {
+
+	std::atomic<unsigned long long> FrameStats::mAllocationCount(0);
+
+	FrameStats::FrameStats() :
+		/* Called during VehicleSimulation::VehicleSimulation
+		*/
+		mAllocationsAtFrameStart(mAllocationCount.load(std::memory_order_relaxed)),
+		mFrameStart(std::chrono::steady_clock::now())
+	{ }
+
+	void FrameStats::addTime(Phase phase, float ms)
+		/* Called by
+		 * - FrameStats::ScopedTimer::~ScopedTimer
+		 * - code timing a phase itself
+		*/
+	{
+		switch (phase) {
+		case PHYSICS: mCurrent.physics += ms; break;
+		case RENDER:  mCurrent.render += ms; break;
+		case UI:      mCurrent.ui += ms; break;
+		default: break;
+		}
+	}
+
+	void FrameStats::endFrame()
+		/* Called by VehicleSimulation::onRender
+		 * Writes the current frame into the ring, over the oldest once it is full, and starts the next
+		*/
+	{
+		const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		const unsigned long long allocations = mAllocationCount.load(std::memory_order_relaxed);
+
+		//The UI is drawn during the render pass, so its time is taken out of the render time
+		mCurrent.render = std::max(mCurrent.render - mCurrent.ui, 0.0f);
+		mCurrent.frame = std::chrono::duration<float, std::milli>(now - mFrameStart).count();
+		mCurrent.allocations = (float)(allocations - mAllocationsAtFrameStart);
+
+		mFrames[mNext] = mCurrent;
+		mNext = (mNext + 1) % FRAME_COUNT;
+		mRecorded = std::min(mRecorded + 1, FRAME_COUNT);
+
+		mCurrent = Frame();
+		mFrameStart = now;
+		mAllocationsAtFrameStart = allocations;
+	}
+
+	void FrameStats::clear()
+		/* Called by UILayer::performancePanel
+		*/
+	{
+		mNext = 0;
+		mRecorded = 0;
+		mCurrent = Frame();
+	}
+
+	FrameStats::Summary FrameStats::summarise(Phase phase) const
+		/* Called by UILayer::performancePanel
+		 * Over the frames in the ring. Percentiles are nearest-rank
+		*/
+	{
+		Summary summary;
+		if (!mRecorded)
+			return summary;
+
+		float values[FRAME_COUNT];
+		double total = 0.0;
+
+		for (size_t i = 0; i < mRecorded; i++) {
+			values[i] = getValue(mFrames[i], phase);
+			total += values[i];
+
+			if (values[i] > mBudget[phase])
+				summary.overBudget++;
+		}
+
+		const size_t
+			p50Rank = (mRecorded - 1) / 2,
+			p99Rank = (mRecorded * 99 + 99) / 100 - 1;
+
+		std::nth_element(values, values + p50Rank, values + mRecorded);
+		summary.p50 = values[p50Rank];
+		std::nth_element(values + p50Rank, values + p99Rank, values + mRecorded);
+		summary.p99 = values[p99Rank];
+
+		summary.mean = (float)(total / mRecorded);
+		summary.max = *std::max_element(values + p99Rank, values + mRecorded);
+
+		return summary;
+	}
+
+	float FrameStats::getValue(const Frame& frame, Phase phase)
+		/* Called by FrameStats::summarise
+		*/
+	{
+		switch (phase) {
+		case PHYSICS: return frame.physics;
+		case RENDER:  return frame.render;
+		case UI:      return frame.ui;
+		default:      return frame.frame;
+		}
+	}
+}
@@ -0,0 +1,257 @@
+#include "HeightPyramid.h"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+namespace External {
+
+	namespace {
+		//Floats either side of a height, so a range built from them always contains it
+		inline float roundDown(double height) { const float rounded = (float)height; return rounded > height ? std::nextafter(rounded, -std::numeric_limits<float>::infinity()) : rounded; }
+		inline float roundUp(double height) { const float rounded = (float)height; return rounded < height ? std::nextafter(rounded, std::numeric_limits<float>::infinity()) : rounded; }
+
+		inline unsigned int calcCells(unsigned int squares, unsigned int level) { return (squares + (1u << level) - 1) >> level; }
+
+		//Along one horizontal axis, narrows [enter, exit] to where the ray is within [0, squares]
+		inline void clipToBlock(double origin, double direction, unsigned int squares, double& enter, double& exit) {
+			if (direction == 0.0) {
+				if (origin < 0.0 || origin > squares)
+					exit = -1.0;
+
+				return;
+			}
+
+			const double
+				toFirst = -origin / direction,
+				toLast = (squares - origin) / direction;
+
+			enter = std::max(enter, std::min(toFirst, toLast));
+			exit = std::min(exit, std::max(toFirst, toLast));
+		}
+
+		//The heights of a cell of level k, including its far edges, in a block of squares x squares
+		HeightPyramid::HeightRange rangeHeights(const TerrainData& data, unsigned int squares, unsigned int level, unsigned int cellX, unsigned int cellZ) {
+			const unsigned int
+				firstX = cellX << level,
+				firstZ = cellZ << level,
+				lastX = std::min(firstX + (1u << level), squares),
+				lastZ = std::min(firstZ + (1u << level), squares);
+
+			double
+				lowest = std::numeric_limits<double>::infinity(),
+				highest = -std::numeric_limits<double>::infinity();
+
+			for (size_t x = firstX; x <= lastX; x++)
+				for (size_t z = firstZ; z <= lastZ; z++) {
+					const double height = data.getHeight(x * data.samplesPerRow + z, x);
+					lowest = std::min(lowest, height);
+					highest = std::max(highest, height);
+				}
+
+			return { roundDown(lowest), roundUp(highest) };
+		}
+	}
+
+	void HeightPyramid::build(const TerrainData& data, unsigned int squares)
+		/* Called by
+		 * - Terrain::raycast, for the whole terrain the first time it is raycast
+		 * - Terrain::generateTile
+		 * Ranges the base level from the heights, and each level above from the four cells below it
+		*/
+	{
+		mSquares = squares;
+		mLevelCells.clear();
+		mLevelOffsets.clear();
+
+		size_t rangeCount = 0;
+		for (unsigned int level = BASE_LEVEL; mLevelCells.empty() || mLevelCells.back() > 1; level++) {
+			mLevelCells.push_back(calcCells(squares, level));
+			mLevelOffsets.push_back(rangeCount);
+			rangeCount += (size_t)mLevelCells.back() * mLevelCells.back();
+		}
+
+		mRanges.assign(rangeCount, HeightRange());
+
+		for (unsigned int cellX = 0; cellX < mLevelCells[0]; cellX++)
+			for (unsigned int cellZ = 0; cellZ < mLevelCells[0]; cellZ++)
+				mRanges[(size_t)cellX * mLevelCells[0] + cellZ] = rangeHeights(data, squares, BASE_LEVEL, cellX, cellZ);
+
+		for (size_t stored = 1; stored < mLevelCells.size(); stored++) {
+			const unsigned int
+				cells = mLevelCells[stored],
+				childCells = mLevelCells[stored - 1];
+
+			for (unsigned int cellX = 0; cellX < cells; cellX++)
+				for (unsigned int cellZ = 0; cellZ < cells; cellZ++) {
+					HeightRange range = { std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity() };
+
+					//Cells at the far edges can have fewer than four children
+					for (unsigned int childX = 2 * cellX; childX < std::min(2 * cellX + 2, childCells); childX++)
+						for (unsigned int childZ = 2 * cellZ; childZ < std::min(2 * cellZ + 2, childCells); childZ++) {
+							const HeightRange& child = mRanges[mLevelOffsets[stored - 1] + (size_t)childX * childCells + childZ];
+							range.lowest = std::min(range.lowest, child.lowest);
+							range.highest = std::max(range.highest, child.highest);
+						}
+
+					mRanges[mLevelOffsets[stored] + (size_t)cellX * cells + cellZ] = range;
+				}
+		}
+	}
+
+	bool HeightPyramid::raycast(const TerrainData& data, glm::dvec3 origin, glm::dvec3 direction, double maxDistance, Hit& hit) const
+		/* Called by Terrain::raycast
+		 * The ray is in the block's own space: x and z in squares from its first height sample (as the rows and columns
+		 * of the heights). Finds the nearest point within maxDistance where it meets the surface, from either side
+		*/
+	{
+		if (mLevelCells.empty())
+			return false;
+
+		double
+			enter = 0.0,
+			exit = maxDistance;
+
+		clipToBlock(origin.x, direction.x, mSquares, enter, exit);
+		clipToBlock(origin.z, direction.z, mSquares, enter, exit);
+
+		if (enter > exit)
+			return false;
+
+		return raycastCell(data, origin, direction, BASE_LEVEL + (unsigned int)mLevelCells.size() - 1, 0, 0, enter, exit, hit);
+	}
+
+	size_t HeightPyramid::calcBytes(unsigned int squares)
+		/* Called by TerrainTileCache::getTileBytes
+		 * What getBytes comes to once built over a block of squares x squares
+		*/
+	{
+		size_t rangeCount = 0;
+		for (unsigned int level = BASE_LEVEL, cells = 0; cells != 1; level++) {
+			cells = calcCells(squares, level);
+			rangeCount += (size_t)cells * cells;
+		}
+
+		return rangeCount * sizeof(HeightRange);
+	}
+
+	HeightPyramid::HeightRange HeightPyramid::getRange(const TerrainData& data, unsigned int level, unsigned int cellX, unsigned int cellZ) const
+		/* Called by HeightPyramid::raycastCell
+		 * Stored levels are looked up; the levels below are ranged over the cell's heights
+		*/
+	{
+		if (level >= BASE_LEVEL) {
+			const size_t stored = level - BASE_LEVEL;
+			return mRanges[mLevelOffsets[stored] + (size_t)cellX * mLevelCells[stored] + cellZ];
+		}
+
+		return rangeHeights(data, mSquares, level, cellX, cellZ);
+	}
+
+	bool HeightPyramid::raycastCell(const TerrainData& data, const glm::dvec3& origin, const glm::dvec3& direction, unsigned int level, unsigned int cellX, unsigned int cellZ,
+		double enter, double exit, Hit& hit) const
+		/* Called by
+		 * - HeightPyramid::raycast
+		 * - HeightPyramid::raycastCell
+		 * The part of the ray within the cell is [enter, exit]. It cannot meet the cell's surface if it stays above or
+		 * below all of it. Otherwise each child the ray crosses is tried in turn, so the first hit found is the nearest
+		*/
+	{
+		const HeightRange range = getRange(data, level, cellX, cellZ);
+		const double
+			enterHeight = origin.y + direction.y * enter,
+			exitHeight = origin.y + direction.y * exit;
+
+		if (std::max(enterHeight, exitHeight) < range.lowest || std::min(enterHeight, exitHeight) > range.highest)
+			return false;
+
+		if (level == 0)
+			return raycastSquare(data, origin, direction, cellX, cellZ, enter, exit, hit);
+
+		//The ray starts in one child, and moves on to the next each time it crosses one of the cell's middle lines
+		const unsigned int childSquares = 1u << (level - 1);
+		const double
+			middleX = (2.0 * cellX + 1.0) * childSquares,
+			middleZ = (2.0 * cellZ + 1.0) * childSquares,
+			crossX = direction.x != 0.0 ? (middleX - origin.x) / direction.x : std::numeric_limits<double>::infinity(),
+			crossZ = direction.z != 0.0 ? (middleZ - origin.z) / direction.z : std::numeric_limits<double>::infinity();
+
+		bool
+			upperX = direction.x == 0.0 ? origin.x >= middleX : (crossX > enter) == (direction.x < 0.0),
+			upperZ = direction.z == 0.0 ? origin.z >= middleZ : (crossZ > enter) == (direction.z < 0.0);
+
+		double start = enter;
+		while (true) {
+			const bool
+				crossesX = crossX > start && crossX < exit,
+				crossesZ = crossZ > start && crossZ < exit;
+			const double end = std::min(crossesX ? crossX : exit, crossesZ ? crossZ : exit);
+
+			const unsigned int
+				childX = 2 * cellX + upperX,
+				childZ = 2 * cellZ + upperZ;
+
+			if (childX * childSquares < mSquares && childZ * childSquares < mSquares &&
+				raycastCell(data, origin, direction, level - 1, childX, childZ, start, end, hit))
+				return true;
+
+			if (end == exit)
+				return false;
+
+			if (crossesX && crossX == end) upperX = !upperX;
+			if (crossesZ && crossZ == end) upperZ = !upperZ;
+			start = end;
+		}
+	}
+
+	bool HeightPyramid::raycastSquare(const TerrainData& data, const glm::dvec3& origin, const glm::dvec3& direction, unsigned int squareX, unsigned int squareZ,
+		double enter, double exit, Hit& hit) const
+		/* Called by HeightPyramid::raycastCell
+		 * Splits [enter, exit] where the ray crosses the square's diagonal, and intersects each part with the plane of the
+		 * triangle it is over (the same triangles, and diagonal convention, as Terrain::calcHeight)
+		*/
+	{
+		const size_t heightsIndexBL = (size_t)squareX * data.samplesPerRow + squareZ;
+		const double
+			heightBL = data.getHeight(heightsIndexBL, squareX),
+			heightTL = data.getHeight(heightsIndexBL + 1, squareX),
+			heightBR = data.getHeight(heightsIndexBL + data.samplesPerRow, squareX + 1),
+			heightTR = data.getHeight(heightsIndexBL + data.samplesPerRow + 1, squareX + 1),
+			withinSquareX = origin.x - squareX,  //Of the ray's origin
+			withinSquareZ = origin.z - squareZ,  //^
+			diagonal = direction.x != direction.z ? (withinSquareZ - withinSquareX) / (direction.x - direction.z) : std::numeric_limits<double>::infinity();
+
+		double start = enter;
+		while (true) {
+			const double
+				end = diagonal > start && diagonal < exit ? diagonal : exit,
+				middle = 0.5 * (start + end);
+
+			const bool right = withinSquareX + direction.x * middle > withinSquareZ + direction.z * middle;
+
+			//The triangle's plane, as height = heightBL + slopeX * withinSquare.x + slopeZ * withinSquare.y
+			const double
+				slopeX = right ? heightBR - heightBL : heightTR - heightTL,
+				slopeZ = right ? heightTR - heightBR : heightTL - heightBL;
+
+			auto heightAbove = [&](double distance) {
+				return origin.y + direction.y * distance - (heightBL + slopeX * (withinSquareX + direction.x * distance) + slopeZ * (withinSquareZ + direction.z * distance));
+			};
+
+			const double
+				startAbove = heightAbove(start),
+				endAbove = heightAbove(end);
+
+			if (startAbove == 0.0 || endAbove == 0.0 || (startAbove < 0.0) != (endAbove < 0.0)) {
+				hit.distance = startAbove == 0.0 ? start : start + (end - start) * startAbove / (startAbove - endAbove);
+				hit.triIndex = 2 * (heightsIndexBL - squareX) + right;
+				return true;
+			}
+
+			if (end == exit)
+				return false;
+
+			start = end;
+		}
+	}
+}
@@ -0,0 +1,180 @@
+#include "LapTimer.h"
+#include "Car.h"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+namespace Internal {
+
+	LapTimer::LapTimer(const External::TrackCentreline& centreline) :
+		/* Called by code timing a car with the default settings
+		*/
+		LapTimer(centreline, Settings())
+	{ }
+
+	LapTimer::LapTimer(const External::TrackCentreline& centreline, const Settings& settings) :
+		/* Called by
+		 * - LapTimer::LapTimer
+		 * - code timing a car round the track (e.g. vds-run --laps)
+		 * The centreline must outlive the timer (it belongs to the car's Environment's Terrain)
+		*/
+		mCentreline(centreline),
+		mSettings(settings),
+		mLength(centreline.getLength()),
+		mSectorLength(centreline.getLength() / std::max(settings.sectors, 1u))
+	{
+		mCurrentLap = { 0.0, {}, 0 };
+		mCurrentLap.sectorTimes.reserve(std::max(settings.sectors, 1u));
+	}
+
+	void LapTimer::update(const Car& car, double t)
+		/* Called by code timing a Car, after each Car::update
+		*/
+	{
+		const glm::dvec3 position_world = car.getState().getPosition_world();
+		const std::vector<WheelInterface>& wheelInterfaces = car.getWheelSystem().getAllWheelInterfaces();
+
+		unsigned char surfaceTypes[4];
+		const unsigned int wheelCount = (unsigned int)std::min(wheelInterfaces.size(), (size_t)4);
+		for (unsigned int wheel = 0; wheel < wheelCount; wheel++)
+			surfaceTypes[wheel] = wheelInterfaces[wheel].getSurfaceType();
+
+		update(t, glm::dvec2(position_world.x, position_world.z), surfaceTypes, wheelCount);
+	}
+
+	void LapTimer::update(double t, glm::dvec2 position_world, const unsigned char* surfaceTypes, unsigned int wheelCount)
+		/* Called by
+		 * - LapTimer::update
+		 * - code timing a car simulated some other way (e.g. a vehicle of a VehicleBatch), after each step
+		 * position_world is the car's horizontal position (x, z), and surfaceTypes the TerrainType under each of its
+		 * wheelCount wheels
+		*/
+	{
+		if (mCentreline.isEmpty())
+			return;
+
+		const double previousLineDistance = mLineDistance;
+		locate(position_world);
+
+		const double previousProgress = mProgress;
+		if (!mStarted) {
+			//Within half a lap either side of the start line, so a car just behind it starts timing as it crosses
+			mProgress = mCentreline.wrapDistance(mLineDistance - mSettings.startDistance + 0.5 * mLength) - 0.5 * mLength;
+			mNextSplit = (long long)ceil(mProgress / mSectorLength);
+			mStarted = true;
+		}
+		else {
+			//The shorter way round the loop from where the car was
+			double moved = mLineDistance - previousLineDistance;
+			if (moved > 0.5 * mLength) moved -= mLength;
+			else if (moved < -0.5 * mLength) moved += mLength;
+
+			mProgress += moved;
+			crossSplits(previousProgress, t);
+		}
+
+		if (mTiming)
+			mCurrentLap.time = t - mLapStartTime;
+
+		//A violation each time the wheels go off, however long they stay off
+		unsigned int wheelsOff = 0;
+		for (unsigned int wheel = 0; wheel < wheelCount; wheel++)
+			wheelsOff += surfaceTypes[wheel] != External::TerrainType::TARMAC;
+
+		const bool offTrack = wheelCount > 0 && wheelsOff >= std::min(mSettings.wheelsOffForViolation, wheelCount);
+		if (offTrack && !mOffTrack) {
+			mTotalViolations++;
+			if (mTiming)
+				mCurrentLap.trackLimitViolations++;
+		}
+
+		mOffTrack = offTrack;
+		mLastTime = t;
+	}
+
+	void LapTimer::reset()
+		/* Called by code timing a car, when the car is reset
+		 * Forgets the car's position and every lap, as if just constructed
+		*/
+	{
+		mStarted = mTiming = mOffTrack = false;
+		mSegment = 0;
+		mLineDistance = mLateralOffset = mProgress = mLapStartTime = mSplitTime = mLastTime = 0.0;
+		mNextSplit = 0;
+		mTotalViolations = 0;
+		mCurrentLap.time = 0.0;
+		mCurrentLap.sectorTimes.clear();
+		mCurrentLap.trackLimitViolations = 0;
+		mLaps.clear();
+	}
+
+	double LapTimer::getProgressPercent() const
+		/* Called by code reporting on a car's progress
+		 * Through the current lap, from the start line
+		*/
+	{
+		return mLength > 0.0 ? 100.0 * mCentreline.wrapDistance(mProgress) / mLength : 0.0;
+	}
+
+	double LapTimer::getBestLapTime() const
+		/* Called by code reporting on a car's laps
+		 * 0.0 before the first lap is completed
+		*/
+	{
+		double best = std::numeric_limits<double>::infinity();
+		for (const Lap& lap : mLaps)
+			best = std::min(best, lap.time);
+
+		return mLaps.empty() ? 0.0 : best;
+	}
+
+	void LapTimer::locate(glm::dvec2 position_world)
+		/* Called by LapTimer::update
+		 * From the segment nearest last step, so each step usually tests a few segments. The first step searches the
+		 * whole track
+		*/
+	{
+		const External::TrackCentreline::Nearest nearest = mStarted ? mCentreline.findNearestFrom(position_world, mSegment, mSettings.relocateDistance) :
+			mCentreline.findNearest(position_world);
+
+		mSegment = nearest.sample.segment;
+		mLineDistance = nearest.sample.distance;
+		mLateralOffset = nearest.lateralOffset;
+	}
+
+	void LapTimer::crossSplits(double previousProgress, double t)
+		/* Called by LapTimer::update
+		 * Each boundary reached for the first time ends a sector, at the time progress reached it (interpolated between
+		 * this step and the last). The start line also ends a lap, or starts the first
+		*/
+	{
+		while (mProgress >= mNextSplit * mSectorLength) {
+			const double
+				boundary = mNextSplit * mSectorLength,
+				crossed = mProgress > previousProgress ? mLastTime + (t - mLastTime) * (boundary - previousProgress) / (mProgress - previousProgress) : t;
+
+			const long long sectors = std::max(mSettings.sectors, 1u);
+			const bool startLine = ((mNextSplit % sectors) + sectors) % sectors == 0;
+
+			if (mTiming)
+				mCurrentLap.sectorTimes.push_back(crossed - mSplitTime);
+
+			if (startLine) {
+				if (mTiming) {
+					mCurrentLap.time = crossed - mLapStartTime;
+					mLaps.push_back(mCurrentLap);
+				}
+
+				mTiming = true;
+				mLapStartTime = crossed;
+				mCurrentLap.time = 0.0;
+				mCurrentLap.sectorTimes.clear();
+				mCurrentLap.trackLimitViolations = 0;
+			}
+
+			mSplitTime = crossed;
+			mNextSplit++;
+		}
+	}
+}
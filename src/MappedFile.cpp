@@ -0,0 +1,195 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace Internal {
+
+	MappedFile::~MappedFile()
+		/* Called when the owner of the mapping is destroyed
+		*/
+	{
+		close();
+	}
+
+	bool MappedFile::openReadOnly(const std::string& path)
+		/* Called by code reading a cache file (e.g. Terrain::loadCache)
+		 * Maps the whole of the file at path, replacing any mapping already held. Fails on missing or empty files
+		*/
+	{
+		close();
+
+#ifdef _WIN32
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+			CloseHandle(file);
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		const void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+		if (!data) {
+			if (mapping) CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		mFileHandle = file;
+		mMappingHandle = mapping;
+		mSize = (size_t)size.QuadPart;
+#else
+		const int file = open(path.c_str(), O_RDONLY);
+		if (file < 0)
+			return false;
+
+		struct stat status;
+		if (fstat(file, &status) != 0 || status.st_size <= 0) {
+			::close(file);
+			return false;
+		}
+
+		void* data = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_SHARED, file, 0);
+
+		//The mapping keeps the file open itself
+		::close(file);
+
+		if (data == MAP_FAILED)
+			return false;
+
+		mSize = (size_t)status.st_size;
+#endif
+
+		mData = data;
+		return true;
+	}
+
+	bool MappedFile::openReadWrite(const std::string& path, size_t size)
+		/* Called by code writing a file through a mapping (e.g. TelemetryRecorder::open)
+		 * Creates the file at path (emptying any file already there), size bytes long and mapped read-write, replacing
+		 * any mapping already held
+		*/
+	{
+		close();
+
+#ifdef _WIN32
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+
+		mFileHandle = file;
+#else
+		const int file = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if (file < 0)
+			return false;
+
+		mFileDescriptor = file;
+#endif
+
+		mWritable = true;
+		if (!resize(size)) {
+			close();
+			return false;
+		}
+
+		return true;
+	}
+
+	bool MappedFile::resize(size_t size)
+		/* Called by
+		 * - MappedFile::openReadWrite
+		 * - code writing a file through a mapping, as it grows (e.g. TelemetryRecorder::writeSamples)
+		 * Sets the length of a writable file and maps the whole of it again; what was written is kept, but may now be at
+		 * a different address. On failure nothing is mapped
+		*/
+	{
+		if (!mWritable || size == 0)
+			return false;
+
+#ifdef _WIN32
+		if (mData)
+			UnmapViewOfFile(mData);
+		if (mMappingHandle)
+			CloseHandle(mMappingHandle);
+
+		mData = nullptr;
+		mMappingHandle = nullptr;
+		mSize = 0;
+
+		LARGE_INTEGER end;
+		end.QuadPart = (LONGLONG)size;
+		if (!SetFilePointerEx(mFileHandle, end, NULL, FILE_BEGIN) || !SetEndOfFile(mFileHandle))
+			return false;
+
+		HANDLE mapping = CreateFileMappingA(mFileHandle, NULL, PAGE_READWRITE, 0, 0, NULL);
+		void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, 0) : nullptr;
+
+		if (!data) {
+			if (mapping) CloseHandle(mapping);
+			return false;
+		}
+
+		mMappingHandle = mapping;
+#else
+		if (mData)
+			munmap(const_cast<void*>(mData), mSize);
+
+		mData = nullptr;
+		mSize = 0;
+
+		if (ftruncate(mFileDescriptor, (off_t)size) != 0)
+			return false;
+
+		void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, mFileDescriptor, 0);
+		if (data == MAP_FAILED)
+			return false;
+#endif
+
+		mData = data;
+		mSize = size;
+		return true;
+	}
+
+	void MappedFile::close()
+		/* Called by
+		 * - MappedFile::~MappedFile
+		 * - MappedFile::openReadOnly
+		 * - MappedFile::openReadWrite
+		*/
+	{
+#ifdef _WIN32
+		if (mData)
+			UnmapViewOfFile(mData);
+		if (mMappingHandle)
+			CloseHandle(mMappingHandle);
+		if (mFileHandle)
+			CloseHandle(mFileHandle);
+
+		mMappingHandle = nullptr;
+		mFileHandle = nullptr;
+#else
+		if (mData)
+			munmap(const_cast<void*>(mData), mSize);
+		if (mFileDescriptor >= 0)
+			::close(mFileDescriptor);
+
+		mFileDescriptor = -1;
+#endif
+
+		mData = nullptr;
+		mSize = 0;
+		mWritable = false;
+	}
+}
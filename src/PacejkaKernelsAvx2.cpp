@@ -0,0 +1,68 @@
+/* Built with AVX2 + FMA code generation (see CMakeLists.txt), so nothing outside this file may call into it unless
+ * PacejkaKernels::cpuSupportsAvx2 has returned true. Only intrinsics and PacejkaKernels.hpp are used here, so no
+ * inline function compiled for AVX2 can be shared with the rest of the program.
+*/
+
+#include "PacejkaKernels.hpp"
+
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#include <immintrin.h>
+
+namespace {
+	struct Avx2Ops {
+		typedef __m256d V;
+		typedef __m256d M;
+		static const size_t width = 4;
+
+		static inline V set1(double x) { return _mm256_set1_pd(x); }
+		static inline V load(const double* p) { return _mm256_loadu_pd(p); }
+		static inline void store(double* p, V x) { _mm256_storeu_pd(p, x); }
+
+		static inline V add(V a, V b) { return _mm256_add_pd(a, b); }
+		static inline V sub(V a, V b) { return _mm256_sub_pd(a, b); }
+		static inline V mul(V a, V b) { return _mm256_mul_pd(a, b); }
+		static inline V div(V a, V b) { return _mm256_div_pd(a, b); }
+		static inline V fmadd(V a, V b, V c) { return _mm256_fmadd_pd(a, b, c); }
+		static inline V neg(V a) { return _mm256_xor_pd(a, _mm256_set1_pd(-0.0)); }
+		static inline V abs(V a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+		static inline V min(V a, V b) { return _mm256_min_pd(a, b); }
+		static inline V max(V a, V b) { return _mm256_max_pd(a, b); }
+		static inline V floor(V a) { return _mm256_floor_pd(a); }
+
+		static inline M cmpEq(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+		static inline M cmpLt(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+		static inline M cmpGt(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+		static inline M maskOr(M a, M b) { return _mm256_or_pd(a, b); }
+		static inline M maskXor(M a, M b) { return _mm256_xor_pd(a, b); }
+		static inline M maskAndNot(M a, M b) { return _mm256_andnot_pd(a, b); }  //!a && b
+		static inline V select(M m, V a, V b) { return _mm256_blendv_pd(b, a, m); }
+
+		static inline V pow2n(V n)
+			/* 2^n for integral n in [-1022, 1023], built directly from the exponent bits
+			*/
+		{
+			__m256i exponent = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(n));
+			exponent = _mm256_slli_epi64(_mm256_add_epi64(exponent, _mm256_set1_epi64x(1023)), 52);
+			return _mm256_castsi256_pd(exponent);
+		}
+	};
+}
+
+namespace Internal {
+	namespace PacejkaKernels {
+		bool evaluateAvx2(const Coefficients& coefficients, const double* verticalLoads_N, const double* slipPercents, const double* slipAngles_degs, const double* camberAngles_degs, size_t count, double* longitudinalForces, double* lateralForces)
+			/* Called by PacejkaMagicFormula::evaluate
+			*/
+		{
+			evaluateBatch<Avx2Ops>(coefficients, verticalLoads_N, slipPercents, slipAngles_degs, camberAngles_degs, count, longitudinalForces, lateralForces);
+			return true;
+		}
+	}
+}
+#else
+namespace Internal {
+	namespace PacejkaKernels {
+		bool evaluateAvx2(const Coefficients&, const double*, const double*, const double*, const double*, size_t, double*, double*) { return false; }
+	}
+}
+#endif
@@ -0,0 +1,68 @@
+/* Built with AVX-512F code generation (see CMakeLists.txt), so nothing outside this file may call into it unless
+ * PacejkaKernels::cpuSupportsAvx512 has returned true. Only intrinsics and PacejkaKernels.hpp are used here, so no
+ * inline function compiled for AVX-512 can be shared with the rest of the program.
+*/
+
+#include "PacejkaKernels.hpp"
+
+#if defined(__AVX512F__)
+#include <immintrin.h>
+
+namespace {
+	struct Avx512Ops {
+		typedef __m512d V;
+		typedef __mmask8 M;
+		static const size_t width = 8;
+
+		static inline V set1(double x) { return _mm512_set1_pd(x); }
+		static inline V load(const double* p) { return _mm512_loadu_pd(p); }
+		static inline void store(double* p, V x) { _mm512_storeu_pd(p, x); }
+
+		static inline V add(V a, V b) { return _mm512_add_pd(a, b); }
+		static inline V sub(V a, V b) { return _mm512_sub_pd(a, b); }
+		static inline V mul(V a, V b) { return _mm512_mul_pd(a, b); }
+		static inline V div(V a, V b) { return _mm512_div_pd(a, b); }
+		static inline V fmadd(V a, V b, V c) { return _mm512_fmadd_pd(a, b, c); }
+		static inline V neg(V a) { return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(a), _mm512_set1_epi64(0x8000000000000000LL))); }
+		static inline V abs(V a) { return _mm512_abs_pd(a); }
+		static inline V min(V a, V b) { return _mm512_min_pd(a, b); }
+		static inline V max(V a, V b) { return _mm512_max_pd(a, b); }
+		static inline V floor(V a) { return _mm512_roundscale_pd(a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+
+		static inline M cmpEq(V a, V b) { return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ); }
+		static inline M cmpLt(V a, V b) { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+		static inline M cmpGt(V a, V b) { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+		static inline M maskOr(M a, M b) { return (M)(a | b); }
+		static inline M maskXor(M a, M b) { return (M)(a ^ b); }
+		static inline M maskAndNot(M a, M b) { return (M)(~a & b); }  //!a && b
+		static inline V select(M m, V a, V b) { return _mm512_mask_blend_pd(m, b, a); }
+
+		static inline V pow2n(V n)
+			/* 2^n for integral n in [-1022, 1023], built directly from the exponent bits
+			*/
+		{
+			__m512i exponent = _mm512_cvtepi32_epi64(_mm512_cvtpd_epi32(n));
+			exponent = _mm512_slli_epi64(_mm512_add_epi64(exponent, _mm512_set1_epi64(1023)), 52);
+			return _mm512_castsi512_pd(exponent);
+		}
+	};
+}
+
+namespace Internal {
+	namespace PacejkaKernels {
+		bool evaluateAvx512(const Coefficients& coefficients, const double* verticalLoads_N, const double* slipPercents, const double* slipAngles_degs, const double* camberAngles_degs, size_t count, double* longitudinalForces, double* lateralForces)
+			/* Called by PacejkaMagicFormula::evaluate
+			*/
+		{
+			evaluateBatch<Avx512Ops>(coefficients, verticalLoads_N, slipPercents, slipAngles_degs, camberAngles_degs, count, longitudinalForces, lateralForces);
+			return true;
+		}
+	}
+}
+#else
+namespace Internal {
+	namespace PacejkaKernels {
+		bool evaluateAvx512(const Coefficients&, const double*, const double*, const double*, const double*, size_t, double*, double*) { return false; }
+	}
+}
+#endif
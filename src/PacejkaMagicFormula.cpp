@@ -1,49 +1,21 @@
 #include "PacejkaMagicFormula.h"
+#include "PacejkaKernels.hpp"
 #include "Tyre.h"
 
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
 namespace Internal {
 
-	float                                 //default values
-		PacejkaMagicFormula::b0 = 1.4,    //1.65
-		PacejkaMagicFormula::b1 = 80.0,   //0
-		PacejkaMagicFormula::b2 = 1700.0, //1100
-		PacejkaMagicFormula::b3 = 0.0,    //0
-		PacejkaMagicFormula::b4 = 300.0,  //300
-		PacejkaMagicFormula::b5 = 0.0,    //0
-		PacejkaMagicFormula::b6 = 0.0,    //0
-		PacejkaMagicFormula::b7 = 0.0,    //0
-		PacejkaMagicFormula::b8 = -2.0,   //-2
-		PacejkaMagicFormula::b9 = 0.0,    //0
-		PacejkaMagicFormula::b10 = 0.0,   //0
-		PacejkaMagicFormula::b11 = 0.0,   //0
-		PacejkaMagicFormula::b12 = 0.0,   //0
-		PacejkaMagicFormula::b13 = 0.0;   //0
-
-	float			                    //default values
-		PacejkaMagicFormula::a0 = 1.4,	//1.4
-		PacejkaMagicFormula::a1 = 80.0,	//0
-		PacejkaMagicFormula::a2 = 1700, //1100
-		PacejkaMagicFormula::a3 = 1100, //1100
-		PacejkaMagicFormula::a4 = 50.0,	//10
-		PacejkaMagicFormula::a5 = 0.0,	//0
-		PacejkaMagicFormula::a6 = 0.0,	//0
-		PacejkaMagicFormula::a7 = -2.0,	//-2
-		PacejkaMagicFormula::a8 = 0.0,	//0
-		PacejkaMagicFormula::a9 = 0.0,	//0
-		PacejkaMagicFormula::a10 = 0.0,	//0
-		PacejkaMagicFormula::a11 = 0.0,	//0
-		PacejkaMagicFormula::a12 = 0.0,	//0
-		PacejkaMagicFormula::a13 = 0.0,	//0
-		PacejkaMagicFormula::a14 = 0.0, //0
-		PacejkaMagicFormula::a15 = 0.0, //0
-		PacejkaMagicFormula::a16 = 0.0, //0
-		PacejkaMagicFormula::a17 = 0.0; //0
+	PacejkaMagicFormula::SimdLevel PacejkaMagicFormula::mSimdLevel = PacejkaMagicFormula::getSupportedSimdLevel();
 
 	PacejkaMagicFormula::PacejkaMagicFormula()
 		/* Called during Tyre::Tyre
+		 * Starts out following the published parameter set
 		*/
 	{
-		setToDriftingTyreParams();
+		setParams(nullptr);
 	}
 
 	void PacejkaMagicFormula::updateForces(double verticalLoad_N, double slipPercent_0_to_100, double slipAngle_degs, double camberAngle_degs)
@@ -52,136 +24,218 @@ namespace Internal {
 	{
 		//http://www.edy.es/dev/docs/pacejka-94-parameters-explained-a-comprehensive-guide/
 
-		updateLongitudinalForce(verticalLoad_N / 1000.0, slipPercent_0_to_100);
-		updateLateralForce(verticalLoad_N / 1000.0, slipAngle_degs, camberAngle_degs);
+		const PacejkaParams& params = *updateParams();
+		const double load_kN = verticalLoad_N / 1000.0;
+
+		if (!mLoadTermsValid || (load_kN != mLoadTerms.load_kN && std::abs(load_kN - mLoadTerms.load_kN) * 1000.0 >= params.loadTolerance_N)) {
+			mLoadTerms = calcLoadTerms(params, load_kN);
+			mLoadTermsValid = true;
+		}
+
+		mLongitudinalForce = calcLongitudinalForce(params, mLoadTerms, slipPercent_0_to_100);
+		mLateralForce = calcLateralForce(params, mLoadTerms, slipAngle_degs, camberAngle_degs);
 	}
 
-	void PacejkaMagicFormula::setToRoadTyreParams()
-		/* Called by UILayer::tyreParameters
+	void PacejkaMagicFormula::evaluate(const PacejkaParams& params, const double* verticalLoads_N, const double* slipPercents_0_to_100, const double* slipAngles_degs, const double* camberAngles_degs, size_t count, double* longitudinalForces, double* lateralForces)
+		/* Called by VehicleBatch::updateTyreForces
+		 * Evaluates count tyres sharing one parameter set at once (e.g. the 4 wheels of one car, or every wheel of a batch of cars)
+		 * Load terms are recalculated for every tyre, whatever the set's loadTolerance_N
+		 * The SIMD paths agree with the scalar formula to within a few ulp per elementary function, not bit for bit
 		*/
 	{
-		//Longitudinal
-		b0 = 1.4,
-		b1 = 80.0,
-		b2 = 1700.0,
-		b3 = 0.0,
-		b4 = 140.0,
-		b5 = 0.67,
-		b6 = 0.0,
-		b7 = 0.273,
-		b8 = -2.0,
-		b9 = 0.698,
-		b10 = 0.0,
-		b11 = 0.0,
-		b12 = 0.0,
-		b13 = 0.0;
+		if (mSimdLevel != SimdLevel::SCALAR) {
+			const PacejkaKernels::Coefficients coefficients = {
+				{ params.a0, params.a1, params.a2, params.a3, params.a4, params.a5, params.a6, params.a7, params.a8,
+				  params.a9, params.a10, params.a11, params.a12, params.a13, params.a14, params.a15, params.a16, params.a17 },
+				{ params.b0, params.b1, params.b2, params.b3, params.b4, params.b5, params.b6,
+				  params.b7, params.b8, params.b9, params.b10, params.b11, params.b12, params.b13 }
+			};
+
+			if (mSimdLevel == SimdLevel::AVX512 && PacejkaKernels::evaluateAvx512(coefficients, verticalLoads_N, slipPercents_0_to_100, slipAngles_degs, camberAngles_degs, count, longitudinalForces, lateralForces))
+				return;
+
+			if (PacejkaKernels::evaluateAvx2(coefficients, verticalLoads_N, slipPercents_0_to_100, slipAngles_degs, camberAngles_degs, count, longitudinalForces, lateralForces))
+				return;
+		}
 
-		//Lateral
-		a0 = 1.4,
-		a1 = 0.0,
-		a2 = 1700.0,
-		a3 = 2000.0,
-		a4 = 18.5,
-		a5 = 0.0,
-		a6 = 0.0,
-		a7 = -2.0,
-		a8 = 1.0,
-		a9 = 0.0,
-		a10 = 0.0,
-		a11 = 0.0,
-		a12 = 0.0,
-		a13 = 0.0,
-		a14 = 0.0,
-		a15 = 0.0,
-		a16 = 0.0,
-		a17 = 0.0;
+		for (size_t i = 0; i < count; i++) {
+			const LoadTerms terms = calcLoadTerms(params, verticalLoads_N[i] / 1000.0);
+			longitudinalForces[i] = calcLongitudinalForce(params, terms, slipPercents_0_to_100[i]);
+			lateralForces[i] = calcLateralForce(params, terms, slipAngles_degs[i], camberAngles_degs[i]);
+		}
 	}
 
-	void PacejkaMagicFormula::setToDriftingTyreParams()
+	void PacejkaMagicFormula::setParams(std::shared_ptr<const PacejkaParams> params)
 		/* Called by
 		 * - PacejkaMagicFormula::PacejkaMagicFormula
-		 * - UILayer::tyreParameters
+		 * - Tyre::setParams
+		 * Gives this instance its own parameter set; nullptr goes back to following the published one
 		*/
 	{
-		//Longitudinal
-		b0 = 1.4,
-		b1 = 80.0,
-		b2 = 1700.0,
-		b3 = 0.0,
-		b4 = 300.0,
-		b5 = 1.0,
-		b6 = 0.0,
-		b7 = 0.0,
-		b8 = -2.0,
-		b9 = 0.0,
-		b10 = 0.0,
-		b11 = 0.0,
-		b12 = 0.0,
-		b13 = 0.0;
-
-		//Lateral
-		a0 = 1.4,
-		a1 = 80.0,
-		a2 = 1700,
-		a3 = 1100,
-		a4 = 50.0,
-		a5 = 0.0,
-		a6 = 0.0,
-		a7 = -2.0,
-		a8 = 0.0,
-		a9 = 0.0,
-		a10 = 0.0,
-		a11 = 0.0,
-		a12 = 0.0,
-		a13 = 0.0,
-		a14 = 0.0,
-		a15 = 0.0,
-		a16 = 0.0,
-		a17 = 0.0;
+		//Version before set, so that a set published in between is picked up at the next update rather than missed
+		mPublishedVersion = PacejkaParams::getPublishedVersion();
+		mFollowsPublished = !params;
+		mParams = mFollowsPublished ? PacejkaParams::getPublished() : std::move(params);
+		mLoadTermsValid = false;
 	}
 
-	void PacejkaMagicFormula::updateLongitudinalForce(double load_kN, double slipAsPercent)
-		/* Called by PacejkaMagicFormula::updateForces
+	const std::shared_ptr<const PacejkaParams>& PacejkaMagicFormula::updateParams()
+		/* Called by
+		 * - PacejkaMagicFormula::updateForces
+		 * - Tyre::update (TyreForceTable lookups)
+		 * Picks up a newly published set, if this instance follows it. The version check is a single atomic load,
+		 * so the shared pointer itself is only copied when something has been published
 		*/
 	{
-		if (load_kN == 0.0 || abs(slipAsPercent == 0.0)) {
-			mLongitudinalForce = 0.0;
-			return;
+		if (mFollowsPublished) {
+			const unsigned int publishedVersion = PacejkaParams::getPublishedVersion();
+
+			if (publishedVersion != mPublishedVersion) {
+				mPublishedVersion = publishedVersion;
+				mParams = PacejkaParams::getPublished();
+				mLoadTermsValid = false;
+			}
 		}
 
-		double loadSquared_kN = pow(load_kN, 2.0);
+		return mParams;
+	}
+
+	PacejkaMagicFormula::SimdLevel PacejkaMagicFormula::getSupportedSimdLevel()
+		/* Called by
+		 * - static initialisation of mSimdLevel
+		 * - PacejkaMagicFormula::setSimdLevel
+		*/
+	{
+		if (PacejkaKernels::cpuSupportsAvx512())
+			return SimdLevel::AVX512;
 
-		C = b0;
-		D = load_kN * (b1 * load_kN + b2);
-		BCD = (b0 * loadSquared_kN + b4 * load_kN) * exp(-b5 * load_kN);
-		B = BCD / (C * D);
-		E = (b6 * loadSquared_kN + b7 * load_kN + b8) * (1.0 - b13 * sign(slipAsPercent + H));
-		H = b9 * load_kN + b10;
-		V = b11 * load_kN + b12;
-		Bx1 = B * (slipAsPercent + H);
+		if (PacejkaKernels::cpuSupportsAvx2())
+			return SimdLevel::AVX2;
 
-		mLongitudinalForce = D * sin(C * atan(Bx1 - E * (Bx1 - atan(Bx1)))) + V;
+		return SimdLevel::SCALAR;
 	}
 
-	void PacejkaMagicFormula::updateLateralForce(double load_kN, double slipAngle_degs, double camberAngle_degs)
-		/* Called by PacejkaMagicFormula::updateForces
+	void PacejkaMagicFormula::setSimdLevel(SimdLevel level)
+		/* Called by code choosing a code path for evaluate (e.g. tests, vds-run --simd)
+		 * Requests for an instruction set the CPU (or the build) lacks fall back to the best one available
 		*/
 	{
-		if (load_kN == 0.0 || abs(slipAngle_degs == 0.0)) {
-			mLateralForce = 0.0;
-			return;
-		}
+		const SimdLevel supported = getSupportedSimdLevel();
+		mSimdLevel = level > supported ? supported : level;
+	}
 
-		C = a0;
-		D = load_kN * (a1 * load_kN + a2) * (1.0 - a15 * pow(camberAngle_degs, 2.0));
-		BCD = a3 * sin(atan(load_kN / a4) * 2.0) * (1.0 - a5 * abs(camberAngle_degs));
-		B = BCD / (C * D);
-		E = (a6 * load_kN + a7) * (1.0 - (a16 * camberAngle_degs + a17) * sign(slipAngle_degs + H));
-		H = a8 * load_kN + a9 + a10 * camberAngle_degs;
-		V = a11 * load_kN + a12 + (a13 * load_kN + a14) * camberAngle_degs * load_kN;
-		Bx1 = B * (slipAngle_degs + H);
+	PacejkaMagicFormula::LoadTerms PacejkaMagicFormula::calcLoadTerms(const PacejkaParams& p, double load_kN)
+		/* Called by
+		 * - PacejkaMagicFormula::updateForces (when the load has moved)
+		 * - PacejkaMagicFormula::evaluate
+		 * - the calcLongitudinalForce/calcLateralForce overloads taking a load
+		*/
+	{
+		const double loadSquared_kN = pow(load_kN, 2.0);
+
+		LoadTerms terms;
+		terms.load_kN = load_kN;
+
+		//Longitudinal
+		const double BCD = (p.b0 * loadSquared_kN + p.b4 * load_kN) * exp(-p.b5 * load_kN);
+		terms.longitudinalD = load_kN * (p.b1 * load_kN + p.b2);
+		terms.longitudinalB = BCD / (p.b0 * terms.longitudinalD);
+		terms.longitudinalH = p.b9 * load_kN + p.b10;
+		terms.longitudinalE = p.b6 * loadSquared_kN + p.b7 * load_kN + p.b8;
+		terms.longitudinalV = p.b11 * load_kN + p.b12;
+
+		//Lateral
+		terms.lateralD = load_kN * (p.a1 * load_kN + p.a2);
+		terms.lateralBCD = p.a3 * sin(atan(load_kN / p.a4) * 2.0);
+		terms.lateralH = p.a8 * load_kN + p.a9;
+		terms.lateralE = p.a6 * load_kN + p.a7;
+		terms.lateralV = p.a11 * load_kN + p.a12;
+		terms.lateralCamberV = p.a13 * load_kN + p.a14;
+
+		return terms;
+	}
+
+	double PacejkaMagicFormula::calcLongitudinalForce(const PacejkaParams& p, const LoadTerms& terms, double slipAsPercent)
+		/* Called by
+		 * - PacejkaMagicFormula::updateForces
+		 * - PacejkaMagicFormula::evaluate
+		 * - TyreForceTable (building, and outside the table's range)
+		*/
+	{
+		if (terms.load_kN == 0.0 || slipAsPercent == 0.0)
+			return 0.0;
+
+		const double
+			C = p.b0,
+			D = terms.longitudinalD,
+			B = terms.longitudinalB,
+			H = terms.longitudinalH,
+			E = terms.longitudinalE * (1.0 - p.b13 * sign(slipAsPercent + H)),
+			V = terms.longitudinalV,
+			Bx1 = B * (slipAsPercent + H);
+
+		return D * sin(C * atan(Bx1 - E * (Bx1 - atan(Bx1)))) + V;
+	}
+
+	double PacejkaMagicFormula::calcLateralForce(const PacejkaParams& p, const LoadTerms& terms, double slipAngle_degs, double camberAngle_degs)
+		/* Called by
+		 * - PacejkaMagicFormula::updateForces
+		 * - PacejkaMagicFormula::evaluate
+		 * - TyreForceTable (building, and outside the table's range)
+		*/
+	{
+		if (terms.load_kN == 0.0 || slipAngle_degs == 0.0)
+			return 0.0;
+
+		const double
+			C = p.a0,
+			D = terms.lateralD * (1.0 - p.a15 * pow(camberAngle_degs, 2.0)),
+			BCD = terms.lateralBCD * (1.0 - p.a5 * std::abs(camberAngle_degs)),
+			B = BCD / (C * D),
+			H = terms.lateralH + p.a10 * camberAngle_degs,
+			E = terms.lateralE * (1.0 - (p.a16 * camberAngle_degs + p.a17) * sign(slipAngle_degs + H)),
+			V = terms.lateralV + terms.lateralCamberV * camberAngle_degs * terms.load_kN,
+			Bx1 = B * (slipAngle_degs + H);
+
+		return D * sin(C * atan(Bx1 - E * (Bx1 - atan(Bx1)))) + V;
+	}
 
-		mLateralForce = D * sin(C * atan(Bx1 - E * (Bx1 - atan(Bx1)))) + V;
+	namespace PacejkaKernels {
+		bool cpuSupportsAvx2()
+			/* Called by PacejkaMagicFormula::getSupportedSimdLevel
+			*/
+		{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#elif defined(_MSC_VER) && defined(_M_X64)
+			int info[4];
+			__cpuid(info, 1);
+			const bool fma = (info[2] & (1 << 12)) != 0, osxsave = (info[2] & (1 << 27)) != 0;
+			__cpuidex(info, 7, 0);
+			return fma && osxsave && (info[1] & (1 << 5)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+#else
+			return false;
+#endif
+		}
+
+		bool cpuSupportsAvx512()
+			/* Called by PacejkaMagicFormula::getSupportedSimdLevel
+			*/
+		{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx512f");
+#elif defined(_MSC_VER) && defined(_M_X64)
+			int info[4];
+			__cpuid(info, 1);
+			const bool osxsave = (info[2] & (1 << 27)) != 0;
+			__cpuidex(info, 7, 0);
+			return osxsave && (info[1] & (1 << 16)) != 0 && (_xgetbv(0) & 0xe6) == 0xe6;
+#else
+			return false;
+#endif
+		}
 	}
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,68 @@
+#include "PacejkaParams.h"
+
+namespace Internal {
+
+	std::atomic<unsigned int> PacejkaParams::mPublishedVersion(0);
+
+	PacejkaParams PacejkaParams::driftingTyre()
+		/* Called by
+		 * - UILayer::tyreParameters
+		 * - PacejkaParams::publishedSlot (the initial published set)
+		 * The member defaults are the drifting tyre
+		*/
+	{
+		return PacejkaParams();
+	}
+
+	PacejkaParams PacejkaParams::roadTyre()
+		/* Called by UILayer::tyreParameters
+		*/
+	{
+		PacejkaParams params;
+
+		//Longitudinal
+		params.b4 = 140.0f;
+		params.b5 = 0.67f;
+		params.b7 = 0.273f;
+		params.b9 = 0.698f;
+
+		//Lateral
+		params.a1 = 0.0f;
+		params.a3 = 2000.0f;
+		params.a4 = 18.5f;
+		params.a8 = 1.0f;
+
+		return params;
+	}
+
+	std::shared_ptr<const PacejkaParams> PacejkaParams::getPublished()
+		/* Called by
+		 * - PacejkaMagicFormula::updateParams
+		 * - VehicleBatch::updateTyreParams
+		 * - UILayer::tyreParameters
+		*/
+	{
+		return std::atomic_load(&publishedSlot());
+	}
+
+	void PacejkaParams::publish(const PacejkaParams& params)
+		/* Called by UILayer::tyreParameters (or any thread replacing the published set)
+		 * The new set is complete before it becomes visible, so readers never see a partly edited set
+		*/
+	{
+		std::atomic_store(&publishedSlot(), std::shared_ptr<const PacejkaParams>(std::make_shared<PacejkaParams>(params)));
+		mPublishedVersion.fetch_add(1, std::memory_order_release);
+	}
+
+	std::shared_ptr<const PacejkaParams>& PacejkaParams::publishedSlot()
+		/* Called by
+		 * - PacejkaParams::getPublished
+		 * - PacejkaParams::publish
+		 * A function-local static, so that tyres constructed during static initialisation still find a set
+		*/
+	{
+		static std::shared_ptr<const PacejkaParams> published = std::make_shared<PacejkaParams>(driftingTyre());
+		return published;
+	}
+
+}
@@ -0,0 +1,329 @@
+#include "ParameterSweep.h"
+#include "WorkStealingPool.h"
+#include "Car.h"
+
+#include <cmath>
+#include <random>
+#include <algorithm>
+
+namespace Internal {
+
+	namespace {
+		//Sobol direction number initialisation (Joe & Kuo, new-joe-kuo-6.21201) for dimensions 2 onwards; the first
+		//dimension is the van der Corput sequence
+		struct SobolPolynomial {
+			unsigned int
+				degree,
+				coefficients,
+				initialNumbers[5];
+		};
+
+		const SobolPolynomial sobolPolynomials[] = {
+			{ 1, 0, { 1 } },
+			{ 2, 1, { 1, 3 } },
+			{ 3, 1, { 1, 3, 1 } },
+			{ 3, 2, { 1, 1, 1 } },
+			{ 4, 1, { 1, 1, 3, 3 } },
+			{ 4, 4, { 1, 3, 5, 13 } },
+			{ 5, 2, { 1, 1, 5, 5, 17 } }
+		};
+
+		const unsigned int sobolBits = 32;
+	}
+
+	ParameterSweep::ParameterSweep()
+		/* Called by code running a study (e.g. vds-sweep)
+		 * Defaults are read from a stock Car; the tyre sets are the drifting and road tyres, on the default Environment
+		*/
+	{
+		Car car;
+		mEnvironment = car.getSharedEnvironment();
+		Framework::Physics::Spring& spring = car.getWheelSystem().getWheelInterface(0)->getSuspension().getSpring();
+
+		mDefaults.values[MASS] = car.getState().getMass().getValue();
+		mDefaults.values[SPRING_CONSTANT] = spring.getSpringConstant();
+		mDefaults.values[DAMPING] = spring.getDamping();
+		mDefaults.values[DRAG_COEFFICIENT] = car.getDragCoefficient();
+		mDefaults.values[FRONTAL_AREA] = car.getFrontalArea();
+		mDefaults.values[STEERING_RATIO] = car.getControlSystem().getSteeringRatio();
+		mDefaults.values[TYRE_SET] = 0.0;
+
+		mTyreSets = {
+			std::make_shared<const PacejkaParams>(PacejkaParams::driftingTyre()),
+			std::make_shared<const PacejkaParams>(PacejkaParams::roadTyre())
+		};
+	}
+
+	void ParameterSweep::vary(Parameter parameter, double min, double max)
+		/* Called by code setting up a study
+		 * For TYRE_SET, min and max are indices into the tyre sets
+		*/
+	{
+		for (Range& range : mRanges)
+			if (range.parameter == parameter) {
+				range.min = min;
+				range.max = max;
+				return;
+			}
+
+		mRanges.push_back({ parameter, min, max });
+	}
+
+	void ParameterSweep::setTyreSets(const std::vector<std::shared_ptr<const PacejkaParams>>& tyreSets)
+		/* Called by code setting up a study, before vary(TYRE_SET, ...)
+		*/
+	{
+		if (!tyreSets.empty())
+			mTyreSets = tyreSets;
+	}
+
+	std::vector<ParameterSweep::Sample> ParameterSweep::generate(Sampling sampling, size_t runs, unsigned int gridLevels, uint64_t seed) const
+		/* Called by code setting up a study
+		 * A grid has gridLevels^(varied parameters) samples, whatever runs is
+		*/
+	{
+		const unsigned int dimensions = (unsigned int)mRanges.size();
+		const std::vector<double> unitSamples = generateUnitSamples(sampling, dimensions, runs, gridLevels, seed);
+		const size_t count = dimensions ? unitSamples.size() / dimensions : std::min<size_t>(runs, 1);
+
+		std::vector<Sample> samples(count, mDefaults);
+
+		for (size_t i = 0; i < count; i++)
+			for (unsigned int d = 0; d < dimensions; d++) {
+				const Range& range = mRanges[d];
+				const double u = unitSamples[i * dimensions + d];
+
+				if (range.parameter == TYRE_SET) {
+					//Equal shares of the unit interval for each index from min to max (inclusive)
+					const double
+						first = std::max(std::round(range.min), 0.0),
+						last = std::min(std::round(range.max), (double)mTyreSets.size() - 1.0);
+
+					samples[i].values[TYRE_SET] = std::min(first + std::floor(u * (last - first + 1.0)), last);
+				}
+				else
+					samples[i].values[range.parameter] = range.min + u * (range.max - range.min);
+			}
+
+		return samples;
+	}
+
+	std::vector<ParameterSweep::Result> ParameterSweep::run(const std::vector<Sample>& samples, const Scenario& scenario, WorkStealingPool& pool) const
+		/* Called by code running a study
+		 * Results are in sample order
+		*/
+	{
+		std::vector<Result> results(samples.size());
+
+		pool.run(samples.size(), [&](size_t run, unsigned int) {
+			results[run] = runOne(run, samples[run], scenario);
+		});
+
+		return results;
+	}
+
+	ParameterSweep::Result ParameterSweep::runOne(size_t run, const Sample& sample, const Scenario& scenario) const
+		/* Called by ParameterSweep::run, on any worker thread
+		*/
+	{
+		Car car(mEnvironment);
+		car.setMass(sample.values[MASS]);
+		car.setSuspension(sample.values[SPRING_CONSTANT], sample.values[DAMPING]);
+		car.setDrag(sample.values[DRAG_COEFFICIENT], sample.values[FRONTAL_AREA]);
+		car.getControlSystem().setSteeringRatio(sample.values[STEERING_RATIO]);
+		car.setTyreParams(mTyreSets[std::min((size_t)sample.values[TYRE_SET], mTyreSets.size() - 1)]);
+
+		car.getTorqueGenerator().setThrottle(scenario.throttle);
+		car.getControlSystem().setSteeringWheelAngle(scenario.steeringWheelAngle);
+
+		Result result;
+		result.run = run;
+		result.sample = sample;
+
+		const unsigned long long steps = (unsigned long long)std::ceil(scenario.duration / scenario.updateDelta);
+		Framework::Physics::State& state = car.getState();
+		glm::dvec3 previousPosition = state.getPosition_world();
+
+		for (unsigned long long step = 0; step < steps; step++) {
+			car.update(step * scenario.updateDelta, scenario.updateDelta);
+
+			const glm::dvec3
+				position = state.getPosition_world(),
+				acceleration_car = glm::dvec3(state.getWorldToLocal_direction() * glm::dvec4(car.getAcceleration_world(), 0.0));
+
+			result.distanceTravelled += glm::length(glm::dvec2(position.x - previousPosition.x, position.z - previousPosition.z));
+			result.maxSpeed = std::max(result.maxSpeed, glm::length(state.getVelocity_world()));
+			result.maxLateralAcceleration = std::max(result.maxLateralAcceleration, std::abs(acceleration_car.x));
+			for (unsigned char wheel = 0; wheel < 2; wheel++)   //Front left and right
+				result.maxWheelAngle = std::max(result.maxWheelAngle, std::abs(car.getWheelSystem().getWheelInterface(wheel)->getWheel().getSteeringAngle()));
+			previousPosition = position;
+		}
+
+		result.finalSpeed = glm::length(state.getVelocity_world());
+		result.finalX = previousPosition.x;
+		result.finalZ = previousPosition.z;
+		result.rolledOver = glm::dvec3(state.getLocalToWorld_direction() * glm::dvec4(0.0, 1.0, 0.0, 0.0)).y < 0.0;
+
+		return result;
+	}
+
+	std::vector<double> ParameterSweep::generateUnitSamples(Sampling sampling, unsigned int dimensions, size_t runs, unsigned int gridLevels, uint64_t seed)
+		/* Called by ParameterSweep::generate
+		 * Returns points in [0, 1]^dimensions, dimensions values per point
+		*/
+	{
+		std::vector<double> unitSamples;
+
+		if (dimensions == 0)
+			return unitSamples;
+
+		switch (sampling) {
+		case Sampling::GRID: generateGrid(dimensions, std::max(gridLevels, 1u), unitSamples); break;
+		case Sampling::LATIN_HYPERCUBE: generateLatinHypercube(dimensions, runs, seed, unitSamples); break;
+		case Sampling::SOBOL: generateSobol(dimensions, runs, unitSamples); break;
+		}
+
+		return unitSamples;
+	}
+
+	void ParameterSweep::generateGrid(unsigned int dimensions, unsigned int levels, std::vector<double>& unitSamples)
+		/* Called by ParameterSweep::generateUnitSamples
+		 * Full factorial, including both ends of every range (a single level sits at the middle)
+		*/
+	{
+		size_t count = 1;
+		for (unsigned int d = 0; d < dimensions; d++)
+			count *= levels;
+
+		unitSamples.resize(count * dimensions);
+
+		for (size_t i = 0; i < count; i++) {
+			size_t remainder = i;
+
+			for (unsigned int d = 0; d < dimensions; d++) {
+				const size_t level = remainder % levels;
+				remainder /= levels;
+
+				unitSamples[i * dimensions + d] = levels > 1 ? (double)level / (levels - 1) : 0.5;
+			}
+		}
+	}
+
+	void ParameterSweep::generateLatinHypercube(unsigned int dimensions, size_t runs, uint64_t seed, std::vector<double>& unitSamples)
+		/* Called by ParameterSweep::generateUnitSamples
+		 * Each dimension is split into runs equal strata, and every stratum of every dimension holds exactly one sample
+		*/
+	{
+		std::mt19937_64 random(seed);
+		std::uniform_real_distribution<double> withinStratum(0.0, 1.0);
+		std::vector<size_t> strata(runs);
+
+		unitSamples.resize(runs * dimensions);
+
+		for (unsigned int d = 0; d < dimensions; d++) {
+			for (size_t i = 0; i < runs; i++)
+				strata[i] = i;
+
+			std::shuffle(strata.begin(), strata.end(), random);
+
+			for (size_t i = 0; i < runs; i++)
+				unitSamples[i * dimensions + d] = (strata[i] + withinStratum(random)) / runs;
+		}
+	}
+
+	void ParameterSweep::generateSobol(unsigned int dimensions, size_t runs, std::vector<double>& unitSamples)
+		/* Called by ParameterSweep::generateUnitSamples
+		 * Gray-code construction, starting from the origin. Any first 2^k points put exactly one point in each of the
+		 * 2^k equal intervals of every dimension, so power-of-two run counts are the most even
+		*/
+	{
+		dimensions = std::min<unsigned int>(dimensions, 1 + sizeof(sobolPolynomials) / sizeof(sobolPolynomials[0]));
+
+		std::vector<uint32_t> directions(dimensions * sobolBits);
+
+		for (unsigned int k = 0; k < sobolBits; k++)
+			directions[k] = 1u << (sobolBits - 1 - k);
+
+		for (unsigned int d = 1; d < dimensions; d++) {
+			const SobolPolynomial& polynomial = sobolPolynomials[d - 1];
+			uint32_t* v = &directions[d * sobolBits];
+			const unsigned int s = polynomial.degree;
+
+			for (unsigned int k = 0; k < sobolBits; k++) {
+				if (k < s) {
+					v[k] = polynomial.initialNumbers[k] << (sobolBits - 1 - k);
+					continue;
+				}
+
+				v[k] = v[k - s] ^ (v[k - s] >> s);
+
+				for (unsigned int j = 1; j < s; j++)
+					if ((polynomial.coefficients >> (s - 1 - j)) & 1)
+						v[k] ^= v[k - j];
+			}
+		}
+
+		unitSamples.resize(runs * dimensions);
+		std::vector<uint32_t> x(dimensions, 0);
+
+		for (size_t i = 0; i < runs; i++) {
+			if (i > 0) {
+				//Index of the lowest zero bit of i - 1
+				unsigned int c = 0;
+				for (size_t value = i - 1; value & 1; value >>= 1)
+					c++;
+
+				for (unsigned int d = 0; d < dimensions; d++)
+					x[d] ^= directions[d * sobolBits + c];
+			}
+
+			for (unsigned int d = 0; d < dimensions; d++)
+				unitSamples[i * dimensions + d] = x[d] / 4294967296.0;
+		}
+	}
+
+	const char* ParameterSweep::getParameterName(Parameter parameter)
+		/* Called by
+		 * - ParameterSweep::writeCsvHeader
+		 * - vds-sweep
+		*/
+	{
+		switch (parameter) {
+		case MASS: return "mass";
+		case SPRING_CONSTANT: return "spring";
+		case DAMPING: return "damping";
+		case DRAG_COEFFICIENT: return "cd";
+		case FRONTAL_AREA: return "area";
+		case STEERING_RATIO: return "steering-ratio";
+		case TYRE_SET: return "tyre-set";
+		default: return "";
+		}
+	}
+
+	void ParameterSweep::writeCsvHeader(FILE* file)
+		/* Called by code writing results (e.g. vds-sweep)
+		*/
+	{
+		fprintf(file, "run");
+
+		for (unsigned char p = 0; p < PARAMETER_COUNT; p++)
+			fprintf(file, ",%s", getParameterName((Parameter)p));
+
+		fprintf(file, ",distance_m,max_speed_mps,final_speed_mps,max_lateral_accel_mps2,max_wheel_angle_degs,final_x_m,final_z_m,rolled_over\n");
+	}
+
+	void ParameterSweep::writeCsvRow(FILE* file, const Result& result)
+		/* Called by code writing results (e.g. vds-sweep)
+		 * Parameters are written with enough digits to reproduce the run exactly
+		*/
+	{
+		fprintf(file, "%zu", result.run);
+
+		for (unsigned char p = 0; p < PARAMETER_COUNT; p++)
+			fprintf(file, ",%.17g", result.sample.values[p]);
+
+		fprintf(file, ",%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%d\n", result.distanceTravelled, result.maxSpeed, result.finalSpeed,
+			result.maxLateralAcceleration, result.maxWheelAngle, result.finalX, result.finalZ, result.rolledOver ? 1 : 0);
+	}
+
+}
@@ -0,0 +1,229 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Internal {
+
+	//Written only by its own thread, as a ring of a power of 2 Events. Event i is written to slot i & mMask: mStarted is
+	//moved on to i + 1 before the slot is written, and mCount after, with release ordering. A reader that loads mCount with
+	//acquire ordering sees every Event before it; one that loads mStarted after copying the slots (behind an acquire
+	//fence) learns which of them may have been overwritten while it copied
+	struct Profiler::ThreadBuffer {
+		struct Slot {
+			std::atomic<const char*> name;
+			std::atomic<int64_t>
+				begin,
+				end;
+		};
+
+		std::vector<Slot> mSlots;
+		size_t mMask;
+		std::atomic<size_t>
+			mStarted,
+			mCount;             //Events recorded since the last clear, including those since overwritten
+		unsigned int mThreadIndex;
+
+		ThreadBuffer(size_t capacity, unsigned int threadIndex) : mSlots(capacity), mMask(capacity - 1), mStarted(0), mCount(0), mThreadIndex(threadIndex) { }
+
+		inline size_t getCapacity() const { return mSlots.size(); }
+	};
+
+	//Every ThreadBuffer ever created, in order of each thread's first Event
+	struct Profiler::Registry {
+		std::mutex mMutex;
+		std::vector<std::unique_ptr<ThreadBuffer>> mBuffers;
+	};
+
+	namespace {
+		const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+		size_t calcCapacity(size_t events) {
+			size_t capacity = 1;
+			while (capacity < events)
+				capacity <<= 1;
+
+			return capacity;
+		}
+
+		void writeJsonString(FILE* file, const char* string) {
+			fputc('"', file);
+			for (const char* c = string; *c; c++) {
+				if (*c == '"' || *c == '\\')
+					fputc('\\', file);
+				fputc(*c, file);
+			}
+			fputc('"', file);
+		}
+	}
+
+	std::atomic<bool> Profiler::mEnabled(true);
+	std::atomic<size_t> Profiler::mThreadCapacity(1 << 18);
+
+	Profiler::Registry& Profiler::getRegistry()
+		/* Called by all Profiler functions that touch more than the calling thread's own buffer
+		*/
+	{
+		static Registry registry;
+		return registry;
+	}
+
+	Profiler::ThreadBuffer& Profiler::getThreadBuffer()
+		/* Called by Profiler::record
+		 * Creates and registers the calling thread's buffer on its first Event; the only time recording takes a lock. Its
+		 * capacity is the thread capacity rounded up to a power of 2
+		*/
+	{
+		thread_local ThreadBuffer* buffer = nullptr;
+
+		if (!buffer) {
+			Registry& registry = getRegistry();
+			std::lock_guard<std::mutex> lock(registry.mMutex);
+
+			registry.mBuffers.push_back(std::make_unique<ThreadBuffer>(calcCapacity(mThreadCapacity.load(std::memory_order_relaxed)), (unsigned int)registry.mBuffers.size()));
+			buffer = registry.mBuffers.back().get();
+		}
+
+		return *buffer;
+	}
+
+	void Profiler::record(const char* name, int64_t begin, int64_t end)
+		/* Called by Profiler::Scope::~Scope
+		 * Once the buffer is full, overwrites its oldest Event
+		*/
+	{
+		ThreadBuffer& buffer = getThreadBuffer();
+		const size_t count = buffer.mCount.load(std::memory_order_relaxed);
+
+		buffer.mStarted.store(count + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		ThreadBuffer::Slot& slot = buffer.mSlots[count & buffer.mMask];
+		slot.name.store(name, std::memory_order_relaxed);
+		slot.begin.store(begin, std::memory_order_relaxed);
+		slot.end.store(end, std::memory_order_relaxed);
+
+		buffer.mCount.store(count + 1, std::memory_order_release);
+	}
+
+	int64_t Profiler::now()
+		/* Called by Profiler::Scope
+		 * Nanoseconds since the program started
+		*/
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+	}
+
+	bool Profiler::writeChromeTrace(const char* path)
+		/* Called by code owning the run (e.g. vds-run, VehicleSimulation::~VehicleSimulation)
+		 * Writes the Events each buffer holds, oldest first, as complete ("X") events in the Trace Event Format, one track
+		 * per thread. Safe to call while other threads are still recording: Events they record meanwhile may or may not be
+		 * included, and any they overwrite while their buffer is copied are left out
+		*/
+	{
+		FILE* file = fopen(path, "w");
+		if (!file)
+			return false;
+
+		Registry& registry = getRegistry();
+		std::lock_guard<std::mutex> lock(registry.mMutex);
+
+		fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+		bool first = true;
+		std::vector<Event> events;
+
+		for (const std::unique_ptr<ThreadBuffer>& buffer : registry.mBuffers) {
+			const unsigned int tid = buffer->mThreadIndex + 1;
+			const size_t
+				capacity = buffer->getCapacity(),
+				count = buffer->mCount.load(std::memory_order_acquire),
+				oldest = count > capacity ? count - capacity : 0;
+
+			events.resize(count - oldest);
+			for (size_t i = oldest; i < count; i++) {
+				const ThreadBuffer::Slot& slot = buffer->mSlots[i & buffer->mMask];
+				events[i - oldest] = { slot.name.load(std::memory_order_relaxed), slot.begin.load(std::memory_order_relaxed), slot.end.load(std::memory_order_relaxed) };
+			}
+
+			//Events the thread started overwriting while they were copied
+			std::atomic_thread_fence(std::memory_order_acquire);
+			const size_t
+				started = buffer->mStarted.load(std::memory_order_relaxed),
+				firstIntact = std::max(oldest, started > capacity ? started - capacity : 0);
+
+			fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}",
+				first ? "" : ",\n", tid, buffer->mThreadIndex);
+			first = false;
+
+			for (size_t i = std::min(firstIntact, count) - oldest; i < events.size(); i++) {
+				const Event& event = events[i];
+
+				fprintf(file, ",\n{\"name\":");
+				writeJsonString(file, event.name);
+				fprintf(file, ",\"cat\":\"vds\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+					event.begin * 1e-3, (event.end - event.begin) * 1e-3, tid);
+			}
+		}
+
+		fprintf(file, "\n]}\n");
+		return fclose(file) == 0;
+	}
+
+	void Profiler::clear()
+		/* Called by code owning the run, between runs
+		 * Discards all recorded Events. Only call while no other thread is recording
+		*/
+	{
+		Registry& registry = getRegistry();
+		std::lock_guard<std::mutex> lock(registry.mMutex);
+
+		for (const std::unique_ptr<ThreadBuffer>& buffer : registry.mBuffers) {
+			buffer->mStarted.store(0, std::memory_order_relaxed);
+			buffer->mCount.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	void Profiler::setThreadCapacity(size_t events)
+		/* Called by code owning the run
+		 * Only applies to threads that have not yet recorded an Event. Rounded up to a power of 2
+		*/
+	{
+		mThreadCapacity.store(events, std::memory_order_relaxed);
+	}
+
+	size_t Profiler::getEventCount()
+		/* Called by code reporting on the run (e.g. vds-run)
+		 * The Events the buffers hold, which writeChromeTrace would write
+		*/
+	{
+		Registry& registry = getRegistry();
+		std::lock_guard<std::mutex> lock(registry.mMutex);
+
+		size_t total = 0;
+		for (const std::unique_ptr<ThreadBuffer>& buffer : registry.mBuffers)
+			total += std::min(buffer->mCount.load(std::memory_order_acquire), buffer->getCapacity());
+
+		return total;
+	}
+
+	size_t Profiler::getWrappedCount()
+		/* Called by code reporting on the run (e.g. vds-run)
+		 * The Events overwritten by newer ones since the last clear
+		*/
+	{
+		Registry& registry = getRegistry();
+		std::lock_guard<std::mutex> lock(registry.mMutex);
+
+		size_t total = 0;
+		for (const std::unique_ptr<ThreadBuffer>& buffer : registry.mBuffers) {
+			const size_t count = buffer->mCount.load(std::memory_order_acquire);
+			total += count > buffer->getCapacity() ? count - buffer->getCapacity() : 0;
+		}
+
+		return total;
+	}
+}
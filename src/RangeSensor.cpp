@@ -0,0 +1,206 @@
+#include "RangeSensor.h"
+#include "Car.h"
+#include "Profiler.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <glm/glm/vec4.hpp>
+#include <glm/glm/mat3x3.hpp>
+#include <glm/glm/gtc/matrix_transform.hpp>
+
+namespace Internal {
+
+	RangeSensor::RangeSensor() :
+		/* Called by code simulating perception with the default sensor
+		*/
+		RangeSensor(Settings())
+	{ }
+
+	RangeSensor::RangeSensor(const Settings& settings) :
+		/* Called by
+		 * - RangeSensor::RangeSensor
+		 * - code simulating perception (e.g. vds-run --lidar)
+		 * Works out every ray's direction in the sensor's space once, as they never change
+		*/
+		mSettings(settings),
+		mColumns(std::min(std::max(settings.columns, 1u), 65536u)),
+		mRings(std::min(std::max(settings.rings, 1u), 256u)),
+		mPool(settings.threads)
+	{
+		//A full circle has no seam, so its last column stops one step short of the first
+		const double
+			columnStep = glm::radians(mSettings.horizontalFieldOfView) / (mSettings.horizontalFieldOfView >= 360.0 ? mColumns : std::max(mColumns - 1, 1u)),
+			firstAzimuth = mSettings.horizontalFieldOfView >= 360.0 ? 0.0 : -0.5 * glm::radians(mSettings.horizontalFieldOfView),
+			ringStep = mRings > 1 ? glm::radians(mSettings.highestElevation - mSettings.lowestElevation) / (mRings - 1) : 0.0;
+
+		mDirections_sensor.resize((size_t)mColumns * mRings);
+
+		for (unsigned int column = 0; column < mColumns; column++)
+			for (unsigned int ring = 0; ring < mRings; ring++) {
+				const double
+					azimuth = firstAzimuth + column * columnStep,       //Clockwise from forward, seen from above
+					elevation = glm::radians(mSettings.lowestElevation) + ring * ringStep;
+
+				mDirections_sensor[(size_t)column * mRings + ring] = glm::dvec3(sin(azimuth) * cos(elevation), sin(elevation), -cos(azimuth) * cos(elevation));
+			}
+	}
+
+	RangeSensor::~RangeSensor()
+		/* Called when the sensor is destroyed
+		 * Waits for any scan still running, and stops the scan thread
+		*/
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mStopping = true;
+		}
+
+		mWake.notify_all();
+		if (mScanThread.joinable())
+			mScanThread.join();
+	}
+
+	void RangeSensor::scan(const Car& car, double t, PointCloud& cloud)
+		/* Called by code that wants the cloud before going on (e.g. tests)
+		*/
+	{
+		cloud.time = t;
+		cloud.sensorToWorld = calcSensorToWorld(car);
+		castRays(car.getEnvironment().getTerrain(), cloud);
+	}
+
+	bool RangeSensor::startScan(const Car& car, double t)
+		/* Called by code simulating perception alongside Car::update (e.g. vds-run --lidar), each sensor frame
+		 * Returns false, and drops the scan, if the last one has not finished yet. The environment is kept alive until
+		 * the scan is done with it
+		*/
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			if (mRequested || mBusy)
+				return false;
+
+			mRequest = { t, calcSensorToWorld(car), car.getSharedEnvironment() };
+			mRequested = true;
+
+			if (!mScanThread.joinable())
+				mScanThread = std::thread(&RangeSensor::runScanThread, this);
+		}
+
+		mWake.notify_all();
+		return true;
+	}
+
+	bool RangeSensor::takeScan(PointCloud& cloud)
+		/* Called by code that started scans (startScan)
+		 * Swaps the latest finished cloud into cloud, if there is one not already taken. The cloud's old buffers are
+		 * reused by a later scan
+		*/
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		if (!mFinishedReady)
+			return false;
+
+		std::swap(cloud, mFinished);
+		mFinishedReady = false;
+		return true;
+	}
+
+	void RangeSensor::waitForScan()
+		/* Called by code that started a scan (startScan) and needs it now
+		*/
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mWake.wait(lock, [this]() { return !mRequested && !mBusy; });
+	}
+
+	glm::dmat4 RangeSensor::calcSensorToWorld(const Car& car) const
+		/* Called by
+		 * - RangeSensor::scan
+		 * - RangeSensor::startScan
+		*/
+	{
+		return car.getState().getLocalToWorld_position() * glm::translate(glm::dmat4(1.0), mSettings.position_car) * glm::mat4_cast(mSettings.orientation_car);
+	}
+
+	void RangeSensor::castRays(const External::Terrain& terrain, PointCloud& cloud)
+		/* Called by
+		 * - RangeSensor::scan
+		 * - RangeSensor::runScanThread
+		 * Each column is a task, writing its hits to the front of its own slice of cloud.points. The slices are then
+		 * packed together in column order, so the cloud is the same however the columns were shared out
+		*/
+	{
+		VDS_PROFILE_SCOPE("RangeSensor::castRays");
+
+		const size_t
+			columns = mColumns,
+			rings = mRings;
+
+		const glm::dvec3 origin_world = glm::dvec3(cloud.sensorToWorld * glm::dvec4(0.0, 0.0, 0.0, 1.0));
+		const glm::dmat3 sensorToWorld_direction = glm::dmat3(cloud.sensorToWorld);
+
+		std::vector<size_t> hitCounts(columns);
+		cloud.rayCount = mDirections_sensor.size();
+		cloud.points.resize(mDirections_sensor.size());
+
+		mPool.run(columns, [&](size_t column, unsigned int) {
+			Point* points = &cloud.points[column * rings];
+			size_t hitCount = 0;
+			External::Terrain::RayHit hit;
+
+			for (size_t ring = 0; ring < rings; ring++) {
+				const glm::dvec3& direction_sensor = mDirections_sensor[column * rings + ring];
+
+				if (!terrain.raycast(origin_world, sensorToWorld_direction * direction_sensor, mSettings.maxRange, hit))
+					continue;
+
+				const glm::dvec3 position_sensor = direction_sensor * hit.distance;
+				points[hitCount++] = { { (float)position_sensor.x, (float)position_sensor.y, (float)position_sensor.z }, (uint16_t)column, (uint8_t)ring, hit.surfaceType };
+			}
+
+			hitCounts[column] = hitCount;
+		});
+
+		size_t packed = 0;
+		for (size_t column = 0; column < columns; column++) {
+			memmove(&cloud.points[packed], &cloud.points[column * rings], hitCounts[column] * sizeof(Point));
+			packed += hitCounts[column];
+		}
+
+		cloud.points.resize(packed);
+	}
+
+	void RangeSensor::runScanThread()
+		/* Called by RangeSensor::startScan, as the body of mScanThread
+		*/
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		while (true) {
+			mWake.wait(lock, [this]() { return mStopping || mRequested; });
+			if (mStopping)
+				return;
+
+			Request request = std::move(mRequest);
+			mRequest.environment.reset();
+			mRequested = false;
+			mBusy = true;
+			lock.unlock();
+
+			mScanning.time = request.time;
+			mScanning.sensorToWorld = request.sensorToWorld;
+			castRays(request.environment->getTerrain(), mScanning);
+			request.environment.reset();
+
+			lock.lock();
+			std::swap(mScanning, mFinished);
+			mFinishedReady = true;
+			mBusy = false;
+			mWake.notify_all();
+		}
+	}
+}
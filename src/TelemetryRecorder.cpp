@@ -0,0 +1,394 @@
+#include "TelemetryRecorder.h"
+#include "Car.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+namespace Internal {
+
+	namespace {
+		const char FILE_MAGIC[8] = { 'V', 'D', 'S', 'T', 'E', 'L', 'E', 'M' };
+		const uint32_t FILE_BYTE_ORDER = 0x01020304;
+		const size_t PAGE_BYTES = 4096;
+
+		inline size_t roundUp(size_t bytes, size_t multiple) { return (bytes + multiple - 1) / multiple * multiple; }
+
+		size_t calcRingCapacity(size_t requested) {
+			size_t capacity = 1;
+			while (capacity < requested)
+				capacity <<= 1;
+
+			return capacity;
+		}
+	}
+
+	TelemetryRecorder::TelemetryRecorder() :
+		/* Called by code recording a car with the default settings
+		*/
+		TelemetryRecorder(Settings())
+	{ }
+
+	TelemetryRecorder::TelemetryRecorder(const Settings& settings) :
+		/* Called by
+		 * - TelemetryRecorder::TelemetryRecorder
+		 * - code recording a car (e.g. vds-run --telemetry)
+		 * The ring is allocated here, so nothing is allocated once recording
+		*/
+		mSettings(settings),
+		mRingMask(calcRingCapacity(std::max(settings.ringCapacity, (size_t)2)) - 1),
+		mRing(mRingMask + 1),
+		mHead(0),
+		mTail(0),
+		mDroppedCount(0)
+	{ }
+
+	TelemetryRecorder::~TelemetryRecorder()
+		/* Called when the recorder's owner is destroyed
+		*/
+	{
+		close();
+	}
+
+	bool TelemetryRecorder::open(const std::string& path)
+		/* Called by code recording a car, before the first step
+		 * Starts a new log at path, replacing any file there and closing any log already being recorded, and starts the
+		 * writer thread
+		*/
+	{
+		close();
+
+		//Car state, then each wheel's quantities, in the order of Sample
+		struct ColumnSource {
+			const char
+				*name,
+				*unit;
+			ColumnType type;
+			size_t sampleOffset;
+		};
+
+		std::vector<ColumnSource> sources = { { "time", "s", ColumnType::FLOAT64, offsetof(Sample, time) } };
+
+		const char* const axes[4] = { "x", "y", "z", "w" };
+		const struct { const char* name; const char* unit; size_t offset; unsigned int count; } vectors[] = {
+			{ "position_world", "m", offsetof(Sample, position_world), 3 },
+			{ "velocity_world", "m/s", offsetof(Sample, velocity_world), 3 },
+			{ "orientation_world", "", offsetof(Sample, orientation_world), 4 },
+			{ "angularVelocity_world", "rads/s", offsetof(Sample, angularVelocity_world), 3 },
+			{ "acceleration_world", "m/s^2", offsetof(Sample, acceleration_world), 3 }
+		};
+
+		std::vector<std::string> names;
+		names.reserve(64);
+
+		for (const auto& vector : vectors)
+			for (unsigned int i = 0; i < vector.count; i++) {
+				//The orientation is stored w first
+				const char* axis = vector.count == 4 ? axes[(i + 3) % 4] : axes[i];
+				names.push_back(std::string(vector.name) + "." + axis);
+				sources.push_back({ nullptr, vector.unit, ColumnType::FLOAT64, vector.offset + i * sizeof(double) });
+			}
+
+		sources.push_back({ "steeringWheelAngle", "degs", ColumnType::FLOAT64, offsetof(Sample, steeringWheelAngle) });
+		sources.push_back({ "throttle", "", ColumnType::FLOAT64, offsetof(Sample, throttle) });
+
+		const char* const wheelNames[WHEELS] = { "fl", "fr", "rl", "rr" };
+		const struct { const char* name; const char* unit; size_t offset; } wheelQuantities[] = {
+			{ "load", "N", offsetof(WheelSample, load) },
+			{ "slipRatio", "", offsetof(WheelSample, slipRatio) },
+			{ "slipAngle", "degs", offsetof(WheelSample, slipAngle) },
+			{ "lateralForce", "N", offsetof(WheelSample, lateralForce) },
+			{ "longitudinalForce", "N", offsetof(WheelSample, longitudinalForce) },
+			{ "suspensionLength", "m", offsetof(WheelSample, suspensionLength) },
+			{ "angularVelocity", "rads/s", offsetof(WheelSample, angularVelocity) },
+			{ "steeringAngle", "degs", offsetof(WheelSample, steeringAngle) }
+		};
+
+		for (unsigned int wheel = 0; wheel < WHEELS; wheel++)
+			for (const auto& quantity : wheelQuantities) {
+				names.push_back(std::string("wheel.") + wheelNames[wheel] + "." + quantity.name);
+				sources.push_back({ nullptr, quantity.unit, ColumnType::FLOAT32, offsetof(Sample, wheels) + wheel * sizeof(WheelSample) + quantity.offset });
+			}
+
+		//Each column's values for a block together, 8-byte aligned
+		const size_t blockRecords = std::max(mSettings.blockRecords, (size_t)1);
+		size_t blockOffset = 0, named = 0;
+
+		mColumns.assign(sources.size(), ColumnHeader());
+		mSampleOffsets.resize(sources.size());
+
+		for (size_t c = 0; c < sources.size(); c++) {
+			ColumnHeader& column = mColumns[c];
+			memset(&column, 0, sizeof(column));
+
+			strncpy(column.name, sources[c].name ? sources[c].name : names[named++].c_str(), sizeof(column.name) - 1);
+			strncpy(column.unit, sources[c].unit, sizeof(column.unit) - 1);
+			column.type = sources[c].type;
+			column.elementBytes = sources[c].type == ColumnType::FLOAT64 ? 8 : 4;
+			column.blockOffset = blockOffset;
+
+			mSampleOffsets[c] = sources[c].sampleOffset;
+			blockOffset = roundUp(blockOffset + column.elementBytes * blockRecords, 8);
+		}
+
+		mBlockBytes = roundUp(blockOffset, PAGE_BYTES);
+		mDataOffset = roundUp(sizeof(FileHeader) + mColumns.size() * sizeof(ColumnHeader), PAGE_BYTES);
+
+		if (!mFile.openReadWrite(path, mDataOffset + mBlockBytes))
+			return false;
+
+		mMappedBlocks = 1;
+		mRecordCount = 0;
+		mWriteFailed = false;
+		mHead.store(0, std::memory_order_relaxed);
+		mTail.store(0, std::memory_order_relaxed);
+		mDroppedCount.store(0, std::memory_order_relaxed);
+
+		memcpy(static_cast<char*>(mFile.getWritableData()) + sizeof(FileHeader), mColumns.data(), mColumns.size() * sizeof(ColumnHeader));
+		writeHeader();
+
+		mStopping = false;
+		mWriterThread = std::thread(&TelemetryRecorder::runWriterThread, this);
+		return true;
+	}
+
+	bool TelemetryRecorder::close()
+		/* Called by
+		 * - TelemetryRecorder::~TelemetryRecorder
+		 * - TelemetryRecorder::open
+		 * - code recording a car, once the run is over
+		 * Waits for the writer thread to write every sample still in the ring. Fails if any of the log could not be
+		 * written
+		*/
+	{
+		if (!mWriterThread.joinable())
+			return true;
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mStopping = true;
+		}
+
+		mWake.notify_one();
+		mWriterThread.join();
+
+		//Trimmed to the blocks written, as the log grows by more than it needs
+		const size_t
+			blockRecords = std::max(mSettings.blockRecords, (size_t)1),
+			blocks = std::max((size_t)1, (size_t)((mRecordCount + blockRecords - 1) / blockRecords));
+
+		if (!mWriteFailed && blocks < mMappedBlocks)
+			mWriteFailed = !mFile.resize(mDataOffset + blocks * mBlockBytes);
+
+		const bool written = !mWriteFailed;
+		mFile.close();
+		return written;
+	}
+
+	bool TelemetryRecorder::record(const Car& car, double t)
+		/* Called by code recording a car, after each Car::update
+		 * Fails (dropping the sample) if the ring is full, or if no log is open
+		*/
+	{
+		Sample* sample = claim();
+		if (!sample)
+			return false;
+
+		capture(car, t, *sample);
+		mHead.store(mHead.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool TelemetryRecorder::record(const Sample& sample)
+		/* Called by code recording a car simulated some other way (e.g. a vehicle of a VehicleBatch), after each step
+		*/
+	{
+		Sample* claimed = claim();
+		if (!claimed)
+			return false;
+
+		*claimed = sample;
+		mHead.store(mHead.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		return true;
+	}
+
+	void TelemetryRecorder::capture(const Car& car, double t, Sample& sample)
+		/* Called by
+		 * - TelemetryRecorder::record
+		 * - code taking a sample to record later, or elsewhere
+		 * Wheels are taken in the WheelSystem's order: front left, front right, rear left, rear right
+		*/
+	{
+		const Framework::Physics::State& state = car.getState();
+		const glm::dvec3
+			position_world = state.getPosition_world(),
+			velocity_world = state.getVelocity_world(),
+			angularVelocity_world = state.getAngularVelocity_world(),
+			acceleration_world = car.getAcceleration_world();
+		const glm::dquat orientation_world = state.getOrientation_world();
+
+		sample.time = t;
+		for (unsigned int i = 0; i < 3; i++) {
+			sample.position_world[i] = position_world[i];
+			sample.velocity_world[i] = velocity_world[i];
+			sample.angularVelocity_world[i] = angularVelocity_world[i];
+			sample.acceleration_world[i] = acceleration_world[i];
+		}
+
+		sample.orientation_world[0] = orientation_world.w;
+		sample.orientation_world[1] = orientation_world.x;
+		sample.orientation_world[2] = orientation_world.y;
+		sample.orientation_world[3] = orientation_world.z;
+
+		sample.steeringWheelAngle = car.getControlSystem().getSteeringWheelAngle();
+		sample.throttle = car.getTorqueGenerator().getThrottle();
+
+		const std::vector<WheelInterface>& wheelInterfaces = car.getWheelSystem().getAllWheelInterfaces();
+		for (unsigned int wheel = 0; wheel < WHEELS; wheel++) {
+			WheelSample& wheelSample = sample.wheels[wheel];
+
+			if (wheel >= wheelInterfaces.size()) {
+				wheelSample = WheelSample();
+				continue;
+			}
+
+			const WheelInterface& wheelInterface = wheelInterfaces[wheel];
+			const Wheel& w = wheelInterface.getWheel();
+			const Slip slip = w.getTyre().getSlip();
+			const glm::dvec2 force_wheel = w.getTyre().getTotalForce_wheel();
+
+			wheelSample.load = (float)wheelInterface.getLoad();
+			wheelSample.slipRatio = (float)slip.getLongitudinal();
+			wheelSample.slipAngle = (float)slip.getAngle_degs();
+			wheelSample.lateralForce = (float)force_wheel.x;
+			wheelSample.longitudinalForce = (float)force_wheel.y;
+			wheelSample.suspensionLength = (float)wheelInterface.getSuspension().getLength();
+			wheelSample.angularVelocity = (float)w.getAngularVelocity();
+			wheelSample.steeringAngle = (float)w.getSteeringAngle();
+		}
+	}
+
+	TelemetryRecorder::Sample* TelemetryRecorder::claim()
+		/* Called by TelemetryRecorder::record
+		 * The next free slot of the ring, to be published by storing mHead one on. nullptr if the ring is full (counted as
+		 * dropped) or no log is open
+		*/
+	{
+		if (!mWriterThread.joinable())
+			return nullptr;
+
+		const size_t head = mHead.load(std::memory_order_relaxed);
+		if (head - mTail.load(std::memory_order_acquire) > mRingMask) {
+			mDroppedCount.store(mDroppedCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		return &mRing[head & mRingMask];
+	}
+
+	void TelemetryRecorder::runWriterThread()
+		/* Called by TelemetryRecorder::open, as the writer thread
+		 * Empties the ring every writeInterval until stopped, and then once more
+		*/
+	{
+		const auto interval = std::chrono::duration<double>(std::max(mSettings.writeInterval, 0.0));
+
+		std::unique_lock<std::mutex> lock(mMutex);
+		while (true) {
+			const bool stopping = mStopping;
+
+			lock.unlock();
+			writeSamples();
+			lock.lock();
+
+			if (stopping)
+				break;
+
+			mWake.wait_for(lock, interval, [this]() { return mStopping; });
+		}
+	}
+
+	size_t TelemetryRecorder::writeSamples()
+		/* Called by TelemetryRecorder::runWriterThread
+		 * Writes every sample in the ring to the log and frees their slots. Samples are written a run at a time (as many
+		 * as fit in the current block, and are together in the ring), a column at a time, so each column's values are
+		 * written one after the other rather than every record touching every column. The log is grown by doubling its
+		 * blocks, so it is remapped only a few times over a run. If it cannot be grown, samples are taken from the ring and
+		 * thrown away, so recording carries on
+		*/
+	{
+		const size_t head = mHead.load(std::memory_order_acquire);
+		size_t tail = mTail.load(std::memory_order_relaxed);
+		const size_t count = head - tail;
+
+		const size_t blockRecords = std::max(mSettings.blockRecords, (size_t)1);
+
+		while (tail != head && !mWriteFailed) {
+			const size_t
+				block = (size_t)(mRecordCount / blockRecords),
+				row = (size_t)(mRecordCount % blockRecords),
+				slot = tail & mRingMask,
+				run = std::min(std::min(head - tail, blockRecords - row), mRing.size() - slot);
+
+			if (block >= mMappedBlocks) {
+				const size_t blocks = std::max(block + 1, mMappedBlocks * 2);
+				if (!mFile.resize(mDataOffset + blocks * mBlockBytes)) {
+					mWriteFailed = true;
+					break;
+				}
+
+				mMappedBlocks = blocks;
+			}
+
+			char* blockData = static_cast<char*>(mFile.getWritableData()) + mDataOffset + block * mBlockBytes;
+			const char* samples = reinterpret_cast<const char*>(&mRing[slot]);
+
+			for (size_t c = 0; c < mColumns.size(); c++) {
+				const char* value = samples + mSampleOffsets[c];
+
+				if (mColumns[c].type == ColumnType::FLOAT64) {
+					double* column = reinterpret_cast<double*>(blockData + mColumns[c].blockOffset) + row;
+					for (size_t i = 0; i < run; i++, value += sizeof(Sample))
+						memcpy(column + i, value, sizeof(double));
+				}
+				else {
+					float* column = reinterpret_cast<float*>(blockData + mColumns[c].blockOffset) + row;
+					for (size_t i = 0; i < run; i++, value += sizeof(Sample))
+						memcpy(column + i, value, sizeof(float));
+				}
+			}
+
+			mRecordCount += run;
+			tail += run;
+		}
+
+		mTail.store(head, std::memory_order_release);
+
+		if (!mWriteFailed)
+			writeHeader();
+
+		return count;
+	}
+
+	void TelemetryRecorder::writeHeader()
+		/* Called by
+		 * - TelemetryRecorder::open
+		 * - TelemetryRecorder::writeSamples
+		*/
+	{
+		FileHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+		header.version = FILE_VERSION;
+		header.byteOrder = FILE_BYTE_ORDER;
+		header.columnCount = (uint32_t)mColumns.size();
+		header.blockRecords = (uint32_t)std::max(mSettings.blockRecords, (size_t)1);
+		header.recordCount = mRecordCount;
+		header.droppedCount = mDroppedCount.load(std::memory_order_relaxed);
+		header.blockBytes = mBlockBytes;
+		header.dataOffset = mDataOffset;
+
+		memcpy(mFile.getWritableData(), &header, sizeof(header));
+	}
+}
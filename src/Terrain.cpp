@@ -1,105 +1,494 @@
 #include "Terrain.h"
+#include "WorkStealingPool.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include <filesystem>
 
 namespace External {
 
-	Terrain::Terrain()
-		/* Called in External::Environment
+	namespace {
+		//Start of every cache file. The buffers follow it in order, each 8-byte aligned: heights, normals and surface types,
+		//or for compact terrain, quantised heights, triangle records and height quantisations
+		struct CacheHeader {
+			char magic[8];
+			uint32_t
+				version,
+				byteOrder,       //CACHE_BYTE_ORDER as written, so files from a machine of the other endianness are rejected
+				size,
+				compact;         //0 or 1
+			uint64_t
+				seed,
+				configHash,
+				heightCount,
+				normalCount,     //Or triangle records
+				surfaceTypeCount;//Or height quantisations
+		};
+
+		const char CACHE_MAGIC[8] = { 'V', 'D', 'S', 'T', 'E', 'R', 'R', 'N' };
+		const uint32_t CACHE_BYTE_ORDER = 0x01020304;
+
+		static_assert(sizeof(CacheHeader) == 64, "CacheHeader must have no padding");
+		static_assert(sizeof(glm::dvec3) == 3 * sizeof(double), "Normals are stored as 3 packed doubles");
+		static_assert(sizeof(HeightQuantisation) == 2 * sizeof(double), "Height quantisations are stored as 2 packed doubles");
+
+		inline uint64_t alignCacheOffset(uint64_t offset) { return (offset + 7) & ~(uint64_t)7; }
+	}
+
+	Terrain::Terrain() :
+		/* Called by External::Environment::Environment
 		*/
+		Terrain(Settings())
+	{ }
+
+	Terrain::Terrain(const Settings& settings) :
+		/* Called by
+		 * - Terrain::Terrain
+		 * - External::Environment::Environment
+		 * Loads the terrain from the cache if a matching file is there, otherwise generates it (and saves it to the cache).
+		 * Streamed terrain generates nothing yet
+		*/
+		mSize(std::max(settings.size | 1u, 3u)),
+		mSettings(settings),
+		mPyramidBuilt(false)
 	{
-		mGenerationLayers.push_back(std::make_unique<RoughGround>());
-		mGenerationLayers.push_back(std::make_unique<Track>(mSize));
+		mSettings.size = mSize;
+
+		mGenerationLayers.push_back(std::make_unique<RoughGround>(mSettings.seed));
+		std::unique_ptr<Track> track = std::make_unique<Track>(mSize);
+		mTrack = track.get();
+		mGenerationLayers.push_back(std::move(track));
 
-		generate();
+		mConfigHash = TerrainGenLayer::hashBytes(TerrainGenLayer::FNV_OFFSET_BASIS, &CACHE_VERSION, sizeof(CACHE_VERSION));
+		for (const auto& layer : mGenerationLayers) {
+			const unsigned long long layerHash = layer->getConfigHash();
+			mConfigHash = TerrainGenLayer::hashBytes(mConfigHash, &layerHash, sizeof(layerHash));
+		}
+
+		//Compact terrain is cached separately (full precision keys are unchanged by it)
+		if (mSettings.compact)
+			mConfigHash = TerrainGenLayer::hashBytes(mConfigHash, "compact", 7);
+
+		if (mSettings.streamed)
+			mTiles = std::make_unique<TerrainTileCache>([this](TerrainTileCache::Tile& tile) { generateTile(tile); }, mSettings.tileMemoryBudget);
+		else if (mSettings.cacheDirectory.empty() || !loadCache()) {
+			generate();
+
+			if (!mSettings.cacheDirectory.empty() && !saveCache())
+				printf("WARNING: Could not write terrain cache file %s\n", getCachePath().c_str());
+		}
 	}
 
 	void Terrain::generate()
 		/* Called by Terrain::Terrain
+		 * Always generates, even if the terrain was loaded from the cache (after which it is read from the new buffers).
+		 * Streamed terrain instead drops its tiles, to be generated again as they are needed
 		*/
 	{
+		if (mTiles) {
+			mTiles->clear();
+			return;
+		}
+
 		//Must be called in the following order due to normals needing height data for their calculation
-		generateHeightData();
-		generateNormalData();
-		generateSurfaceTypeData();
+		Internal::WorkStealingPool pool(mSettings.generationThreads);
+
+		generateHeightData(pool);
+		generateNormalData(pool);
+		generateSurfaceTypeData(pool);
+
+		mData = TerrainData();
+		mData.samplesPerRow = mSize;
+
+		if (mSettings.compact) {
+			mQuantisedHeights.resize(mHeights.size());
+			mHeightQuantisations.resize((mSize + ROWS_PER_TILE - 1) / ROWS_PER_TILE);
+			mTriangles.resize(mNormals.size());
+
+			runInRowTiles(pool, mSize, [this](unsigned int firstRow, unsigned int endRow) { compactRows(firstRow, endRow); });
+
+			//Only the compact buffers are kept
+			std::vector<double>().swap(mHeights);
+			std::vector<glm::dvec3>().swap(mNormals);
+			std::vector<unsigned char>().swap(mSurfaceTypes);
+
+			mData.quantisedHeights = mQuantisedHeights.data();
+			mData.quantisations = mHeightQuantisations.data();
+			mData.triangles = mTriangles.data();
+			mData.quantisationShift = QUANTISATION_SHIFT;
+		}
+		else {
+			mData.heights = mHeights.data();
+			mData.normals = mNormals.data();
+			mData.surfaceTypes = mSurfaceTypes.data();
+		}
+
+		mCacheFile.close();
+		mLoadedFromCache = false;
+		mPyramidBuilt = false;
+	}
+
+	std::string Terrain::getCachePath() const
+		/* Called by
+		 * - Terrain::loadCache
+		 * - Terrain::saveCache
+		 * The cache file this terrain is saved to and loaded from, named after everything that determines its contents
+		*/
+	{
+		char fileName[96];
+		snprintf(fileName, sizeof(fileName), "terrain-%u-%llu-%016llx.bin", (unsigned int)mSize, mSettings.seed, mConfigHash);
+
+		return (std::filesystem::path(mSettings.cacheDirectory) / fileName).string();
+	}
+
+	bool Terrain::loadCache()
+		/* Called by Terrain::Terrain
+		 * Maps the cache file and points the terrain's reads into it, if it exists and its header matches this terrain
+		*/
+	{
+		const uint64_t
+			heightCount = (uint64_t)mSize * mSize,
+			triangleCount = (uint64_t)(mSize - 1) * (mSize - 1) * 2,
+			quantisationCount = mSettings.compact ? (mSize + ROWS_PER_TILE - 1) / ROWS_PER_TILE : 0,
+			normalsOffset = alignCacheOffset(sizeof(CacheHeader) + heightCount * (mSettings.compact ? sizeof(uint16_t) : sizeof(double))),
+			lastOffset = alignCacheOffset(normalsOffset + triangleCount * (mSettings.compact ? sizeof(uint32_t) : sizeof(glm::dvec3))),
+			fileSize = lastOffset + (mSettings.compact ? quantisationCount * sizeof(HeightQuantisation) : triangleCount);
+
+		if (!mCacheFile.openReadOnly(getCachePath()))
+			return false;
+
+		const unsigned char* bytes = static_cast<const unsigned char*>(mCacheFile.getData());
+		CacheHeader header;
+
+		if (mCacheFile.getSize() != fileSize) {
+			mCacheFile.close();
+			return false;
+		}
+
+		memcpy(&header, bytes, sizeof(header));
+
+		if (memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != CACHE_VERSION || header.byteOrder != CACHE_BYTE_ORDER ||
+			header.size != mSize || header.compact != (uint32_t)mSettings.compact || header.seed != mSettings.seed || header.configHash != mConfigHash ||
+			header.heightCount != heightCount || header.normalCount != triangleCount || header.surfaceTypeCount != (mSettings.compact ? quantisationCount : triangleCount)) {
+			mCacheFile.close();
+			return false;
+		}
+
+		mData = TerrainData();
+		mData.samplesPerRow = mSize;
+
+		if (mSettings.compact) {
+			mData.quantisedHeights = reinterpret_cast<const uint16_t*>(bytes + sizeof(CacheHeader));
+			mData.triangles = reinterpret_cast<const uint32_t*>(bytes + normalsOffset);
+			mData.quantisations = reinterpret_cast<const HeightQuantisation*>(bytes + lastOffset);
+			mData.quantisationShift = QUANTISATION_SHIFT;
+		}
+		else {
+			mData.heights = reinterpret_cast<const double*>(bytes + sizeof(CacheHeader));
+			mData.normals = reinterpret_cast<const glm::dvec3*>(bytes + normalsOffset);
+			mData.surfaceTypes = bytes + lastOffset;
+		}
+
+		mHeights.clear();
+		mNormals.clear();
+		mSurfaceTypes.clear();
+		mQuantisedHeights.clear();
+		mHeightQuantisations.clear();
+		mTriangles.clear();
+		mLoadedFromCache = true;
+		mPyramidBuilt = false;
+
+		return true;
+	}
+
+	bool Terrain::saveCache() const
+		/* Called by Terrain::Terrain
+		 * Written to a temporary file first and then renamed into place, so a concurrent loader (e.g. another CI job
+		 * sharing the directory) never maps a partly written file
+		*/
+	{
+		std::error_code error;
+		std::filesystem::create_directories(mSettings.cacheDirectory, error);
+
+		const std::string
+			path = getCachePath(),
+			temporaryPath = path + "." + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".tmp";
+
+		FILE* file = fopen(temporaryPath.c_str(), "wb");
+		if (!file)
+			return false;
+
+		CacheHeader header = {};
+		memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+		header.version = CACHE_VERSION;
+		header.byteOrder = CACHE_BYTE_ORDER;
+		header.size = mSize;
+		header.compact = mSettings.compact;
+		header.seed = mSettings.seed;
+		header.configHash = mConfigHash;
+
+		//Each buffer, padded to the next 8 bytes
+		const unsigned char padding[8] = {};
+		uint64_t offset = sizeof(header);
+
+		auto writeBuffer = [&](const void* data, size_t elementSize, size_t count) {
+			const uint64_t start = alignCacheOffset(offset);
+			const bool written = fwrite(padding, 1, start - offset, file) == start - offset && fwrite(data, elementSize, count, file) == count;
+
+			offset = start + (uint64_t)elementSize * count;
+			return written;
+		};
+
+		bool written = false;
+		if (mSettings.compact) {
+			header.heightCount = mQuantisedHeights.size();
+			header.normalCount = mTriangles.size();
+			header.surfaceTypeCount = mHeightQuantisations.size();
+
+			written =
+				fwrite(&header, sizeof(header), 1, file) == 1 &&
+				writeBuffer(mQuantisedHeights.data(), sizeof(uint16_t), mQuantisedHeights.size()) &&
+				writeBuffer(mTriangles.data(), sizeof(uint32_t), mTriangles.size()) &&
+				writeBuffer(mHeightQuantisations.data(), sizeof(HeightQuantisation), mHeightQuantisations.size());
+		}
+		else {
+			header.heightCount = mHeights.size();
+			header.normalCount = mNormals.size();
+			header.surfaceTypeCount = mSurfaceTypes.size();
+
+			written =
+				fwrite(&header, sizeof(header), 1, file) == 1 &&
+				writeBuffer(mHeights.data(), sizeof(double), mHeights.size()) &&
+				writeBuffer(mNormals.data(), sizeof(glm::dvec3), mNormals.size()) &&
+				writeBuffer(mSurfaceTypes.data(), 1, mSurfaceTypes.size());
+		}
+
+		if (fclose(file) != 0 || !written) {
+			std::filesystem::remove(temporaryPath, error);
+			return false;
+		}
+
+		std::filesystem::rename(temporaryPath, path, error);
+		if (error) {
+			std::filesystem::remove(temporaryPath, error);
+			return false;
+		}
+
+		return true;
 	}
 
-	double Terrain::getHeight(glm::dvec2 horizontalSamplePoint)
+	size_t Terrain::getMemoryBytes() const
+		/* Called by code reporting on the terrain (e.g. vds-run)
+		 * Of the buffers every query reads: generated, mapped from the cache file, or the resident streamed tiles, and
+		 * the height pyramid once built
+		*/
+	{
+		if (mTiles)
+			return mTiles->getResidentBytes();
+
+		const size_t pyramidBytes = mPyramidBuilt ? mPyramid.getBytes() : 0;
+
+		if (mLoadedFromCache)
+			return mCacheFile.getSize() + pyramidBytes;
+
+		return pyramidBytes + mHeights.size() * sizeof(double) + mNormals.size() * sizeof(glm::dvec3) + mSurfaceTypes.size() +
+			mQuantisedHeights.size() * sizeof(uint16_t) + mHeightQuantisations.size() * sizeof(HeightQuantisation) + mTriangles.size() * sizeof(uint32_t);
+	}
+
+	double Terrain::getHeight(glm::dvec2 horizontalSamplePoint) const
 		/* Called by
 		 * - FPVCamera::afterPositionConstraints
-		 * - Car::basicCollision
-		 * - DebugCarModel::updateVectorLines
+		 * - Car::positionConstraints
 		 * - TerrainModel::fillWithPositionData
 		 * - UILayer::upsideDownWarning
-		 * - WheelInterface::update
+		 * - VehicleBatch::positionConstraints
 		 * Calculates the height of the terrain at an arbitrary	2D position on it
 		*/
 	{
-		/*       -z
-		 *        |
-		 * -x --- + --- +x
-		 *        |
-		 *       +z
+		return calcHeight(calcSquareIndex(horizontalSamplePoint));
+	}
+
+	glm::dvec3 Terrain::getNormal_world(glm::dvec2 horizontalSamplePoint) const
+		/* Called by code that only needs the normal (the physics uses sampleContacts)
+		 * Returns the surface normal vector at any arbitrary 2D position on the terrain
 		*/
+	{
+		const SquareIndex square = calcSquareIndex(horizontalSamplePoint);
+		return square.data->getNormal(calc_PerTriAttribute_Index(square));
+	}
 
-		using namespace glm;
+	Terrain::Contact Terrain::sampleContact(glm::dvec2 horizontalSamplePoint) const
+		/* Called by DebugCarModel::updateVectorLines, and other code querying a single point
+		 * Same height and normal as getHeight and getNormal_world, plus the surface type, from one index calculation
+		*/
+	{
+		return calcContact(calcSquareIndex(horizontalSamplePoint));
+	}
 
-		//The horizontalSamplePoint will be a non-integer coordinate within the bounds of a terrain square.
-		//The location of the target within this square is required
-		const dvec2 withinSquare = horizontalSamplePoint - floor(horizontalSamplePoint);
+	void Terrain::sampleContacts(const glm::dvec2* horizontalSamplePoints, size_t count, Contact* contacts) const
+		/* Called by
+		 * - WheelSystem::updateAllWheelInterfaces
+		 * - VehicleBatch::updateWheels
+		 * Equivalent of sampleContact for each point. The index arithmetic for a chunk of points is done in one pass
+		 * (no memory access beyond the points, so it vectorises), followed by the gathers from the terrain arrays.
+		 * Streamed terrain samples point by point, as a square only stays valid until the next tile is looked up
+		*/
+	{
+		if (mTiles) {
+			for (size_t i = 0; i < count; i++)
+				contacts[i] = calcContact(calcTileSquareIndex(horizontalSamplePoints[i]));
 
-		//The 3 vertices of the triangle that the target horizontalSamplePoint lies within
-		dvec3
-			vertex1,
-			vertex2,
-			vertex3;
+			return;
+		}
 
-		const int halfTerrainSize = floor(0.5 * mSize);
+		const size_t chunkSize = 16;
+		SquareIndex squares[chunkSize];
 
-		//Indices into the heights array
-		const unsigned int
-			heightsIndexBL_X = horizontalSamplePoint.x < -halfTerrainSize ? 0 : horizontalSamplePoint.x > halfTerrainSize ? mSize - 2 : floor(horizontalSamplePoint.x) + halfTerrainSize,
-			heightsIndexBL_Z = horizontalSamplePoint.y < -halfTerrainSize ? 0 : horizontalSamplePoint.y > halfTerrainSize ? mSize - 2 : floor(horizontalSamplePoint.y) + halfTerrainSize,
-			actualHeightsIndexBL = heightsIndexBL_X * mSize + heightsIndexBL_Z;
+		for (size_t first = 0; first < count; first += chunkSize) {
+			const size_t chunkCount = std::min(chunkSize, count - first);
 
-		vertex1 = dvec3(0.0, mHeights[actualHeightsIndexBL], 0.0);
+			for (size_t i = 0; i < chunkCount; i++)
+				squares[i] = calcSquareIndex(horizontalSamplePoints[first + i]);
 
-		//If point is on lower right triangle
-		if(withinSquare.x >= withinSquare.y)
-			vertex2 = dvec3(1.0, mHeights[actualHeightsIndexBL + mSize], 0.0);
-		//If point is on upper left triangle
-		else
-			vertex2 = dvec3(0.0, mHeights[actualHeightsIndexBL + 1], 1.0);
+			for (size_t i = 0; i < chunkCount; i++)
+				contacts[first + i] = calcContact(squares[i]);
+		}
+	}
 
-		vertex3 = dvec3(1.0, mHeights[actualHeightsIndexBL + mSize + 1], 1.0);
+	void Terrain::prefetch(glm::dvec2 horizontalPosition) const
+		/* Called by
+		 * - Car::positionConstraints
+		 * - VehicleBatch::positionConstraints
+		 * Has the tiles within PREFETCH_DISTANCE of the position generated in the background, so they are ready by the
+		 * time they are driven onto. Does nothing unless the terrain is streamed
+		*/
+	{
+		if (!mTiles)
+			return;
 
-		//Use barycentric interpolation to calculate the final height given the 3 vertices and a between them
-		return Framework::Maths::barycentric(vertex1, vertex2, vertex3, withinSquare);
+		mTiles->prefetch(
+			TerrainTileCache::getTileCoordinate(horizontalPosition.x - PREFETCH_DISTANCE), TerrainTileCache::getTileCoordinate(horizontalPosition.y - PREFETCH_DISTANCE),
+			TerrainTileCache::getTileCoordinate(horizontalPosition.x + PREFETCH_DISTANCE), TerrainTileCache::getTileCoordinate(horizontalPosition.y + PREFETCH_DISTANCE));
 	}
 
-	glm::dvec3 Terrain::getNormal_world(glm::dvec2 horizontalSamplePoint)
-		  /* Called by
-		     - DebugCarModel::updateVectorLines
-			 - WheelInterface::update
-			 Returns the surface normal vector at any arbitrary 2D position on the terrain
-		  */
+	bool Terrain::raycast(glm::dvec3 origin_world, glm::dvec3 direction_world, double maxDistance, RayHit& hit) const
+		/* Called by
+		 * - FPVCamera::afterPositionConstraints
+		 * - code intersecting rays with the terrain (e.g. sensors)
+		 * Finds the nearest point within maxDistance of the origin, along the direction (of any length), where the ray
+		 * meets the surface from above or below. Whole terrain is only raycast within its size, as its edges are not
+		 * extended. Streamed terrain is raycast a tile at a time, generating the tiles the ray crosses, to no further than
+		 * MAX_STREAMED_RAY_DISTANCE
+		*/
 	{
-		return mNormals[calc_PerTriAttribute_Index(horizontalSamplePoint)];
+		const double length = glm::length(direction_world);
+		if (!(length > 0.0))
+			return false;
+
+		const glm::dvec3 direction = direction_world / length;
+		HeightPyramid::Hit pyramidHit;
+
+		auto fillHit = [&](const TerrainData& data) {
+			hit.distance = pyramidHit.distance;
+			hit.position_world = origin_world + direction * pyramidHit.distance;
+			hit.normal_world = data.getNormal(pyramidHit.triIndex);
+			hit.surfaceType = data.getSurfaceType(pyramidHit.triIndex);
+		};
+
+		if (!mTiles) {
+			if (!mPyramidBuilt.load(std::memory_order_acquire)) {
+				std::lock_guard<std::mutex> lock(mPyramidMutex);
+				if (!mPyramidBuilt.load(std::memory_order_relaxed)) {
+					mPyramid.build(mData, mSize - 1);
+					mPyramidBuilt.store(true, std::memory_order_release);
+				}
+			}
+
+			const double halfTerrainSize = floor(0.5 * mSize);
+			if (!mPyramid.raycast(mData, origin_world + glm::dvec3(halfTerrainSize, 0.0, halfTerrainSize), direction, maxDistance, pyramidHit))
+				return false;
+
+			fillHit(mData);
+			return true;
+		}
+
+		//The tiles the ray crosses, in order, until it goes beyond maxDistance. Without a limit, a ray that misses (e.g. one
+		//pointing up, or straight up and so never leaving its tile) would be followed for ever
+		maxDistance = std::min(maxDistance, MAX_STREAMED_RAY_DISTANCE);
+
+		const double
+			infinity = std::numeric_limits<double>::infinity(),
+			tileSquares = TerrainTileCache::TILE_SQUARES;
+
+		int
+			tileX = TerrainTileCache::getTileCoordinate(origin_world.x),
+			tileZ = TerrainTileCache::getTileCoordinate(origin_world.z);
+
+		const int
+			stepX = direction.x < 0.0 ? -1 : 1,
+			stepZ = direction.z < 0.0 ? -1 : 1;
+
+		const double
+			everyX = direction.x != 0.0 ? tileSquares / fabs(direction.x) : infinity,  //Distance between crossings into the next tile along x
+			everyZ = direction.z != 0.0 ? tileSquares / fabs(direction.z) : infinity;  //^ z
+
+		double
+			nextX = direction.x != 0.0 ? ((tileX + (stepX > 0)) * tileSquares - origin_world.x) / direction.x : infinity,
+			nextZ = direction.z != 0.0 ? ((tileZ + (stepZ > 0)) * tileSquares - origin_world.z) / direction.z : infinity;
+
+		while (true) {
+			const TerrainTileCache::Tile& tile = mTiles->getTile(tileX, tileZ);
+
+			if (tile.pyramid.raycast(tile.data, origin_world - glm::dvec3(tile.region.firstX, 0.0, tile.region.firstZ), direction, maxDistance, pyramidHit)) {
+				fillHit(tile.data);
+				return true;
+			}
+
+			if (std::min(nextX, nextZ) > maxDistance)
+				return false;
+
+			if (nextX < nextZ) {
+				tileX += stepX;
+				nextX += everyX;
+			}
+			else {
+				tileZ += stepZ;
+				nextZ += everyZ;
+			}
+		}
 	}
 
-	void Terrain::generateHeightData()
+	void Terrain::generateHeightData(Internal::WorkStealingPool& pool)
 		/* Called by Terrain::generate
 		 * Calculates and stores height data in mHeights
 		*/
 	{
-		mHeights.resize(mSize * mSize, 0.0);
+		mHeights.resize((size_t)mSize * mSize, 0.0);
 
 		for (const auto& layer : mGenerationLayers)
-			layer->runHeights(mHeights);
+			runInRowTiles(pool, mSize, [&](unsigned int firstRow, unsigned int endRow) { layer->runHeights(mHeights, firstRow, endRow); });
 	}
 
-	void Terrain::generateNormalData()
+	void Terrain::generateNormalData(Internal::WorkStealingPool& pool)
 		/* Called by Terrain::generate
 		 * Calculates and stores normal vectors in mNormals
 		*/
+	{
+		mNormals.resize((size_t)(mSize - 1) * (mSize - 1) * 2);
+
+		runInRowTiles(pool, mSize - 1, [this](unsigned int firstRow, unsigned int endRow) { generateNormalRows(mHeights.data(), mNormals.data(), mSize, firstRow, endRow); });
+	}
+
+	void Terrain::generateNormalRows(const double* heights, glm::dvec3* normals, unsigned int samplesPerRow, unsigned int firstRow, unsigned int endRow)
+		/* Called by
+		 * - Terrain::generateNormalData
+		 * - Terrain::generateTile
+		 * Normals of the squares in rows [firstRow, endRow) of a square block of samplesPerRow x samplesPerRow heights
+		*/
 	{
 		/*
 		 *       -z
@@ -119,8 +508,6 @@ namespace External {
 
 		using namespace glm;
 
-		mNormals.resize(pow(mSize - 1, 2) * 2);
-
 		dvec3
 			ThisBLpoint,         //The currently inspected terrain point is considered as the bottom left of a square
 			TLpoint,			 //The top left terrain point in this square
@@ -129,75 +516,239 @@ namespace External {
 			leftTriangleNormal,	 //Temporary variables used each iteration to store the normal calculation results for both triangles
 			rightTriangleNormal; //^
 
-		const int halfTerrainSize = floor(0.5 * mSize);
-
-		int
-			XIndex = 0,   //If mHeights was treated as a 2D array, this would be the X index into this array ie. mHeights[XIndex][...]
-			currentIndex = 0; //This is the actual index into the (1D) mHeights array (from the bottom left position)
-
-		//Iterate over the bottom left points of all squares in the terrain
-		for (int x = -halfTerrainSize; x < halfTerrainSize; x++) {
-			for (int z = -halfTerrainSize; z < halfTerrainSize; z++) {
+		size_t currentIndex = 0; //The index into the (1D) heights array (from the bottom left position)
 
-				//Calculate the index into mHeights that gets the height at the *current* position
-				currentIndex = (x + halfTerrainSize) * mSize + (z + halfTerrainSize);
+		//Iterate over the bottom left points of all squares in the rows. x is the X index of heights if it was a 2D array
+		//(with the bottom left item being [0][0])
+		for (size_t x = firstRow; x < endRow; x++) {
+			for (size_t z = 0; z < samplesPerRow - 1; z++) {
 
-				//Use this index to calculate the X index of mHeights if it was a 2D array (with the bottom left item being [0][0])
-				XIndex = floor(currentIndex / mSize);
+				//Calculate the index into heights that gets the height at the *current* position
+				currentIndex = x * samplesPerRow + z;
 
 				//Retrieve the height values that will be needed for the normal calculation
-				ThisBLpoint = dvec3(0.0, mHeights[currentIndex],             0.0);
-				TLpoint =     dvec3(0.0, mHeights[currentIndex + 1],         1.0);
-				TRpoint =     dvec3(1.0, mHeights[currentIndex + mSize + 1], 1.0);
-				BRpoint =     dvec3(1.0, mHeights[currentIndex + mSize],     0.0);
+				ThisBLpoint = dvec3(0.0, heights[currentIndex],                     0.0);
+				TLpoint =     dvec3(0.0, heights[currentIndex + 1],                 1.0);
+				TRpoint =     dvec3(1.0, heights[currentIndex + samplesPerRow + 1], 1.0);
+				BRpoint =     dvec3(1.0, heights[currentIndex + samplesPerRow],     0.0);
 
 				//Use the height values to calculate the normal vectors for both halves (triangles) of the currently inspected terrain square
 				leftTriangleNormal = normalize(cross(TRpoint - TLpoint, ThisBLpoint - TLpoint));
 				rightTriangleNormal = normalize(cross(ThisBLpoint - BRpoint, TRpoint - BRpoint));
 
-				//Insert these normal vectors into the correct positions in mNormals
-				mNormals[2 * (currentIndex - XIndex)] = leftTriangleNormal;
-				mNormals[2 * (currentIndex - XIndex) + 1] = rightTriangleNormal;
+				//Insert these normal vectors into the correct positions in normals
+				normals[2 * (currentIndex - x)] = leftTriangleNormal;
+				normals[2 * (currentIndex - x) + 1] = rightTriangleNormal;
 			}
 		}
 	}
 
-	void Terrain::generateSurfaceTypeData()
+	void Terrain::generateSurfaceTypeData(Internal::WorkStealingPool& pool)
 		/* Called by Terrain::generate
 		* Calculates and stores terrain surface types in mSurfaceTypes
 		*/
 	{
-		mSurfaceTypes.resize(pow(mSize - 1, 2) * 2);
+		mSurfaceTypes.resize((size_t)(mSize - 1) * (mSize - 1) * 2);
 
 		for (const auto& layer : mGenerationLayers)
-			layer->runSurfaceTypes(mSurfaceTypes);
+			runInRowTiles(pool, mSize - 1, [&](unsigned int firstRow, unsigned int endRow) { layer->runSurfaceTypes(mSurfaceTypes, firstRow, endRow); });
+	}
+
+	void Terrain::compactRows(unsigned int firstRow, unsigned int endRow)
+		/* Called by Terrain::generate, for compact terrain
+		 * Packs rows [firstRow, endRow) of heights, and of squares, into the compact buffers. The rows must be whole row
+		 * tiles, which are quantised one at a time
+		*/
+	{
+		for (unsigned int row = firstRow; row < endRow; row += ROWS_PER_TILE) {
+			const size_t
+				firstHeight = (size_t)row * mSize,
+				heightCount = (size_t)(std::min(row + ROWS_PER_TILE, endRow) - row) * mSize;
+
+			mHeightQuantisations[row >> QUANTISATION_SHIFT] = TerrainData::quantiseHeights(mHeights.data() + firstHeight, heightCount, mQuantisedHeights.data() + firstHeight);
+		}
+
+		const size_t trianglesPerRow = 2 * (size_t)(mSize - 1);
+		for (size_t i = firstRow * trianglesPerRow; i < std::min(endRow, mSize - 1) * trianglesPerRow; i++)
+			mTriangles[i] = TerrainData::packTriangle(mNormals[i], mSurfaceTypes[i]);
+	}
+
+	void Terrain::generateTile(TerrainTileCache::Tile& tile) const
+		/* Called by the TerrainTileCache of streamed terrain, on the thread that first needs the tile or its prefetch thread
+		 * The same steps as generate, over one tile: heights, then normals, then surface types, then packing them if
+		 * compact, and lastly its height pyramid
+		*/
+	{
+		const unsigned int squares = tile.region.samples - 1;
+
+		tile.heights.resize((size_t)tile.region.samples * tile.region.samples, 0.0);
+		for (const auto& layer : mGenerationLayers)
+			layer->runTileHeights(tile.heights, tile.region);
+
+		tile.normals.resize((size_t)squares * squares * 2);
+		generateNormalRows(tile.heights.data(), tile.normals.data(), tile.region.samples, 0, squares);
+
+		tile.surfaceTypes.resize((size_t)squares * squares * 2);
+		for (const auto& layer : mGenerationLayers)
+			layer->runTileSurfaceTypes(tile.surfaceTypes, tile.region);
+
+		tile.data.samplesPerRow = tile.region.samples;
+
+		if (mSettings.compact) {
+			tile.quantisedHeights.resize(tile.heights.size());
+			tile.quantisation = TerrainData::quantiseHeights(tile.heights.data(), tile.heights.size(), tile.quantisedHeights.data());
+
+			tile.triangles.resize(tile.normals.size());
+			for (size_t i = 0; i < tile.triangles.size(); i++)
+				tile.triangles[i] = TerrainData::packTriangle(tile.normals[i], tile.surfaceTypes[i]);
+
+			std::vector<double>().swap(tile.heights);
+			std::vector<glm::dvec3>().swap(tile.normals);
+			std::vector<unsigned char>().swap(tile.surfaceTypes);
+
+			//One quantisation for every row of the tile
+			tile.data.quantisedHeights = tile.quantisedHeights.data();
+			tile.data.quantisations = &tile.quantisation;
+			tile.data.triangles = tile.triangles.data();
+			tile.data.quantisationShift = 31;
+		}
+		else {
+			tile.data.heights = tile.heights.data();
+			tile.data.normals = tile.normals.data();
+			tile.data.surfaceTypes = tile.surfaceTypes.data();
+		}
+
+		tile.pyramid.build(tile.data, squares);
+	}
+
+	void Terrain::runInRowTiles(Internal::WorkStealingPool& pool, unsigned int rowCount, const std::function<void(unsigned int firstRow, unsigned int endRow)>& run)
+		/* Called by
+		 * - Terrain::generateHeightData
+		 * - Terrain::generateNormalData
+		 * - Terrain::generateSurfaceTypeData
+		 * Runs run over tiles of ROWS_PER_TILE rows, in parallel, and returns once every tile is done
+		*/
+	{
+		const unsigned int tileCount = (rowCount + ROWS_PER_TILE - 1) / ROWS_PER_TILE;
+
+		pool.run(tileCount, [&](size_t tile, unsigned int) {
+			run((unsigned int)tile * ROWS_PER_TILE, std::min(((unsigned int)tile + 1) * ROWS_PER_TILE, rowCount));
+		});
 	}
 
-	unsigned int Terrain::calc_PerTriAttribute_Index(glm::dvec2 horizontalSamplePoint)
-		/* Called by Terrain::getNormal_world
-		 * Maps any arbitrary 2D position in space, onto (the index of) the triangle it is contained within.
-		 * Works for mSurfaceTypes and mNormals (both are one-per-triangle)
+	Terrain::SquareIndex Terrain::calcSquareIndex(glm::dvec2 horizontalSamplePoint) const
+		/* Called by
+		 * - Terrain::getHeight
+		 * - Terrain::getNormal_world
+		 * - Terrain::sampleContact
+		 * - Terrain::sampleContacts
+		 * Maps any arbitrary 2D position in space onto the terrain square it lies over. Points beyond the edges are
+		 * clamped onto the outermost squares (streamed terrain has no edges)
 		*/
 	{
-		/*       -y
+		if (mTiles)
+			return calcTileSquareIndex(horizontalSamplePoint);
+
+		/*       -z
 		 *        |
 		 * -x --- + --- +x
 		 *        |
-		 *       +y
+		 *       +z
+		*/
+
+		SquareIndex square;
+
+		//The horizontalSamplePoint will be a non-integer coordinate within the bounds of a terrain square.
+		//The location of the target within this square is required
+		square.withinSquare = horizontalSamplePoint - floor(horizontalSamplePoint);
+
+		//A point exactly on the far edges (+halfTerrainSize) is also clamped, as the square it starts has no far side
+		const double halfTerrainSize = floor(0.5 * mSize);
+
+		const size_t heightsIndexBL_Z = horizontalSamplePoint.y < -halfTerrainSize ? 0 : horizontalSamplePoint.y >= halfTerrainSize ? mSize - 2 : (size_t)(floor(horizontalSamplePoint.y) + halfTerrainSize);
+
+		square.heightsIndexBL_X = horizontalSamplePoint.x < -halfTerrainSize ? 0 : horizontalSamplePoint.x >= halfTerrainSize ? mSize - 2 : (size_t)(floor(horizontalSamplePoint.x) + halfTerrainSize);
+		square.heightsIndexBL = square.heightsIndexBL_X * mSize + heightsIndexBL_Z;
+		square.data = &mData;
+
+		return square;
+	}
+
+	Terrain::SquareIndex Terrain::calcTileSquareIndex(glm::dvec2 horizontalSamplePoint) const
+		/* Called by
+		 * - Terrain::calcSquareIndex
+		 * - Terrain::sampleContacts
+		 * Equivalent of calcSquareIndex for streamed terrain, into the tile the square is in. The square is only valid
+		 * until this thread next looks up a tile
 		*/
+	{
+		SquareIndex square;
+
+		const glm::dvec2 bottomLeft = floor(horizontalSamplePoint);
+		square.withinSquare = horizontalSamplePoint - bottomLeft;
 
-		//Used to determine which triangle (half of a terrain square) the horizontalSamplePoint lies within
-		const glm::dvec2 withinSquare = horizontalSamplePoint - floor(horizontalSamplePoint);
+		const TerrainTileCache::Tile& tile = mTiles->getTile(TerrainTileCache::getTileCoordinate(bottomLeft.x), TerrainTileCache::getTileCoordinate(bottomLeft.y));
 
-		const int halfTerrainSize = floor(0.5 * mSize);
+		square.data = &tile.data;
+		square.heightsIndexBL_X = (size_t)(bottomLeft.x - tile.region.firstX);
+		square.heightsIndexBL = square.heightsIndexBL_X * tile.data.samplesPerRow + (size_t)(bottomLeft.y - tile.region.firstZ);
 
-		//Indices into the per-triangle-attribute array
-		const unsigned int
-			heightsIndexBL_X = horizontalSamplePoint.x < -halfTerrainSize ? 0 : horizontalSamplePoint.x > halfTerrainSize ? mSize - 2 : floor(horizontalSamplePoint.x) + halfTerrainSize,
-			heightsIndexBL_Z = horizontalSamplePoint.y < -halfTerrainSize ? 0 : horizontalSamplePoint.y > halfTerrainSize ? mSize - 2 : floor(horizontalSamplePoint.y) + halfTerrainSize,
-			actualHeightsIndexBL = heightsIndexBL_X * mSize + heightsIndexBL_Z;
+		return square;
+	}
 
-		return 2 * (actualHeightsIndexBL - heightsIndexBL_X) + (withinSquare.x > withinSquare.y);
+	double Terrain::calcHeight(const SquareIndex& square) const
+		/* Called by
+		 * - Terrain::getHeight
+		 * - Terrain::calcContact
+		*/
+	{
+		using namespace glm;
+
+		//The 3 vertices of the triangle that the target point lies within
+		dvec3
+			vertex1,
+			vertex2,
+			vertex3;
+
+		const TerrainData& data = *square.data;
+		const size_t rowBL = square.heightsIndexBL_X;
+
+		vertex1 = dvec3(0.0, data.getHeight(square.heightsIndexBL, rowBL), 0.0);
+
+		//If point is on lower right triangle
+		if (square.withinSquare.x >= square.withinSquare.y)
+			vertex2 = dvec3(1.0, data.getHeight(square.heightsIndexBL + data.samplesPerRow, rowBL + 1), 0.0);
+		//If point is on upper left triangle
+		else
+			vertex2 = dvec3(0.0, data.getHeight(square.heightsIndexBL + 1, rowBL), 1.0);
+
+		vertex3 = dvec3(1.0, data.getHeight(square.heightsIndexBL + data.samplesPerRow + 1, rowBL + 1), 1.0);
+
+		//Use barycentric interpolation to calculate the final height given the 3 vertices and a between them
+		return Framework::Maths::barycentric(vertex1, vertex2, vertex3, square.withinSquare);
+	}
+
+	Terrain::Contact Terrain::calcContact(const SquareIndex& square) const
+		/* Called by
+		 * - Terrain::sampleContact
+		 * - Terrain::sampleContacts
+		*/
+	{
+		const size_t triIndex = calc_PerTriAttribute_Index(square);
+		return { calcHeight(square), square.data->getNormal(triIndex), square.data->getSurfaceType(triIndex), triIndex };
+	}
+
+	size_t Terrain::calc_PerTriAttribute_Index(const SquareIndex& square)
+		/* Called by
+		 * - Terrain::getNormal_world
+		 * - Terrain::calcContact
+		 * Maps a terrain square and a position within it onto (the index of) the triangle that position is contained within.
+		 * Works for mSurfaceTypes and mNormals (both are one-per-triangle).
+		 * A point exactly on the diagonal belongs to the left triangle here, but calcHeight interpolates it on the right
+		 * one; both give the same height there
+		*/
+	{
+		return 2 * (square.heightsIndexBL - square.heightsIndexBL_X) + (square.withinSquare.x > square.withinSquare.y);
 	}
 
 }
\ No newline at end of file
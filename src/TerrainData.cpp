@@ -0,0 +1,49 @@
+#include "TerrainData.h"
+
+#include <algorithm>
+
+namespace External {
+
+	HeightQuantisation TerrainData::quantiseHeights(const double* heights, size_t count, uint16_t* quantised)
+		/* Called by
+		 * - Terrain::compactRows
+		 * - Terrain::generateTile
+		 * Spreads the 16-bit range over [lowest, highest] of the heights, rounding each to the nearest step
+		*/
+	{
+		const auto range = std::minmax_element(heights, heights + count);
+		const HeightQuantisation quantisation = { *range.first, (*range.second - *range.first) / 65535.0 };
+
+		for (size_t i = 0; i < count; i++)
+			quantised[i] = quantisation.scale > 0.0 ? (uint16_t)std::lround((heights[i] - quantisation.offset) / quantisation.scale) : 0;
+
+		return quantisation;
+	}
+
+	uint32_t TerrainData::packTriangle(const glm::dvec3& normal, unsigned char surfaceType)
+		/* Called by
+		 * - Terrain::compactRows
+		 * - Terrain::generateTile
+		 * Projects the (unit) normal onto the octahedron |x| + |y| + |z| = 1, folds its lower half out over the corners,
+		 * and quantises the (x, z) that results to 12 bits each. The surface type goes in the top 8 bits
+		*/
+	{
+		const double length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+
+		double
+			u = normal.x / length,
+			v = normal.z / length;
+
+		if (normal.y < 0.0) {
+			const double foldedU = (1.0 - std::abs(v)) * (u < 0.0 ? -1.0 : 1.0);
+			v = (1.0 - std::abs(u)) * (v < 0.0 ? -1.0 : 1.0);
+			u = foldedU;
+		}
+
+		const uint32_t
+			quantisedU = (uint32_t)std::lround((u + 1.0) * (4095.0 / 2.0)),
+			quantisedV = (uint32_t)std::lround((v + 1.0) * (4095.0 / 2.0));
+
+		return quantisedU | (quantisedV << 12) | ((uint32_t)surfaceType << 24);
+	}
+}
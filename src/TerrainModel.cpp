@@ -1,12 +1,17 @@
 #include "TerrainModel.h"
 
+#include <random>
+#include <algorithm>
+
 namespace Visual {
 
-	TerrainModel::TerrainModel(Framework::ResourceSet& resourceBucket, Framework::Graphics::Shader* terrainShader) :
+	TerrainModel::TerrainModel(Framework::ResourceSet& resourceBucket, Framework::Graphics::Shader* terrainShader, const External::Terrain& terrain) :
 		/* Called by EnvironmentModel::loadResources
 		*/
 		mResourceBucket(resourceBucket),
-		mShader(terrainShader)
+		mTerrain(terrain),
+		mShader(terrainShader),
+		mHalfModelSize(std::min((int)(terrain.getSize() / 2), MAX_MODEL_SQUARES / 2))
 	{
 		loadModel();
 	}
@@ -77,8 +82,6 @@ namespace Visual {
 
 		using namespace External;
 
-		const int halfTerrainSize = floor(0.5 * Environment::mTerrain.getSize());
-
 		//These represent the terrain heights at each of the four corners of the current terrain square being inspected
 		double
 			BL = 0.0,
@@ -86,16 +89,16 @@ namespace Visual {
 			TR = 0.0,
 			BR = 0.0;
 
-		for (int x = -halfTerrainSize; x < halfTerrainSize; x++) {
-			for (int z = -halfTerrainSize; z < halfTerrainSize; z++) {
+		for (int x = -mHalfModelSize; x < mHalfModelSize; x++) {
+			for (int z = -mHalfModelSize; z < mHalfModelSize; z++) {
 				//An (x,z) coordinate in here sits on the bottom left (origin) of one of the terrain squares.
 				//This can be used to add the position data.
 
 				//First get the heights
-				BL = Environment::mTerrain.getHeight(glm::dvec2(x, z));
-				TL = Environment::mTerrain.getHeight(glm::dvec2(x, z + 1.0));
-				TR = Environment::mTerrain.getHeight(glm::dvec2(x + 1.0, z + 1.0));
-				BR = Environment::mTerrain.getHeight(glm::dvec2(x + 1.0, z));
+				BL = mTerrain.getHeight(glm::dvec2(x, z));
+				TL = mTerrain.getHeight(glm::dvec2(x, z + 1.0));
+				TR = mTerrain.getHeight(glm::dvec2(x + 1.0, z + 1.0));
+				BR = mTerrain.getHeight(glm::dvec2(x + 1.0, z));
 
 				//Now add each position to the buffer
 
@@ -156,25 +159,15 @@ namespace Visual {
 		using namespace glm;
 		using namespace External;
 
-		const int
-			terrainSize = Environment::mTerrain.getSize(),
-			halfTerrainSize = floor(0.5 * terrainSize);
-
 		vec3
 			leftTriangleNormal,
 			rightTriangleNormal;
 
-		int
-			normalsArrayIndexX = 0,
-			heightsIndex = 0;
-
-		for (int x = -halfTerrainSize; x < halfTerrainSize; x++) {
-			for (int z = -halfTerrainSize; z < halfTerrainSize; z++) {
-				heightsIndex = (x + halfTerrainSize) * terrainSize + (z + halfTerrainSize);
-				normalsArrayIndexX = floor(heightsIndex / terrainSize);
-
-				leftTriangleNormal = Environment::mTerrain.mNormals[2 * (heightsIndex - normalsArrayIndexX)];
-				rightTriangleNormal = Environment::mTerrain.mNormals[2 * (heightsIndex - normalsArrayIndexX) + 1];
+		for (int x = -mHalfModelSize; x < mHalfModelSize; x++) {
+			for (int z = -mHalfModelSize; z < mHalfModelSize; z++) {
+				//Sampled within each triangle, so this works on streamed terrain too
+				leftTriangleNormal = mTerrain.getNormal_world(dvec2(x + 0.25, z + 0.75));
+				rightTriangleNormal = mTerrain.getNormal_world(dvec2(x + 0.75, z + 0.25));
 
 				//v0
 				toFill.push_back(leftTriangleNormal.x);
@@ -232,37 +225,28 @@ namespace Visual {
 		using namespace glm;
 		using namespace External;
 
-		const int
-			terrainSize = Environment::mTerrain.getSize(),
-			halfTerrainSize = floor(0.5 * terrainSize);
-
 		vec3
 			leftTriangleColour,
 			rightTriangleColour;
 
-		int
-			surfaceTypesArrayIndexX = 0,
-			surfaceTypesArrayIndexZ = 0,
-			heightsIndex = 0;
-
 		vec3 terrainSurfaceColours[3];
 		terrainSurfaceColours[External::TerrainType::GRASS] = glm::vec3(0.2509803921568627f, 0.3529411764705882f, 0.1215686274509804f);
 		terrainSurfaceColours[External::TerrainType::TARMAC] = glm::vec3(0.3725490196078431f, 0.2509803921568627f, 0.1411764705882353f);
 		terrainSurfaceColours[External::TerrainType::ERROR_TYPE] = glm::vec3(1.0f, 0.0f, 0.0f);
 
-		for (int x = -halfTerrainSize; x < halfTerrainSize; x++) {
-			for (int z = -halfTerrainSize; z < halfTerrainSize; z++) {
-				heightsIndex = (x + halfTerrainSize) * terrainSize + (z + halfTerrainSize);
-				surfaceTypesArrayIndexX = floor(heightsIndex / terrainSize);
-				surfaceTypesArrayIndexZ = heightsIndex - terrainSize * surfaceTypesArrayIndexX;
+		//Seeded from the terrain, so the same terrain is always coloured the same
+		std::mt19937_64 random(mTerrain.getSeed());
+		std::uniform_real_distribution<float> distortion(-0.5f, 0.5f);
 
-				leftTriangleColour = terrainSurfaceColours[Environment::mTerrain.mSurfaceTypes[2 * (heightsIndex - surfaceTypesArrayIndexX)]];
-				rightTriangleColour = terrainSurfaceColours[Environment::mTerrain.mSurfaceTypes[2 * (heightsIndex - surfaceTypesArrayIndexX) + 1]];
+		for (int x = -mHalfModelSize; x < mHalfModelSize; x++) {
+			for (int z = -mHalfModelSize; z < mHalfModelSize; z++) {
+				leftTriangleColour = terrainSurfaceColours[mTerrain.sampleContact(dvec2(x + 0.25, z + 0.75)).surfaceType];
+				rightTriangleColour = terrainSurfaceColours[mTerrain.sampleContact(dvec2(x + 0.75, z + 0.25)).surfaceType];
 
 				//Add some distortion
 				double distortionLevel = 0.08;
-				leftTriangleColour += vec3(distortionLevel) * ((((float)rand() / RAND_MAX) * 2.0f - 1.0f) / 2.0f);
-				rightTriangleColour += vec3(distortionLevel) * ((((float)rand() / RAND_MAX) * 2.0f - 1.0f) / 2.0f);
+				leftTriangleColour += vec3(distortionLevel) * distortion(random);
+				rightTriangleColour += vec3(distortionLevel) * distortion(random);
 
 				//v0
 				toFill.push_back(leftTriangleColour.x);
@@ -301,7 +285,10 @@ namespace Visual {
 		/*Called by TerrainModel::loadModel
 		*/
 	{
-		for (unsigned int i = 0; i < pow(External::Environment::mTerrain.getSize() - 1, 2) * 6; i++)
+		const unsigned int vertexCount = (unsigned int)(4 * mHalfModelSize * mHalfModelSize * 6);
+
+		toFill.reserve(vertexCount);
+		for (unsigned int i = 0; i < vertexCount; i++)
 			toFill.push_back(i);
 	}
 
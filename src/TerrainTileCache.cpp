@@ -0,0 +1,231 @@
+#include "TerrainTileCache.h"
+
+#include <algorithm>
+
+namespace External {
+
+	namespace {
+		//The tile a thread last looked up, and the cache (by id) it came from
+		struct HotTile {
+			unsigned long long cacheId = 0;
+			unsigned long long key = 0;
+			std::shared_ptr<const TerrainTileCache::Tile> tile;
+		};
+
+		//The range of tiles a thread last prefetched, so a car staying within the same tiles costs nothing
+		struct LastPrefetch {
+			unsigned long long cacheId = 0;
+			int range[4] = { 0, 0, 0, 0 };
+		};
+
+		thread_local HotTile hotTile;
+		thread_local LastPrefetch lastPrefetch;
+
+		std::atomic<unsigned long long> nextCacheId(1);
+	}
+
+	TerrainTileCache::TerrainTileCache(const Generator& generator, size_t memoryBudget) :
+		/* Called by Terrain::Terrain, for streamed terrain
+		*/
+		mGenerator(generator),
+		mMemoryBudget(memoryBudget),
+		mId(nextCacheId++),
+		mGeneratedCount(0)
+	{ }
+
+	TerrainTileCache::~TerrainTileCache()
+		/* Called when the Terrain is destroyed
+		 * Stops the prefetch thread, abandoning any tiles still queued
+		*/
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mStopping = true;
+		}
+
+		mPrefetchWake.notify_all();
+		if (mPrefetchThread.joinable())
+			mPrefetchThread.join();
+	}
+
+	const TerrainTileCache::Tile& TerrainTileCache::getTile(int tileX, int tileZ)
+		/* Called by Terrain::calcSquareIndex
+		 * The returned tile stays valid until this thread looks up another tile (of any cache)
+		*/
+	{
+		const Key key = makeKey(tileX, tileZ);
+		const unsigned long long id = mId.load(std::memory_order_relaxed);
+
+		if (hotTile.cacheId != id || hotTile.key != key || !hotTile.tile) {
+			hotTile.tile = findOrGenerate(key);
+			hotTile.cacheId = id;
+			hotTile.key = key;
+		}
+
+		return *hotTile.tile;
+	}
+
+	void TerrainTileCache::prefetch(int firstTileX, int firstTileZ, int lastTileX, int lastTileZ)
+		/* Called by Terrain::prefetch
+		 * Queues the tiles in [firstTile, lastTile] on both axes that are not already in memory, to be generated in the
+		 * background
+		*/
+	{
+		const unsigned long long id = mId.load(std::memory_order_relaxed);
+		const int range[4] = { firstTileX, firstTileZ, lastTileX, lastTileZ };
+
+		if (lastPrefetch.cacheId == id && std::equal(range, range + 4, lastPrefetch.range))
+			return;
+
+		lastPrefetch.cacheId = id;
+		std::copy(range, range + 4, lastPrefetch.range);
+
+		bool queued = false;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			for (int tileX = firstTileX; tileX <= lastTileX; tileX++)
+				for (int tileZ = firstTileZ; tileZ <= lastTileZ; tileZ++) {
+					const Key key = makeKey(tileX, tileZ);
+
+					if (!mTiles.count(key) && std::find(mPrefetchQueue.begin(), mPrefetchQueue.end(), key) == mPrefetchQueue.end()) {
+						mPrefetchQueue.push_back(key);
+						queued = true;
+					}
+				}
+
+			if (queued && !mPrefetchThread.joinable())
+				mPrefetchThread = std::thread(&TerrainTileCache::runPrefetchThread, this);
+		}
+
+		if (queued)
+			mPrefetchWake.notify_one();
+	}
+
+	void TerrainTileCache::clear()
+		/* Called by Terrain::generate
+		 * Drops every tile, so they are all generated again when next needed. Threads' hot tiles are left to expire
+		*/
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		mTiles.clear();
+		mRecentlyUsed.clear();
+		mResidentBytes = 0;
+		mPrefetchQueue.clear();
+		mId = nextCacheId++;
+	}
+
+	size_t TerrainTileCache::getResidentCount()
+		/* Called by code reporting on the cache (e.g. tests)
+		*/
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		return mTiles.size();
+	}
+
+	size_t TerrainTileCache::getResidentBytes()
+		/* Called by Terrain::getMemoryBytes
+		*/
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		return mResidentBytes;
+	}
+
+	size_t TerrainTileCache::getTileBytes(bool compact)
+		/* Called by code choosing a memory budget
+		 * What Tile::getBytes comes to for every tile, in either storage
+		*/
+	{
+		const size_t
+			samples = (size_t)(TILE_SQUARES + 1) * (TILE_SQUARES + 1),
+			triangles = (size_t)TILE_SQUARES * TILE_SQUARES * 2;
+
+		return sizeof(Tile) + HeightPyramid::calcBytes(TILE_SQUARES) + (compact ?
+			samples * sizeof(uint16_t) + triangles * sizeof(uint32_t) :
+			samples * sizeof(double) + triangles * (sizeof(glm::dvec3) + sizeof(unsigned char)));
+	}
+
+	size_t TerrainTileCache::Tile::getBytes() const
+		/* Called by TerrainTileCache::insert
+		*/
+	{
+		return sizeof(Tile) + heights.size() * sizeof(double) + normals.size() * sizeof(glm::dvec3) + surfaceTypes.size() +
+			quantisedHeights.size() * sizeof(uint16_t) + triangles.size() * sizeof(uint32_t) + pyramid.getBytes();
+	}
+
+	std::shared_ptr<const TerrainTileCache::Tile> TerrainTileCache::findOrGenerate(Key key)
+		/* Called by
+		 * - TerrainTileCache::getTile
+		 * - TerrainTileCache::runPrefetchThread
+		 * Generation happens outside the lock, so other threads' lookups are not held up by it. If two threads
+		 * generate the same tile at once, the first to finish is kept (they are identical)
+		*/
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			const auto found = mTiles.find(key);
+			if (found != mTiles.end()) {
+				mRecentlyUsed.splice(mRecentlyUsed.begin(), mRecentlyUsed, found->second.recentlyUsed);
+				return found->second.tile;
+			}
+		}
+
+		const std::shared_ptr<Tile> tile = std::make_shared<Tile>();
+		tile->region = { (int)(key >> 32) * TILE_SQUARES, (int)(unsigned int)key * TILE_SQUARES, TILE_SQUARES + 1 };
+		mGenerator(*tile);
+		mGeneratedCount++;
+
+		return insert(key, tile);
+	}
+
+	std::shared_ptr<const TerrainTileCache::Tile> TerrainTileCache::insert(Key key, const std::shared_ptr<const Tile>& tile)
+		/* Called by TerrainTileCache::findOrGenerate
+		 * Adds the tile as the most recently used, then evicts the least recently used tiles until the rest fit the
+		 * memory budget (always keeping the new one)
+		*/
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		const auto inserted = mTiles.emplace(key, Entry{ tile, mRecentlyUsed.end() });
+		if (!inserted.second)
+			return inserted.first->second.tile;
+
+		mRecentlyUsed.push_front(key);
+		inserted.first->second.recentlyUsed = mRecentlyUsed.begin();
+		mResidentBytes += tile->getBytes();
+
+		while (mTiles.size() > 1 && mResidentBytes > mMemoryBudget) {
+			const auto evicted = mTiles.find(mRecentlyUsed.back());
+			mResidentBytes -= evicted->second.tile->getBytes();
+			mTiles.erase(evicted);
+			mRecentlyUsed.pop_back();
+		}
+
+		return tile;
+	}
+
+	void TerrainTileCache::runPrefetchThread()
+		/* Called by TerrainTileCache::prefetch, as the body of mPrefetchThread
+		*/
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		while (true) {
+			mPrefetchWake.wait(lock, [this]() { return mStopping || !mPrefetchQueue.empty(); });
+			if (mStopping)
+				return;
+
+			const Key key = mPrefetchQueue.front();
+			mPrefetchQueue.pop_front();
+
+			if (mTiles.count(key))
+				continue;
+
+			lock.unlock();
+			findOrGenerate(key);
+			lock.lock();
+		}
+	}
+}
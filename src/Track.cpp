@@ -1,5 +1,7 @@
 #include "Track.h"
 
+#include <limits>
+
 #define CIRCULAR_TRACK      0
 #define COMPLEX_TRACK       1
 #define SQUARE_TRACK        0
@@ -11,28 +13,82 @@ namespace External {
 	Track::Track(const unsigned int terrainSize_heightSamples) :
 		/* Called by Terrain::Terrain
 		 * Prepares the class for runHeights and runSurfaceTypes to be called, by running a pilot version of the track generation algorithm
+		 * and then walking the full track once
 		*/
-		mTerrainSize_heightSamples(terrainSize_heightSamples)
+		mTerrainSize_heightSamples(terrainSize_heightSamples),
+		mTerrainBorderPadding(std::max(10u, (terrainSize_heightSamples - 1) / 64))
 	{
-		mTempSurfaceTypes.resize(pow(terrainSize_heightSamples - 1, 2) * 2);
-
 		addAllPoints();
 		runPilotVersion();
 
 		mSizeLimit = (mTerrainSize_heightSamples - 1) - (2 * mTerrainBorderPadding) - mWidth;
 		mPilotToMainScaleFactor = mSizeLimit / std::max(mPilotResults.mShapeDimensions.x, mPilotResults.mShapeDimensions.y);
 
+		//Steps no longer than a quarter of the track width, so that the squares walked through leave no gaps in the track
+		mStepsPerSample = std::max(1u, (unsigned int)ceil(mPilotToMainScaleFactor / (0.25 * mWidth)));
+
 		updateStartingPosition();
+		findCentrelineSquares();
 	}
 
-	void Track::runHeights(std::vector<double>& previousLayerHeights)
+	void Track::runHeights(std::vector<double>& previousLayerHeights, unsigned int firstRow, unsigned int endRow)
 		/* Called by Terrain::generateHeightData
-		 * Adds the track shape to the terrain height buffer passed in
+		 * Adds the track shape to the terrain height buffer passed in, within the rows passed in.
+		 * Each point's height depends only on its distance to the centreline, so the result does not depend on the rows
+		 * the terrain is split into
 		*/
 	{
-		const int
-			terrainSize = sqrt(previousLayerHeights.size()),
-			halfTerrainSize = 0.5 * terrainSize;
+		const int halfTerrainSize = 0.5 * mTerrainSize_heightSamples;
+
+		imprintRows({ previousLayerHeights.data(), nullptr, { -halfTerrainSize, -halfTerrainSize, mTerrainSize_heightSamples },
+			(int)firstRow - halfTerrainSize, (int)endRow - halfTerrainSize });
+	}
+
+	void Track::runSurfaceTypes(std::vector<unsigned char>& previousLayerSurfaceTypes, unsigned int firstRow, unsigned int endRow)
+		/* Called by Terrain::generateSurfaceTypeData
+		 * Sets the terrain surface types for the track, in the rows of squares passed in
+		*/
+	{
+		const int halfTerrainSize = 0.5 * mTerrainSize_heightSamples;
+
+		imprintRows({ nullptr, previousLayerSurfaceTypes.data(), { -halfTerrainSize, -halfTerrainSize, mTerrainSize_heightSamples },
+			(int)firstRow - halfTerrainSize, (int)endRow - halfTerrainSize });
+	}
+
+	void Track::runTileHeights(std::vector<double>& previousLayerHeights, const TerrainRegion& tile) const
+		/* Called by Terrain::generateTile
+		*/
+	{
+		imprintRows({ previousLayerHeights.data(), nullptr, tile, tile.firstX, tile.firstX + (int)tile.samples });
+	}
+
+	void Track::runTileSurfaceTypes(std::vector<unsigned char>& previousLayerSurfaceTypes, const TerrainRegion& tile) const
+		/* Called by Terrain::generateTile
+		*/
+	{
+		imprintRows({ nullptr, previousLayerSurfaceTypes.data(), tile, tile.firstX, tile.firstX + (int)tile.samples });
+	}
+
+	unsigned long long Track::getConfigHash() const
+		/* Called by Terrain::Terrain
+		 * The track's shape (its angle graph) and the parameters it is laid out and imprinted with
+		*/
+	{
+		const unsigned int layout[3] = { mNumSamplesOverTotal, mWidth, mTerrainBorderPadding };
+
+		unsigned long long hash = hashBytes(FNV_OFFSET_BASIS, layout, sizeof(layout));
+		hash = hashBytes(hash, &mMaxDepth, sizeof(mMaxDepth));
+		return hashBytes(hash, mPoints_graph.data(), mPoints_graph.size() * sizeof(glm::dvec2));
+	}
+
+	void Track::findCentrelineSquares()
+		/* Called by Track::Track
+		 * Walks the full track, recording each terrain square the walk passes through, then sorts them by row (so
+		 * imprintRows can find those near a row by binary search) and drops those passed through more than once.
+		 * The positions walked through become the centreline
+		*/
+	{
+		const int halfTerrainSize = 0.5 * mTerrainSize_heightSamples;
 
 		int
 			currentX = 0,
@@ -46,17 +102,23 @@ namespace External {
 			positionTracker = mStartPosition,
 			currentDirection = mStartDirection;
 
+		const unsigned int stepCount = mNumSamplesOverTotal * mStepsPerSample;
+
+		std::vector<glm::dvec2> walked;
+		walked.reserve(stepCount);
+
 		//Iterate over the shape of the track by taking small steps along a changing direction vector
-		for (unsigned int i = 0; i < mNumSamplesOverTotal; i++) {
+		for (unsigned int i = 0; i < stepCount; i++) {
 
 			//Look up the angle of the 2D direction vector, clockwise from the -Z axis, at the current position on the track
-			currentAngle = lookUpAngleAtPercent_graph((double)i / (double)mNumSamplesOverTotal);
+			currentAngle = lookUpAngleAtPercent_graph((double)i / (double)stepCount);
 
 			//Create a direction (unit) vector using this angle
 			currentDirection = normalize(glm::rotate(mStartDirection, glm::radians(currentAngle)));
 
 			//Take a step along the vector
-			positionTracker += currentDirection * mPilotToMainScaleFactor;
+			positionTracker += currentDirection * (mPilotToMainScaleFactor / mStepsPerSample);
+			walked.push_back(positionTracker);
 
 			//If the track could sit inside the terrain at our position after taking this step...
 			if (
@@ -69,11 +131,9 @@ namespace External {
 				currentX = floor(positionTracker.x);
 				currentZ = floor(positionTracker.y);
 
-				//If this is different to the previous square...
+				//If this is different to the previous square, it is on the centreline
 				if (currentX != lastX || currentZ != lastZ) {
-
-					//...then imprint/'stamp' a circle with the track width as its diameter around this point and continue
-					imprintCircle(previousLayerHeights, currentX, currentZ);
+					mCentrelineSquares.push_back(glm::ivec2(currentX, currentZ));
 					lastX = currentX;
 					lastZ = currentZ;
 				}
@@ -81,16 +141,12 @@ namespace External {
 			else
 				continue;
 		}
-	}
 
-	void Track::runSurfaceTypes(std::vector<unsigned char>& previousLayerSurfaceTypes)
-		/* Called by Terrain::generateSurfaceTypeData
-		 * Sets the terrain surface types for the track
-		*/
-	{
-		//To avoid unnecessarily iterating over the track twice, mTempSurfaceTypes is filled DURING the height iteration and then
-		//just copied into previousLayerSurfaceTypes here.
-		previousLayerSurfaceTypes = mTempSurfaceTypes;
+		auto byRow = [](const glm::ivec2& a, const glm::ivec2& b) { return a.x < b.x || (a.x == b.x && a.y < b.y); };
+		std::sort(mCentrelineSquares.begin(), mCentrelineSquares.end(), byRow);
+		mCentrelineSquares.erase(std::unique(mCentrelineSquares.begin(), mCentrelineSquares.end()), mCentrelineSquares.end());
+
+		mCentreline = TrackCentreline(walked);
 	}
 
 	void Track::addAllPoints()
@@ -205,114 +261,153 @@ namespace External {
 			printf("ERROR: Point out of bounds: (%g, %g)\n", percent, angle);
 	}
 
-	double Track::lookUpAngleAtPercent_graph(double percent)
+	double Track::lookUpAngleAtPercent_graph(double percent) const
 		/* Called by
 		 * - Track::runPilotVersion
-		 * - Track::runHeights
+		 * - Track::findCentrelineSquares
 		 * Input: a percentage along the track, given between 0.0 and 1.0
 		 * Output: the angle of the tangent to the track at this percentage
+		 * The graph's points are in order of percentage, so the pair either side of it is found by binary search
 		*/
 	{
-		//Lower and upper bounds for interpolation are both points on the graph
-		glm::dvec2
-			behind,
-			ahead;
-
 		//Make sure that the track wraps round
 		if (percent < 0.0) percent += 1.0;
 		if (percent > 1.0) percent -= 1.0;
 
-		//Iterate over all points on the percentage-angle graph
-		for (unsigned int i = 0; i < mPoints_graph.size(); i++) {
-
-			//If there's a point on the graph with the exact target percentage...
-			if (mPoints_graph[i].x == percent) {
-
-				//... then no interpolation is required, and this can be returned directly.
-
-				unsigned int latest = 0;
+		//The first point at or beyond the target percentage
+		const std::vector<glm::dvec2>::const_iterator reached = std::lower_bound(mPoints_graph.begin(), mPoints_graph.end(), percent,
+			[](const glm::dvec2& point, double percent) { return point.x < percent; });
 
-				//Just check that there aren't any other more recent points with the same coordinate
-				for (unsigned int j = i; j < mPoints_graph.size(); j++) {
-					if (mPoints_graph[j].x == percent)
-						latest = j;
-				}
-
-				return mPoints_graph[latest].y;
-			}
-			//Just overshot the target point
-			else if (mPoints_graph[i].x > percent) {
+		if (reached == mPoints_graph.end())
+			return mPoints_graph.back().y;
 
-				//The point behind the current position
-				behind = mPoints_graph[i - 1];
+		//If there's a point on the graph with the exact target percentage, then no interpolation is required, and the
+		//latest point with that percentage can be returned directly
+		if (reached->x == percent)
+			return (std::upper_bound(reached, mPoints_graph.cend(), percent, [](double percent, const glm::dvec2& point) { return percent < point.x; }) - 1)->y;
 
-				//The point ahead of the current position
-				ahead = mPoints_graph[i];
+		//Lower and upper bounds for interpolation are the points either side of the target
+		glm::dvec2
+			behind = *(reached - 1),
+			ahead = *reached;
 
-				//Handle the fact that 0 degrees is the same as 360 degrees
-				if (behind.y == 360.0 && (360.0 - ahead.y >= 180.0))
-					behind.y = 0.0;
-				else if (ahead.y == 360.0 && (360.0 - behind.y >= 180.0) && (behind.y != 0.0))
-					ahead.y = 0.0;
+		//Handle the fact that 0 degrees is the same as 360 degrees
+		if (behind.y == 360.0 && (360.0 - ahead.y >= 180.0))
+			behind.y = 0.0;
+		else if (ahead.y == 360.0 && (360.0 - behind.y >= 180.0) && (behind.y != 0.0))
+			ahead.y = 0.0;
 
-				//Interpolate between points to return the answer
-				return behind.y + (ahead.y - behind.y) * ((percent - behind.x) / (ahead.x - behind.x));
-			}
-		}
+		//Interpolate between points to return the answer
+		return behind.y + (ahead.y - behind.y) * ((percent - behind.x) / (ahead.x - behind.x));
 	}
 
-	void Track::imprintCircle(std::vector<double>& toImprintHeights, int centreX, int centreZ)
-		/* Called by Track::runHeights
-		 * Imprints a circle with a diameter of mWidth, and centre (centreX, centreZ) in the terrain height data
+	void Track::imprintRows(const ImprintTarget& target) const
+		/* Called by
+		 * - Track::runHeights
+		 * - Track::runSurfaceTypes
+		 * - Track::runTileHeights
+		 * - Track::runTileSurfaceTypes
+		 * Imprints the track in the terrain heights and/or surface types of the target, within its rows. Every point
+		 * within half the track's width of a centreline square is visited once: along a row, the squared distance to
+		 * each nearby centreline square is a parabola in z, and the lower envelope of those parabolas gives each point's
+		 * nearest square. The points' depths give the track its 'bowl' shape, and the squares whose bottom left point
+		 * lies within the track become track
 		*/
 	{
 		const int
-			halfTerrainSize = floor(mTerrainSize_heightSamples * 0.5),
-			circleRadius = floor(0.5 * mWidth);
+			radius = floor(0.5 * mWidth),
+			radiusSquared = radius * radius,
+			lastSample = (int)target.buffer.samples - 1,
+			firstRow = std::max(target.firstRow, target.buffer.firstX),
+			endRow = std::min(target.endRow, target.buffer.firstX + (int)target.buffer.samples);
 
-		//X and Z need to be integer coordinates within the bounds of the heights array
-		int
-			targetX = 0,
-			targetZ = 0,
-			currentHeightIndex = 0;
+		//The centreline squares within reach of the current row, each as (z, squared distance along x)
+		std::vector<glm::ivec2> parabolas;
 
-		double
-			distToCircleCentre = 0.0, //The distance from the current point to the centre of the circle
-			circleWeighting = 0.0,    //A value between 0.0 and 1.0 describing the depth of the 'bowl' shape at a point
-			newHeight = 0.0;		  //Used to store the new height being added to the terrain
+		//The parabolas making up the lower envelope, and the z from which each is the lowest
+		std::vector<int> envelope;
+		std::vector<double> envelopeStarts;
 
-		//Iterate over a square of points around (centreX, centreZ)
-		for (int x = -circleRadius; x <= circleRadius; x++) {
-			for (int z = -circleRadius; z <= circleRadius; z++) {
+		auto crossing = [](const glm::ivec2& a, const glm::ivec2& b) {
+			return ((b.y + (double)b.x * b.x) - (a.y + (double)a.x * a.x)) / (2.0 * (b.x - a.x));
+		};
 
-				//Calculate the distance of the current point to the centre of the circle
-				distToCircleCentre = sqrt(pow(x, 2.0) + pow(z, 2.0));
+		std::vector<glm::ivec2>::const_iterator firstInReach = std::lower_bound(mCentrelineSquares.begin(), mCentrelineSquares.end(), firstRow - radius,
+			[](const glm::ivec2& square, int x) { return square.x < x; });
 
-				//If this distance is greater than the radius, then the point is outside the circle
-				if (distToCircleCentre > circleRadius)  continue;
+		for (int x = firstRow; x < endRow; x++) {
+			while (firstInReach != mCentrelineSquares.end() && firstInReach->x < x - radius)
+				++firstInReach;
 
-				//Otherwise, establish where the target point is on the terrain (given the position of the centre,
-				//and the position of the point relative to the centre).
-				targetX = centreX + x;
-				targetZ = centreZ + z;
+			parabolas.clear();
+			for (std::vector<glm::ivec2>::const_iterator square = firstInReach; square != mCentrelineSquares.end() && square->x <= x + radius; ++square)
+				parabolas.push_back(glm::ivec2(square->y, (x - square->x) * (x - square->x)));
+
+			if (parabolas.empty())
+				continue;
 
-				//Use these values to get the index into the height array of this point
-				currentHeightIndex = (targetX + halfTerrainSize) * mTerrainSize_heightSamples + (targetZ + halfTerrainSize);
+			//By z, keeping only the nearest square at each z
+			std::sort(parabolas.begin(), parabolas.end(), [](const glm::ivec2& a, const glm::ivec2& b) { return a.x < b.x || (a.x == b.x && a.y < b.y); });
+			parabolas.erase(std::unique(parabolas.begin(), parabolas.end(), [](const glm::ivec2& a, const glm::ivec2& b) { return a.x == b.x; }), parabolas.end());
 
-				//Check that this point is actually within the terrain
-				if (targetX >= -halfTerrainSize && targetX <= halfTerrainSize && targetZ >= -halfTerrainSize && targetZ <= halfTerrainSize) {
+			envelope.assign(1, 0);
+			envelopeStarts.assign(1, -std::numeric_limits<double>::infinity());
 
-					//This line is used to give the track a 'bowl' like shape, by calculating a depth based on the distance to the centre of the circle
-					circleWeighting = (1.0 - pow(distToCircleCentre / circleRadius, 3.0));
-					newHeight = circleWeighting * -mMaxDepth;
+			for (int i = 1; i < (int)parabolas.size(); i++) {
+				double start = crossing(parabolas[envelope.back()], parabolas[i]);
 
-					//Avoids a shape issue with overlapping circles
-					if (newHeight < toImprintHeights[currentHeightIndex])
-						toImprintHeights[currentHeightIndex] = newHeight;
+				while (start <= envelopeStarts.back()) {
+					envelope.pop_back();
+					envelopeStarts.pop_back();
+					start = crossing(parabolas[envelope.back()], parabolas[i]);
+				}
+
+				envelope.push_back(i);
+				envelopeStarts.push_back(start);
+			}
 
-					//Lastly, modify the surface types to represent the track
-					mTempSurfaceTypes[2 * (currentHeightIndex - halfTerrainSize - targetX)] = TerrainType::TARMAC;
-					mTempSurfaceTypes[2 * (currentHeightIndex - halfTerrainSize - targetX) + 1] = TerrainType::TARMAC;
+			const int targetX = x - target.buffer.firstX;
+
+			for (size_t i = 0; i < envelope.size(); i++) {
+				const glm::ivec2& parabola = parabolas[envelope[i]];
+				if (parabola.y > radiusSquared)
+					continue;
+
+				//The z within the track's width of the square, where it is the nearest, within the buffers
+				int halfChord = (int)sqrt((double)(radiusSquared - parabola.y));
+				while ((halfChord + 1) * (halfChord + 1) <= radiusSquared - parabola.y) halfChord++;
+				while (halfChord * halfChord > radiusSquared - parabola.y) halfChord--;
+
+				int
+					firstZ = std::max(parabola.x - halfChord, target.buffer.firstZ),
+					lastZ = std::min(parabola.x + halfChord, target.buffer.firstZ + lastSample);
+
+				if (i > 0)
+					firstZ = std::max(firstZ, (int)ceil(envelopeStarts[i]));
+				if (i + 1 < envelope.size())
+					lastZ = std::min(lastZ, (int)ceil(envelopeStarts[i + 1]) - 1);
+
+				for (int z = firstZ; z <= lastZ; z++) {
+					const int targetZ = z - target.buffer.firstZ;
+
+					if (target.heights) {
+						//The depth of the 'bowl' shape at the point, from its distance to the centreline
+						const double
+							distToCentreline = sqrt((double)(parabola.y + (z - parabola.x) * (z - parabola.x))),
+							weighting = (1.0 - pow(distToCentreline / radius, 3.0)),
+							newHeight = weighting * -mMaxDepth;
+
+						double& height = target.heights[(size_t)targetX * target.buffer.samples + targetZ];
+						if (newHeight < height)
+							height = newHeight;
+					}
+
+					//Lastly, modify the surface types to represent the track (the far edges have no square of their own)
+					if (target.surfaceTypes && targetX < lastSample && targetZ < lastSample) {
+						const size_t squareIndex = (size_t)targetX * lastSample + targetZ;
+						target.surfaceTypes[2 * squareIndex] = TerrainType::TARMAC;
+						target.surfaceTypes[2 * squareIndex + 1] = TerrainType::TARMAC;
+					}
 				}
 			}
 		}
@@ -378,12 +473,12 @@ namespace External {
 
 		//Calculate a starting position for the track that allows its bounding rectangle to fit within that of the terrain (square)
 		if (mPilotResults.shapeIsLandscape()) {
-			mStartPosition.x = completePadding + abs(lowerBound.x);
-			mStartPosition.y = completePadding + abs(lowerBound.y) + 0.5 * (terrainSize_units - (completePadding * 2.0) - dimensions.y);
+			mStartPosition.x = completePadding + std::abs(lowerBound.x);
+			mStartPosition.y = completePadding + std::abs(lowerBound.y) + 0.5 * (terrainSize_units - (completePadding * 2.0) - dimensions.y);
 		}
 		else {
-			mStartPosition.x = completePadding + abs(lowerBound.x) + 0.5 * (terrainSize_units - (completePadding * 2.0) - dimensions.x);
-			mStartPosition.y = completePadding + abs(lowerBound.y);
+			mStartPosition.x = completePadding + std::abs(lowerBound.x) + 0.5 * (terrainSize_units - (completePadding * 2.0) - dimensions.x);
+			mStartPosition.y = completePadding + std::abs(lowerBound.y);
 		}
 
 		mStartPosition -= glm::dvec2(0.5 * terrainSize_units);
@@ -0,0 +1,323 @@
+#include "TrackCentreline.h"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <glm/glm/common.hpp>
+#include <glm/glm/geometric.hpp>
+
+namespace External {
+
+	namespace {
+		//Of a direction in the horizontal plane, seen from above with +x to the right (as the car's space)
+		inline glm::dvec2 rightOf(glm::dvec2 direction) { return glm::dvec2(-direction.y, direction.x); }
+		inline double cross(glm::dvec2 a, glm::dvec2 b) { return a.x * b.y - a.y * b.x; }
+	}
+
+	TrackCentreline::TrackCentreline(const std::vector<glm::dvec2>& loop_world)
+		/* Called by Track::findCentrelineSquares
+		 * loop_world is the line's vertices in order, not repeating the first at the end. Vertices on top of the one
+		 * before are dropped
+		*/
+	{
+		mPositions_world.reserve(loop_world.size());
+		for (const glm::dvec2 position_world : loop_world)
+			if (mPositions_world.empty() || glm::length(position_world - mPositions_world.back()) > 1e-9)
+				mPositions_world.push_back(position_world);
+
+		if (mPositions_world.size() > 2 && glm::length(mPositions_world.front() - mPositions_world.back()) <= 1e-9)
+			mPositions_world.pop_back();
+
+		if (mPositions_world.size() < 2) {
+			mPositions_world.clear();
+			return;
+		}
+
+		const size_t count = mPositions_world.size();
+		mDistances.resize(count + 1);
+		mTangents_world.resize(count);
+		mCurvatures.resize(count);
+
+		mDistances[0] = 0.0;
+		for (size_t i = 0; i < count; i++)
+			mDistances[i + 1] = mDistances[i] + glm::length(mPositions_world[nextVertex(i)] - mPositions_world[i]);
+
+		//At each vertex, from the segments either side of it. The curvature is that of the circle through the vertex and
+		//its neighbours
+		for (size_t i = 0; i < count; i++) {
+			const size_t previous = i > 0 ? i - 1 : count - 1;
+			const glm::dvec2
+				behind = mPositions_world[i] - mPositions_world[previous],
+				ahead = mPositions_world[nextVertex(i)] - mPositions_world[i];
+			const double
+				behindLength = mDistances[previous + 1] - mDistances[previous],
+				aheadLength = mDistances[i + 1] - mDistances[i];
+
+			mTangents_world[i] = glm::normalize(behind / behindLength + ahead / aheadLength);
+			mCurvatures[i] = 2.0 * cross(behind, ahead) / (behindLength * aheadLength * glm::length(behind + ahead));
+		}
+
+		buildGrid();
+	}
+
+	TrackCentreline::Sample TrackCentreline::sampleAtDistance(double distance) const
+		/* Called by code following the track (e.g. LapTimer, AutoDriver)
+		*/
+	{
+		if (isEmpty())
+			return { glm::dvec2(0.0), glm::dvec2(0.0, -1.0), 0.0, 0.0, 0 };
+
+		const double wrapped = wrapDistance(distance);
+		const size_t segment = findSegment(wrapped);
+
+		return interpolate(segment, wrapped - mDistances[segment]);
+	}
+
+	TrackCentreline::Nearest TrackCentreline::findNearest(glm::dvec2 position_world) const
+		/* Called by code following the track (e.g. LapTimer, AutoDriver)
+		 * Each ring of cells around the position's cell holds the middle of every segment within (ring * CELL_SIZE -
+		 * half the longest segment) of the position, so once the nearest found so far is within that, the search is
+		 * over. Segments are compared by squared distance, and only the nearest is sampled
+		*/
+	{
+		if (isEmpty())
+			return { sampleAtDistance(0.0), 0.0 };
+
+		int cellX, cellZ;
+		findCell(position_world, cellX, cellZ);
+
+		size_t nearestSegment = 0;
+		double nearestDistanceSquared = std::numeric_limits<double>::infinity();
+
+		//Rings before the first to reach the grid are empty
+		const int
+			lastCellX = mGridCellsX - 1,
+			lastCellZ = mGridCellsZ - 1,
+			firstRing = std::max({ 0, -cellX, cellX - lastCellX, -cellZ, cellZ - lastCellZ }),
+			lastRing = std::max({ cellX, lastCellX - cellX, cellZ, lastCellZ - cellZ });
+
+		auto searchCell = [&](int x, int z) {
+			const size_t cell = (size_t)x * mGridCellsZ + z;
+
+			for (size_t i = mCellStarts[cell]; i < mCellStarts[cell + 1]; i++) {
+				const size_t segment = mCellSegments[i];
+				const double distanceSquared = calcDistanceSquared(position_world, segment);
+
+				if (distanceSquared < nearestDistanceSquared || (distanceSquared == nearestDistanceSquared && segment < nearestSegment)) {
+					nearestSegment = segment;
+					nearestDistanceSquared = distanceSquared;
+				}
+			}
+		};
+
+		for (int ring = firstRing; ring <= lastRing; ring++) {
+			for (int x = std::max(cellX - ring, 0); x <= std::min(cellX + ring, lastCellX); x++) {
+				if (abs(x - cellX) == ring) {
+					for (int z = std::max(cellZ - ring, 0); z <= std::min(cellZ + ring, lastCellZ); z++)
+						searchCell(x, z);
+				}
+				else {
+					if (cellZ - ring >= 0) searchCell(x, cellZ - ring);
+					if (cellZ + ring <= lastCellZ) searchCell(x, cellZ + ring);
+				}
+			}
+
+			const double searched = ring * CELL_SIZE - 0.5 * mLongestSegment;
+			if (searched > 0.0 && nearestDistanceSquared <= searched * searched)
+				break;
+		}
+
+		return findNearestOnSegment(position_world, nearestSegment);
+	}
+
+	TrackCentreline::Nearest TrackCentreline::findNearestOnSegment(glm::dvec2 position_world, size_t segment) const
+		/* Called by
+		 * - TrackCentreline::findNearest
+		 * - TrackCentreline::findNearestFrom
+		*/
+	{
+		const glm::dvec2
+			start = mPositions_world[segment],
+			direction = mPositions_world[nextVertex(segment)] - start;
+		const double
+			length = mDistances[segment + 1] - mDistances[segment],
+			along = glm::clamp(glm::dot(position_world - start, direction) / length, 0.0, length);
+
+		const Sample sample = interpolate(segment, along);
+		const glm::dvec2 offset = position_world - sample.position_world;
+
+		return { sample, glm::dot(offset, rightOf(direction)) < 0.0 ? -glm::length(offset) : glm::length(offset) };
+	}
+
+	TrackCentreline::Nearest TrackCentreline::findNearestFrom(glm::dvec2 position_world, size_t segment, double searchDistance) const
+		/* Called by code tracking a position along the line from one step to the next (e.g. LapTimer, AutoDriver)
+		 * From segment (the one nearest last step), moves along the line (forwards, or else backwards) for as long as
+		 * the next segment is nearer. A car moves a fraction of a segment per step, so this rarely tests more than three.
+		 * If that leaves the position further than searchDistance from the line, it may have been moved (or the search
+		 * stopped at a nearer part of the track than the one it is on), so the whole line is searched instead
+		*/
+	{
+		if (isEmpty())
+			return { sampleAtDistance(0.0), 0.0 };
+
+		const size_t segmentCount = getSegmentCount();
+		segment = std::min(segment, segmentCount - 1);
+
+		double distanceSquared = calcDistanceSquared(position_world, segment);
+
+		for (int direction : { 1, -1 }) {
+			size_t moves = 0;
+			while (moves < segmentCount) {
+				const size_t next = direction > 0 ? nextVertex(segment) : (segment == 0 ? segmentCount - 1 : segment - 1);
+
+				const double nextDistanceSquared = calcDistanceSquared(position_world, next);
+				if (nextDistanceSquared >= distanceSquared)
+					break;
+
+				segment = next;
+				distanceSquared = nextDistanceSquared;
+				moves++;
+			}
+
+			if (moves > 0)
+				break;
+		}
+
+		if (distanceSquared > searchDistance * searchDistance) {
+			const Nearest nearest = findNearest(position_world);
+			if (distanceSquared > nearest.lateralOffset * nearest.lateralOffset)
+				return nearest;
+		}
+
+		return findNearestOnSegment(position_world, segment);
+	}
+
+	double TrackCentreline::calcDistanceSquared(glm::dvec2 position_world, size_t segment) const
+		/* Called by
+		 * - TrackCentreline::findNearest
+		 * - TrackCentreline::findNearestFrom
+		 * From the nearest point of the segment: cheaper than findNearestOnSegment, for comparing segments
+		*/
+	{
+		const glm::dvec2
+			start = mPositions_world[segment],
+			direction = mPositions_world[nextVertex(segment)] - start,
+			fromStart = position_world - start,
+			offset = fromStart - direction * glm::clamp(glm::dot(fromStart, direction) / glm::dot(direction, direction), 0.0, 1.0);
+
+		return glm::dot(offset, offset);
+	}
+
+	size_t TrackCentreline::findSegment(double distance) const
+		/* Called by
+		 * - TrackCentreline::sampleAtDistance
+		 * - code following the track
+		 * Of a distance already within [0, getLength())
+		*/
+	{
+		const size_t vertex = std::upper_bound(mDistances.begin(), mDistances.end(), distance) - mDistances.begin();
+		return std::min(vertex == 0 ? 0 : vertex - 1, mPositions_world.size() - 1);
+	}
+
+	double TrackCentreline::wrapDistance(double distance) const
+		/* Called by
+		 * - TrackCentreline::sampleAtDistance
+		 * - code following the track
+		 * Into [0, getLength())
+		*/
+	{
+		const double length = getLength();
+		if (length <= 0.0)
+			return 0.0;
+
+		double wrapped = fmod(distance, length);
+		if (wrapped < 0.0)
+			wrapped += length;
+
+		return wrapped < length ? wrapped : 0.0;
+	}
+
+	size_t TrackCentreline::getBytes() const
+		/* Called by code reporting on the track
+		*/
+	{
+		return (mPositions_world.size() + mTangents_world.size()) * sizeof(glm::dvec2) + (mDistances.size() + mCurvatures.size()) * sizeof(double) +
+			(mCellStarts.size() + mCellSegments.size()) * sizeof(size_t);
+	}
+
+	void TrackCentreline::buildGrid()
+		/* Called by TrackCentreline::TrackCentreline
+		 * Covers the line's bounds. Each segment is listed in the cell its middle is in: first counted, then placed, so
+		 * each cell's segments are together in mCellSegments
+		*/
+	{
+		glm::dvec2
+			lowest = mPositions_world[0],
+			highest = mPositions_world[0];
+
+		for (const glm::dvec2 position_world : mPositions_world) {
+			lowest = glm::min(lowest, position_world);
+			highest = glm::max(highest, position_world);
+		}
+
+		mGridOrigin_world = lowest;
+		mGridCellsX = (int)floor((highest.x - lowest.x) / CELL_SIZE) + 1;
+		mGridCellsZ = (int)floor((highest.y - lowest.y) / CELL_SIZE) + 1;
+
+		std::vector<size_t> segmentCells(mPositions_world.size());
+		mCellStarts.assign((size_t)mGridCellsX * mGridCellsZ + 1, 0);
+		mLongestSegment = 0.0;
+
+		for (size_t segment = 0; segment < mPositions_world.size(); segment++) {
+			int cellX, cellZ;
+			findCell(0.5 * (mPositions_world[segment] + mPositions_world[nextVertex(segment)]), cellX, cellZ);
+
+			segmentCells[segment] = (size_t)std::min(std::max(cellX, 0), mGridCellsX - 1) * mGridCellsZ + std::min(std::max(cellZ, 0), mGridCellsZ - 1);
+			mCellStarts[segmentCells[segment] + 1]++;
+			mLongestSegment = std::max(mLongestSegment, mDistances[segment + 1] - mDistances[segment]);
+		}
+
+		for (size_t cell = 1; cell < mCellStarts.size(); cell++)
+			mCellStarts[cell] += mCellStarts[cell - 1];
+
+		std::vector<size_t> filled(mCellStarts.begin(), mCellStarts.end() - 1);
+		mCellSegments.resize(mPositions_world.size());
+		for (size_t segment = 0; segment < mPositions_world.size(); segment++)
+			mCellSegments[filled[segmentCells[segment]]++] = segment;
+	}
+
+	void TrackCentreline::findCell(glm::dvec2 position_world, int& cellX, int& cellZ) const
+		/* Called by
+		 * - TrackCentreline::findNearest
+		 * - TrackCentreline::buildGrid
+		 * The cell a position is in, whether or not it is within the grid
+		*/
+	{
+		const glm::dvec2 withinGrid = (position_world - mGridOrigin_world) / CELL_SIZE;
+		cellX = (int)std::max(std::min(floor(withinGrid.x), 1e9), -1e9);
+		cellZ = (int)std::max(std::min(floor(withinGrid.y), 1e9), -1e9);
+	}
+
+	TrackCentreline::Sample TrackCentreline::interpolate(size_t segment, double along) const
+		/* Called by
+		 * - TrackCentreline::sampleAtDistance
+		 * - TrackCentreline::findNearestOnSegment
+		 * The point along metres into a segment, between the tangents and curvatures of its ends
+		*/
+	{
+		const size_t next = nextVertex(segment);
+		const double
+			length = mDistances[segment + 1] - mDistances[segment],
+			fraction = length > 0.0 ? along / length : 0.0;
+
+		const glm::dvec2 tangent_world = mTangents_world[segment] + (mTangents_world[next] - mTangents_world[segment]) * fraction;
+
+		return {
+			mPositions_world[segment] + (mPositions_world[next] - mPositions_world[segment]) * fraction,
+			glm::length(tangent_world) > 0.0 ? glm::normalize(tangent_world) : (mPositions_world[next] - mPositions_world[segment]) / length,
+			mDistances[segment] + along,
+			mCurvatures[segment] + (mCurvatures[next] - mCurvatures[segment]) * fraction,
+			segment
+		};
+	}
+}
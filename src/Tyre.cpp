@@ -1,7 +1,10 @@
 #include "Tyre.h"
+#include "TyreForceTable.h"
 
 namespace Internal {
 
+	Tyre::ForceModel Tyre::mForceModel = Tyre::ForceModel::ANALYTIC;
+
 	Tyre::Tyre(double wheelRimRadius) :
 		/* Called by Wheel::Wheel
 		*/
@@ -18,6 +21,18 @@ namespace Internal {
 
 		mRollResistForce_long = wheelVelocity_wheel.y > 0.0 ? -mRollResistCoefficient * verticalLoad : wheelVelocity_wheel.y < 0.0 ? mRollResistCoefficient * verticalLoad : 0.0;
 
+		if (mForceModel == ForceModel::TABLE) {
+			const std::shared_ptr<const PacejkaParams>& params = mForceCalculator.updateParams();
+			if (!mForceTable || mForceTable->getParams() != params)
+				mForceTable = TyreForceTable::getFor(params);
+
+			double longitudinalForce, lateralForce;
+			mForceTable->lookup(verticalLoad, mSlip.getLongitudinal() * 100.0, mSlip.getAngle_degs(), camberAngle, longitudinalForce, lateralForce);
+			mTotalForce_wheel.x = lateralForce;
+			mTotalForce_wheel.y = longitudinalForce + mRollResistForce_long;
+			return;
+		}
+
 		mForceCalculator.updateForces(verticalLoad, mSlip.getLongitudinal() * 100.0, mSlip.getAngle_degs(), camberAngle);
 		mTotalForce_wheel.x = mForceCalculator.getLateralForce();
 		mTotalForce_wheel.y = mForceCalculator.getLongitudinalForce() + mRollResistForce_long;
@@ -0,0 +1,269 @@
+#include "TyreForceTable.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace Internal {
+
+	void TyreForceTable::Axis::configure(unsigned int samples, double max, double warpScale)
+		/* Called by TyreForceTable::build
+		*/
+	{
+		mSamples = samples;
+		mMax = max;
+		mWarpScale = warpScale;
+		mMaxU = warp(max);
+		mStepU = 2.0 * mMaxU / (samples - 1);
+	}
+
+	double TyreForceTable::Axis::valueAt(double index) const
+		/* Called by
+		 * - TyreForceTable::build
+		 * - TyreForceTable::measureMaxError
+		 * Inverse of warp, at a (possibly fractional) sample index
+		*/
+	{
+		return mWarpScale * std::sinh(-mMaxU + index * mStepU);
+	}
+
+	std::mutex TyreForceTable::mSharedMutex;
+	std::vector<std::weak_ptr<const TyreForceTable>> TyreForceTable::mShared;
+	TyreForceTable::Settings TyreForceTable::mSharedSettings;
+	std::atomic<unsigned int> TyreForceTable::mBuildCount(0);
+
+	TyreForceTable::TyreForceTable(std::shared_ptr<const PacejkaParams> params, const Settings& settings) :
+		/* Called by
+		 * - TyreForceTable::getFor
+		 * - code measuring other table sizes (e.g. tests)
+		*/
+		mParams(std::move(params)),
+		mSettings(settings)
+	{
+		mSettings.loadSamples = std::max(mSettings.loadSamples, 4u);
+		mSettings.slipSamples = std::max(mSettings.slipSamples, 4u);
+		mSettings.slipAngleSamples = std::max(mSettings.slipAngleSamples, 4u);
+
+		build();
+	}
+
+	std::shared_ptr<const TyreForceTable> TyreForceTable::getFor(const std::shared_ptr<const PacejkaParams>& params)
+		/* Called by
+		 * - Tyre::update
+		 * - VehicleBatch::updateTyreForces
+		 * Every tyre using the same parameter set shares one table, built (with the shared settings) by whichever
+		 * thread asks first. Tables nobody holds any more are forgotten
+		*/
+	{
+		std::lock_guard<std::mutex> lock(mSharedMutex);
+
+		for (const std::weak_ptr<const TyreForceTable>& shared : mShared)
+			if (std::shared_ptr<const TyreForceTable> table = shared.lock())
+				if (table->mParams == params)
+					return table;
+
+		mShared.erase(std::remove_if(mShared.begin(), mShared.end(), [](const std::weak_ptr<const TyreForceTable>& shared) { return shared.expired(); }), mShared.end());
+
+		std::shared_ptr<const TyreForceTable> table = std::make_shared<const TyreForceTable>(params, mSharedSettings);
+		mShared.push_back(table);
+
+		return table;
+	}
+
+	void TyreForceTable::setSharedSettings(const Settings& settings)
+		/* Called by code selecting the accuracy/cost trade-off (e.g. vds-run --tyre-table)
+		 * Applies to tables built by getFor from now on; tables already handed out keep their settings
+		*/
+	{
+		std::lock_guard<std::mutex> lock(mSharedMutex);
+		mSharedSettings = settings;
+		mShared.clear();
+	}
+
+	TyreForceTable::Settings TyreForceTable::getSharedSettings()
+		/* Called by code reporting the table configuration
+		*/
+	{
+		std::lock_guard<std::mutex> lock(mSharedMutex);
+		return mSharedSettings;
+	}
+
+	void TyreForceTable::lookup(double verticalLoad_N, double slipPercent, double slipAngle_degs, double camberAngle_degs, double& longitudinalForce, double& lateralForce) const
+		/* Called by
+		 * - Tyre::update
+		 * - TyreForceTable::evaluate
+		 * Drop-in replacement for PacejkaMagicFormula::updateForces
+		*/
+	{
+		const PacejkaParams& params = *mParams;
+		const double load_kN = verticalLoad_N / 1000.0;
+
+		//Outside the grids (the formula's own zero-load/zero-slip early-outs are kept exact)
+		if (camberAngle_degs != 0.0 || verticalLoad_N <= 0.0 || verticalLoad_N > mSettings.maxLoad_N) {
+			const PacejkaMagicFormula::LoadTerms terms = PacejkaMagicFormula::calcLoadTerms(params, load_kN);
+			longitudinalForce = PacejkaMagicFormula::calcLongitudinalForce(params, terms, slipPercent);
+			lateralForce = PacejkaMagicFormula::calcLateralForce(params, terms, slipAngle_degs, camberAngle_degs);
+			return;
+		}
+
+		if (slipPercent == 0.0)
+			longitudinalForce = 0.0;
+		else if (std::abs(slipPercent) <= mSlipAxis.mMax)
+			longitudinalForce = interpolate(mLongitudinalForces, mSlipAxis, verticalLoad_N, slipPercent);
+		else
+			longitudinalForce = PacejkaMagicFormula::calcLongitudinalForce(params, load_kN, slipPercent);
+
+		if (slipAngle_degs == 0.0)
+			lateralForce = 0.0;
+		else if (std::abs(slipAngle_degs) <= mSlipAngleAxis.mMax)
+			lateralForce = interpolate(mLateralForces, mSlipAngleAxis, verticalLoad_N, slipAngle_degs);
+		else
+			lateralForce = PacejkaMagicFormula::calcLateralForce(params, load_kN, slipAngle_degs, 0.0);
+	}
+
+	void TyreForceTable::evaluate(const double* verticalLoads_N, const double* slipPercents_0_to_100, const double* slipAngles_degs, const double* camberAngles_degs, size_t count, double* longitudinalForces, double* lateralForces) const
+		/* Called by VehicleBatch::updateTyreForces
+		 * Drop-in replacement for PacejkaMagicFormula::evaluate
+		*/
+	{
+		for (size_t i = 0; i < count; i++)
+			lookup(verticalLoads_N[i], slipPercents_0_to_100[i], slipAngles_degs[i], camberAngles_degs[i], longitudinalForces[i], lateralForces[i]);
+	}
+
+	TyreForceTable::MaxError TyreForceTable::measureMaxError() const
+		/* Called by code reporting the accuracy of the current tables (e.g. vds-run --tyre-table, tests)
+		 * Compares the interpolated force with the formula at the centre of every cell of both grids
+		 * Zero slip is skipped: the formula (and lookup) return exactly zero there, even when the shifts make the force
+		 * either side of it non-zero
+		*/
+	{
+		const PacejkaParams& params = *mParams;
+
+		MaxError error;
+		double
+			maxLongitudinal = 0.0,
+			maxLateral = 0.0;
+
+		for (double f : mLongitudinalForces)
+			maxLongitudinal = std::max(maxLongitudinal, std::abs(f));
+
+		for (double f : mLateralForces)
+			maxLateral = std::max(maxLateral, std::abs(f));
+
+		for (unsigned int i = 0; i + 1 < mSettings.loadSamples; i++) {
+			const double
+				load_N = (i + 0.5) * mLoadStep,
+				load_kN = load_N / 1000.0;
+
+			for (unsigned int j = 0; j + 1 < mSlipAxis.mSamples; j++) {
+				const double slipPercent = mSlipAxis.valueAt(j + 0.5);
+				if (slipPercent == 0.0)
+					continue;
+
+				error.longitudinal_N = std::max(error.longitudinal_N, std::abs(interpolate(mLongitudinalForces, mSlipAxis, load_N, slipPercent) - PacejkaMagicFormula::calcLongitudinalForce(params, load_kN, slipPercent)));
+			}
+
+			for (unsigned int j = 0; j + 1 < mSlipAngleAxis.mSamples; j++) {
+				const double slipAngle_degs = mSlipAngleAxis.valueAt(j + 0.5);
+				if (slipAngle_degs == 0.0)
+					continue;
+
+				error.lateral_N = std::max(error.lateral_N, std::abs(interpolate(mLateralForces, mSlipAngleAxis, load_N, slipAngle_degs) - PacejkaMagicFormula::calcLateralForce(params, load_kN, slipAngle_degs, 0.0)));
+			}
+		}
+
+		error.longitudinalRelative = maxLongitudinal > 0.0 ? error.longitudinal_N / maxLongitudinal : 0.0;
+		error.lateralRelative = maxLateral > 0.0 ? error.lateral_N / maxLateral : 0.0;
+
+		return error;
+	}
+
+	void TyreForceTable::build()
+		/* Called by TyreForceTable::TyreForceTable
+		 * Samples the formula (scalar path, so the tables do not depend on the CPU) at every grid node
+		*/
+	{
+		mSlipAxis.configure(mSettings.slipSamples, mSettings.maxSlipPercent, mSettings.slipWarpScale);
+		mSlipAngleAxis.configure(mSettings.slipAngleSamples, mSettings.maxSlipAngle_degs, mSettings.slipAngleWarpScale);
+		mLoadStep = mSettings.maxLoad_N / (mSettings.loadSamples - 1);
+
+		mLongitudinalForces.resize(mSettings.loadSamples * mSettings.slipSamples);
+		mLateralForces.resize(mSettings.loadSamples * mSettings.slipAngleSamples);
+
+		const PacejkaParams& params = *mParams;
+
+		for (unsigned int i = 0; i < mSettings.loadSamples; i++) {
+			const PacejkaMagicFormula::LoadTerms terms = PacejkaMagicFormula::calcLoadTerms(params, i * mLoadStep / 1000.0);
+
+			for (unsigned int j = 0; j < mSettings.slipSamples; j++)
+				mLongitudinalForces[i * mSettings.slipSamples + j] = PacejkaMagicFormula::calcLongitudinalForce(params, terms, mSlipAxis.valueAt(j));
+
+			for (unsigned int j = 0; j < mSettings.slipAngleSamples; j++)
+				mLateralForces[i * mSettings.slipAngleSamples + j] = PacejkaMagicFormula::calcLateralForce(params, terms, mSlipAngleAxis.valueAt(j), 0.0);
+		}
+
+		mBuildCount++;
+	}
+
+	double TyreForceTable::interpolate(const std::vector<double>& grid, const Axis& axis, double verticalLoad_N, double x) const
+		/* Called by
+		 * - TyreForceTable::lookup
+		 * - TyreForceTable::measureMaxError
+		 * Rows are load, columns are the (warped) slip axis
+		*/
+	{
+		const int
+			rows = (int)mSettings.loadSamples,
+			columns = (int)axis.mSamples;
+
+		const double
+			rowPosition = verticalLoad_N / mLoadStep,
+			columnPosition = (axis.warp(x) + axis.mMaxU) / axis.mStepU;
+
+		const int
+			row = std::min(std::max((int)rowPosition, 0), rows - 2),
+			column = std::min(std::max((int)columnPosition, 0), columns - 2);
+
+		const double
+			t = rowPosition - row,
+			s = columnPosition - column;
+
+		if (mSettings.interpolation == Interpolation::BILINEAR) {
+			const double
+				*lower = &grid[row * columns + column],
+				*upper = lower + columns,
+				lowerValue = lower[0] + (lower[1] - lower[0]) * s,
+				upperValue = upper[0] + (upper[1] - upper[0]) * s;
+
+			return lowerValue + (upperValue - lowerValue) * t;
+		}
+
+		//Catmull-Rom weights. Past the edges of the grid, ghost rows/columns are extrapolated linearly from the
+		//last two, which keeps the edge cells second order (repeating the edge value would make them first order)
+		const double
+			rowWeights[] = { ((-t + 2.0) * t - 1.0) * t * 0.5, ((3.0 * t - 5.0) * t * t + 2.0) * 0.5, ((-3.0 * t + 4.0) * t + 1.0) * t * 0.5, (t - 1.0) * t * t * 0.5 },
+			columnWeights[] = { ((-s + 2.0) * s - 1.0) * s * 0.5, ((3.0 * s - 5.0) * s * s + 2.0) * 0.5, ((-3.0 * s + 4.0) * s + 1.0) * s * 0.5, (s - 1.0) * s * s * 0.5 };
+
+		auto interpolateRow = [&](int sourceRow) {
+			const double* values = &grid[sourceRow * columns];
+			const double
+				inner0 = values[column],
+				inner1 = values[column + 1],
+				outer0 = column > 0 ? values[column - 1] : 2.0 * inner0 - inner1,
+				outer1 = column + 2 < columns ? values[column + 2] : 2.0 * inner1 - inner0;
+
+			return columnWeights[0] * outer0 + columnWeights[1] * inner0 + columnWeights[2] * inner1 + columnWeights[3] * outer1;
+		};
+
+		double rowValues[4];
+		rowValues[1] = interpolateRow(row);
+		rowValues[2] = interpolateRow(row + 1);
+		rowValues[0] = row > 0 ? interpolateRow(row - 1) : 2.0 * rowValues[1] - rowValues[2];
+		rowValues[3] = row + 2 < rows ? interpolateRow(row + 2) : 2.0 * rowValues[2] - rowValues[1];
+
+		const double result = rowWeights[0] * rowValues[0] + rowWeights[1] * rowValues[1] + rowWeights[2] * rowValues[2] + rowWeights[3] * rowValues[3];
+
+		return result;
+	}
+
+}
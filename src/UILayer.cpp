@@ -1,15 +1,19 @@
 #include <Framework/Physics/State.hpp>
+#include <cfloat>
+#include <cstdio>
 
 #include "UILayer.h"
 #include "Car.h"
 #include "Environment.h"
+#include "Profiler.h"
 
 namespace Visual {
 
-	UILayer::UILayer(Internal::Car& simDataSource, Framework::Graphics::Shader& carModelShader, CameraSystem& cameraSystem, float& simulationSpeedHandle, bool& debugModeHandle) :
+	UILayer::UILayer(Internal::Car& simDataSource, Internal::FrameStats& frameStats, Framework::Graphics::Shader& carModelShader, CameraSystem& cameraSystem, float& simulationSpeedHandle, bool& debugModeHandle) :
 		/* Called by VisualShell::load
 		*/
 		mDataSource(simDataSource),
+		mFrameStats(frameStats),
 		mCarModelShader(carModelShader),
 		mCameraSystem(cameraSystem),
 		mSimulationSpeedHandle(simulationSpeedHandle),
@@ -23,6 +27,9 @@ namespace Visual {
 		 * Renders all active ImGui windows
 		*/
 	{
+		VDS_PROFILE_SCOPE("UILayer::render");
+		Internal::FrameStats::ScopedTimer timer(mFrameStats, Internal::FrameStats::UI);
+
 		mainControlPanel();
 
 		if (mShowCarCustomise) carCustomisation();
@@ -30,6 +37,7 @@ namespace Visual {
 		if (mShowDebugMode_handle) carDebugInfo();
 		if (mShowHelpInfo) helpInfo();
 		if (mShowTyreParams) tyreParameters();
+		if (mShowPerformance) performancePanel();
 
 		upsideDownWarning();
 	}
@@ -55,7 +63,7 @@ namespace Visual {
 		using namespace ImGui;
 
 		SetNextWindowPos(ImVec2(0.0f, 0.0f));
-		SetNextWindowSize(ImVec2(235.0f, 425.0f));
+		SetNextWindowSize(ImVec2(235.0f, 445.0f));
 		Begin("Control panel", NULL, ImGuiWindowFlags_NoResize);
 		{
 			float childWidth = GetContentRegionAvailWidth();
@@ -98,7 +106,7 @@ namespace Visual {
 			}
 
 			Text("View");
-			BeginChild("View", ImVec2(childWidth, 185.0f), true);
+			BeginChild("View", ImVec2(childWidth, 205.0f), true);
 			{
 				Text("Windows");
 				Checkbox("Driver info panel", &mShowDriverInfo);
@@ -106,6 +114,7 @@ namespace Visual {
 				Checkbox("Car customisation panel", &mShowCarCustomise);
 				Checkbox("Help", &mShowHelpInfo);
 				Checkbox("Tyre parameters", &mShowTyreParams);
+				Checkbox("Performance", &mShowPerformance);
 
 				Separator();
 
@@ -391,36 +400,45 @@ namespace Visual {
 	void UILayer::tyreParameters() const
 		/* Called by UILayer::render
 		 * Enables individual tyre parameter alteration
+		 * Sliders edit a private copy of the published set; any change is published as a whole new set, which every
+		 * tyre following it picks up at its next update (tyres never read a set while it is being edited)
 		*/
 	{
 		using namespace ImGui;
 		using namespace Internal;
 
+		static PacejkaParams edited = *PacejkaParams::getPublished();
+		bool changed = false;
+
 		Begin("Pacejka magic formula parameters");
 
-		if (Button("Drifting tyres"))
-			PacejkaMagicFormula::setToDriftingTyreParams();
-		if (Button("Standard tyres"))
-			PacejkaMagicFormula::setToRoadTyreParams();
+		if (Button("Drifting tyres")) {
+			edited = PacejkaParams::driftingTyre();
+			changed = true;
+		}
+		if (Button("Standard tyres")) {
+			edited = PacejkaParams::roadTyre();
+			changed = true;
+		}
 
 		//Longitudinal
 		Text("Longitidinal parameters");
 		BeginChild("longitudinal params", ImVec2(0, 335.0f), true);
 		{
-			SliderFloat("b0 Shape factor", &PacejkaMagicFormula::b0, 1.4f, 1.8f);
-			SliderFloat("b1 Load influence on longitudinal friction coefficient", &PacejkaMagicFormula::b1, -80.0f, 80.0f);
-			SliderFloat("b2 Longitudinal friction coefficient", &PacejkaMagicFormula::b2, 900.0f, 1700.0f);
-			SliderFloat("b3 Curvature factor of stiffness/load", &PacejkaMagicFormula::b3, -20.0f, 20.0f);
-			SliderFloat("b4 Change of stiffness with slip", &PacejkaMagicFormula::b4, 100.0f, 500.0f);
-			SliderFloat("b5 Change of progressivity of stiffness/load", &PacejkaMagicFormula::b5, -1.0f, 1.0f);
-			SliderFloat("b6 Curvature change with load^2", &PacejkaMagicFormula::b6, -0.1f, 0.1f);
-			SliderFloat("b7 Curvature change with load", &PacejkaMagicFormula::b7, -1.0f, 1.0f);
-			SliderFloat("b8 Curvature factor", &PacejkaMagicFormula::b8, -20.0f, 1.0f);
-			SliderFloat("b9 Load influence on horizontal shift", &PacejkaMagicFormula::b9, -1.0f, 1.0f);
-			SliderFloat("b10 Horizontal shift", &PacejkaMagicFormula::b10, -5.0f, 5.0f);
-			SliderFloat("b11 Vertical shift", &PacejkaMagicFormula::b11, -100.0f, 100.0f);
-			SliderFloat("b12 Vertical shift at load = 0", &PacejkaMagicFormula::b12, -10.0f, 10.0f);
-			SliderFloat("b13 Curvature shift", &PacejkaMagicFormula::b13, -1.0f, 1.0f);
+			changed |= SliderFloat("b0 Shape factor", &edited.b0, 1.4f, 1.8f);
+			changed |= SliderFloat("b1 Load influence on longitudinal friction coefficient", &edited.b1, -80.0f, 80.0f);
+			changed |= SliderFloat("b2 Longitudinal friction coefficient", &edited.b2, 900.0f, 1700.0f);
+			changed |= SliderFloat("b3 Curvature factor of stiffness/load", &edited.b3, -20.0f, 20.0f);
+			changed |= SliderFloat("b4 Change of stiffness with slip", &edited.b4, 100.0f, 500.0f);
+			changed |= SliderFloat("b5 Change of progressivity of stiffness/load", &edited.b5, -1.0f, 1.0f);
+			changed |= SliderFloat("b6 Curvature change with load^2", &edited.b6, -0.1f, 0.1f);
+			changed |= SliderFloat("b7 Curvature change with load", &edited.b7, -1.0f, 1.0f);
+			changed |= SliderFloat("b8 Curvature factor", &edited.b8, -20.0f, 1.0f);
+			changed |= SliderFloat("b9 Load influence on horizontal shift", &edited.b9, -1.0f, 1.0f);
+			changed |= SliderFloat("b10 Horizontal shift", &edited.b10, -5.0f, 5.0f);
+			changed |= SliderFloat("b11 Vertical shift", &edited.b11, -100.0f, 100.0f);
+			changed |= SliderFloat("b12 Vertical shift at load = 0", &edited.b12, -10.0f, 10.0f);
+			changed |= SliderFloat("b13 Curvature shift", &edited.b13, -1.0f, 1.0f);
 		}
 		EndChild();
 
@@ -428,27 +446,30 @@ namespace Visual {
 		Text("Lateral parameters");
 		BeginChild("lateral params", ImVec2(0, 425.0f), true);
 		{
-			SliderFloat("a0 Shape factor", &PacejkaMagicFormula::a0, 1.2f, 1.8f);
-			SliderFloat("a1 Load influence on lateral friction coefficient", &PacejkaMagicFormula::a1, -80.0f, 80.0f);
-			SliderFloat("a2 Lateral friction coefficient", &PacejkaMagicFormula::a2, 900.0f, 1700.0f);
-			SliderFloat("a3 Change of stiffness with slip", &PacejkaMagicFormula::a3, 500.0f, 2000.0f);
-			SliderFloat("a4 Change of progressivity of stiffness / load", &PacejkaMagicFormula::a4, 0.0f, 50.0f);
-			SliderFloat("a5 Camber influence on stiffness", &PacejkaMagicFormula::a5, -0.1f, 1.0f);
-			SliderFloat("a6 Curvature change with load", &PacejkaMagicFormula::a6, -2.0f, 2.0f);
-			SliderFloat("a7 Curvature factor", &PacejkaMagicFormula::a7, -20.0f, 1.0f);
-			SliderFloat("a8 Load influence on horizontal shift", &PacejkaMagicFormula::a8, -1.0f, 1.0f);
-			SliderFloat("a9 Horizontal shift at load = 0 and camber = 0", &PacejkaMagicFormula::a9, -1.0f, 1.0f);
-			SliderFloat("a10 Camber influence on horizontal shift", &PacejkaMagicFormula::a10, -0.1f, 0.1f);
-			SliderFloat("a11 Vertical shift", &PacejkaMagicFormula::a11, -200.0f, 200.0f);
-			SliderFloat("a12 Vertical shift at load = 0", &PacejkaMagicFormula::a12, -10.0f, 10.0f);
-			SliderFloat("a13 Camber influence on vertical shift, load dependent	", &PacejkaMagicFormula::a13, -10.0f, 10.0f);
-			SliderFloat("a14 Camber influence on vertical shift", &PacejkaMagicFormula::a14, -15.0f, 15.0f);
-			SliderFloat("a15 Camber influence on lateral friction coefficient", &PacejkaMagicFormula::a15, -0.01f, 0.01f);
-			SliderFloat("a16 Curvature change with camber", &PacejkaMagicFormula::a16, -0.1f, 0.1f);
-			SliderFloat("a17 Curvature shift", &PacejkaMagicFormula::a17, -1.0f, 1.0f);
+			changed |= SliderFloat("a0 Shape factor", &edited.a0, 1.2f, 1.8f);
+			changed |= SliderFloat("a1 Load influence on lateral friction coefficient", &edited.a1, -80.0f, 80.0f);
+			changed |= SliderFloat("a2 Lateral friction coefficient", &edited.a2, 900.0f, 1700.0f);
+			changed |= SliderFloat("a3 Change of stiffness with slip", &edited.a3, 500.0f, 2000.0f);
+			changed |= SliderFloat("a4 Change of progressivity of stiffness / load", &edited.a4, 0.0f, 50.0f);
+			changed |= SliderFloat("a5 Camber influence on stiffness", &edited.a5, -0.1f, 1.0f);
+			changed |= SliderFloat("a6 Curvature change with load", &edited.a6, -2.0f, 2.0f);
+			changed |= SliderFloat("a7 Curvature factor", &edited.a7, -20.0f, 1.0f);
+			changed |= SliderFloat("a8 Load influence on horizontal shift", &edited.a8, -1.0f, 1.0f);
+			changed |= SliderFloat("a9 Horizontal shift at load = 0 and camber = 0", &edited.a9, -1.0f, 1.0f);
+			changed |= SliderFloat("a10 Camber influence on horizontal shift", &edited.a10, -0.1f, 0.1f);
+			changed |= SliderFloat("a11 Vertical shift", &edited.a11, -200.0f, 200.0f);
+			changed |= SliderFloat("a12 Vertical shift at load = 0", &edited.a12, -10.0f, 10.0f);
+			changed |= SliderFloat("a13 Camber influence on vertical shift, load dependent	", &edited.a13, -10.0f, 10.0f);
+			changed |= SliderFloat("a14 Camber influence on vertical shift", &edited.a14, -15.0f, 15.0f);
+			changed |= SliderFloat("a15 Camber influence on lateral friction coefficient", &edited.a15, -0.01f, 0.01f);
+			changed |= SliderFloat("a16 Curvature change with camber", &edited.a16, -0.1f, 0.1f);
+			changed |= SliderFloat("a17 Curvature shift", &edited.a17, -1.0f, 1.0f);
 		}
 		EndChild();
 		End();
+
+		if (changed)
+			PacejkaParams::publish(edited);
 	}
 
 	void UILayer::upsideDownWarning() const
@@ -458,7 +479,7 @@ namespace Visual {
 	{
 		glm::dvec3 carPosition_world = mDataSource.getState().getPosition_world();
 
-		double terrainHeight = External::Environment::mTerrain.getHeight(glm::dvec2(carPosition_world.x, carPosition_world.y));
+		double terrainHeight = mDataSource.getEnvironment().getTerrain().getHeight(glm::dvec2(carPosition_world.x, carPosition_world.y));
 
 		bool displayWarning =
 			glm::dvec3(mDataSource.getState().getLocalToWorld_direction() * glm::dvec4(0.0, 1.0, 0.0, 1.0)).y < 0.0
@@ -476,4 +497,68 @@ namespace Visual {
 		}
 	}
 
+	void UILayer::performancePanel()
+		/* Called by UILayer::render
+		 * Rolling histograms of the last FrameStats::FRAME_COUNT frames, with each phase's timings against its budget
+		*/
+	{
+		using namespace ImGui;
+		using Internal::FrameStats;
+
+		const FrameStats::Frame* frames = mFrameStats.getFrames();
+		const FrameStats::Frame& latest = mFrameStats.getLatest();
+		const int
+			count = (int)mFrameStats.getRecorded(),
+			offset = (int)mFrameStats.getOldest();
+
+		char overlay[32];
+
+		Begin("Performance");
+		{
+			Text("Physics steps per frame");
+			snprintf(overlay, sizeof(overlay), "%.0f", latest.physicsSteps);
+			PlotHistogram("##Physics steps", &frames->physicsSteps, count, offset, overlay, 0.0f, FLT_MAX, ImVec2(0.0f, 40.0f), sizeof(FrameStats::Frame));
+
+			performance_phaseTiming("Physics", FrameStats::PHYSICS, &frames->physics, count, offset);
+			performance_phaseTiming("Render", FrameStats::RENDER, &frames->render, count, offset);
+			performance_phaseTiming("UI", FrameStats::UI, &frames->ui, count, offset);
+			performance_phaseTiming("Frame", FrameStats::FRAME, &frames->frame, count, offset);
+
+			Text("Allocations per frame");
+			snprintf(overlay, sizeof(overlay), "%.0f", latest.allocations);
+			PlotHistogram("##Allocations", &frames->allocations, count, offset, overlay, 0.0f, FLT_MAX, ImVec2(0.0f, 40.0f), sizeof(FrameStats::Frame));
+
+			if (Button("Clear"))
+				mFrameStats.clear();
+		}
+		End();
+	}
+
+	void UILayer::performance_phaseTiming(const char* name, Internal::FrameStats::Phase phase, const float* values, int count, int offset)
+		/* Called by UILayer::performancePanel
+		 * Histogram of one phase's ms per frame, scaled so its budget is half way up, and shown red while its p99 is over budget
+		*/
+	{
+		using namespace ImGui;
+
+		const Internal::FrameStats::Summary summary = mFrameStats.summarise(phase);
+		const float budget = mFrameStats.getBudget(phase);
+
+		char label[32];
+
+		Separator();
+		if (summary.p99 > budget)
+			TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "%s: %u of %d frames over budget", name, summary.overBudget, count);
+		else
+			Text("%s: %u of %d frames over budget", name, summary.overBudget, count);
+
+		snprintf(label, sizeof(label), "##%s", name);
+		PlotHistogram(label, values, count, offset, NULL, 0.0f, budget * 2.0f, ImVec2(0.0f, 40.0f), sizeof(Internal::FrameStats::Frame));
+
+		Text("p50 %.2f  p99 %.2f  max %.2f ms", summary.p50, summary.p99, summary.max);
+
+		snprintf(label, sizeof(label), "Budget (ms)##%s", name);
+		DragFloat(label, mFrameStats.getBudgetHandle(phase), 0.1f, 0.1f, 100.0f);
+	}
+
 }
\ No newline at end of file
@@ -0,0 +1,693 @@
+#include "VehicleBatch.h"
+#include "Car.h"
+#include "Environment.h"
+#include "TyreForceTable.h"
+#include "DriverInputs.h"
+
+#include <limits>
+#include <glm/glm/gtx/rotate_vector.hpp>
+#include <glm/glm/gtc/matrix_transform.hpp>
+
+namespace Internal {
+
+	size_t VehicleBatch::addVehicle(Car& source)
+		/* Called by code that owns the batch, once per vehicle, before stepping
+		 * Copies the configuration and the current physical state of a fully assembled Car
+		 * Returns the index of the new vehicle
+		*/
+	{
+		using namespace glm;
+
+		const size_t vehicle = size();
+
+		Framework::Physics::State& state = source.getState();
+		WheelSystem& wheelSystem = source.getWheelSystem();
+		ControlSystem& controlSystem = source.getControlSystem();
+		TorqueGenerator& torqueGenerator = source.getTorqueGenerator();
+
+		//Chassis
+		mPosition_world.push_back(state.getPosition_world());
+		mMomentum_world.push_back(state.getMomentum_world());
+		mAngularMomentum_world.push_back(state.getAngularMomentum_world());
+		mOrientation_world.push_back(state.getOrientation_world());
+
+		mVelocity_world.push_back(state.getVelocity_world());
+		mAngularVelocity_world.push_back(state.getAngularVelocity_world());
+		mAcceleration_world.push_back(source.getAcceleration_world());
+		mAerodynamicDrag_world.push_back(source.getAeroDrag_world());
+		mWheelForce_world.push_back(wheelSystem.getTotalForce_world());
+		mWheelTorque_world.push_back(wheelSystem.getTotalTorque_world());
+
+		mLocalToWorld_position.push_back(state.getLocalToWorld_position());
+		mLocalToWorld_direction.push_back(state.getLocalToWorld_direction());
+		mWorldToLocal_direction.push_back(state.getWorldToLocal_direction());
+
+		mMass.push_back(state.getMass().getValue());
+		mFrontalArea.push_back(source.getFrontalArea());
+		mDragCoefficient.push_back(source.getDragCoefficient());
+		mMassCentre_car.push_back(state.getMass().getCentre());
+		mInverseInertiaTensor_local.push_back(inverse(state.getInertiaTensor_local()));
+		mEnvironment.push_back(source.getSharedEnvironment());
+
+		//Wheel system geometry
+		mWheelBase.push_back(wheelSystem.getWheelBase());
+		mFrontAxleLength.push_back(wheelSystem.getAxle(WheelSystem::FRONT).getLength());
+		mRearAxleLength.push_back(wheelSystem.getAxle(WheelSystem::REAR).getLength());
+		mFrontAxleLongDisplacement.push_back(wheelSystem.getAxle(WheelSystem::FRONT).getLongDisplacement_car());
+		mRearAxleLongDisplacement.push_back(wheelSystem.getAxle(WheelSystem::REAR).getLongDisplacement_car());
+
+		//Driver controls
+		mSteeringWheelAngle.push_back(controlSystem.getSteeringWheelAngle());
+		mSteeringRatio.push_back(controlSystem.getSteeringRatio());
+		mMaxAbsSteeringWheelAngle.push_back(controlSystem.getMaxAbsSteeringWheelAngle());
+		mThrottle.push_back(torqueGenerator.getThrottle());
+
+		//Torque generator and axles
+		mMaxForwardTorque.push_back(torqueGenerator.getMaxOutputForwardTorque());
+		mMaxReverseTorque.push_back(torqueGenerator.getMaxOutputReverseTorque());
+		mGeneratorRPM.push_back(torqueGenerator.getRPM());
+		mGeneratorTorque.push_back(torqueGenerator.getOutputTorque());
+		mFrontAxleTorque.push_back(wheelSystem.getAxle(WheelSystem::FRONT).getTransferredTorque());
+		mRearAxleTorque.push_back(wheelSystem.getAxle(WheelSystem::REAR).getTransferredTorque());
+		mReverseMode.push_back(torqueGenerator.reverseModeOn());
+
+		//Wheels, in WheelSystem index order
+		for (unsigned char i = 0; i < mWheelsPerVehicle; i++) {
+			WheelInterface& wheelInterface = *wheelSystem.getWheelInterface(i);
+			Wheel& wheel = wheelInterface.getWheel();
+			Tyre& tyre = wheel.getTyre();
+			Framework::Physics::Spring& spring = wheelInterface.getSuspension().getSpring();
+
+			mInterfacePosition_car.push_back(wheelInterface.getPosition_car());
+			mWheelPosition_car.push_back(wheel.getPosition_car());
+			mWheelPosition_world.push_back(wheelInterface.getPosition_world());
+			mWheelVelocity_world.push_back(wheelInterface.getVelocity_world());
+			mWheelVelocity_car.push_back(wheelSystem.getKinematics(i).velocity_car);
+			mSuspensionForce_world.push_back(wheelInterface.getSuspension().getForce_world());
+			mTyreForce_world.push_back(wheel.getTyreForce_world());
+			mTerrainNormal_world.push_back(glm::dvec3(0.0, 1.0, 0.0));
+			mTyreForce_wheel.push_back(tyre.getTotalForce_wheel());
+
+			mAngularAcceleration.push_back(wheel.getAngularAcceleration());
+			mAngularVelocity.push_back(wheel.getAngularVelocity());
+			mAngularPosition.push_back(wheel.getAngularPosition());
+			mSteeringAngle.push_back(wheel.getSteeringAngle());
+			mBrakeTravel.push_back(wheelInterface.getBrake().getTravelPercentage());
+			mBrakeTorque.push_back(wheelInterface.getBrake().getTorqueMagnitude());
+			mSpringConstant.push_back(spring.getSpringConstant());
+			mDamping.push_back(spring.getDamping());
+			mSpringRestLength.push_back(spring.getRestLength());
+			mSpringLength.push_back(spring.getCurrentLength());
+			mSpringForce.push_back(spring.getForce());
+			mLoad.push_back(wheelInterface.getLoad());
+			mSlipLongitudinal.push_back(tyre.getSlip().getLongitudinal());
+			mSlipAngle.push_back(tyre.getSlip().getAngle_degs());
+			mRimRadius.push_back(wheel.getRimRadius());
+			mTyreDepth.push_back(tyre.getDepth());
+			mAxialInertia.push_back(tyre.getAxialInertia());
+			mRollResistCoefficient.push_back(tyre.getRollResistCoefficient());
+			mRollResistForce.push_back(0.0);
+			mCamberAngle.push_back(0.0);
+			mTyreSlipPercent.push_back(tyre.getSlip().getLongitudinal() * 100.0);
+			mTyreLongitudinalForce.push_back(tyre.getForceCalculator().getLongitudinalForce());
+			mTyreLateralForce.push_back(tyre.getForceCalculator().getLateralForce());
+
+			mRotationDirection.push_back(wheel.getRotationDirection());
+			mCollisionRegistered.push_back(wheelInterface.collisionRegistered());
+			mSurfaceType.push_back(wheelInterface.getSurfaceType());
+
+			mTyreParams.push_back(tyre.getForceCalculator().getParams());
+			mTyreFollowsPublished.push_back(tyre.getForceCalculator().followsPublishedParams());
+		}
+
+		mTyreParamsStale = true;
+
+		return vehicle;
+	}
+
+	void VehicleBatch::reserve(size_t vehicleCount)
+		/* Called by code that owns the batch, before adding vehicles
+		*/
+	{
+		const size_t wheelCount = vehicleCount * mWheelsPerVehicle;
+
+		for (std::vector<glm::dvec3>* v : { &mPosition_world, &mMomentum_world, &mAngularMomentum_world, &mVelocity_world, &mAngularVelocity_world,
+			&mAcceleration_world, &mAerodynamicDrag_world, &mWheelForce_world, &mWheelTorque_world, &mMassCentre_car })
+			v->reserve(vehicleCount);
+
+		for (std::vector<double>* v : { &mMass, &mFrontalArea, &mDragCoefficient, &mWheelBase, &mFrontAxleLength, &mRearAxleLength,
+			&mFrontAxleLongDisplacement, &mRearAxleLongDisplacement, &mSteeringWheelAngle, &mSteeringRatio, &mMaxAbsSteeringWheelAngle,
+			&mThrottle, &mMaxForwardTorque, &mMaxReverseTorque, &mGeneratorRPM, &mGeneratorTorque, &mFrontAxleTorque, &mRearAxleTorque })
+			v->reserve(vehicleCount);
+
+		for (std::vector<glm::dmat4>* v : { &mLocalToWorld_position, &mLocalToWorld_direction, &mWorldToLocal_direction })
+			v->reserve(vehicleCount);
+
+		mOrientation_world.reserve(vehicleCount);
+		mInverseInertiaTensor_local.reserve(vehicleCount);
+		mEnvironment.reserve(vehicleCount);
+		mReverseMode.reserve(vehicleCount);
+
+		for (std::vector<glm::dvec3>* v : { &mTerrainNormal_world, &mInterfacePosition_car, &mWheelPosition_car, &mWheelPosition_world, &mWheelVelocity_world, &mWheelVelocity_car,
+			&mSuspensionForce_world, &mTyreForce_world })
+			v->reserve(wheelCount);
+
+		for (std::vector<double>* v : { &mAngularAcceleration, &mAngularVelocity, &mAngularPosition, &mSteeringAngle, &mBrakeTravel,
+			&mBrakeTorque, &mSpringConstant, &mDamping, &mSpringRestLength, &mSpringLength, &mSpringForce, &mLoad, &mSlipLongitudinal,
+			&mSlipAngle, &mRimRadius, &mTyreDepth, &mAxialInertia, &mRollResistCoefficient, &mRollResistForce, &mCamberAngle,
+			&mTyreSlipPercent, &mTyreLongitudinalForce, &mTyreLateralForce })
+			v->reserve(wheelCount);
+
+		mTyreForce_wheel.reserve(wheelCount);
+		mRotationDirection.reserve(wheelCount);
+		mCollisionRegistered.reserve(wheelCount);
+		mSurfaceType.reserve(wheelCount);
+		mTyreParams.reserve(wheelCount);
+		mTyreFollowsPublished.reserve(wheelCount);
+	}
+
+	void VehicleBatch::step(double dt)
+		/* Called by code that owns the batch
+		 * Advances every vehicle by dt seconds, in the same order as Car::update
+		*/
+	{
+		updateSteeringAngles();
+		updateTorqueGenerators();
+		updateAxles();
+		updateWheels(dt);
+		updateTyreForces();
+		updateWheelTotals();
+		integrate(dt);
+		positionConstraints();
+	}
+
+	void VehicleBatch::setSteeringWheelAngle(size_t vehicle, double angle)
+		/* Equivalent of ControlSystem::setSteeringWheelAngle
+		*/
+	{
+		const double maxAbsAngle = mMaxAbsSteeringWheelAngle[vehicle];
+		mSteeringWheelAngle[vehicle] = angle > maxAbsAngle ? maxAbsAngle : angle < -maxAbsAngle ? -maxAbsAngle : angle;
+	}
+
+	void VehicleBatch::setBrakeTravel(size_t vehicle, double travelPercentage)
+		/* Equivalent of ControlSystem::setBrakeTravel
+		*/
+	{
+		for (size_t w = vehicle * mWheelsPerVehicle; w < (vehicle + 1) * mWheelsPerVehicle; w++)
+			mBrakeTravel[w] = travelPercentage < 0.0 ? 0.0 : travelPercentage > 1.0 ? 1.0 : travelPercentage;
+	}
+
+	void VehicleBatch::applyInputs(size_t vehicle, const DriverInputs& inputs, double dt)
+		/* Equivalent of ControlSystem::applyInputs, before each step
+		 * The reset event is not acted on: a vehicle of the batch stays where it is
+		*/
+	{
+		setSteeringWheelAngle(vehicle, inputs.steerByRate ? mSteeringWheelAngle[vehicle] + inputs.steeringWheelRate * dt : inputs.steeringWheelAngle);
+		setThrottle(vehicle, inputs.throttle);
+		setBrakeTravel(vehicle, inputs.brake);
+
+		if (inputs.toggleReverse)
+			toggleReverse(vehicle);
+	}
+
+	void VehicleBatch::setMass(size_t vehicle, double mass)
+		/* Equivalent of the mass setup in Car::assemble
+		*/
+	{
+		mMass[vehicle] = mass;
+		mInverseInertiaTensor_local[vehicle] = glm::inverse(glm::dmat3(mass));
+		recalcSecondary(vehicle);
+	}
+
+	void VehicleBatch::setSuspension(size_t vehicle, double springConstant, double damping)
+		/* Applies the same spring to all four wheels of a vehicle
+		*/
+	{
+		for (size_t w = vehicle * mWheelsPerVehicle; w < (vehicle + 1) * mWheelsPerVehicle; w++) {
+			mSpringConstant[w] = springConstant;
+			mDamping[w] = damping;
+		}
+	}
+
+	void VehicleBatch::setTyreParams(size_t vehicle, std::shared_ptr<const PacejkaParams> params)
+		/* Equivalent of Car::setTyreParams: nullptr puts all four tyres back on the published parameter set
+		*/
+	{
+		for (size_t w = vehicle * mWheelsPerVehicle; w < (vehicle + 1) * mWheelsPerVehicle; w++) {
+			mTyreParams[w] = params;
+			mTyreFollowsPublished[w] = !params;
+		}
+
+		mTyreParamsStale = true;
+	}
+
+	void VehicleBatch::updateSteeringAngles()
+		/* Called by VehicleBatch::step
+		 * Equivalent of ControlSystem::update
+		*/
+	{
+		for (size_t v = 0; v < size(); v++) {
+			const size_t frontLeft = v * mWheelsPerVehicle;
+			ControlSystem::calcWheelAngles(mSteeringWheelAngle[v], mSteeringRatio[v], mWheelBase[v], mFrontAxleLength[v], mSteeringAngle[frontLeft], mSteeringAngle[frontLeft + 1]);
+		}
+	}
+
+	void VehicleBatch::updateTorqueGenerators()
+		/* Called by VehicleBatch::step
+		 * Equivalent of TorqueGenerator::update, using the RPM from the previous step
+		*/
+	{
+		for (size_t v = 0; v < size(); v++)
+			mGeneratorTorque[v] = TorqueGenerator::calcOutputTorque(mGeneratorRPM[v], mThrottle[v], mReverseMode[v] != 0, mMaxForwardTorque[v], mMaxReverseTorque[v]);
+	}
+
+	void VehicleBatch::updateAxles()
+		/* Called by VehicleBatch::step
+		 * Equivalent of WheelSystem::updateAxles, with the torque generator on the rear axle (as in Car::assemble)
+		*/
+	{
+		for (size_t v = 0; v < size(); v++) {
+			const size_t
+				frontLeft = v * mWheelsPerVehicle,
+				frontRight = frontLeft + 1,
+				rearLeft = frontLeft + 2,
+				rearRight = frontLeft + 3;
+
+			double
+				frontAxleCounterTorque = 0.0,
+				rearAxleCounterTorque = 0.0;
+
+			//Front axle
+			frontAxleCounterTorque += mBrakeTorque[frontLeft] * -mRotationDirection[frontLeft];
+			frontAxleCounterTorque += mBrakeTorque[frontRight] * -mRotationDirection[frontRight];
+			frontAxleCounterTorque += mTyreForce_wheel[frontRight].y * (mRimRadius[frontRight] + mTyreDepth[frontRight]);
+			frontAxleCounterTorque += mTyreForce_wheel[frontLeft].y * (mRimRadius[frontRight] + mTyreDepth[frontRight]);
+
+			mFrontAxleTorque[v] = 0.0;
+			mFrontAxleTorque[v] += frontAxleCounterTorque;
+
+			//Rear axle
+			rearAxleCounterTorque += mBrakeTorque[rearLeft] * -mRotationDirection[rearLeft];
+			rearAxleCounterTorque += mBrakeTorque[rearRight] * -mRotationDirection[rearRight];
+			rearAxleCounterTorque += mTyreForce_wheel[rearRight].y * (mRimRadius[rearRight] + mTyreDepth[rearRight]);
+			rearAxleCounterTorque += mTyreForce_wheel[rearLeft].y * (mRimRadius[rearLeft] + mTyreDepth[rearLeft]);
+
+			mGeneratorRPM[v] = std::max(mAngularVelocity[rearLeft] / glm::two_pi<double>(), mAngularVelocity[rearRight] / glm::two_pi<double>()) * 60.0;
+
+			mRearAxleTorque[v] = 0.0;
+			mRearAxleTorque[v] -= mGeneratorTorque[v];
+			mRearAxleTorque[v] += rearAxleCounterTorque;
+		}
+	}
+
+	void VehicleBatch::updateWheels(double dt)
+		/* Called by VehicleBatch::step
+		 * Equivalent of WheelSystem::updateAllWheelInterfaces
+		*/
+	{
+		using namespace glm;
+
+		dvec2 wheelPositions_world[mWheelsPerVehicle];
+		External::Terrain::Contact terrainContacts[mWheelsPerVehicle];
+
+		for (size_t v = 0; v < size(); v++) {
+			const dvec3 carAcceleration_car = dvec3(mWorldToLocal_direction[v] * dvec4(mAcceleration_world[v], 1.0));
+			const double carCMHeightAboveGround = recalcCarCmHeightAboveGround(v);
+
+			//Equivalent of WheelSystem::updateKinematics
+			const dmat4& localToWorld_position = mLocalToWorld_position[v];
+			const dvec3 massCentre_world = dvec3(localToWorld_position * dvec4(mMassCentre_car[v], 1.0));
+
+			for (unsigned char i = 0; i < mWheelsPerVehicle; i++) {
+				const size_t wheel = v * mWheelsPerVehicle + i;
+
+				mWheelPosition_world[wheel] = dvec3(localToWorld_position * dvec4(mInterfacePosition_car[wheel], 1.0));
+				mWheelVelocity_world[wheel] = mVelocity_world[v] + cross(mAngularVelocity_world[v], mWheelPosition_world[wheel] - massCentre_world);
+				mWheelVelocity_car[wheel] = dvec3(mWorldToLocal_direction[v] * dvec4(mWheelVelocity_world[wheel], 1.0));
+				wheelPositions_world[i] = dvec2(mWheelPosition_world[wheel].x, mWheelPosition_world[wheel].z);
+			}
+
+			mEnvironment[v]->getTerrain().sampleContacts(wheelPositions_world, mWheelsPerVehicle, terrainContacts);
+
+			for (unsigned char i = 0; i < mWheelsPerVehicle; i++)
+				updateWheelInterface(v, v * mWheelsPerVehicle + i, recalcLoad(v, i, carAcceleration_car, carCMHeightAboveGround), terrainContacts[i], dt);
+		}
+	}
+
+	void VehicleBatch::updateTyreParams()
+		/* Called by VehicleBatch::updateTyreForces
+		 * Equivalent of PacejkaMagicFormula::updateParams, for every wheel that follows the published set
+		*/
+	{
+		const unsigned int publishedVersion = PacejkaParams::getPublishedVersion();
+
+		if (!mTyreParamsStale && publishedVersion == mPublishedVersion)
+			return;
+
+		const std::shared_ptr<const PacejkaParams> published = PacejkaParams::getPublished();
+
+		for (size_t w = 0; w < mTyreParams.size(); w++)
+			if (mTyreFollowsPublished[w])
+				mTyreParams[w] = published;
+
+		mPublishedVersion = publishedVersion;
+		mTyreParamsStale = false;
+	}
+
+	void VehicleBatch::updateTyreForces()
+		/* Called by VehicleBatch::step
+		 * Second half of Tyre::update and Wheel::update, for every wheel at once
+		 * No wheel's tyre force feeds into another wheel's update within a step, so evaluating them all after
+		 * VehicleBatch::updateWheels gives the same result as evaluating each one inside it
+		*/
+	{
+		const size_t wheelCount = mLoad.size();
+
+		updateTyreParams();
+
+		for (size_t first = 0, last; first < wheelCount; first = last) {
+			const std::shared_ptr<const PacejkaParams>& params = mTyreParams[first];
+
+			for (last = first + 1; last < wheelCount && mTyreParams[last] == params; last++);
+
+			const size_t count = last - first;
+
+			if (Tyre::getForceModel() == Tyre::ForceModel::TABLE) {
+				if (!mForceTable || mForceTable->getParams() != params)
+					mForceTable = TyreForceTable::getFor(params);
+
+				mForceTable->evaluate(&mLoad[first], &mTyreSlipPercent[first], &mSlipAngle[first], &mCamberAngle[first], count, &mTyreLongitudinalForce[first], &mTyreLateralForce[first]);
+			}
+			else
+				PacejkaMagicFormula::evaluate(*params, &mLoad[first], &mTyreSlipPercent[first], &mSlipAngle[first], &mCamberAngle[first], count, &mTyreLongitudinalForce[first], &mTyreLateralForce[first]);
+		}
+
+		for (size_t w = 0; w < wheelCount; w++) {
+			mTyreForce_wheel[w].x = mTyreLateralForce[w];
+			mTyreForce_wheel[w].y = mTyreLongitudinalForce[w] + mRollResistForce[w];
+
+			updateTyreForce_world(w / mWheelsPerVehicle, w, mTerrainNormal_world[w]);
+		}
+	}
+
+	void VehicleBatch::updateWheelTotals()
+		/* Called by VehicleBatch::step
+		 * Equivalent of WheelSystem::updateTotalForce_world and WheelSystem::updateTotalTorque_world
+		*/
+	{
+		using namespace glm;
+
+		for (size_t v = 0; v < size(); v++) {
+			const size_t firstWheel = v * mWheelsPerVehicle;
+
+			mWheelForce_world[v] = dvec3(0.0);
+
+			for (size_t w = firstWheel; w < firstWheel + mWheelsPerVehicle; w++) {
+				mWheelForce_world[v] += mSuspensionForce_world[w];
+				mWheelForce_world[v] += mTyreForce_world[w];
+			}
+
+			mWheelTorque_world[v] = dvec3(0.0);
+
+			for (size_t w = firstWheel; w < firstWheel + mWheelsPerVehicle; w++) {
+				const dvec3 contactPatchPosition_car = mWheelPosition_car[w] - dvec3(0.0, mRimRadius[w] + mTyreDepth[w], 0.0);
+
+				mWheelTorque_world[v] += cross(mWheelPosition_world[w] - mPosition_world[v], mSuspensionForce_world[w]);
+				mWheelTorque_world[v] += cross(dvec3(mLocalToWorld_position[v] * dvec4(contactPatchPosition_car, 1.0)) - mPosition_world[v], mTyreForce_world[w]);
+			}
+		}
+	}
+
+	void VehicleBatch::integrate(double dt)
+		/* Called by VehicleBatch::step
+		 * Equivalent of Car::updateTotalForce_world, Car::updateTotalTorque_world and RigidBody::euler
+		*/
+	{
+		using namespace glm;
+		using namespace External;
+
+		for (size_t v = 0; v < size(); v++) {
+			const Environment& environment = *mEnvironment[v];
+			const double mass = mMass[v];
+
+			//Forces
+			dvec3 force_world = dvec3(0.0);
+			mAerodynamicDrag_world[v] = dvec3(0.0);
+
+			dvec3 velocity_world = mVelocity_world[v];
+
+			if (length(velocity_world))
+				mAerodynamicDrag_world[v] = -0.5 * pow(length(velocity_world), 2.0) * mDragCoefficient[v] * mFrontalArea[v] * environment.getAirDensity() * normalize(velocity_world);
+
+			force_world += dvec3(0.0, mass * -environment.getGravityAccel(), 0.0);
+			force_world += mWheelForce_world[v];
+			force_world += mAerodynamicDrag_world[v];
+
+			const dvec3 torque_world = mWheelTorque_world[v];
+
+			//Semi-implicit Euler
+			mAcceleration_world[v] = force_world / mass;
+
+			const dmat3 rotation = dmat3(mLocalToWorld_direction[v]);
+
+			const dvec3
+				momentum_world = mMomentum_world[v] + force_world * dt,
+				angularMomentum_world = mAngularMomentum_world[v] + torque_world * dt,
+				newVelocity_world = momentum_world / mass,
+				angularVelocity_world = rotation * (mInverseInertiaTensor_local[v] * (transpose(rotation) * angularMomentum_world));
+
+			const dquat
+				orientation_world = mOrientation_world[v],
+				spin_world = dquat(0.0, angularVelocity_world.x, angularVelocity_world.y, angularVelocity_world.z) * orientation_world * 0.5;
+
+			mPosition_world[v] = mPosition_world[v] + newVelocity_world * dt;
+			mMomentum_world[v] = momentum_world;
+			mOrientation_world[v] = orientation_world + spin_world * dt;
+			mAngularMomentum_world[v] = angularMomentum_world;
+			recalcSecondary(v);
+		}
+	}
+
+	void VehicleBatch::positionConstraints()
+		/* Called by VehicleBatch::step
+		 * Equivalent of Car::positionConstraints
+		*/
+	{
+		using namespace glm;
+		using namespace External;
+
+		for (size_t v = 0; v < size(); v++) {
+			const Terrain& terrain = mEnvironment[v]->getTerrain();
+			const double halfTerrainSize = terrain.isStreamed() ? std::numeric_limits<double>::infinity() : floor(terrain.getSize() * 0.5);
+
+			dvec3
+				positionInitial = mPosition_world[v],
+				velocityInitial = mVelocity_world[v],
+				newPosition = positionInitial,
+				newVelocity = velocityInitial;
+
+			const double planeHeight = terrain.getHeight(dvec2(positionInitial.x, positionInitial.z));
+			terrain.prefetch(dvec2(positionInitial.x, positionInitial.z));
+
+			//Terrain collision
+			if (positionInitial.y < planeHeight) {
+				double beneathTerrain = planeHeight - positionInitial.y;
+				newPosition.y += beneathTerrain;
+				newVelocity.y *= -0.3;
+			}
+
+			//Playable region limits
+			if (positionInitial.x < -halfTerrainSize) {
+				newPosition.x = -halfTerrainSize;
+				newVelocity.x *= -0.5;
+			}
+			else if (positionInitial.x > halfTerrainSize) {
+				newPosition.x = halfTerrainSize;
+				newVelocity.x *= -0.5;
+			}
+
+			if (positionInitial.z < -halfTerrainSize) {
+				newPosition.z = -halfTerrainSize;
+				newVelocity.z *= -0.5;
+			}
+			else if (positionInitial.z > halfTerrainSize) {
+				newPosition.z = halfTerrainSize;
+				newVelocity.z *= 0.5;
+			}
+
+			//State::setPosition_world followed by State::setVelocity_world, each of which recalculates
+			mPosition_world[v] = newPosition;
+			recalcSecondary(v);
+			mMomentum_world[v] = newVelocity * mMass[v];
+			recalcSecondary(v);
+		}
+	}
+
+	void VehicleBatch::recalcSecondary(size_t vehicle)
+		/* Equivalent of State::recalc
+		 * The orientation is renormalised on every call, so this must be called exactly as often as State::recalc would be
+		*/
+	{
+		using namespace glm;
+
+		mOrientation_world[vehicle] = normalize(mOrientation_world[vehicle]);
+		mVelocity_world[vehicle] = mMomentum_world[vehicle] / mMass[vehicle];
+
+		mLocalToWorld_direction[vehicle] = mat4_cast(mOrientation_world[vehicle]);
+		mWorldToLocal_direction[vehicle] = transpose(mLocalToWorld_direction[vehicle]);
+		mLocalToWorld_position[vehicle] = translate(dmat4(1.0), mPosition_world[vehicle]) * mLocalToWorld_direction[vehicle];
+
+		const dmat3 rotation = dmat3(mLocalToWorld_direction[vehicle]);
+		mAngularVelocity_world[vehicle] = rotation * (mInverseInertiaTensor_local[vehicle] * (transpose(rotation) * mAngularMomentum_world[vehicle]));
+	}
+
+	double VehicleBatch::recalcCarCmHeightAboveGround(size_t vehicle) const
+		/* Called by VehicleBatch::updateWheels
+		 * Equivalent of WheelSystem::recalcCarCmHeightAboveGround (average tyre contact patch height)
+		*/
+	{
+		glm::dvec3 avgWheelOriginPos_world = glm::dvec3(0.0);
+
+		double
+			avgWheelRadius = 0.0,
+			avgTyreContactPatchHeight_world = 0.0;
+
+		for (size_t w = vehicle * mWheelsPerVehicle; w < (vehicle + 1) * mWheelsPerVehicle; w++) {
+			avgWheelOriginPos_world += glm::dvec3(mLocalToWorld_position[vehicle] * glm::dvec4(mWheelPosition_car[w], 1.0));
+			avgWheelRadius += mRimRadius[w] + mTyreDepth[w];
+		}
+
+		avgWheelOriginPos_world /= static_cast<double>(mWheelsPerVehicle);
+		avgWheelRadius /= static_cast<double>(mWheelsPerVehicle);
+
+		avgTyreContactPatchHeight_world = avgWheelOriginPos_world.y - avgWheelRadius;
+
+		return mPosition_world[vehicle].y - avgTyreContactPatchHeight_world;
+	}
+
+	double VehicleBatch::recalcLoad(size_t vehicle, unsigned char wheel, glm::dvec3 carAcceleration_car, double carCMHeightAboveGround) const
+		/* Called by VehicleBatch::updateWheels
+		 * Equivalent of WheelSystem::recalcLoad
+		*/
+	{
+		const bool front = wheel < 2;
+
+		const glm::dvec3
+			massCentre_car = mMassCentre_car[vehicle],
+			wheelPosition_car = mWheelPosition_car[vehicle * mWheelsPerVehicle + wheel];
+
+		const double
+			wheelBase = mWheelBase[vehicle],
+			axleLength = front ? mFrontAxleLength[vehicle] : mRearAxleLength[vehicle],
+			axleLongDisplacement = front ? mFrontAxleLongDisplacement[vehicle] : mRearAxleLongDisplacement[vehicle],
+			carMassValue = mMass[vehicle],
+
+			restAxleLoad = std::abs(axleLongDisplacement - massCentre_car.z) / wheelBase * (carMassValue * mEnvironment[vehicle]->getGravityAccel()),
+			currentAxleLoad = restAxleLoad + (carCMHeightAboveGround / wheelBase) * carMassValue * carAcceleration_car.z * (std::signbit(axleLongDisplacement) ? -1.0 : 1.0),
+			restIndividualWheelLoad = std::abs(wheelPosition_car.x - massCentre_car.x) / axleLength * currentAxleLoad,
+			currentWheelLoad = restIndividualWheelLoad + (carCMHeightAboveGround / axleLength) * carMassValue * carAcceleration_car.x * (std::signbit(wheelPosition_car.x) ? 1.0 : -1.0);
+
+		return currentWheelLoad;
+	}
+
+	void VehicleBatch::updateWheelInterface(size_t vehicle, size_t wheel, double load, const External::Terrain::Contact& terrainContact, double dt)
+		/* Called by VehicleBatch::updateWheels
+		 * Equivalent of WheelInterface::update, including the Brake and Suspension updates
+		*/
+	{
+		using namespace glm;
+		using namespace External;
+
+		const dvec3 position_world = mWheelPosition_world[wheel];
+		const dvec3 terrainNormal = terrainContact.normal_world;
+		mTerrainNormal_world[wheel] = terrainNormal;
+		mSurfaceType[wheel] = terrainContact.surfaceType;
+
+		double
+			terrainHeight = terrainContact.height,
+			terrainOverlap = std::max(0.0, (mRimRadius[wheel] + mTyreDepth[wheel]) - (position_world.y - terrainHeight));
+
+		mCollisionRegistered[wheel] = terrainOverlap ? 1 : 0;
+		mLoad[wheel] = mCollisionRegistered[wheel] ? load : 0.0;
+
+		//Brake
+		mBrakeTorque[wheel] = Brake::calcTorqueMagnitude(mBrakeTravel[wheel]);
+
+		//Suspension
+		mSpringLength[wheel] = -terrainOverlap;
+		mSpringForce[wheel] = -mSpringConstant[wheel] * (mSpringLength[wheel] - mSpringRestLength[wheel]) - mDamping[wheel] * (terrainOverlap ? mWheelVelocity_world[wheel].y : 0.0);
+		mSuspensionForce_world[wheel] = terrainOverlap ? normalize(terrainNormal) * mSpringForce[wheel] : dvec3(0.0);
+
+		const double transferredTorque = (wheel % mWheelsPerVehicle) < 2 ? mFrontAxleTorque[vehicle] : mRearAxleTorque[vehicle];
+		updateWheel(wheel, terrainOverlap, transferredTorque, dt);
+	}
+
+	void VehicleBatch::updateWheel(size_t wheel, double terrainOverlap, double transferredTorque, double dt)
+		/* Called by VehicleBatch::updateWheelInterface
+		 * Equivalent of WheelInterface::updateWheel, Wheel::update and Tyre::update, up to the tyre force itself
+		 * (see VehicleBatch::updateTyreForces)
+		*/
+	{
+		using namespace glm;
+
+		const dvec3 wheelVelocity_car = mWheelVelocity_car[wheel];
+
+		//Angular motion
+		if (mAxialInertia[wheel])
+			mAngularAcceleration[wheel] = transferredTorque / mAxialInertia[wheel];
+
+		mAngularVelocity[wheel] += mAngularAcceleration[wheel] * dt;
+		mAngularPosition[wheel] += mAngularVelocity[wheel] * dt;
+
+		if (mAngularPosition[wheel] >= two_pi<double>())
+			mAngularPosition[wheel] -= two_pi<double>();
+
+		if (mAngularPosition[wheel] <= -two_pi<double>())
+			mAngularPosition[wheel] += two_pi<double>();
+
+		mRotationDirection[wheel] = mAngularVelocity[wheel] < 0.0 ? -1 : mAngularVelocity[wheel] > 0.0 ? 1 : 0;
+
+		//Tyre
+		const dvec2 wheelVel_wheel = rotate(dvec2(wheelVelocity_car.x, wheelVelocity_car.z), radians(mSteeringAngle[wheel]));
+		const double
+			load = mLoad[wheel],
+			effectiveRollingRadius = mRimRadius[wheel] + mTyreDepth[wheel],
+			longSlipSpeed = wheelVel_wheel.y - mAngularVelocity[wheel] * effectiveRollingRadius,
+			lateralSlipSpeed = wheelVel_wheel.x;
+
+		mSlipLongitudinal[wheel] = wheelVel_wheel.y == 0.0 ? 0.0 : longSlipSpeed;
+		mSlipAngle[wheel] = wheelVel_wheel.y == 0.0 ? (wheelVel_wheel.x > 0.0 ? -90.0 : 90.0) : degrees(atan(lateralSlipSpeed / std::abs(wheelVel_wheel.y)));
+
+		mRollResistForce[wheel] = wheelVel_wheel.y > 0.0 ? -mRollResistCoefficient[wheel] * load : wheelVel_wheel.y < 0.0 ? mRollResistCoefficient[wheel] * load : 0.0;
+		mTyreSlipPercent[wheel] = mSlipLongitudinal[wheel] * 100.0;
+
+		//Suspension travel moves the wheel vertically in car space
+		mWheelPosition_car[wheel] = mInterfacePosition_car[wheel] + dvec3(0.0, terrainOverlap, 0.0);
+	}
+
+	void VehicleBatch::updateTyreForce_world(size_t vehicle, size_t wheel, glm::dvec3 terrainNormalUnderWheel)
+		/* Called by VehicleBatch::updateTyreForces
+		 * Equivalent of Wheel::updateTyreForce_world
+		*/
+	{
+		using namespace glm;
+
+		const dmat4& carToWorldRotation_car = mLocalToWorld_direction[vehicle];
+
+		//No tyre force while upside down
+		if (dvec3(carToWorldRotation_car * dvec4(0.0, 1.0, 0.0, 1.0)).y < 0.0) {
+			mTyreForce_world[wheel] = dvec3(0.0);
+			return;
+		}
+
+		dvec3
+			normalisedLong_world = normalize(dvec3(carToWorldRotation_car * dvec4(rotate(dvec3(0.0, 0.0, -1.0), radians(mSteeringAngle[wheel]), dvec3(0.0, 1.0, 0.0)), 1.0))),
+			flattenedNormLong_world = normalize(dvec3(normalisedLong_world.x, 0.0, normalisedLong_world.z)),
+			rotatedFlatNormLong_world = rotate(flattenedNormLong_world, radians(90.0), dvec3(0.0, 1.0, 0.0)),
+			normTangentResult_world = normalize(cross(rotatedFlatNormLong_world, terrainNormalUnderWheel)),
+			normalisedLat_world = normalize(cross(terrainNormalUnderWheel, normTangentResult_world));
+
+		mTyreForce_world[wheel] = normTangentResult_world * mTyreForce_wheel[wheel].y + normalisedLat_world * mTyreForce_wheel[wheel].x;
+	}
+
+}
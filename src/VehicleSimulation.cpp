@@ -1,4 +1,5 @@
 #include "VehicleSimulation.h"
+#include "Profiler.h"
 
 VehicleSimulation::VehicleSimulation() :
 	/* Called by main
@@ -8,12 +9,24 @@ VehicleSimulation::VehicleSimulation() :
 	onLoad();
 }
 
+VehicleSimulation::~VehicleSimulation()
+	/* Called by main
+	 * In a VDS_PROFILE build, the session's trace is written on exit
+	*/
+{
+	if (Internal::Profiler::isCompiledIn())
+		Internal::Profiler::writeChromeTrace("vds-trace.json");
+}
+
 void VehicleSimulation::onLoad()
 	/* Called by VehicleSimulation::VehicleSimulation
 	 * Called once
 	*/
 {
-	mVisuals = std::make_unique<Visual::VisualShell>(mCar, mWindow, mSimulationSpeed);
+	mKeyboard = std::make_shared<Internal::KeyboardInputSource>();
+	mCar.setInputSource(mKeyboard);
+
+	mVisuals = std::make_unique<Visual::VisualShell>(mCar, mFrameStats, mWindow, mSimulationSpeed);
 }
 
 void VehicleSimulation::onInputCheck()
@@ -25,7 +38,7 @@ void VehicleSimulation::onInputCheck()
 
 	if (Input::isKeyReleased(GLFW_KEY_ESCAPE)) mRunning = false;
 
-	mCar.checkInput(mFrameTime * mSimulationSpeed);
+	mKeyboard->poll();
 	mVisuals->checkInput(mFrameTime);
 }
 
@@ -34,14 +47,23 @@ void VehicleSimulation::onUpdate()
 	 * Called multiple times per frame
 	*/
 {
+	Internal::FrameStats::ScopedTimer timer(mFrameStats, Internal::FrameStats::PHYSICS);
+	mFrameStats.countPhysicsStep();
+
 	mCar.update(mCurrentTime, mUpdateDelta * mSimulationSpeed);
 }
 
 void VehicleSimulation::onRender()
 	/* Called by Application::render
 	 * Called once per frame
+	 * Ends the frame's timings, as the last part of the main loop the application controls
 	*/
 {
-	mVisuals->update(mFrameTime);
-	mVisuals->renderAll();
+	{
+		Internal::FrameStats::ScopedTimer timer(mFrameStats, Internal::FrameStats::RENDER);
+		mVisuals->update(mFrameTime);
+		mVisuals->renderAll();
+	}
+
+	mFrameStats.endFrame();
 }
\ No newline at end of file
@@ -1,13 +1,15 @@
 #include "VisualShell.h"
 #include "Car.h"
+#include "Profiler.h"
 
 namespace Visual {
 
-	VisualShell::VisualShell(Internal::Car& dataSource, Framework::Window& window, float& simSpeedHandle) :
+	VisualShell::VisualShell(Internal::Car& dataSource, Internal::FrameStats& frameStats, Framework::Window& window, float& simSpeedHandle) :
 		/* Called by VehicleSimulation::onLoad
 		*/
 		mWindow(window),
 		mDataSource(dataSource),
+		mFrameStats(frameStats),
 		mCameraSystem(window.getAspect()),
 		mSimulationSpeedHandle(simSpeedHandle)
 	{
@@ -25,11 +27,13 @@ namespace Visual {
 		/* Called by VehicleSimulation::onRender
 		*/
 	{
+		VDS_PROFILE_SCOPE("VisualShell::renderAll");
+
 		//temp
 		//glm::dvec3 carPos = mDataSource.getWheelSystem().getWheelInterface(Internal::WheelSystem::AxlePos::REAR, Internal::WheelSystem::Side::LEFT).getPosition_world();
 		//glm::dvec3
 		//	wheelPos_world = mDataSource.getWheelSystem().getWheelInterface(Internal::WheelSystem::AxlePos::REAR, Internal::WheelSystem::Side::LEFT).getPosition_world(),
-		//	targetPos_world = glm::dvec3(0.0, External::Environment::mTerrain.getHeight({ wheelPos_world.x, wheelPos_world.z }), wheelPos_world.z);
+		//	targetPos_world = glm::dvec3(0.0, mDataSource.getEnvironment().getTerrain().getHeight({ wheelPos_world.x, wheelPos_world.z }), wheelPos_world.z);
 		//glm::dvec3 carPos = mDataSource.getState().getPosition_world();
 
 		//orthoCam->setPosition({0.0, carPos.y, carPos.z});
@@ -104,7 +108,7 @@ namespace Visual {
 		glEnable(GL_BLEND);
 		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-		mEnvironmentModel = std::make_unique<EnvironmentModel>(mResourceHolder);
+		mEnvironmentModel = std::make_unique<EnvironmentModel>(mResourceHolder, mDataSource.getEnvironment());
 		mGameCarModel = std::make_unique<GameCarModel>(mDataSource, mResourceHolder);
 		mGameCarModel->setShaderUniforms(
 			mEnvironmentModel->getFogDensity(),
@@ -115,7 +119,7 @@ namespace Visual {
 
 		mDebugCarModel = std::make_unique<DebugCarModel>(mDataSource, mResourceHolder);
 
-		mUILayer = std::make_unique<UILayer>(mDataSource, *mResourceHolder.getResource<Framework::Graphics::Shader>("bodyShader"), mCameraSystem, mSimulationSpeedHandle, mDebugMode);
+		mUILayer = std::make_unique<UILayer>(mDataSource, mFrameStats, *mResourceHolder.getResource<Framework::Graphics::Shader>("bodyShader"), mCameraSystem, mSimulationSpeedHandle, mDebugMode);
 
 		Framework::Camera& currentCamera = mCameraSystem.getCurrentSimCamera().getInternalCamera();
 		mBaseRenderer.setCamera(currentCamera);
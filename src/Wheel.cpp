@@ -8,7 +8,7 @@ namespace Internal {
 		mTyre(mRimRadius)
 	{ }
 
-	void Wheel::update(glm::dmat4 carToWorldRotation_car, glm::dvec3 terrainNormalUnderWheel, glm::dvec2 wheelVel_car, double load, double totalInputTorque, double dt)
+	void Wheel::update(const glm::dmat4& carToWorldRotation_car, glm::dvec3 terrainNormalUnderWheel, glm::dvec2 wheelVel_car, double load, double totalInputTorque, double dt)
 		/* Called by WheelInterface::updateWheel
 		*/
 	{
@@ -55,7 +55,7 @@ namespace Internal {
 			mAngularPosition += glm::two_pi<double>();
 	}
 
-	void Wheel::updateTyreForce_world(glm::dmat4 carToWorldRotation_car, glm::dvec3 terrainNormalUnderWheel)
+	void Wheel::updateTyreForce_world(const glm::dmat4& carToWorldRotation_car, glm::dvec3 terrainNormalUnderWheel)
 		/* Called by Wheel::update
 		 * Transforms individual tyre force components, into a 3D force vector in world space that lies tangent to the terrain surface
 		*/
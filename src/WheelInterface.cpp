@@ -1,5 +1,4 @@
 #include "WheelInterface.h"
-#include "Environment.h"
 
 namespace Internal {
 
@@ -9,22 +8,21 @@ namespace Internal {
 		mConnectedAxle(connectedAxle)
 	{ }
 
-	void WheelInterface::update(Framework::Physics::State& carState, double load, double dt)
+	void WheelInterface::update(const WheelKinematics& kinematics, const glm::dmat4& carToWorldRotation_car, double load, const External::Terrain::Contact& terrainContact, double dt)
 		/* Called by WheelSystem::updateAllWheelInterfaces
-		 * Updates all per-wheel components
-		 * Transforms car physical-state data before passing it to components
+		 * Updates all per-wheel components, given this step's kinematics of the wheel and the terrain under it
 		*/
 	{
 		using namespace glm;
-		using namespace External;
 
-		mPosition_world = dvec3(carState.getLocalToWorld_position() * dvec4(mPosition_car, 1.0));
-		mVelocity_world = carState.getVelocity_world() + cross(carState.getAngularVelocity_world(), mPosition_world - dvec3(carState.getLocalToWorld_position() * dvec4(carState.getMass().getCentre(), 1.0)));
+		mPosition_world = kinematics.interfacePosition_world;
+		mVelocity_world = kinematics.velocity_world;
 
-		dvec3 terrainNormal = Environment::mTerrain.getNormal_world(dvec2(mPosition_world.x, mPosition_world.z));
+		dvec3 terrainNormal = terrainContact.normal_world;
+		mSurfaceType = terrainContact.surfaceType;
 
 		double
-			terrainHeight = Environment::mTerrain.getHeight(dvec2(mPosition_world.x, mPosition_world.z)),
+			terrainHeight = terrainContact.height,
 			terrainOverlap = std::max(0.0, mWheel.getTotalRadius() - (mPosition_world.y - terrainHeight));
 
 		mCollisionRegistered = terrainOverlap ? true : false;
@@ -33,7 +31,7 @@ namespace Internal {
 		//Member object updates
 		mBrake.update();
 		mSuspension.update(mVelocity_world.y, terrainOverlap, terrainNormal);
-		updateWheel(carState.getLocalToWorld_direction(), terrainNormal, terrainOverlap, dt);
+		updateWheel(carToWorldRotation_car, kinematics.velocity_car, terrainNormal, terrainOverlap, dt);
 	}
 
 	void WheelInterface::setPosition_car(glm::dvec3 newPosition_car)
@@ -59,14 +57,12 @@ namespace Internal {
 		mLoad = 0.0;
 	}
 
-	void WheelInterface::updateWheel(glm::dmat4 carToWorldRotation_car, glm::dvec3 terrainNormalUnderWheel, double terrainOverlap, double dt)
+	void WheelInterface::updateWheel(const glm::dmat4& carToWorldRotation_car, glm::dvec3 wheelVelocity_car, glm::dvec3 terrainNormalUnderWheel, double terrainOverlap, double dt)
 		/* Called by WheelInterface::update
 		*/
 	{
 		using namespace glm;
 
-		//Use carToWorldRotation_car to calculate the velocity of the Wheel, relative to the Car
-		dvec3 wheelVelocity_car = dvec3(inverse(carToWorldRotation_car) * dvec4(mVelocity_world, 1.0));
 		mWheel.update(carToWorldRotation_car, terrainNormalUnderWheel, dvec2(wheelVelocity_car.x, wheelVelocity_car.z), mLoad, mConnectedAxle.getTransferredTorque(), dt);
 
 		mWheel.resetToBasePosition();
@@ -1,6 +1,7 @@
 #include "WheelSystem.h"
 #include "Environment.h"
 #include "ControlSystem.h"
+#include "Profiler.h"
 
 namespace Internal {
 
@@ -19,18 +20,33 @@ namespace Internal {
 		positionWheelInterfaces();
 	}
 
-	void WheelSystem::update(Framework::Physics::State& carState, glm::dvec3 carAcceleration_world, double dt)
+	void WheelSystem::update(Framework::Physics::State& carState, glm::dvec3 carAcceleration_world, const External::Environment& environment, double dt)
 		/* Called by Car::update
 		 * Passes Car physical-state information down to the WheelInterfaces and updates them
 		 * Calculates the final force and torque vectors
 		*/
 	{
+		VDS_PROFILE_SCOPE("WheelSystem::update");
+
 		glm::dvec3 carAcceleration_car = glm::dvec3(carState.getWorldToLocal_direction() * glm::dvec4(carAcceleration_world, 1.0));
 
-		updateAxles();
-		updateAllWheelInterfaces(carState, carAcceleration_car, dt);
-		updateTotalForce_world();
-		updateTotalTorque_world(carState.getPosition_world(), carState.getLocalToWorld_position());
+		{
+			VDS_PROFILE_SCOPE("WheelSystem::updateAxles");
+			updateAxles();
+		}
+		{
+			VDS_PROFILE_SCOPE("WheelSystem::updateKinematics");
+			updateKinematics(carState);
+		}
+		{
+			VDS_PROFILE_SCOPE("WheelSystem::updateAllWheelInterfaces");
+			updateAllWheelInterfaces(carState, carAcceleration_car, environment, dt);
+		}
+		{
+			VDS_PROFILE_SCOPE("WheelSystem::sumForceAndTorque");
+			updateTotalForce_world();
+			updateTotalTorque_world(carState.getPosition_world(), carState.getLocalToWorld_position());
+		}
 	}
 
 	void WheelSystem::bindControlSystem(ControlSystem& controlSystem)
@@ -51,7 +67,7 @@ namespace Internal {
 	}
 
 	void WheelSystem::reset()
-		/* Called by Car::checkInput
+		/* Called by Car::applyInputs
 		*/
 	{
 		for (WheelInterface& w : mWheelInterfaces)
@@ -123,17 +139,54 @@ namespace Internal {
 		}
 	}
 
-	void WheelSystem::updateAllWheelInterfaces(Framework::Physics::State& carState, glm::dvec3 carAcceleration_car, double dt)
+	void WheelSystem::updateKinematics(Framework::Physics::State& carState)
+		/* Called by WheelSystem::update
+		 * Computes everything about where the wheels are and how they move that this step needs, once, from one copy of
+		 * each of the car's matrices. Car space velocities use the world-to-car rotation the State already holds (the
+		 * transpose of the car-to-world rotation), rather than inverting the rotation for every wheel
+		*/
+	{
+		using namespace glm;
+
+		const dmat4
+			localToWorld_position = carState.getLocalToWorld_position(),
+			worldToLocal_direction = carState.getWorldToLocal_direction();
+
+		const dvec3
+			velocity_world = carState.getVelocity_world(),
+			angularVelocity_world = carState.getAngularVelocity_world(),
+			massCentre_world = dvec3(localToWorld_position * dvec4(carState.getMass().getCentre(), 1.0));
+
+		for (unsigned char i = 0; i < mWheelInterfaces.size(); i++) {
+			WheelKinematics& kinematics = mKinematics[i];
+			WheelInterface& wheelInterface = mWheelInterfaces[i];
+
+			kinematics.interfacePosition_world = dvec3(localToWorld_position * dvec4(wheelInterface.getPosition_car(), 1.0));
+			kinematics.velocity_world = velocity_world + cross(angularVelocity_world, kinematics.interfacePosition_world - massCentre_world);
+			kinematics.velocity_car = dvec3(worldToLocal_direction * dvec4(kinematics.velocity_world, 1.0));
+			kinematics.wheelOrigin_world = dvec3(localToWorld_position * dvec4(wheelInterface.getWheel().getPosition_car(), 1.0));
+
+			mContactPoints_world[i] = dvec2(kinematics.interfacePosition_world.x, kinematics.interfacePosition_world.z);
+		}
+	}
+
+	void WheelSystem::updateAllWheelInterfaces(Framework::Physics::State& carState, glm::dvec3 carAcceleration_car, const External::Environment& environment, double dt)
 		/* Called by WheelSystem::update
 		*/
 	{
 		double carCMHeightAboveGround = recalcCarCmHeightAboveGround(carState);
 
+		//The terrain under all four wheels is sampled in one batch
+		External::Terrain::Contact terrainContacts[4];
+		environment.getTerrain().sampleContacts(mContactPoints_world, mWheelInterfaces.size(), terrainContacts);
+
+		const glm::dmat4 carToWorldRotation_car = carState.getLocalToWorld_direction();
+
 		for (unsigned char i = 0; i < mWheelInterfaces.size(); i++)
-			mWheelInterfaces[i].update(carState, recalcLoad(calcAxleFromIndex(i), calcSideFromIndex(i), carState.getMass(), carAcceleration_car, carCMHeightAboveGround), dt);
+			mWheelInterfaces[i].update(mKinematics[i], carToWorldRotation_car, recalcLoad(calcAxleFromIndex(i), calcSideFromIndex(i), carState.getMass(), carAcceleration_car, carCMHeightAboveGround, environment.getGravityAccel()), terrainContacts[i], dt);
 	}
 
-	double WheelSystem::recalcLoad(AxlePos position, Side side, Framework::Physics::Mass& carMass_car, glm::dvec3 carAcceleration_car, double carCMHeightAboveGround)
+	double WheelSystem::recalcLoad(AxlePos position, Side side, Framework::Physics::Mass& carMass_car, glm::dvec3 carAcceleration_car, double carCMHeightAboveGround, double gravityAccel)
 		/* Called by WheelSystem::updateAllWheelInterfaces
 		*/
 	{
@@ -143,16 +196,16 @@ namespace Internal {
 			carMassValue = carMass_car.getValue(),
 
 			//The load on the axle involved, when the car is at rest.
-			restAxleLoad = abs(currentAxle.getLongDisplacement_car() - carMass_car.getCentre().z) / mWheelBase * (carMassValue * External::Environment::mGravityAccel),
+			restAxleLoad = std::abs(currentAxle.getLongDisplacement_car() - carMass_car.getCentre().z) / mWheelBase * (carMassValue * gravityAccel),
 
 			//The current load on the axle involved, considering load transfer due to longitudinal acceleration.
-			currentAxleLoad = restAxleLoad + (carCMHeightAboveGround / mWheelBase) * carMassValue * carAcceleration_car.z * (signbit(currentAxle.getLongDisplacement_car()) ? -1.0 : 1.0),
+			currentAxleLoad = restAxleLoad + (carCMHeightAboveGround / mWheelBase) * carMassValue * carAcceleration_car.z * (std::signbit(currentAxle.getLongDisplacement_car()) ? -1.0 : 1.0),
 
 			//The load on the wheel involved, when the car is at rest.
-			restIndividualWheelLoad = abs(getWheelInterface(position, side).getWheel().getPosition_car().x - carMass_car.getCentre().x) / currentAxle.getLength() * currentAxleLoad,
+			restIndividualWheelLoad = std::abs(getWheelInterface(position, side).getWheel().getPosition_car().x - carMass_car.getCentre().x) / currentAxle.getLength() * currentAxleLoad,
 
 			//The current load on the wheel involved, considering load transfer due to lateral acceleration.
-			currentWheelLoad = restIndividualWheelLoad + (carCMHeightAboveGround / currentAxle.getLength()) * carMassValue * carAcceleration_car.x * (signbit(getWheelInterface(position, side).getWheel().getPosition_car().x) ? 1.0 : -1.0);
+			currentWheelLoad = restIndividualWheelLoad + (carCMHeightAboveGround / currentAxle.getLength()) * carMassValue * carAcceleration_car.x * (std::signbit(getWheelInterface(position, side).getWheel().getPosition_car().x) ? 1.0 : -1.0);
 
 		return currentWheelLoad;
 	}
@@ -181,12 +234,9 @@ namespace Internal {
 			avgWheelRadius = 0.0,
 			avgTyreContactPatchHeight_world = 0.0;
 
-		Wheel* currentWheel = nullptr;
-
-		for (WheelInterface& w : mWheelInterfaces) {
-			currentWheel = &w.getWheel();
-			avgWheelOriginPos_world += glm::dvec3(carState.getLocalToWorld_position() * glm::dvec4(currentWheel->getPosition_car(), 1.0));
-			avgWheelRadius += currentWheel->getTotalRadius();
+		for (unsigned char i = 0; i < mWheelInterfaces.size(); i++) {
+			avgWheelOriginPos_world += mKinematics[i].wheelOrigin_world;
+			avgWheelRadius += mWheelInterfaces[i].getWheel().getTotalRadius();
 		}
 
 		avgWheelOriginPos_world /= mWheelInterfaces.size();
@@ -209,7 +259,7 @@ namespace Internal {
 		}
 	}
 
-	void WheelSystem::updateTotalTorque_world(glm::dvec3 carPosition_world, glm::dmat4 carToWorldTransform_car)
+	void WheelSystem::updateTotalTorque_world(glm::dvec3 carPosition_world, const glm::dmat4& carToWorldTransform_car)
 		/* Called by WheelSystem::update
 		*/
 	{
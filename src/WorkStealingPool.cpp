@@ -0,0 +1,106 @@
+#include "WorkStealingPool.h"
+
+#include <thread>
+#include <algorithm>
+
+namespace Internal {
+
+	WorkStealingPool::WorkStealingPool(unsigned int threadCount) :
+		/* Called by code owning the work (e.g. vds-sweep)
+		 * A thread count of 0 uses one thread per hardware thread
+		*/
+		mThreadCount(threadCount ? threadCount : std::max(std::thread::hardware_concurrency(), 1u)),
+		mStealCount(0)
+	{ }
+
+	void WorkStealingPool::run(size_t taskCount, const Task& task)
+		/* Called by code owning the work (e.g. ParameterSweep::run)
+		 * Calls task(index, worker) exactly once for every index in [0, taskCount), and returns once all have finished.
+		 * The calling thread is worker 0; mThreadCount - 1 further threads are started for the duration of the call
+		*/
+	{
+		const unsigned int workerCount = (unsigned int)std::min<size_t>(mThreadCount, std::max<size_t>(taskCount, 1));
+		std::vector<Range> ranges(workerCount);
+
+		for (unsigned int w = 0; w < workerCount; w++) {
+			ranges[w].mBegin = taskCount * w / workerCount;
+			ranges[w].mEnd = taskCount * (w + 1) / workerCount;
+		}
+
+		std::vector<std::thread> threads;
+		threads.reserve(workerCount - 1);
+
+		for (unsigned int w = 1; w < workerCount; w++)
+			threads.emplace_back(&WorkStealingPool::work, this, std::ref(ranges), w, std::cref(task));
+
+		work(ranges, 0, task);
+
+		for (std::thread& thread : threads)
+			thread.join();
+	}
+
+	void WorkStealingPool::work(std::vector<Range>& ranges, unsigned int worker, const Task& task)
+		/* Called by WorkStealingPool::run, on every worker thread
+		 * Stops once a full pass over the other workers finds nothing left to steal. Ranges only ever shrink or move
+		 * to a thief, so no task is lost if a worker stops while another is mid-steal
+		*/
+	{
+		const unsigned int workerCount = (unsigned int)ranges.size();
+		Range& own = ranges[worker];
+		size_t index;
+
+		for (;;) {
+			while (takeFront(own, index))
+				task(index, worker);
+
+			bool stolen = false;
+
+			for (unsigned int offset = 1; offset < workerCount && !stolen; offset++)
+				stolen = stealBack(ranges[(worker + offset) % workerCount], own);
+
+			if (!stolen)
+				return;
+
+			mStealCount++;
+		}
+	}
+
+	bool WorkStealingPool::takeFront(Range& range, size_t& task)
+		/* Called by WorkStealingPool::work, by the range's owner
+		*/
+	{
+		std::lock_guard<std::mutex> lock(range.mMutex);
+
+		if (range.mBegin == range.mEnd)
+			return false;
+
+		task = range.mBegin++;
+		return true;
+	}
+
+	bool WorkStealingPool::stealBack(Range& victim, Range& thief)
+		/* Called by WorkStealingPool::work, by a worker whose own range is empty
+		 * Moves the back half (rounded up, so a last single task can be stolen too) of the victim's range to the thief
+		*/
+	{
+		size_t begin, end;
+		{
+			std::lock_guard<std::mutex> lock(victim.mMutex);
+
+			const size_t remaining = victim.mEnd - victim.mBegin;
+			if (remaining == 0)
+				return false;
+
+			end = victim.mEnd;
+			begin = victim.mEnd - (remaining + 1) / 2;
+			victim.mEnd = begin;
+		}
+
+		std::lock_guard<std::mutex> lock(thief.mMutex);
+		thief.mBegin = begin;
+		thief.mEnd = end;
+
+		return true;
+	}
+
+}
@@ -0,0 +1,448 @@
+/* vds-bench
+ * Google Benchmark microbenchmarks for the simulation's hot paths. One iteration is one operation, so the reported
+ * time is ns/op; items/s counts tyres, terrain queries, wheel systems, car steps, rays or generated height samples.
+ * Results are printed to the console and written as JSON to vds-bench.json (or to --benchmark_out=FILE, in
+ * --benchmark_out_format).
+ *
+ * Usage: vds-bench [--benchmark_filter=REGEX] [--benchmark_repetitions=N] [--benchmark_out=FILE] [...]
+*/
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <benchmark/benchmark.h>
+
+#include "AutoDriver.h"
+#include "Car.h"
+#include "Environment.h"
+#include "LapTimer.h"
+#include "PacejkaMagicFormula.h"
+#include "RangeSensor.h"
+#include "TelemetryRecorder.h"
+#include "Terrain.h"
+#include "Track.h"
+
+namespace {
+	const size_t sampleCount = 4096;   //Inputs cycled through by the per-call benchmarks (a power of 2)
+
+	struct TyreInput {
+		double
+			load,                          //N
+			slipPercent,                   //0 -> 100
+			slipAngle;                     //degs
+	};
+
+	//Load bands: a steady 4 kN, or anywhere from 2 to 8 kN (the load-dependent terms are then recalculated every call)
+	//Slip bands: the linear region, around the peak, and deep into saturation
+	std::vector<TyreInput> generateTyreInputs(int64_t loadBand, int64_t slipBand) {
+		const double
+			slipPercentRanges[3][2] = { { 0.0, 2.0 }, { 5.0, 15.0 }, { 30.0, 100.0 } },
+			slipAngleRanges[3][2] = { { 0.0, 2.0 }, { 3.0, 8.0 }, { 10.0, 30.0 } };
+
+		std::mt19937_64 random(1);
+		std::uniform_real_distribution<double>
+			load(2000.0, 8000.0),
+			slipPercent(slipPercentRanges[slipBand][0], slipPercentRanges[slipBand][1]),
+			slipAngle(slipAngleRanges[slipBand][0], slipAngleRanges[slipBand][1]);
+
+		std::vector<TyreInput> inputs(sampleCount);
+		for (TyreInput& input : inputs) {
+			const double sign = random() & 1 ? 1.0 : -1.0;
+			input = { loadBand == 0 ? 4000.0 : load(random), sign * slipPercent(random), sign * slipAngle(random) };
+		}
+
+		return inputs;
+	}
+
+	//Random points anywhere on the terrain, or a coherent path (consecutive points 2 cm apart, as a wheel at 24 m/s
+	//would sample at 1 kHz)
+	std::vector<glm::dvec2> generateTerrainPoints(bool coherent) {
+		const double halfTerrainSize = External::Environment::getDefault()->getTerrain().getSize() * 0.5 - 1.0;
+
+		std::mt19937_64 random(2);
+		std::uniform_real_distribution<double> position(-halfTerrainSize, halfTerrainSize);
+
+		std::vector<glm::dvec2> points(sampleCount);
+		for (size_t i = 0; i < sampleCount; i++)
+			points[i] = coherent ? glm::dvec2(-40.0 + i * 0.02, 10.0 + i * 0.005) : glm::dvec2(position(random), position(random));
+
+		return points;
+	}
+
+	const char* terrainPatternLabel(const benchmark::State& state) {
+		return state.range(0) ? "coherent" : "random";
+	}
+
+	void BM_PacejkaUpdateForces(benchmark::State& state) {
+		static const char* const loadLabels[2] = { "load 4 kN", "load 2-8 kN" };
+		static const char* const slipLabels[3] = { "linear slip", "peak slip", "saturated slip" };
+
+		const std::vector<TyreInput> inputs = generateTyreInputs(state.range(0), state.range(1));
+		Internal::PacejkaMagicFormula formula;
+		size_t i = 0;
+
+		for (auto _ : state) {
+			const TyreInput& input = inputs[i++ & (sampleCount - 1)];
+			formula.updateForces(input.load, input.slipPercent, input.slipAngle, 0.0);
+			benchmark::DoNotOptimize(formula.getLateralForce());
+		}
+
+		state.SetItemsProcessed(state.iterations());
+		state.SetLabel(std::string(loadLabels[state.range(0)]) + ", " + slipLabels[state.range(1)]);
+	}
+
+	void BM_TerrainGetHeight(benchmark::State& state) {
+		const External::Terrain& terrain = External::Environment::getDefault()->getTerrain();
+		const std::vector<glm::dvec2> points = generateTerrainPoints(state.range(0));
+		size_t i = 0;
+
+		for (auto _ : state)
+			benchmark::DoNotOptimize(terrain.getHeight(points[i++ & (sampleCount - 1)]));
+
+		state.SetItemsProcessed(state.iterations());
+		state.SetLabel(terrainPatternLabel(state));
+	}
+
+	//The same points over streamed terrain: the hot tile for coherent points, the tile cache's lock for random ones
+	void BM_TerrainStreamedGetHeight(benchmark::State& state) {
+		External::Terrain::Settings settings;
+		settings.streamed = true;
+
+		const External::Terrain terrain(settings);
+		const std::vector<glm::dvec2> points = generateTerrainPoints(state.range(0));
+		size_t i = 0;
+
+		for (const glm::dvec2& point : points)
+			terrain.getHeight(point);
+
+		for (auto _ : state)
+			benchmark::DoNotOptimize(terrain.getHeight(points[i++ & (sampleCount - 1)]));
+
+		state.SetItemsProcessed(state.iterations());
+		state.SetLabel(terrainPatternLabel(state));
+	}
+
+	void BM_TerrainGetNormal(benchmark::State& state) {
+		const External::Terrain& terrain = External::Environment::getDefault()->getTerrain();
+		const std::vector<glm::dvec2> points = generateTerrainPoints(state.range(0));
+		size_t i = 0;
+
+		for (auto _ : state)
+			benchmark::DoNotOptimize(terrain.getNormal_world(points[i++ & (sampleCount - 1)]));
+
+		state.SetItemsProcessed(state.iterations());
+		state.SetLabel(terrainPatternLabel(state));
+	}
+
+	//One iteration samples four points, as WheelSystem does for its wheels
+	void BM_TerrainSampleContacts(benchmark::State& state) {
+		const External::Terrain& terrain = External::Environment::getDefault()->getTerrain();
+		const std::vector<glm::dvec2> points = generateTerrainPoints(state.range(0));
+		External::Terrain::Contact contacts[4];
+		size_t i = 0;
+
+		for (auto _ : state) {
+			terrain.sampleContacts(&points[i], 4, contacts);
+			benchmark::DoNotOptimize(contacts);
+			i = (i + 4) & (sampleCount - 1);
+		}
+
+		state.SetItemsProcessed(state.iterations() * 4);
+		state.SetLabel(terrainPatternLabel(state));
+	}
+
+	//The same, decoding compact terrain (quantised heights, packed normals and surface types)
+	void BM_TerrainCompactSampleContacts(benchmark::State& state) {
+		External::Terrain::Settings settings;
+		settings.compact = true;
+
+		const External::Terrain terrain(settings);
+		const std::vector<glm::dvec2> points = generateTerrainPoints(state.range(0));
+		External::Terrain::Contact contacts[4];
+		size_t i = 0;
+
+		for (auto _ : state) {
+			terrain.sampleContacts(&points[i], 4, contacts);
+			benchmark::DoNotOptimize(contacts);
+			i = (i + 4) & (sampleCount - 1);
+		}
+
+		state.SetItemsProcessed(state.iterations() * 4);
+		state.SetLabel(terrainPatternLabel(state));
+	}
+
+	//Level rays 2 m above the ground, from random points across kilometre-scale terrain in random directions, reaching
+	//as far as range(0) metres
+	void BM_TerrainRaycast(benchmark::State& state) {
+		External::Terrain::Settings settings;
+		settings.size = 2049;
+
+		static const External::Terrain terrain(settings);
+		const double maxDistance = (double)state.range(0);
+
+		std::mt19937_64 random(3);
+		std::uniform_real_distribution<double>
+			position(-1000.0, 1000.0),
+			heading(0.0, 2.0 * M_PI);
+
+		std::vector<glm::dvec3> origins(sampleCount), directions(sampleCount);
+		for (size_t i = 0; i < sampleCount; i++) {
+			const glm::dvec2 start(position(random), position(random));
+			const double angle = heading(random);
+
+			origins[i] = glm::dvec3(start.x, terrain.getHeight(start) + 2.0, start.y);
+			directions[i] = glm::dvec3(cos(angle), 0.0, sin(angle));
+		}
+
+		External::Terrain::RayHit hit;
+		size_t
+			i = 0,
+			hits = 0;
+
+		for (auto _ : state) {
+			hits += terrain.raycast(origins[i], directions[i], maxDistance, hit);
+			benchmark::DoNotOptimize(hit);
+			i = (i + 1) & (sampleCount - 1);
+		}
+
+		state.SetItemsProcessed(state.iterations());
+		state.counters["hit%"] = 100.0 * hits / state.iterations();
+	}
+
+	//A car that has settled onto the terrain, accelerating through a turn
+	void prepareCar(Internal::Car& car, double dt) {
+		car.getTorqueGenerator().setThrottle(1.0);
+		car.getControlSystem().setSteeringWheelAngle(90.0);
+
+		for (unsigned int step = 0; step < 2000; step++)
+			car.update(step * dt, dt);
+	}
+
+	void BM_WheelSystemUpdate(benchmark::State& state) {
+		const double dt = 1.0 / 1000.0;
+
+		Internal::Car car;
+		prepareCar(car, dt);
+
+		Internal::WheelSystem& wheelSystem = car.getWheelSystem();
+		Framework::Physics::State& carState = car.getState();
+
+		for (auto _ : state)
+			wheelSystem.update(carState, car.getAcceleration_world(), car.getEnvironment(), dt);
+
+		state.SetItemsProcessed(state.iterations());
+	}
+
+	void BM_CarUpdate(benchmark::State& state) {
+		const double dt = 1.0 / 1000.0;
+
+		Internal::Car car;
+		prepareCar(car, dt);
+
+		double t = 0.0;
+		for (auto _ : state) {
+			car.update(t, dt);
+			t += dt;
+		}
+
+		state.SetItemsProcessed(state.iterations());
+	}
+
+	//BM_CarUpdate, recording every step with a TelemetryRecorder, so the difference is the recording's cost to the step
+	void BM_CarUpdateWithTelemetry(benchmark::State& state) {
+		const double dt = 1.0 / 1000.0;
+		const std::string path = (std::filesystem::temp_directory_path() / "vds-bench.telemetry").string();
+
+		Internal::Car car;
+		prepareCar(car, dt);
+
+		Internal::TelemetryRecorder recorder;
+		if (!recorder.open(path)) {
+			state.SkipWithError("could not write the telemetry log");
+			return;
+		}
+
+		double t = 0.0;
+		for (auto _ : state) {
+			car.update(t, dt);
+			t += dt;
+			recorder.record(car, t);
+		}
+
+		recorder.close();
+		std::filesystem::remove(path);
+
+		state.SetItemsProcessed(state.iterations());
+		state.counters["dropped"] = (double)recorder.getDroppedCount();
+	}
+
+	//One full scan of the default sensor (131072 rays) from a car that has settled onto the terrain
+	void BM_RangeSensorScan(benchmark::State& state) {
+		Internal::Car car;
+		prepareCar(car, 1.0 / 1000.0);
+
+		Internal::RangeSensor sensor;
+		Internal::RangeSensor::PointCloud cloud;
+
+		for (auto _ : state)
+			sensor.scan(car, 0.0, cloud);
+
+		state.SetItemsProcessed(state.iterations() * sensor.getRayCount());
+	}
+
+	void BM_TrackConstruction(benchmark::State& state) {
+		const unsigned int terrainSize = External::Environment::getDefault()->getTerrain().getSize();
+
+		for (auto _ : state) {
+			External::Track track(terrainSize);
+			benchmark::DoNotOptimize(&track);
+		}
+
+		state.SetItemsProcessed(state.iterations());
+	}
+
+	//0 = sampleAtDistance, 1 = findNearest
+	void BM_TrackCentrelineLookUp(benchmark::State& state) {
+		const External::TrackCentreline& centreline = External::Environment::getDefault()->getTerrain().getTrackCentreline();
+
+		std::mt19937_64 random(5);
+		std::uniform_real_distribution<double>
+			distance(0.0, centreline.getLength()),
+			position(-150.0, 150.0);
+
+		std::vector<double> distances(sampleCount);
+		std::vector<glm::dvec2> positions(sampleCount);
+		for (size_t i = 0; i < sampleCount; i++) {
+			distances[i] = distance(random);
+			positions[i] = glm::dvec2(position(random), position(random));
+		}
+
+		size_t i = 0;
+		for (auto _ : state) {
+			if (state.range(0) == 0)
+				benchmark::DoNotOptimize(centreline.sampleAtDistance(distances[i]));
+			else
+				benchmark::DoNotOptimize(centreline.findNearest(positions[i]));
+
+			i = (i + 1) & (sampleCount - 1);
+		}
+
+		state.SetItemsProcessed(state.iterations());
+	}
+
+	//One step of a car driving round the track at 30 m/s, 1 ms apart
+	void BM_LapTimerUpdate(benchmark::State& state) {
+		const External::TrackCentreline& centreline = External::Environment::getDefault()->getTerrain().getTrackCentreline();
+		const unsigned char surfaceTypes[4] = { External::TARMAC, External::TARMAC, External::TARMAC, External::TARMAC };
+
+		//A lap's worth of positions, 2 m right of the line
+		std::vector<glm::dvec2> positions_world((size_t)(centreline.getLength() / 0.03));
+		for (size_t i = 0; i < positions_world.size(); i++) {
+			const External::TrackCentreline::Sample sample = centreline.sampleAtDistance(i * 0.03);
+			positions_world[i] = sample.position_world + glm::dvec2(-sample.tangent_world.y, sample.tangent_world.x) * 2.0;
+		}
+
+		Internal::LapTimer timer(centreline);
+		double t = 0.0;
+		size_t i = 0;
+
+		for (auto _ : state) {
+			timer.update(t, positions_world[i], surfaceTypes, 4);
+
+			t += 0.001;
+			i = i + 1 == positions_world.size() ? 0 : i + 1;
+		}
+
+		state.SetItemsProcessed(state.iterations());
+		state.counters["laps"] = (double)timer.getLaps().size();
+	}
+
+	void BM_AutoDriverDrive(benchmark::State& state) {
+		const External::TrackCentreline& centreline = External::Environment::getDefault()->getTerrain().getTrackCentreline();
+
+		//A lap's worth of poses, 2 m right of the line, heading along it at 20 m/s
+		struct Pose {
+			glm::dvec3 position_world, velocity_world;
+			glm::dquat orientation_world;
+		};
+
+		std::vector<Pose> poses((size_t)(centreline.getLength() / 0.02));
+		for (size_t i = 0; i < poses.size(); i++) {
+			const External::TrackCentreline::Sample sample = centreline.sampleAtDistance(i * 0.02);
+			const glm::dvec2 position_world = sample.position_world + glm::dvec2(-sample.tangent_world.y, sample.tangent_world.x) * 2.0;
+
+			poses[i] = { glm::dvec3(position_world.x, 0.0, position_world.y), glm::dvec3(sample.tangent_world.x, 0.0, sample.tangent_world.y) * 20.0,
+				glm::angleAxis(atan2(-sample.tangent_world.x, -sample.tangent_world.y), glm::dvec3(0.0, 1.0, 0.0)) };
+		}
+
+		Internal::AutoDriver driver(centreline);
+		Internal::DriverInputs inputs;
+		size_t i = 0;
+
+		for (auto _ : state) {
+			driver.drive(poses[i].position_world, poses[i].velocity_world, poses[i].orientation_world, 2.5, 13.0, inputs);
+			benchmark::DoNotOptimize(inputs);
+
+			i = i + 1 == poses.size() ? 0 : i + 1;
+		}
+
+		state.SetItemsProcessed(state.iterations());
+	}
+
+	void BM_TerrainGenerate(benchmark::State& state) {
+		External::Terrain terrain;
+
+		for (auto _ : state)
+			terrain.generate();
+
+		state.SetItemsProcessed(state.iterations() * terrain.getSize() * terrain.getSize());
+	}
+}
+
+BENCHMARK(BM_PacejkaUpdateForces)->ArgsProduct({ { 0, 1 }, { 0, 1, 2 } });
+BENCHMARK(BM_TerrainGetHeight)->Arg(0)->Arg(1);
+BENCHMARK(BM_TerrainStreamedGetHeight)->Arg(0)->Arg(1);
+BENCHMARK(BM_TerrainGetNormal)->Arg(0)->Arg(1);
+BENCHMARK(BM_TerrainSampleContacts)->Arg(0)->Arg(1);
+BENCHMARK(BM_TerrainCompactSampleContacts)->Arg(0)->Arg(1);
+BENCHMARK(BM_TerrainRaycast)->Arg(16)->Arg(128)->Arg(1024);
+BENCHMARK(BM_WheelSystemUpdate);
+BENCHMARK(BM_CarUpdate);
+BENCHMARK(BM_CarUpdateWithTelemetry);
+BENCHMARK(BM_RangeSensorScan)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TrackConstruction)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TrackCentrelineLookUp)->Arg(0)->Arg(1);
+BENCHMARK(BM_LapTimerUpdate);
+BENCHMARK(BM_AutoDriverDrive);
+BENCHMARK(BM_TerrainGenerate)->Unit(benchmark::kMillisecond);
+
+int main(int argc, char* argv[]) {
+	//JSON goes to vds-bench.json unless an output file was asked for
+	static char
+		defaultOutput[] = "--benchmark_out=vds-bench.json",
+		defaultOutputFormat[] = "--benchmark_out_format=json";
+
+	std::vector<char*> args(argv, argv + argc);
+	bool outputGiven = false;
+
+	for (int i = 1; i < argc; i++)
+		outputGiven = outputGiven || strncmp(argv[i], "--benchmark_out=", 16) == 0;
+
+	if (!outputGiven) {
+		args.push_back(defaultOutput);
+		args.push_back(defaultOutputFormat);
+	}
+
+	int argCount = (int)args.size();
+	benchmark::Initialize(&argCount, args.data());
+	if (benchmark::ReportUnrecognizedArguments(argCount, args.data()))
+		return 1;
+
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+
+	return 0;
+}
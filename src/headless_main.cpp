@@ -0,0 +1,382 @@
+/* vds-run
+ * Steps a single Car as fast as possible with no window, graphics context or keyboard, and reports throughput.
+ * With --vehicles=N, steps N identical vehicles together in a VehicleBatch instead (steps/s then counts vehicle-steps).
+ * --simd selects the instruction set used for batched tyre forces (default: the best the CPU supports).
+ * --tyre-table reads tyre forces from an interpolated TyreForceTable instead of the Magic Formula, and reports its max error.
+ * --load-tolerance lets each tyre reuse its load-dependent Magic Formula terms until its load moves by more than N newtons.
+ * --trace writes the VDS_PROFILE_SCOPE timings as Chrome trace JSON (only in builds configured with -DVDS_PROFILE=ON).
+ * --terrain-seed picks the terrain (default 1). --terrain-cache saves generated terrain to DIR, and maps it from there
+ * on later runs with the same seed instead of generating it again. --terrain-size sets the height samples along each side
+ * (default 291). --terrain-streamed generates the terrain in tiles around the car instead, keeping at most MB of them in
+ * memory (default 256), and lets the car drive on past the terrain's size. --terrain-compact stores it quantised, in about
+ * a sixth of the memory.
+ * --lidar scans the terrain from a RangeSensor on the car HZ times per simulated second (default 10), in the background
+ * while the car is stepped, and reports the scans' points and any dropped for the last still running (single Car only).
+ * --laps times the car (or the batch's first vehicle) round the track with a LapTimer, and reports its laps, best lap,
+ * progress round the current one and track-limit violations.
+ * --input-trace drives the car from an input trace recorded earlier instead of --throttle and --steer, and --record-inputs
+ * records whatever drives it to FILE, to be played back later (single Car only).
+ * --auto-drive has an AutoDriver drive the car (or each of the batch's vehicles) round the track, at the planned speeds
+ * and by pure pursuit of its centreline, instead of --throttle and --steer.
+ * --telemetry records the car's state and each wheel's load, slip, tyre force, suspension and steering every step to a
+ * TelemetryRecorder log at FILE, and reports the records written and any dropped (single Car only).
+ *
+ * Usage: vds-run [--steps=N] [--dt=SECONDS] [--throttle=0..1] [--steer=DEGREES] [--vehicles=N] [--simd=scalar|avx2|avx512] [--tyre-table[=bilinear|bicubic]] [--load-tolerance=N] [--trace=FILE]
+ *                [--terrain-seed=N] [--terrain-size=N] [--terrain-cache=DIR] [--terrain-streamed[=MB]]
+ *                [--terrain-compact] [--lidar[=HZ]] [--laps] [--auto-drive] [--input-trace=FILE] [--record-inputs=FILE] [--telemetry=FILE] [--quiet]
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+#include "Car.h"
+#include "LapTimer.h"
+#include "AutoDriver.h"
+#include "DriverInputs.h"
+#include "RangeSensor.h"
+#include "Environment.h"
+#include "VehicleBatch.h"
+#include "TyreForceTable.h"
+#include "TelemetryRecorder.h"
+#include "Profiler.h"
+
+namespace {
+	struct RunSettings {
+		unsigned long long mSteps = 1000000;
+		unsigned int mVehicles = 0;       //0 = a single Car, without VehicleBatch
+		double
+			mUpdateDelta = 1.0 / 1000.0,  //s
+			mThrottle = 1.0,              //0.0 -> 1.0
+			mSteeringWheelAngle = 0.0,    //degs
+			mLoadTolerance = 0.0,         //N
+			mLidarRate = 0.0;             //Hz, 0 for no lidar
+		const char
+			*mTracePath = nullptr,
+			*mInputTracePath = nullptr,
+			*mRecordInputsPath = nullptr,
+			*mTelemetryPath = nullptr;
+		External::Terrain::Settings mTerrainSettings;
+		bool
+			mQuiet = false,
+			mTyreTable = false,
+			mLaps = false,
+			mAutoDrive = false;
+		Internal::TyreForceTable::Interpolation mTyreTableInterpolation = Internal::TyreForceTable::Interpolation::BICUBIC;
+		Internal::PacejkaMagicFormula::SimdLevel mSimdLevel = Internal::PacejkaMagicFormula::getSupportedSimdLevel();
+	};
+
+	Internal::PacejkaMagicFormula::SimdLevel parseSimdLevel(const char* value) {
+		using Internal::PacejkaMagicFormula;
+
+		if (strcmp(value, "avx512") == 0) return PacejkaMagicFormula::SimdLevel::AVX512;
+		if (strcmp(value, "avx2") == 0)   return PacejkaMagicFormula::SimdLevel::AVX2;
+		return PacejkaMagicFormula::SimdLevel::SCALAR;
+	}
+
+	const char* simdLevelName(Internal::PacejkaMagicFormula::SimdLevel level) {
+		using Internal::PacejkaMagicFormula;
+
+		switch (level) {
+		case PacejkaMagicFormula::SimdLevel::AVX512: return "avx512";
+		case PacejkaMagicFormula::SimdLevel::AVX2: return "avx2";
+		default: return "scalar";
+		}
+	}
+
+	bool parseArgument(const char* arg, const char* name, const char** value) {
+		const size_t nameLength = strlen(name);
+
+		if (strncmp(arg, name, nameLength) != 0 || arg[nameLength] != '=')
+			return false;
+
+		*value = arg + nameLength + 1;
+		return true;
+	}
+
+	bool parseSettings(int argc, char* argv[], RunSettings& settings) {
+		const char* value = nullptr;
+
+		for (int i = 1; i < argc; i++) {
+			if (parseArgument(argv[i], "--steps", &value))         settings.mSteps = strtoull(value, nullptr, 10);
+			else if (parseArgument(argv[i], "--dt", &value))       settings.mUpdateDelta = atof(value);
+			else if (parseArgument(argv[i], "--throttle", &value)) settings.mThrottle = atof(value);
+			else if (parseArgument(argv[i], "--steer", &value))    settings.mSteeringWheelAngle = atof(value);
+			else if (parseArgument(argv[i], "--vehicles", &value)) settings.mVehicles = (unsigned int)strtoul(value, nullptr, 10);
+			else if (parseArgument(argv[i], "--simd", &value))     settings.mSimdLevel = parseSimdLevel(value);
+			else if (parseArgument(argv[i], "--tyre-table", &value)) {
+				settings.mTyreTable = true;
+				settings.mTyreTableInterpolation = strcmp(value, "bilinear") == 0 ? Internal::TyreForceTable::Interpolation::BILINEAR : Internal::TyreForceTable::Interpolation::BICUBIC;
+			}
+			else if (strcmp(argv[i], "--tyre-table") == 0)         settings.mTyreTable = true;
+			else if (parseArgument(argv[i], "--load-tolerance", &value)) settings.mLoadTolerance = atof(value);
+			else if (parseArgument(argv[i], "--trace", &value))    settings.mTracePath = value;
+			else if (parseArgument(argv[i], "--terrain-seed", &value))  settings.mTerrainSettings.seed = strtoull(value, nullptr, 10);
+			else if (parseArgument(argv[i], "--terrain-size", &value))  settings.mTerrainSettings.size = (unsigned int)strtoul(value, nullptr, 10);
+			else if (parseArgument(argv[i], "--terrain-cache", &value)) settings.mTerrainSettings.cacheDirectory = value;
+			else if (parseArgument(argv[i], "--terrain-streamed", &value)) {
+				settings.mTerrainSettings.streamed = true;
+				settings.mTerrainSettings.tileMemoryBudget = (size_t)strtoull(value, nullptr, 10) << 20;
+			}
+			else if (strcmp(argv[i], "--terrain-streamed") == 0)   settings.mTerrainSettings.streamed = true;
+			else if (strcmp(argv[i], "--terrain-compact") == 0)    settings.mTerrainSettings.compact = true;
+			else if (parseArgument(argv[i], "--lidar", &value))    settings.mLidarRate = atof(value);
+			else if (strcmp(argv[i], "--lidar") == 0)              settings.mLidarRate = 10.0;
+			else if (strcmp(argv[i], "--laps") == 0)               settings.mLaps = true;
+			else if (strcmp(argv[i], "--auto-drive") == 0)         settings.mAutoDrive = true;
+			else if (parseArgument(argv[i], "--input-trace", &value))   settings.mInputTracePath = value;
+			else if (parseArgument(argv[i], "--record-inputs", &value)) settings.mRecordInputsPath = value;
+			else if (parseArgument(argv[i], "--telemetry", &value))   settings.mTelemetryPath = value;
+			else if (strcmp(argv[i], "--quiet") == 0)              settings.mQuiet = true;
+			else {
+				printf("Unknown argument: %s\n", argv[i]);
+				printf("Usage: vds-run [--steps=N] [--dt=SECONDS] [--throttle=0..1] [--steer=DEGREES] [--vehicles=N] [--simd=scalar|avx2|avx512] [--tyre-table[=bilinear|bicubic]] [--load-tolerance=N] [--trace=FILE] [--terrain-seed=N] [--terrain-size=N] [--terrain-cache=DIR] [--terrain-streamed[=MB]] [--terrain-compact] [--lidar[=HZ]] [--laps] [--auto-drive] [--input-trace=FILE] [--record-inputs=FILE] [--telemetry=FILE] [--quiet]\n");
+				return false;
+			}
+		}
+
+		return settings.mUpdateDelta > 0.0;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	RunSettings settings;
+	if (!parseSettings(argc, argv, settings))
+		return 1;
+
+	Internal::PacejkaMagicFormula::setSimdLevel(settings.mSimdLevel);
+
+	//Timings are only recorded when a trace was asked for; a Car step records 10 events (up to 4M are kept)
+	Internal::Profiler::setEnabled(settings.mTracePath != nullptr);
+	Internal::Profiler::setThreadCapacity((size_t)std::min(settings.mSteps * 10, 1ull << 22));
+
+	if (settings.mTracePath && !Internal::Profiler::isCompiledIn())
+		printf("warning: built without VDS_PROFILE, so --trace will record no timings\n");
+
+	if (settings.mLoadTolerance > 0.0) {
+		Internal::PacejkaParams params = *Internal::PacejkaParams::getPublished();
+		params.loadTolerance_N = settings.mLoadTolerance;
+		Internal::PacejkaParams::publish(params);
+	}
+
+	const auto terrainStart = std::chrono::steady_clock::now();
+	const std::shared_ptr<const External::Environment> environment = std::make_shared<const External::Environment>(settings.mTerrainSettings);
+	const double terrainSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - terrainStart).count();
+
+	Internal::Car car(environment);
+
+	if (settings.mTyreTable) {
+		Internal::TyreForceTable::Settings tableSettings;
+		tableSettings.interpolation = settings.mTyreTableInterpolation;
+		Internal::TyreForceTable::setSharedSettings(tableSettings);
+		Internal::Tyre::setForceModel(Internal::Tyre::ForceModel::TABLE);
+	}
+
+	car.getTorqueGenerator().setThrottle(settings.mThrottle);
+	car.getControlSystem().setSteeringWheelAngle(settings.mSteeringWheelAngle);
+
+	//Without a trace or AutoDriver, a recording is of the steady --throttle and --steer
+	std::shared_ptr<const Internal::AutoDriver::Plan> autoDriverPlan;
+	if (settings.mAutoDrive)
+		autoDriverPlan = std::make_shared<const Internal::AutoDriver::Plan>(environment->getTerrain().getTrackCentreline(), Internal::AutoDriver::Settings());
+
+	std::shared_ptr<Internal::DriverInputSource> inputSource;
+	std::shared_ptr<Internal::TraceInputSource> inputTrace;
+	std::shared_ptr<Internal::RecordingInputSource> inputRecording;
+
+	if (settings.mInputTracePath) {
+		inputSource = inputTrace = std::make_shared<Internal::TraceInputSource>();
+		if (!inputTrace->open(settings.mInputTracePath)) {
+			printf("Could not read input trace %s\n", settings.mInputTracePath);
+			return 1;
+		}
+	}
+	else if (autoDriverPlan)
+		inputSource = std::make_shared<Internal::AutoDriver>(autoDriverPlan);
+	else if (settings.mRecordInputsPath) {
+		Internal::DriverInputs steady;
+		steady.throttle = settings.mThrottle;
+		steady.steeringWheelAngle = settings.mSteeringWheelAngle;
+		inputSource = std::make_shared<Internal::ScriptedInputSource>(std::vector<Internal::ScriptedInputSource::Keyframe>{ { 0.0, steady } });
+	}
+
+	if (settings.mRecordInputsPath) {
+		inputSource = inputRecording = std::make_shared<Internal::RecordingInputSource>(inputSource);
+		if (!inputRecording->open(settings.mRecordInputsPath)) {
+			printf("Could not write input trace %s\n", settings.mRecordInputsPath);
+			return 1;
+		}
+	}
+
+	car.setInputSource(inputSource);
+
+	Internal::VehicleBatch batch;
+	batch.reserve(settings.mVehicles);
+	for (unsigned int v = 0; v < settings.mVehicles; v++)
+		batch.addVehicle(car);
+
+	std::vector<Internal::AutoDriver> autoDrivers;
+	if (autoDriverPlan)
+		autoDrivers.assign(settings.mVehicles, Internal::AutoDriver(autoDriverPlan));
+
+	double t = 0.0;
+	size_t
+		lidarRays = 0,
+		lidarScans = 0,
+		lidarScansDropped = 0,
+		lidarPoints = 0;
+
+	std::unique_ptr<Internal::LapTimer> lapTimer;
+	if (settings.mLaps)
+		lapTimer = std::make_unique<Internal::LapTimer>(environment->getTerrain().getTrackCentreline());
+
+	std::unique_ptr<Internal::TelemetryRecorder> telemetry;
+	if (settings.mTelemetryPath && !settings.mVehicles) {
+		telemetry = std::make_unique<Internal::TelemetryRecorder>();
+		if (!telemetry->open(settings.mTelemetryPath)) {
+			printf("Could not write telemetry %s\n", settings.mTelemetryPath);
+			return 1;
+		}
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+
+	if (settings.mVehicles) {
+		const double
+			wheelBase = car.getWheelSystem().getWheelBase(),
+			steeringRatio = car.getControlSystem().getSteeringRatio();
+
+		for (unsigned long long i = 0; i < settings.mSteps; i++) {
+			for (size_t v = 0; v < autoDrivers.size(); v++) {
+				Internal::DriverInputs inputs;
+				autoDrivers[v].drive(batch.getPosition_world(v), batch.getVelocity_world(v), batch.getOrientation_world(v), wheelBase, steeringRatio, inputs);
+				batch.applyInputs(v, inputs, settings.mUpdateDelta);
+			}
+
+			batch.step(settings.mUpdateDelta);
+			t += settings.mUpdateDelta;
+
+			if (lapTimer) {
+				const glm::dvec3 position_world = batch.getPosition_world(0);
+				const unsigned char surfaceTypes[4] = { batch.getSurfaceType(0, 0), batch.getSurfaceType(0, 1), batch.getSurfaceType(0, 2), batch.getSurfaceType(0, 3) };
+				lapTimer->update(t, glm::dvec2(position_world.x, position_world.z), surfaceTypes, 4);
+			}
+		}
+	}
+	else if (settings.mLidarRate > 0.0) {
+		Internal::RangeSensor sensor;
+		Internal::RangeSensor::PointCloud cloud;
+		const unsigned long long stepsPerScan = std::max(1ll, std::llround(1.0 / (settings.mLidarRate * settings.mUpdateDelta)));
+
+		for (unsigned long long i = 0; i < settings.mSteps; i++) {
+			if (i % stepsPerScan == 0)
+				lidarScansDropped += !sensor.startScan(car, t);
+
+			car.update(t, settings.mUpdateDelta);
+			t += settings.mUpdateDelta;
+
+			if (telemetry)
+				telemetry->record(car, t);
+
+			if (lapTimer)
+				lapTimer->update(car, t);
+
+			if (sensor.takeScan(cloud)) {
+				lidarScans++;
+				lidarPoints += cloud.points.size();
+			}
+		}
+
+		sensor.waitForScan();
+		if (sensor.takeScan(cloud)) {
+			lidarScans++;
+			lidarPoints += cloud.points.size();
+		}
+
+		lidarRays = sensor.getRayCount();
+	}
+	else {
+		for (unsigned long long i = 0; i < settings.mSteps; i++) {
+			car.update(t, settings.mUpdateDelta);
+			t += settings.mUpdateDelta;
+
+			if (telemetry)
+				telemetry->record(car, t);
+
+			if (lapTimer)
+				lapTimer->update(car, t);
+		}
+	}
+
+	const double
+		wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(),
+		vehicleSteps = (double)settings.mSteps * (settings.mVehicles ? settings.mVehicles : 1);
+
+	if (inputRecording && !inputRecording->close()) {
+		printf("Could not write input trace %s\n", settings.mRecordInputsPath);
+		return 1;
+	}
+
+	if (telemetry && !telemetry->close()) {
+		printf("Could not write telemetry %s\n", settings.mTelemetryPath);
+		return 1;
+	}
+
+	const glm::dvec3
+		position = settings.mVehicles ? batch.getPosition_world(0) : car.getState().getPosition_world(),
+		velocity = settings.mVehicles ? batch.getVelocity_world(0) : car.getState().getVelocity_world();
+
+	if (!settings.mQuiet) {
+		const External::Terrain& terrain = environment->getTerrain();
+		if (terrain.isStreamed())
+			printf("terrain:         seed %llu, streamed%s: %zu tiles generated, %zu resident (%.1f of %zu MB)\n", terrain.getSeed(), terrain.isCompact() ? ", compact" : "",
+				terrain.getTileCache()->getGeneratedCount(), terrain.getTileCache()->getResidentCount(), terrain.getMemoryBytes() / 1048576.0, terrain.getTileCache()->getMemoryBudget() >> 20);
+		else
+			printf("terrain:         seed %llu, %u x %u%s (%.1f MB), %s in %.1f ms\n", terrain.getSeed(), terrain.getSize(), terrain.getSize(), terrain.isCompact() ? ", compact" : "",
+				terrain.getMemoryBytes() / 1048576.0, terrain.isLoadedFromCache() ? "mapped from cache" : "generated", terrainSeconds * 1000.0);
+		printf("steps:           %llu\n", settings.mSteps);
+		if (settings.mVehicles)
+			printf("vehicles:        %u (tyre forces: %s)\n", settings.mVehicles, simdLevelName(Internal::PacejkaMagicFormula::getSimdLevel()));
+		if (settings.mTyreTable) {
+			const Internal::TyreForceTable::MaxError error = Internal::TyreForceTable::getFor(Internal::PacejkaParams::getPublished())->measureMaxError();
+			printf("tyre table:      max error %.1f N longitudinal (%.3f%%), %.1f N lateral (%.3f%%)\n",
+				error.longitudinal_N, error.longitudinalRelative * 100.0, error.lateral_N, error.lateralRelative * 100.0);
+		}
+		if (lidarScans)
+			printf("lidar:           %zu scans of %zu rays at %.0f Hz (%zu dropped), %.0f points per scan\n", lidarScans, lidarRays, settings.mLidarRate,
+				lidarScansDropped, (double)lidarPoints / lidarScans);
+		if (lapTimer)
+			printf("laps:            %zu (best %.3f s), %.1f%% round the current one, %u track-limit violations\n", lapTimer->getLaps().size(),
+				lapTimer->getBestLapTime(), lapTimer->getProgressPercent(), lapTimer->getTotalViolations());
+		if (inputTrace)
+			printf("inputs:          %zu records played from %s\n", inputTrace->getRecordCount(), settings.mInputTracePath);
+		if (inputRecording)
+			printf("inputs:          %zu records written to %s\n", inputRecording->getRecordCount(), settings.mRecordInputsPath);
+		if (telemetry)
+			printf("telemetry:       %llu records written to %s (%zu dropped)\n", (unsigned long long)telemetry->getWrittenCount(), settings.mTelemetryPath,
+				telemetry->getDroppedCount());
+		printf("simulated time:  %.3f s\n", t);
+		printf("wall time:       %.3f s\n", wallSeconds);
+		printf("steps/s:         %.0f\n", wallSeconds > 0.0 ? vehicleSteps / wallSeconds : 0.0);
+		printf("real-time ratio: %.1fx\n", wallSeconds > 0.0 ? t / wallSeconds : 0.0);
+		printf("final position:  (%.3f, %.3f, %.3f)\n", position.x, position.y, position.z);
+		printf("final speed:     %.3f m/s\n", glm::length(velocity));
+	}
+	else
+		printf("%.0f\n", wallSeconds > 0.0 ? vehicleSteps / wallSeconds : 0.0);
+
+	if (settings.mTracePath) {
+		if (!Internal::Profiler::writeChromeTrace(settings.mTracePath)) {
+			printf("Could not write %s\n", settings.mTracePath);
+			return 1;
+		}
+
+		if (!settings.mQuiet)
+			printf("trace:           %zu events to %s (%zu older overwritten)\n", Internal::Profiler::getEventCount(), settings.mTracePath, Internal::Profiler::getWrappedCount());
+	}
+
+	return 0;
+}
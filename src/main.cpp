@@ -1,4 +1,22 @@
+#include <new>
+#include <cstdlib>
+
 #include "VehicleSimulation.h"
+#include "FrameStats.h"
+
+//Every heap allocation is counted for the Performance panel (operator new[] and the sized deletes forward to these)
+void* operator new(std::size_t size) {
+	Internal::FrameStats::countAllocation();
+
+	if (void* memory = std::malloc(size ? size : 1))
+		return memory;
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+	std::free(memory);
+}
 
 int main() {
 	VehicleSimulation sim;
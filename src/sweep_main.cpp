@@ -0,0 +1,138 @@
+/* vds-sweep
+ * Runs a design-of-experiments study: one headless Car per sample of the varied parameters, spread over all cores,
+ * writing one CSV row per run (to --out, or stdout). A summary goes to stderr.
+ * Parameters are varied with --NAME=MIN:MAX; the rest keep the stock Car's values. --tyre-set takes indices
+ * (0 = drifting, 1 = road).
+ * --sampling=grid runs --levels^(varied parameters) runs; lhs and sobol run --runs runs.
+ *
+ * Usage: vds-sweep [--mass=MIN:MAX] [--spring=MIN:MAX] [--damping=MIN:MAX] [--cd=MIN:MAX] [--area=MIN:MAX]
+ *                  [--steering-ratio=MIN:MAX] [--tyre-set=MIN:MAX] [--sampling=grid|lhs|sobol] [--runs=N] [--levels=N]
+ *                  [--seed=N] [--threads=N] [--duration=SECONDS] [--dt=SECONDS] [--throttle=0..1] [--steer=DEGREES]
+ *                  [--out=FILE]
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+
+#include "ParameterSweep.h"
+#include "WorkStealingPool.h"
+
+namespace {
+	using Internal::ParameterSweep;
+
+	struct SweepSettings {
+		ParameterSweep::Sampling mSampling = ParameterSweep::Sampling::SOBOL;
+		ParameterSweep::Scenario mScenario;
+		size_t mRuns = 64;
+		unsigned int
+			mLevels = 3,
+			mThreads = 0;                 //0 = one per hardware thread
+		unsigned long long mSeed = 1;
+		const char* mOutputPath = nullptr;
+	};
+
+	bool parseArgument(const char* arg, const char* name, const char** value) {
+		const size_t nameLength = strlen(name);
+
+		if (strncmp(arg, name, nameLength) != 0 || arg[nameLength] != '=')
+			return false;
+
+		*value = arg + nameLength + 1;
+		return true;
+	}
+
+	bool parseRange(const char* arg, ParameterSweep& sweep) {
+		const char* value = nullptr;
+
+		for (unsigned char p = 0; p < ParameterSweep::PARAMETER_COUNT; p++) {
+			char name[32];
+			snprintf(name, sizeof(name), "--%s", ParameterSweep::getParameterName((ParameterSweep::Parameter)p));
+
+			if (!parseArgument(arg, name, &value))
+				continue;
+
+			double min, max;
+			if (sscanf(value, "%lf:%lf", &min, &max) != 2)
+				return false;
+
+			sweep.vary((ParameterSweep::Parameter)p, min, max);
+			return true;
+		}
+
+		return false;
+	}
+
+	//Anything but the three names is reported as an unknown argument, rather than falling back to one of them
+	bool parseSampling(const char* value, ParameterSweep::Sampling& sampling) {
+		if (strcmp(value, "grid") == 0)       sampling = ParameterSweep::Sampling::GRID;
+		else if (strcmp(value, "lhs") == 0)   sampling = ParameterSweep::Sampling::LATIN_HYPERCUBE;
+		else if (strcmp(value, "sobol") == 0) sampling = ParameterSweep::Sampling::SOBOL;
+		else                                  return false;
+
+		return true;
+	}
+
+	bool parseSettings(int argc, char* argv[], SweepSettings& settings, ParameterSweep& sweep) {
+		const char* value = nullptr;
+
+		for (int i = 1; i < argc; i++) {
+			if (parseRange(argv[i], sweep))                          continue;
+			else if (parseArgument(argv[i], "--runs", &value))       settings.mRuns = strtoull(value, nullptr, 10);
+			else if (parseArgument(argv[i], "--levels", &value))     settings.mLevels = (unsigned int)strtoul(value, nullptr, 10);
+			else if (parseArgument(argv[i], "--seed", &value))       settings.mSeed = strtoull(value, nullptr, 10);
+			else if (parseArgument(argv[i], "--threads", &value))    settings.mThreads = (unsigned int)strtoul(value, nullptr, 10);
+			else if (parseArgument(argv[i], "--duration", &value))   settings.mScenario.duration = atof(value);
+			else if (parseArgument(argv[i], "--dt", &value))         settings.mScenario.updateDelta = atof(value);
+			else if (parseArgument(argv[i], "--throttle", &value))   settings.mScenario.throttle = atof(value);
+			else if (parseArgument(argv[i], "--steer", &value))      settings.mScenario.steeringWheelAngle = atof(value);
+			else if (parseArgument(argv[i], "--out", &value))        settings.mOutputPath = value;
+			else if (parseArgument(argv[i], "--sampling", &value) && parseSampling(value, settings.mSampling)) continue;
+			else {
+				fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+				fprintf(stderr, "Usage: vds-sweep [--mass|--spring|--damping|--cd|--area|--steering-ratio|--tyre-set=MIN:MAX]... "
+					"[--sampling=grid|lhs|sobol] [--runs=N] [--levels=N] [--seed=N] [--threads=N] [--duration=SECONDS] [--dt=SECONDS] "
+					"[--throttle=0..1] [--steer=DEGREES] [--out=FILE]\n");
+				return false;
+			}
+		}
+
+		return settings.mScenario.updateDelta > 0.0;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	SweepSettings settings;
+	ParameterSweep sweep;
+
+	if (!parseSettings(argc, argv, settings, sweep))
+		return 1;
+
+	FILE* output = settings.mOutputPath ? fopen(settings.mOutputPath, "w") : stdout;
+	if (!output) {
+		fprintf(stderr, "Could not open %s\n", settings.mOutputPath);
+		return 1;
+	}
+
+	const std::vector<ParameterSweep::Sample> samples = sweep.generate(settings.mSampling, settings.mRuns, settings.mLevels, settings.mSeed);
+	Internal::WorkStealingPool pool(settings.mThreads);
+
+	const auto start = std::chrono::steady_clock::now();
+	const std::vector<ParameterSweep::Result> results = sweep.run(samples, settings.mScenario, pool);
+	const double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	ParameterSweep::writeCsvHeader(output);
+	for (const ParameterSweep::Result& result : results)
+		ParameterSweep::writeCsvRow(output, result);
+
+	if (output != stdout)
+		fclose(output);
+
+	fprintf(stderr, "runs:            %zu (%zu parameters varied)\n", results.size(), sweep.getVariedCount());
+	fprintf(stderr, "threads:         %u (%zu steals)\n", pool.getThreadCount(), pool.getStealCount());
+	fprintf(stderr, "wall time:       %.3f s\n", wallSeconds);
+	fprintf(stderr, "runs/s:          %.2f\n", wallSeconds > 0.0 ? results.size() / wallSeconds : 0.0);
+
+	return 0;
+}
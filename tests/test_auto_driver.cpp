@@ -0,0 +1,84 @@
+#include <stdio.h>
+#include <math.h>
+#include "Car.h"
+#include "LapTimer.h"
+#include "AutoDriver.h"
+#include "VehicleBatch.h"
+
+using External::TrackCentreline;
+using Internal::AutoDriver;
+
+int main() {
+	const TrackCentreline& centreline = External::Environment::getDefault()->getTerrain().getTrackCentreline();
+	const AutoDriver::Settings settings;
+	const auto plan = std::make_shared<const AutoDriver::Plan>(centreline, settings);
+
+	//The planned speeds take every corner within the grip allowed, and can be braked down to in time
+	const std::vector<double>& speeds = plan->getSpeeds();
+	const double interval = centreline.getLength() / speeds.size();
+
+	for (size_t i = 0; i < speeds.size(); i++) {
+		const double
+			curvature = fabs(centreline.sampleAtDistance(i * interval).curvature),
+			following = speeds[i + 1 < speeds.size() ? i + 1 : 0];
+
+		if (speeds[i] <= 0.0 || speeds[i] > settings.maxSpeed || speeds[i] * speeds[i] * curvature > settings.maxLateralAccel + 1e-9 ||
+			speeds[i] * speeds[i] > following * following + 2.0 * settings.maxDeceleration * interval + 1e-9) {
+			printf("Failed: planned %f m/s %f m along the line, with a curvature of %f\n", speeds[i], i * interval, curvature);
+			return 1;
+		}
+	}
+
+	//From rest, round the track inside its limits, and on again
+	Internal::Car car;
+	const auto driver = std::make_shared<AutoDriver>(plan);
+	car.setInputSource(driver);
+
+	Internal::LapTimer timer(centreline);
+	const double dt = 0.001;
+	double furthestOff = 0.0;
+
+	for (unsigned int step = 0; step < 130000; step++) {
+		car.update(step * dt, dt);
+		timer.update(car, (step + 1) * dt);
+
+		if (timer.isTiming())
+			furthestOff = std::max(furthestOff, fabs(timer.getLateralOffset()));
+	}
+
+	if (timer.getLaps().size() != 1 || timer.getTotalViolations() != 0 || furthestOff > 10.0 || timer.getProgressPercent() < 5.0) {
+		printf("Failed: %zu laps with %u track-limit violations, up to %f m off the line\n", timer.getLaps().size(), timer.getTotalViolations(), furthestOff);
+		return 1;
+	}
+
+	//A vehicle of a VehicleBatch driven the same way goes exactly where the Car did (bit-for-bit equality is only
+	//promised for the scalar tyre force path)
+	Internal::PacejkaMagicFormula::setSimdLevel(Internal::PacejkaMagicFormula::SimdLevel::SCALAR);
+
+	Internal::Car start;
+	Internal::VehicleBatch batch;
+	batch.addVehicle(start);
+
+	AutoDriver batchDriver(plan);
+	Internal::Car driven;
+	driven.setInputSource(std::make_shared<AutoDriver>(plan));
+
+	for (unsigned int step = 0; step < 20000; step++) {
+		Internal::DriverInputs inputs;
+		batchDriver.drive(batch.getPosition_world(0), batch.getVelocity_world(0), batch.getOrientation_world(0), start.getWheelSystem().getWheelBase(),
+			start.getControlSystem().getSteeringRatio(), inputs);
+		batch.applyInputs(0, inputs, dt);
+		batch.step(dt);
+
+		driven.update(step * dt, dt);
+	}
+
+	if (batch.getPosition_world(0) != driven.getState().getPosition_world()) {
+		printf("Failed: the batch's vehicle drove to (%f, %f), the Car to (%f, %f)\n", batch.getPosition_world(0).x, batch.getPosition_world(0).z,
+			driven.getState().getPosition_world().x, driven.getState().getPosition_world().z);
+		return 1;
+	}
+
+	printf("Passed: a lap in %f s, at most %f m off the line\n", timer.getBestLapTime(), furthestOff);
+	return 0;
+}
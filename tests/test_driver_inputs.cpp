@@ -0,0 +1,128 @@
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include <string>
+#include <filesystem>
+#include "Car.h"
+#include "AutoDriver.h"
+#include "DriverInputs.h"
+#include "Environment.h"
+
+using Internal::Car;
+using Internal::DriverInputs;
+
+//Steps a Car from rest, returning where it ends up
+static glm::dvec3 drive(Car& car, unsigned int steps, double dt) {
+	for (unsigned int step = 0; step < steps; step++)
+		car.update(step * dt, dt);
+
+	return car.getState().getPosition_world();
+}
+
+//Records a drive from source to path, then plays it back on another car, which must end up exactly where the first did.
+//Returns the records written, or 0 on failure
+static size_t recordAndPlay(std::shared_ptr<Internal::DriverInputSource> source, const std::string& path, const char* name, unsigned int steps, double dt) {
+	Car recorded;
+	auto recording = std::make_shared<Internal::RecordingInputSource>(source);
+	if (!recording->open(path)) {
+		printf("Failed: could not write %s\n", path.c_str());
+		return 0;
+	}
+
+	recorded.setInputSource(recording);
+	const glm::dvec3 recordedPosition = drive(recorded, steps, dt);
+	const size_t recordCount = recording->getRecordCount();
+
+	if (!recording->close() || recordCount == 0) {
+		printf("Failed: no records of the %s written\n", name);
+		return 0;
+	}
+
+	Car played;
+	auto trace = std::make_shared<Internal::TraceInputSource>();
+	if (!trace->open(path) || trace->getRecordCount() != recordCount) {
+		printf("Failed: could not read back %zu records of the %s\n", recordCount, name);
+		return 0;
+	}
+
+	played.setInputSource(trace);
+	const glm::dvec3 playedPosition = drive(played, steps, dt);
+
+	if (playedPosition != recordedPosition || played.getControlSystem().getSteeringWheelAngle() != recorded.getControlSystem().getSteeringWheelAngle() ||
+		played.getTorqueGenerator().getThrottle() != recorded.getTorqueGenerator().getThrottle()) {
+		printf("Failed: %s played back to (%f, %f, %f), recorded at (%f, %f, %f)\n", name, playedPosition.x, playedPosition.y, playedPosition.z,
+			recordedPosition.x, recordedPosition.y, recordedPosition.z);
+		return 0;
+	}
+
+	return recordCount;
+}
+
+int main() {
+	const double dt = 0.001;
+	const std::string path = (std::filesystem::temp_directory_path() /
+		("vds-test-driver-inputs-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".trace")).string();
+
+	//A step steer turns the wheel at its time, and not before
+	{
+		Car car;
+		car.setInputSource(std::make_shared<Internal::ScriptedInputSource>(Internal::ScriptedInputSource::makeStepSteer(1.0, 0.5, 90.0)));
+
+		drive(car, 500, dt);
+		const double before = car.getControlSystem().getSteeringWheelAngle();
+		car.update(500 * dt, dt);
+		const double after = car.getControlSystem().getSteeringWheelAngle();
+
+		if (before != 0.0 || after != 90.0 || car.getTorqueGenerator().getThrottle() != 1.0) {
+			printf("Failed: step steer from %f to %f degs\n", before, after);
+			return 1;
+		}
+	}
+
+	//A closed-loop drive (holding 8 m/s, weaving at 10 Hz, reversing and reset part way) is recorded, and played back exactly
+	auto controller = [](const Car& car, double t, double dt, DriverInputs& inputs) {
+		const double
+			speed = glm::length(car.getState().getVelocity_world()),
+			tick = floor(t * 10.0) / 10.0;
+
+		inputs.throttle = speed < 8.0 ? 1.0 : 0.0;
+		inputs.brake = speed > 9.0 ? 0.5 : 0.0;
+		inputs.steerByRate = t > 1.0;
+		inputs.steeringWheelAngle = 60.0 * sin(tick);
+		inputs.steeringWheelRate = 100.0 * cos(3.0 * tick);
+		inputs.toggleReverse = fabs(t - 2.0) < 0.5 * dt || fabs(t - 2.5) < 0.5 * dt;
+		inputs.reset = fabs(t - 3.0) < 0.5 * dt;
+	};
+
+	const size_t recordCount = recordAndPlay(std::make_shared<Internal::ControllerInputSource>(controller), path, "controller's drive", 4000, dt);
+	if (recordCount == 0)
+		return 1;
+
+	if (recordCount >= 4000) {
+		printf("Failed: %zu records written for 4000 steps\n", recordCount);
+		return 1;
+	}
+
+	//An AutoDriver's throttle, brake and steering vary continuously, and are played back exactly too
+	const External::TrackCentreline& centreline = External::Environment::getDefault()->getTerrain().getTrackCentreline();
+	const size_t autoDriverRecordCount = recordAndPlay(std::make_shared<Internal::AutoDriver>(centreline), path, "AutoDriver's drive", 4000, dt);
+	if (autoDriverRecordCount == 0)
+		return 1;
+
+	//Anything else is not a trace
+	FILE* file = fopen(path.c_str(), "wb");
+	fputs("not an input trace, but long enough to have a header", file);
+	fclose(file);
+
+	Internal::TraceInputSource notTrace;
+	const bool opened = notTrace.open(path);
+	std::filesystem::remove(path);
+
+	if (opened) {
+		printf("Failed: read a file that is not an input trace\n");
+		return 1;
+	}
+
+	printf("Passed: %zu records of a controller and %zu of an AutoDriver for 4000 steps, played back exactly\n", recordCount, autoDriverRecordCount);
+	return 0;
+}
@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include <string.h>
+#include <memory>
+#include <thread>
+#include "Car.h"
+#include "Environment.h"
+#include "VehicleBatch.h"
+
+using External::Environment;
+
+struct RunResult {
+	glm::dvec3 position_world;
+	glm::dvec3 momentum_world;
+};
+
+static RunResult drive(std::shared_ptr<const Environment> environment, unsigned int steps) {
+	const double dt = 1.0 / 120.0;
+
+	Internal::Car car(environment);
+	car.getTorqueGenerator().setThrottle(1.0);
+	car.getControlSystem().setSteeringWheelAngle(90.0);
+
+	for (unsigned int step = 0; step < steps; step++)
+		car.update(step * dt, dt);
+
+	return { car.getState().getPosition_world(), car.getState().getMomentum_world() };
+}
+
+static bool sameBits(const RunResult& a, const RunResult& b) {
+	return memcmp(&a.position_world, &b.position_world, sizeof(glm::dvec3)) == 0 && memcmp(&a.momentum_world, &b.momentum_world, sizeof(glm::dvec3)) == 0;
+}
+
+int main() {
+	const unsigned int steps = 1200;
+
+	Internal::PacejkaMagicFormula::setSimdLevel(Internal::PacejkaMagicFormula::SimdLevel::SCALAR);
+
+	//Cars constructed without an Environment share the lazily built default
+	Internal::Car stock;
+	if (&stock.getEnvironment() != Environment::getDefault().get() || Environment::getDefault()->getGravityAccel() != 9.80665) {
+		printf("Failed: default Environment\n");
+		return 1;
+	}
+
+	const std::shared_ptr<const Environment>
+		earth = std::make_shared<const Environment>(),
+		moon = std::make_shared<const Environment>(1.625, 0.0);
+
+	//Serial reference runs
+	const RunResult
+		earthSerial = drive(earth, steps),
+		moonSerial = drive(moon, steps);
+
+	if (sameBits(earthSerial, moonSerial)) {
+		printf("Failed: gravity and air density had no effect\n");
+		return 1;
+	}
+
+	//The same runs, concurrently, must not see each other's Environment
+	RunResult earthConcurrent, moonConcurrent;
+	std::thread earthThread([&]() { earthConcurrent = drive(earth, steps); });
+	std::thread moonThread([&]() { moonConcurrent = drive(moon, steps); });
+	earthThread.join();
+	moonThread.join();
+
+	if (!sameBits(earthSerial, earthConcurrent) || !sameBits(moonSerial, moonConcurrent)) {
+		printf("Failed: concurrent runs differ from serial runs\n");
+		return 1;
+	}
+
+	//A batch holding vehicles from both Environments simulates each in its own
+	Internal::Car earthCar(earth), moonCar(moon);
+	Internal::VehicleBatch batch;
+	batch.addVehicle(earthCar);
+	batch.addVehicle(moonCar);
+
+	const double dt = 1.0 / 120.0;
+	for (unsigned int step = 0; step < steps; step++) {
+		for (Internal::Car* car : { &earthCar, &moonCar }) {
+			car->getTorqueGenerator().setThrottle(1.0);
+			car->getControlSystem().setSteeringWheelAngle(90.0);
+		}
+		for (size_t v = 0; v < batch.size(); v++) {
+			batch.setThrottle(v, 1.0);
+			batch.setSteeringWheelAngle(v, 90.0);
+		}
+
+		earthCar.update(step * dt, dt);
+		moonCar.update(step * dt, dt);
+		batch.step(dt);
+	}
+
+	if (!sameBits({ batch.getPosition_world(0), batch.getMomentum_world(0) }, earthSerial) ||
+		!sameBits({ batch.getPosition_world(1), batch.getMomentum_world(1) }, moonSerial)) {
+		printf("Failed: batch vehicles do not match their Cars' Environments\n");
+		return 1;
+	}
+
+	printf("Passed\n");
+	return 0;
+}
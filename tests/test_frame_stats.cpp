@@ -0,0 +1,63 @@
+#include <stdio.h>
+#include "FrameStats.h"
+
+using Internal::FrameStats;
+
+int main() {
+	FrameStats stats;
+
+	//Partly filled: frames 1..100 ms of physics, in order
+	for (int i = 1; i <= 100; i++) {
+		stats.countPhysicsStep();
+		stats.addTime(FrameStats::PHYSICS, (float)i);
+		stats.endFrame();
+	}
+
+	FrameStats::Summary summary = stats.summarise(FrameStats::PHYSICS);
+	if (stats.getRecorded() != 100 || stats.getOldest() != 0 || summary.p50 != 50.0f || summary.p99 != 99.0f || summary.max != 100.0f ||
+		summary.mean != 50.5f || summary.overBudget != 100 - (unsigned int)stats.getBudget(FrameStats::PHYSICS)) {
+		printf("Failed: summary of 100 frames (p50 %.1f, p99 %.1f, max %.1f, mean %.2f, %u over budget)\n",
+			summary.p50, summary.p99, summary.max, summary.mean, summary.overBudget);
+		return 1;
+	}
+
+	//Wrapped: only the last FRAME_COUNT frames are kept, oldest first from getOldest
+	const size_t total = FrameStats::FRAME_COUNT + 50;
+	for (size_t i = 100; i < total; i++) {
+		stats.addTime(FrameStats::PHYSICS, (float)(i + 1));
+		stats.endFrame();
+	}
+
+	const FrameStats::Frame* frames = stats.getFrames();
+	for (size_t i = 0; i < FrameStats::FRAME_COUNT; i++)
+		if (frames[(stats.getOldest() + i) % FrameStats::FRAME_COUNT].physics != (float)(total - FrameStats::FRAME_COUNT + i + 1)) {
+			printf("Failed: ring order after wrapping\n");
+			return 1;
+		}
+
+	if (stats.getLatest().physics != (float)total || stats.getLatest().physicsSteps != 0.0f) {
+		printf("Failed: latest frame\n");
+		return 1;
+	}
+
+	//UI time is taken out of render time, and allocations are counted per frame
+	stats.addTime(FrameStats::RENDER, 5.0f);
+	stats.addTime(FrameStats::UI, 2.0f);
+	for (int i = 0; i < 7; i++)
+		FrameStats::countAllocation();
+	stats.endFrame();
+
+	if (stats.getLatest().render != 3.0f || stats.getLatest().ui != 2.0f || stats.getLatest().allocations < 7.0f || stats.getLatest().frame < 0.0f) {
+		printf("Failed: render %.1f, ui %.1f, allocations %.0f\n", stats.getLatest().render, stats.getLatest().ui, stats.getLatest().allocations);
+		return 1;
+	}
+
+	stats.clear();
+	if (stats.getRecorded() != 0 || stats.summarise(FrameStats::FRAME).max != 0.0f) {
+		printf("Failed: clear\n");
+		return 1;
+	}
+
+	printf("Passed\n");
+	return 0;
+}
@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <math.h>
+#include "Car.h"
+#include "LapTimer.h"
+
+using External::TrackCentreline;
+using Internal::LapTimer;
+
+//A car driven along the centreline at a steady speed, offset to its right, with its four wheels on whatever is under it
+struct Drive {
+	const External::Terrain& terrain;
+	LapTimer& timer;
+	double
+		t = 0.0,
+		distance;
+	const double dt = 0.01;
+
+	void step(double speed, double offset) {
+		const TrackCentreline& centreline = terrain.getTrackCentreline();
+
+		distance += speed * dt;
+		t += dt;
+
+		const TrackCentreline::Sample sample = centreline.sampleAtDistance(distance);
+		const glm::dvec2 position_world = sample.position_world + glm::dvec2(-sample.tangent_world.y, sample.tangent_world.x) * offset;
+
+		unsigned char surfaceTypes[4];
+		for (unsigned char& surfaceType : surfaceTypes)
+			surfaceType = terrain.sampleContact(position_world).surfaceType;
+
+		timer.update(t, position_world, surfaceTypes, 4);
+	}
+};
+
+int main() {
+	const External::Terrain& terrain = External::Environment::getDefault()->getTerrain();
+	const TrackCentreline& centreline = terrain.getTrackCentreline();
+	const double
+		length = centreline.getLength(),
+		speed = 25.0;
+
+	LapTimer::Settings settings;
+	settings.startDistance = 0.3 * length;
+	LapTimer timer(centreline, settings);
+
+	//From 50 m behind the start line, three laps and a bit, the second lap partly off the track twice
+	Drive drive = { terrain, timer, 0.0, settings.startDistance - 50.0 };
+	while (drive.distance < settings.startDistance + 3.2 * length) {
+		const double lapDistance = centreline.wrapDistance(drive.distance - settings.startDistance);
+		const bool offTrack = drive.distance > settings.startDistance + length && drive.distance < settings.startDistance + 2.0 * length &&
+			((lapDistance > 100.0 && lapDistance < 110.0) || (lapDistance > 300.0 && lapDistance < 330.0));
+
+		drive.step(speed, offTrack ? 15.0 : 3.0);
+	}
+
+	const double lapTime = length / speed;
+	if (timer.getLaps().size() != 3 || fabs(timer.getBestLapTime() - lapTime) > 1e-3) {
+		printf("Failed: %zu laps, the best in %f s rather than %f s\n", timer.getLaps().size(), timer.getBestLapTime(), lapTime);
+		return 1;
+	}
+
+	for (size_t lap = 0; lap < timer.getLaps().size(); lap++) {
+		const LapTimer::Lap& timed = timer.getLaps()[lap];
+		const unsigned int violations = lap == 1 ? 2 : 0;
+
+		if (timed.sectorTimes.size() != 3 || timed.trackLimitViolations != violations || fabs(timed.time - lapTime) > 1e-3) {
+			printf("Failed: lap %zu took %f s in %zu sectors, with %u violations\n", lap + 1, timed.time, timed.sectorTimes.size(), timed.trackLimitViolations);
+			return 1;
+		}
+
+		for (const double sectorTime : timed.sectorTimes)
+			if (fabs(sectorTime - lapTime / 3.0) > 1e-3) {
+				printf("Failed: lap %zu has a sector of %f s rather than %f s\n", lap + 1, sectorTime, lapTime / 3.0);
+				return 1;
+			}
+	}
+
+	if (fabs(timer.getProgressPercent() - 20.0) > 0.5 || fabs(timer.getLateralOffset() - 3.0) > 0.05 || timer.getTotalViolations() != 2) {
+		printf("Failed: %f%% of the way round, %f m right of the line, %u violations\n", timer.getProgressPercent(), timer.getLateralOffset(), timer.getTotalViolations());
+		return 1;
+	}
+
+	//Backing over the start line and crossing it again does not complete a lap
+	for (unsigned int i = 0; i < 4000; i++)
+		drive.step(-speed, 3.0);
+	for (unsigned int i = 0; i < 2000; i++)
+		drive.step(speed, 3.0);
+
+	if (timer.getLaps().size() != 3 || timer.getProgress() > 3.0 * length) {
+		printf("Failed: reversing over the start line gave %zu laps\n", timer.getLaps().size());
+		return 1;
+	}
+
+	//A Car's own position and wheels, wherever it is
+	Internal::Car car;
+	car.getTorqueGenerator().setThrottle(1.0);
+
+	LapTimer carTimer(centreline);
+	for (unsigned int step = 0; step < 2000; step++) {
+		car.update(step * 0.001, 0.001);
+		carTimer.update(car, step * 0.001);
+	}
+
+	const glm::dvec3 position_world = car.getState().getPosition_world();
+	const TrackCentreline::Nearest nearest = centreline.findNearest(glm::dvec2(position_world.x, position_world.z));
+	if (fabs(carTimer.getLateralOffset() - nearest.lateralOffset) > 1e-9) {
+		printf("Failed: the car is %f m from the line, not %f m\n", carTimer.getLateralOffset(), nearest.lateralOffset);
+		return 1;
+	}
+
+	printf("Passed: 3 laps of %f s\n", lapTime);
+	return 0;
+}
@@ -0,0 +1,167 @@
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include <memory>
+#include "PacejkaMagicFormula.h"
+
+using Internal::PacejkaMagicFormula;
+using Internal::PacejkaParams;
+
+static const char* levelName(PacejkaMagicFormula::SimdLevel level) {
+	switch (level) {
+	case PacejkaMagicFormula::SimdLevel::AVX512: return "AVX-512";
+	case PacejkaMagicFormula::SimdLevel::AVX2: return "AVX2";
+	default: return "scalar";
+	}
+}
+
+//Loads, slips and cambers covering a car at rest, braking, accelerating, cornering and airborne (zero load)
+static void makeInputs(std::vector<double>& loads, std::vector<double>& slips, std::vector<double>& angles, std::vector<double>& cambers) {
+	const double
+		loadValues[] = { 0.0, 250.0, 1200.0, 4809.0, 9000.0, 15000.0 },
+		slipValues[] = { -100.0, -35.0, -4.0, -0.01, 0.0, 0.02, 3.0, 12.5, 60.0, 100.0 },
+		angleValues[] = { -90.0, -30.0, -6.0, -0.5, 0.0, 0.3, 2.0, 11.0, 45.0, 90.0 },
+		camberValues[] = { -3.0, 0.0, 1.5 };
+
+	for (double load : loadValues)
+		for (double slip : slipValues)
+			for (double angle : angleValues)
+				for (double camber : camberValues) {
+					loads.push_back(load);
+					slips.push_back(slip);
+					angles.push_back(angle);
+					cambers.push_back(camber);
+				}
+}
+
+static bool closeEnough(double reference, double value) {
+	return fabs(reference - value) <= 1e-12 * fmax(1.0, fabs(reference));
+}
+
+static int checkAgainstScalar(const PacejkaParams& params, const char* paramsName) {
+	PacejkaMagicFormula single;
+	single.setParams(std::make_shared<const PacejkaParams>(params));
+
+	std::vector<double> loads, slips, angles, cambers;
+	makeInputs(loads, slips, angles, cambers);
+
+	//Odd count, so every SIMD path also runs its tail
+	const size_t count = loads.size() - 3;
+
+	std::vector<double> referenceLong(count), referenceLat(count), longitudinal(count), lateral(count);
+
+	//The scalar path of evaluate must be exactly updateForces (which keeps its load terms while consecutive inputs share a load)
+	PacejkaMagicFormula::setSimdLevel(PacejkaMagicFormula::SimdLevel::SCALAR);
+	PacejkaMagicFormula::evaluate(params, loads.data(), slips.data(), angles.data(), cambers.data(), count, referenceLong.data(), referenceLat.data());
+
+	for (size_t i = 0; i < count; i++) {
+		single.updateForces(loads[i], slips[i], angles[i], cambers[i]);
+		if (single.getLongitudinalForce() != referenceLong[i] || single.getLateralForce() != referenceLat[i]) {
+			printf("Failed (%s): scalar evaluate differs from updateForces at %zu\n", paramsName, i);
+			return 1;
+		}
+
+		if ((loads[i] == 0.0 || slips[i] == 0.0) && referenceLong[i] != 0.0) {
+			printf("Failed (%s): longitudinal force without load or slip at %zu\n", paramsName, i);
+			return 1;
+		}
+	}
+
+	const PacejkaMagicFormula::SimdLevel levels[] = { PacejkaMagicFormula::SimdLevel::AVX2, PacejkaMagicFormula::SimdLevel::AVX512 };
+
+	for (PacejkaMagicFormula::SimdLevel level : levels) {
+		if (level > PacejkaMagicFormula::getSupportedSimdLevel())
+			continue;
+
+		PacejkaMagicFormula::setSimdLevel(level);
+		PacejkaMagicFormula::evaluate(params, loads.data(), slips.data(), angles.data(), cambers.data(), count, longitudinal.data(), lateral.data());
+
+		for (size_t i = 0; i < count; i++) {
+			if (!closeEnough(referenceLong[i], longitudinal[i]) || !closeEnough(referenceLat[i], lateral[i])) {
+				printf("Failed (%s, %s): load %g slip %g angle %g camber %g gives (%.17g, %.17g), scalar gives (%.17g, %.17g)\n",
+					paramsName, levelName(level), loads[i], slips[i], angles[i], cambers[i], longitudinal[i], lateral[i], referenceLong[i], referenceLat[i]);
+				return 1;
+			}
+		}
+
+		printf("%s matches scalar (%s tyre, %zu tyres)\n", levelName(level), paramsName, count);
+	}
+
+	return 0;
+}
+
+static bool matches(const PacejkaMagicFormula& formula, const PacejkaParams& params, double load_N, double slip, double angle) {
+	return formula.getLongitudinalForce() == PacejkaMagicFormula::calcLongitudinalForce(params, load_N / 1000.0, slip) &&
+		formula.getLateralForce() == PacejkaMagicFormula::calcLateralForce(params, load_N / 1000.0, angle, 0.0);
+}
+
+//Instances following the published set pick up each new one; instances with their own set keep it
+static int checkPublishing() {
+	const std::shared_ptr<const PacejkaParams> road = std::make_shared<const PacejkaParams>(PacejkaParams::roadTyre());
+
+	PacejkaMagicFormula following, own;
+	own.setParams(road);
+
+	PacejkaParams edited = PacejkaParams::driftingTyre();
+	edited.b2 = 1200.0f;
+	edited.a2 = 1300.0f;
+	PacejkaParams::publish(edited);
+
+	following.updateForces(4000.0, 12.0, 3.0, 0.0);
+	own.updateForces(4000.0, 12.0, 3.0, 0.0);
+
+	if (!matches(following, edited, 4000.0, 12.0, 3.0) || !matches(own, *road, 4000.0, 12.0, 3.0)) {
+		printf("Failed: published set not picked up by following instance only\n");
+		return 1;
+	}
+
+	own.setParams(nullptr);
+	PacejkaParams::publish(PacejkaParams::driftingTyre());
+	own.updateForces(4000.0, 12.0, 3.0, 0.0);
+
+	if (!own.followsPublishedParams() || !matches(own, PacejkaParams::driftingTyre(), 4000.0, 12.0, 3.0)) {
+		printf("Failed: instance did not go back to the published set\n");
+		return 1;
+	}
+
+	//Load terms are reused while the load stays within the tolerance, and recalculated once it moves further
+	PacejkaParams tolerant = PacejkaParams::driftingTyre();
+	tolerant.loadTolerance_N = 50.0;
+	PacejkaMagicFormula formula;
+	formula.setParams(std::make_shared<const PacejkaParams>(tolerant));
+
+	formula.updateForces(4000.0, 12.0, 3.0, 0.0);
+	formula.updateForces(4030.0, 12.0, 3.0, 0.0);
+	if (!matches(formula, tolerant, 4000.0, 12.0, 3.0)) {
+		printf("Failed: load terms recalculated within the tolerance\n");
+		return 1;
+	}
+
+	formula.updateForces(4060.0, 12.0, 3.0, 0.0);
+	if (!matches(formula, tolerant, 4060.0, 12.0, 3.0)) {
+		printf("Failed: load terms not recalculated beyond the tolerance\n");
+		return 1;
+	}
+
+	return 0;
+}
+
+int main() {
+	if (checkAgainstScalar(PacejkaParams::driftingTyre(), "drifting") || checkAgainstScalar(PacejkaParams::roadTyre(), "road"))
+		return 1;
+
+	//Non-zero horizontal shift and curvature shift, so that the sign(slip + H) term matters
+	PacejkaParams shifted = PacejkaParams::roadTyre();
+	shifted.b10 = 2.0f;
+	shifted.b13 = 0.5f;
+	shifted.a9 = -0.5f;
+	shifted.a17 = 0.25f;
+	if (checkAgainstScalar(shifted, "shifted"))
+		return 1;
+
+	if (checkPublishing())
+		return 1;
+
+	printf("Passed\n");
+	return 0;
+}
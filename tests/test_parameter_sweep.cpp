@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <atomic>
+#include <vector>
+#include "ParameterSweep.h"
+#include "WorkStealingPool.h"
+
+using Internal::ParameterSweep;
+using Internal::WorkStealingPool;
+
+//Every one of the count equal intervals of each dimension holds exactly one of the first count points
+static bool stratified(const std::vector<double>& unitSamples, unsigned int dimensions, size_t count) {
+	for (unsigned int d = 0; d < dimensions; d++) {
+		std::vector<unsigned int> hits(count, 0);
+
+		for (size_t i = 0; i < count; i++) {
+			const double u = unitSamples[i * dimensions + d];
+			if (!(u >= 0.0 && u < 1.0) || hits[(size_t)(u * count)]++)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+static int checkSampling() {
+	const unsigned int dimensions = ParameterSweep::PARAMETER_COUNT;
+
+	const std::vector<double> sobol = ParameterSweep::generateUnitSamples(ParameterSweep::Sampling::SOBOL, dimensions, 256, 0, 0);
+	for (size_t count = 1; count <= 256; count *= 2)
+		if (!stratified(sobol, dimensions, count)) {
+			printf("Failed: first %zu Sobol points are not stratified\n", count);
+			return 1;
+		}
+
+	//The first two dimensions form a (0, m, 2)-net: one point in each cell of a 4 x 4 grid
+	unsigned int cells[16] = { 0 };
+	for (size_t i = 0; i < 16; i++)
+		cells[(size_t)(sobol[i * dimensions] * 4.0) * 4 + (size_t)(sobol[i * dimensions + 1] * 4.0)]++;
+
+	for (unsigned int cell : cells)
+		if (cell != 1) {
+			printf("Failed: first 16 Sobol points do not fill a 4 x 4 grid\n");
+			return 1;
+		}
+
+	const std::vector<double> hypercube = ParameterSweep::generateUnitSamples(ParameterSweep::Sampling::LATIN_HYPERCUBE, dimensions, 50, 0, 7);
+	if (hypercube.size() != 50 * dimensions || !stratified(hypercube, dimensions, 50)) {
+		printf("Failed: Latin hypercube is not stratified\n");
+		return 1;
+	}
+
+	const std::vector<double> grid = ParameterSweep::generateUnitSamples(ParameterSweep::Sampling::GRID, 2, 0, 3, 0);
+	const double expectedGrid[] = { 0.0, 0.0, 0.5, 0.0, 1.0, 0.0, 0.0, 0.5, 0.5, 0.5, 1.0, 0.5, 0.0, 1.0, 0.5, 1.0, 1.0, 1.0 };
+	if (grid.size() != 18 || memcmp(grid.data(), expectedGrid, sizeof(expectedGrid)) != 0) {
+		printf("Failed: 3-level grid over 2 parameters\n");
+		return 1;
+	}
+
+	//Scaling to ranges, including the tyre set index
+	ParameterSweep sweep;
+	sweep.vary(ParameterSweep::MASS, 1500.0, 2500.0);
+	sweep.vary(ParameterSweep::TYRE_SET, 0.0, 1.0);
+	const std::vector<ParameterSweep::Sample> samples = sweep.generate(ParameterSweep::Sampling::GRID, 0, 2, 0);
+	const double expectedSamples[][2] = { { 1500.0, 0.0 }, { 2500.0, 0.0 }, { 1500.0, 1.0 }, { 2500.0, 1.0 } };
+
+	for (size_t i = 0; i < 4; i++)
+		if (samples.size() != 4 || samples[i].values[ParameterSweep::MASS] != expectedSamples[i][0] || samples[i].values[ParameterSweep::TYRE_SET] != expectedSamples[i][1] ||
+			samples[i].values[ParameterSweep::STEERING_RATIO] != sweep.getDefaults().values[ParameterSweep::STEERING_RATIO]) {
+			printf("Failed: samples not scaled to their ranges\n");
+			return 1;
+		}
+
+	return 0;
+}
+
+//Every task runs exactly once, however uneven the tasks are
+static int checkPool() {
+	const size_t taskCount = 2000;
+	std::vector<std::atomic<unsigned int>> runs(taskCount);
+	for (std::atomic<unsigned int>& count : runs)
+		count = 0;
+
+	WorkStealingPool pool(4);
+	pool.run(taskCount, [&](size_t task, unsigned int) {
+		//The first tasks are far more expensive, so the first worker's range is stolen from
+		volatile double sink = 0.0;
+		for (size_t i = 0; i < (task < 100 ? 20000 : 10); i++)
+			sink = sink + sqrt((double)i);
+
+		runs[task]++;
+	});
+
+	for (size_t task = 0; task < taskCount; task++)
+		if (runs[task] != 1) {
+			printf("Failed: task %zu ran %u times\n", task, runs[task].load());
+			return 1;
+		}
+
+	printf("Pool: %zu tasks on %u threads, %zu steals\n", taskCount, pool.getThreadCount(), pool.getStealCount());
+	return 0;
+}
+
+//Results depend only on the sample, not on the number of threads
+static int checkDeterminism() {
+	ParameterSweep sweep;
+	sweep.vary(ParameterSweep::MASS, 1200.0, 2600.0);
+	sweep.vary(ParameterSweep::DAMPING, 1500.0, 5000.0);
+	sweep.vary(ParameterSweep::TYRE_SET, 0.0, 1.0);
+
+	ParameterSweep::Scenario scenario;
+	scenario.duration = 1.0;
+	scenario.steeringWheelAngle = 120.0;
+
+	const std::vector<ParameterSweep::Sample> samples = sweep.generate(ParameterSweep::Sampling::LATIN_HYPERCUBE, 6, 0, 3);
+
+	WorkStealingPool serial(1), parallel(3);
+	const std::vector<ParameterSweep::Result>
+		serialResults = sweep.run(samples, scenario, serial),
+		parallelResults = sweep.run(samples, scenario, parallel);
+
+	for (size_t i = 0; i < samples.size(); i++) {
+		const ParameterSweep::Result &a = serialResults[i], &b = parallelResults[i];
+
+		if (a.run != i || b.run != i || a.distanceTravelled != b.distanceTravelled || a.maxSpeed != b.maxSpeed || a.finalSpeed != b.finalSpeed ||
+			a.maxLateralAcceleration != b.maxLateralAcceleration || a.finalX != b.finalX || a.finalZ != b.finalZ) {
+			printf("Failed: run %zu differs between 1 and 3 threads\n", i);
+			return 1;
+		}
+	}
+
+	if (serialResults[0].distanceTravelled <= 0.0) {
+		printf("Failed: car did not move\n");
+		return 1;
+	}
+
+	return 0;
+}
+
+//Turned to full lock, the wheels reach the same angle whatever the steering ratio
+static int checkSteeringRatio() {
+	ParameterSweep sweep;
+	sweep.vary(ParameterSweep::STEERING_RATIO, 10.0, 20.0);
+
+	ParameterSweep::Scenario scenario;
+	scenario.duration = 0.1;
+	scenario.steeringWheelAngle = 2000.0;
+
+	WorkStealingPool pool(1);
+	const std::vector<ParameterSweep::Result> results = sweep.run(sweep.generate(ParameterSweep::Sampling::GRID, 0, 2, 0), scenario, pool);
+
+	if (results.size() != 2 || results[0].maxWheelAngle <= 0.0 || fabs(results[0].maxWheelAngle - results[1].maxWheelAngle) > 1e-9) {
+		printf("Failed: full lock of %f degs at ratio 10, %f degs at ratio 20\n", results.empty() ? 0.0 : results[0].maxWheelAngle,
+			results.size() < 2 ? 0.0 : results[1].maxWheelAngle);
+		return 1;
+	}
+
+	return 0;
+}
+
+int main() {
+	if (checkSampling() || checkPool() || checkDeterminism() || checkSteeringRatio())
+		return 1;
+
+	printf("Passed\n");
+	return 0;
+}
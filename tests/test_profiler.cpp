@@ -0,0 +1,154 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <thread>
+#include "Car.h"
+#include "Profiler.h"
+
+using Internal::Profiler;
+
+static size_t countOccurrences(const std::string& text, const char* pattern) {
+	size_t count = 0;
+	for (size_t at = text.find(pattern); at != std::string::npos; at = text.find(pattern, at + 1))
+		count++;
+
+	return count;
+}
+
+static std::string readFile(const char* path) {
+	std::string text;
+	FILE* file = fopen(path, "r");
+	if (!file)
+		return text;
+
+	char chunk[4096];
+	size_t read;
+	while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0)
+		text.append(chunk, read);
+
+	fclose(file);
+	return text;
+}
+
+//The "ts" of each event with the given name, in the order written, in ns
+static std::vector<long long> readTimes(const std::string& trace, const char* name) {
+	const std::string pattern = std::string("{\"name\":\"") + name + "\",\"cat\":\"vds\",\"ph\":\"X\",\"ts\":";
+	std::vector<long long> times;
+
+	for (size_t at = trace.find(pattern); at != std::string::npos; at = trace.find(pattern, at + 1))
+		times.push_back(llround(atof(trace.c_str() + at + pattern.size()) * 1e3));
+
+	return times;
+}
+
+int main() {
+	const char* path = "test-profiler-trace.json";
+	const unsigned int steps = 100;
+
+	//Each thread records into its own ring, which once full keeps only the most recent events
+	Profiler::setThreadCapacity(64);
+
+	std::thread workers[2];
+	for (std::thread& worker : workers)
+		worker = std::thread([]() {
+			for (int i = 0; i < 100; i++)
+				Profiler::record("worker", i, i);
+		});
+	for (std::thread& worker : workers)
+		worker.join();
+
+	if (Profiler::getEventCount() != 128 || Profiler::getWrappedCount() != 72) {
+		printf("Failed: %zu events held and %zu overwritten, expected 128 and 72\n", Profiler::getEventCount(), Profiler::getWrappedCount());
+		return 1;
+	}
+
+	if (!Profiler::writeChromeTrace(path)) {
+		printf("Failed: could not write %s\n", path);
+		return 1;
+	}
+
+	const std::vector<long long> workerTimes = readTimes(readFile(path), "worker");
+	for (size_t i = 0; i < workerTimes.size(); i++)
+		if (workerTimes.size() != 128 || workerTimes[i] != 36 + (long long)(i % 64)) {
+			printf("Failed: trace does not hold each worker's last 64 events\n");
+			return 1;
+		}
+
+	//Exported while a thread wraps its ring many times over, each trace holds a run of its events with none torn or skipped
+	Profiler::clear();
+	Profiler::setThreadCapacity(256);
+
+	std::atomic<bool> spinning(true);
+	std::thread spinner([&spinning]() {
+		for (long long i = 0; spinning.load(std::memory_order_relaxed); i++)
+			Profiler::record("spinner", i, i);
+	});
+
+	unsigned int tornTrace = 0;
+	for (unsigned int trace = 1; trace <= 20 && !tornTrace; trace++) {
+		Profiler::writeChromeTrace(path);
+
+		const std::vector<long long> spinnerTimes = readTimes(readFile(path), "spinner");
+		for (size_t i = 1; i < spinnerTimes.size(); i++)
+			if (spinnerTimes.size() > 256 || spinnerTimes[i] != spinnerTimes[i - 1] + 1)
+				tornTrace = trace;
+	}
+
+	spinning = false;
+	spinner.join();
+
+	if (tornTrace) {
+		printf("Failed: trace %u of a wrapping thread is not one run of its events\n", tornTrace);
+		return 1;
+	}
+
+	Profiler::clear();
+	Profiler::setThreadCapacity(1 << 16);
+
+	//Car::update is instrumented with 10 scopes per step, which are only recorded in VDS_PROFILE builds
+	Internal::Car car;
+	const double dt = 1.0 / 120.0;
+	for (unsigned int step = 0; step < steps; step++)
+		car.update(step * dt, dt);
+
+	const size_t expected = Profiler::isCompiledIn() ? steps * 10 : 0;
+	if (Profiler::getEventCount() != expected) {
+		printf("Failed: %zu events from Car::update, expected %zu\n", Profiler::getEventCount(), expected);
+		return 1;
+	}
+
+	//Disabled at runtime, nothing is recorded
+	Profiler::setEnabled(false);
+	car.update(steps * dt, dt);
+	Profiler::setEnabled(true);
+
+	if (Profiler::getEventCount() != expected) {
+		printf("Failed: events recorded while disabled\n");
+		return 1;
+	}
+
+	if (!Profiler::writeChromeTrace(path)) {
+		printf("Failed: could not write %s\n", path);
+		return 1;
+	}
+
+	//One thread_name record per thread that recorded (the workers, the spinner and, in VDS_PROFILE builds, this one), and one
+	//complete event per scope
+	const std::string trace = readFile(path);
+	remove(path);
+
+	if (trace.find("\"traceEvents\":[") == std::string::npos ||
+		countOccurrences(trace, "\"ph\":\"M\"") != (Profiler::isCompiledIn() ? 4u : 3u) ||
+		countOccurrences(trace, "\"ph\":\"X\"") != expected ||
+		countOccurrences(trace, "\"name\":\"Car::update\"") != expected / 10 ||
+		trace.compare(trace.size() - 4, 4, "\n]}\n") != 0) {
+		printf("Failed: malformed trace\n");
+		return 1;
+	}
+
+	printf("Passed\n");
+	return 0;
+}
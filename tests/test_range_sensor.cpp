@@ -0,0 +1,79 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "Car.h"
+#include "RangeSensor.h"
+
+using Internal::RangeSensor;
+
+static bool sameCloud(const RangeSensor::PointCloud& a, const RangeSensor::PointCloud& b) {
+	return a.rayCount == b.rayCount && a.points.size() == b.points.size() && a.time == b.time &&
+		memcmp(a.points.data(), b.points.data(), a.points.size() * sizeof(RangeSensor::Point)) == 0;
+}
+
+int main() {
+	Internal::Car car;
+	car.getTorqueGenerator().setThrottle(1.0);
+	car.getControlSystem().setSteeringWheelAngle(90.0);
+
+	for (unsigned int step = 0; step < 500; step++)
+		car.update(step * 0.001, 0.001);
+
+	const External::Terrain& terrain = car.getEnvironment().getTerrain();
+
+	RangeSensor::Settings settings;
+	settings.threads = 4;
+	RangeSensor sensor(settings);
+
+	RangeSensor::PointCloud cloud;
+	sensor.scan(car, 0.5, cloud);
+
+	if (cloud.rayCount != 1024 * 128 || cloud.points.size() < cloud.rayCount / 2 || cloud.points.size() > cloud.rayCount) {
+		printf("Failed: %zu points from %zu rays\n", cloud.points.size(), cloud.rayCount);
+		return 1;
+	}
+
+	//Every point, back in world space, is on the ground within range, and labelled with the ground's surface type
+	size_t sameSurfaceTypes = 0;
+	for (const RangeSensor::Point& point : cloud.points) {
+		const glm::dvec3
+			position_sensor(point.position_sensor[0], point.position_sensor[1], point.position_sensor[2]),
+			position_world = glm::dvec3(cloud.sensorToWorld * glm::dvec4(position_sensor, 1.0));
+
+		const External::Terrain::Contact contact = terrain.sampleContact(glm::dvec2(position_world.x, position_world.z));
+		if (fabs(position_world.y - contact.height) > 1e-3 || glm::length(position_sensor) > settings.maxRange + 1e-3 || point.ring >= settings.rings) {
+			printf("Failed: point (%f, %f, %f) of ring %u, column %u is not on the ground within range\n", position_world.x, position_world.y, position_world.z, point.ring, point.column);
+			return 1;
+		}
+
+		sameSurfaceTypes += point.surfaceType == contact.surfaceType;
+	}
+
+	//(Points within a float's precision of a triangle's edge can take either side's)
+	if (sameSurfaceTypes < cloud.points.size() * 99 / 100) {
+		printf("Failed: only %zu of %zu points have the surface type under them\n", sameSurfaceTypes, cloud.points.size());
+		return 1;
+	}
+
+	//The same cloud however many threads cast it, and whether it is scanned in the background or not
+	RangeSensor::Settings oneThreadSettings = settings;
+	oneThreadSettings.threads = 1;
+	RangeSensor oneThread(oneThreadSettings);
+
+	RangeSensor::PointCloud oneThreadCloud, backgroundCloud;
+	oneThread.scan(car, 0.5, oneThreadCloud);
+
+	if (!sensor.startScan(car, 0.5)) {
+		printf("Failed: could not start a background scan\n");
+		return 1;
+	}
+
+	sensor.waitForScan();
+	if (!sensor.takeScan(backgroundCloud) || sensor.takeScan(backgroundCloud) || !sameCloud(cloud, oneThreadCloud) || !sameCloud(cloud, backgroundCloud)) {
+		printf("Failed: clouds differ between threads, or in the background\n");
+		return 1;
+	}
+
+	printf("Passed: %zu points from %zu rays\n", cloud.points.size(), cloud.rayCount);
+	return 0;
+}
@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include "Car.h"
+#include "MappedFile.h"
+#include "TelemetryRecorder.h"
+
+using Internal::Car;
+using Internal::TelemetryRecorder;
+
+//The column of the log with the given name, or nullptr
+static const TelemetryRecorder::ColumnHeader* findColumn(const TelemetryRecorder::ColumnHeader* columns, uint32_t count, const char* name) {
+	for (uint32_t c = 0; c < count; c++)
+		if (strncmp(columns[c].name, name, sizeof(columns[c].name)) == 0)
+			return &columns[c];
+
+	return nullptr;
+}
+
+//Record's value of a column, read as a double
+static double readValue(const char* data, const TelemetryRecorder::FileHeader& header, const TelemetryRecorder::ColumnHeader& column, uint64_t record) {
+	const char* value = data + header.dataOffset + (record / header.blockRecords) * header.blockBytes + column.blockOffset +
+		(record % header.blockRecords) * column.elementBytes;
+
+	if (column.type == TelemetryRecorder::ColumnType::FLOAT32) {
+		float f;
+		memcpy(&f, value, sizeof(f));
+		return f;
+	}
+
+	double d;
+	memcpy(&d, value, sizeof(d));
+	return d;
+}
+
+int main() {
+	const double dt = 0.001;
+	const unsigned int steps = 5000;
+	const std::string path = (std::filesystem::temp_directory_path() /
+		("vds-test-telemetry-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".telemetry")).string();
+
+	//A run of more than one block is recorded, keeping what was captured to check the log against
+	TelemetryRecorder::Settings settings;
+	settings.blockRecords = 1024;
+
+	TelemetryRecorder recorder(settings);
+	if (!recorder.open(path)) {
+		printf("Failed: could not write %s\n", path.c_str());
+		return 1;
+	}
+
+	Car car;
+	car.setInputSource(std::make_shared<Internal::ScriptedInputSource>(Internal::ScriptedInputSource::makeStepSteer(1.0, 2.0, 90.0)));
+
+	std::vector<TelemetryRecorder::Sample> expected(steps);
+	for (unsigned int step = 0; step < steps; step++) {
+		car.update(step * dt, dt);
+		TelemetryRecorder::capture(car, step * dt, expected[step]);
+
+		if (!recorder.record(car, step * dt)) {
+			printf("Failed: step %u dropped\n", step);
+			return 1;
+		}
+	}
+
+	if (!recorder.close() || recorder.getWrittenCount() != steps || recorder.getDroppedCount() != 0) {
+		printf("Failed: %llu records written, %zu dropped, for %u steps\n", (unsigned long long)recorder.getWrittenCount(), recorder.getDroppedCount(), steps);
+		return 1;
+	}
+
+	//The log is read back by its own description
+	Internal::MappedFile log;
+	if (!log.openReadOnly(path) || log.getSize() < sizeof(TelemetryRecorder::FileHeader)) {
+		printf("Failed: could not read back %s\n", path.c_str());
+		return 1;
+	}
+
+	const char* data = static_cast<const char*>(log.getData());
+	TelemetryRecorder::FileHeader header;
+	memcpy(&header, data, sizeof(header));
+
+	const uint64_t blocks = (header.recordCount + header.blockRecords - 1) / header.blockRecords;
+	if (memcmp(header.magic, "VDSTELEM", 8) != 0 || header.version != TelemetryRecorder::FILE_VERSION || header.recordCount != steps ||
+		header.blockRecords != 1024 || log.getSize() < header.dataOffset + blocks * header.blockBytes) {
+		printf("Failed: header of %llu records, %u per block, in %zu bytes\n", (unsigned long long)header.recordCount, header.blockRecords, log.getSize());
+		return 1;
+	}
+
+	const TelemetryRecorder::ColumnHeader* columns = reinterpret_cast<const TelemetryRecorder::ColumnHeader*>(data + sizeof(header));
+	const TelemetryRecorder::ColumnHeader
+		*time = findColumn(columns, header.columnCount, "time"),
+		*positionZ = findColumn(columns, header.columnCount, "position_world.z"),
+		*steering = findColumn(columns, header.columnCount, "steeringWheelAngle"),
+		*load = findColumn(columns, header.columnCount, "wheel.rl.load"),
+		*slipAngle = findColumn(columns, header.columnCount, "wheel.fr.slipAngle");
+
+	if (!time || !positionZ || !steering || !load || !slipAngle || load->type != TelemetryRecorder::ColumnType::FLOAT32) {
+		printf("Failed: %u columns, missing some of those recorded\n", header.columnCount);
+		return 1;
+	}
+
+	for (unsigned int step = 0; step < steps; step++) {
+		const TelemetryRecorder::Sample& sample = expected[step];
+
+		if (readValue(data, header, *time, step) != sample.time || readValue(data, header, *positionZ, step) != sample.position_world[2] ||
+			readValue(data, header, *steering, step) != sample.steeringWheelAngle || readValue(data, header, *load, step) != sample.wheels[2].load ||
+			readValue(data, header, *slipAngle, step) != sample.wheels[1].slipAngle) {
+			printf("Failed: record %u does not match the step\n", step);
+			return 1;
+		}
+	}
+
+	const double lastSteering = readValue(data, header, *steering, steps - 1);
+	log.close();
+	std::filesystem::remove(path);
+
+	if (lastSteering != 90.0) {
+		printf("Failed: steering wheel at %f degs after the step steer\n", lastSteering);
+		return 1;
+	}
+
+	printf("Passed: %u records in %llu blocks, %u columns, read back exactly\n", steps, (unsigned long long)blocks, header.columnCount);
+	return 0;
+}
@@ -0,0 +1,50 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include "Environment.h"
+
+using External::Terrain;
+
+int main() {
+	const Terrain& terrain = External::Environment::getDefault()->getTerrain();
+	const double halfTerrainSize = terrain.getSize() * 0.5;
+
+	//A spiral of points over the whole terrain and beyond its edges, plus points on square corners and diagonals
+	std::vector<glm::dvec2> points;
+	for (unsigned int i = 0; i < 5003; i++) {
+		const double radius = (halfTerrainSize + 20.0) * i / 5003.0, angle = i * 0.37;
+		points.push_back(glm::dvec2(radius * cos(angle), radius * sin(angle)));
+	}
+	for (int i = -5; i < 5; i++) {
+		points.push_back(glm::dvec2(i, i * 2));
+		points.push_back(glm::dvec2(i + 0.25, i * 3 + 0.25));
+	}
+
+	std::vector<Terrain::Contact> contacts(points.size());
+	terrain.sampleContacts(points.data(), points.size(), contacts.data());
+
+	for (size_t i = 0; i < points.size(); i++) {
+		const Terrain::Contact single = terrain.sampleContact(points[i]);
+		const glm::dvec3 normal = terrain.getNormal_world(points[i]);
+		const double height = terrain.getHeight(points[i]);
+
+		if (memcmp(&single, &contacts[i], sizeof(double) + sizeof(glm::dvec3)) != 0 || single.surfaceType != contacts[i].surfaceType || single.triIndex != contacts[i].triIndex) {
+			printf("Failed: batched contact %zu differs from sampleContact\n", i);
+			return 1;
+		}
+
+		if (memcmp(&single.height, &height, sizeof(double)) != 0 || memcmp(&single.normal_world, &normal, sizeof(glm::dvec3)) != 0) {
+			printf("Failed: contact at (%f, %f) differs from getHeight/getNormal_world\n", points[i].x, points[i].y);
+			return 1;
+		}
+
+		if (single.surfaceType >= External::TerrainType::ERROR_TYPE) {
+			printf("Failed: surface type %u at (%f, %f)\n", single.surfaceType, points[i].x, points[i].y);
+			return 1;
+		}
+	}
+
+	printf("Passed\n");
+	return 0;
+}
@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <filesystem>
+#include "Terrain.h"
+
+using External::Terrain;
+
+//Every height, normal and surface type, sampled at the centre of each triangle
+static bool sameTerrain(const Terrain& a, const Terrain& b) {
+	const int halfTerrainSize = a.getSize() / 2;
+
+	for (int x = -halfTerrainSize; x < halfTerrainSize; x++)
+		for (int z = -halfTerrainSize; z < halfTerrainSize; z++)
+			for (const glm::dvec2 withinSquare : { glm::dvec2(0.7, 0.2), glm::dvec2(0.2, 0.7), glm::dvec2(0.0) }) {
+				const Terrain::Contact
+					contactA = a.sampleContact(glm::dvec2(x, z) + withinSquare),
+					contactB = b.sampleContact(glm::dvec2(x, z) + withinSquare);
+
+				if (memcmp(&contactA.height, &contactB.height, sizeof(double)) != 0 || memcmp(&contactA.normal_world, &contactB.normal_world, sizeof(glm::dvec3)) != 0 ||
+					contactA.surfaceType != contactB.surfaceType)
+					return false;
+			}
+
+	return true;
+}
+
+int main() {
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() /
+		("vds-test-terrain-cache-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+
+	Terrain::Settings settings;
+	settings.seed = 42;
+
+	//A seed always gives the same terrain, however many threads generate it, and different seeds give different terrain
+	settings.generationThreads = 1;
+	const Terrain generated(settings);
+	settings.generationThreads = 3;
+	const Terrain regenerated(settings);
+
+	Terrain::Settings otherSettings;
+	otherSettings.seed = 43;
+	const Terrain other(otherSettings);
+
+	if (!sameTerrain(generated, regenerated) || sameTerrain(generated, other)) {
+		printf("Failed: terrain is not determined by its seed\n");
+		return 1;
+	}
+
+	//The first Terrain with a cache directory generates and saves; the next maps the file instead
+	settings.cacheDirectory = directory.string();
+	const Terrain saved(settings);
+	const std::string path = saved.getCachePath();
+
+	if (saved.isLoadedFromCache() || !std::filesystem::exists(path)) {
+		printf("Failed: cache file not written to %s\n", path.c_str());
+		return 1;
+	}
+
+	{
+		const Terrain loaded(settings);
+		if (!loaded.isLoadedFromCache() || !sameTerrain(generated, loaded)) {
+			printf("Failed: terrain loaded from the cache differs from generated terrain\n");
+			return 1;
+		}
+	}
+
+	//A damaged file is regenerated (and replaced)
+	std::filesystem::resize_file(path, std::filesystem::file_size(path) / 2);
+	const Terrain repaired(settings);
+	const Terrain reloaded(settings);
+
+	if (repaired.isLoadedFromCache() || !sameTerrain(generated, repaired) || !reloaded.isLoadedFromCache() || !sameTerrain(generated, reloaded)) {
+		printf("Failed: damaged cache file\n");
+		return 1;
+	}
+
+	//Other seeds are keyed separately
+	otherSettings.cacheDirectory = directory.string();
+	const Terrain otherSaved(otherSettings);
+	if (otherSaved.isLoadedFromCache() || otherSaved.getCachePath() == path || !sameTerrain(other, otherSaved)) {
+		printf("Failed: cache key does not include the seed\n");
+		return 1;
+	}
+
+	//Size is set at construction (rounded up to odd), keys the cache, and is sampled safely right up to the far edges
+	Terrain::Settings sizedSettings;
+	sizedSettings.size = 600;
+	sizedSettings.cacheDirectory = directory.string();
+	const Terrain sized(sizedSettings);
+	const Terrain sizedLoaded(sizedSettings);
+
+	if (sized.getSize() != 601 || sized.getCachePath() == saved.getCachePath() || !sizedLoaded.isLoadedFromCache() || !sameTerrain(sized, sizedLoaded)) {
+		printf("Failed: terrain of size %u\n", sized.getSize());
+		return 1;
+	}
+
+	const double halfSize = sized.getSize() / 2;
+	for (const glm::dvec2 point : { glm::dvec2(halfSize, halfSize), glm::dvec2(-halfSize, -halfSize), glm::dvec2(halfSize, -halfSize), glm::dvec2(halfSize + 10.0, 0.0) }) {
+		const Terrain::Contact contact = sized.sampleContact(point);
+		if (contact.height != sized.getHeight(point) || contact.triIndex >= (size_t)(sized.getSize() - 1) * (sized.getSize() - 1) * 2) {
+			printf("Failed: sample at the edge (%.1f, %.1f)\n", point.x, point.y);
+			return 1;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::remove_all(directory, error);
+
+	printf("Passed\n");
+	return 0;
+}
@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <string>
+#include <algorithm>
+#include <filesystem>
+#include "Terrain.h"
+
+using External::Terrain;
+
+//The accuracy compact terrain is documented to keep (TerrainData): heights within half a quantisation step, which over
+//this terrain's ~10 m of relief is well under 0.1 mm, and normals within 0.1 degrees
+static const double
+	MAX_HEIGHT_ERROR = 1.0e-4,   //m
+	MAX_NORMAL_ERROR = 0.1;      //degrees
+
+struct Errors {
+	double
+		height = 0.0,
+		normal = 0.0;
+	bool
+		sameSurfaceTypes = true,
+		identical = true;            //Bit for bit
+};
+
+//Against full precision terrain, at three points in every square (one in each triangle, and the corner)
+static Errors measureErrors(const Terrain& full, const Terrain& compact) {
+	const int halfTerrainSize = full.getSize() / 2;
+	Errors errors;
+
+	for (int x = -halfTerrainSize; x < halfTerrainSize; x++)
+		for (int z = -halfTerrainSize; z < halfTerrainSize; z++)
+			for (const glm::dvec2 withinSquare : { glm::dvec2(0.7, 0.2), glm::dvec2(0.2, 0.7), glm::dvec2(0.0) }) {
+				const Terrain::Contact
+					expected = full.sampleContact(glm::dvec2(x, z) + withinSquare),
+					actual = compact.sampleContact(glm::dvec2(x, z) + withinSquare);
+
+				errors.height = std::max(errors.height, fabs(actual.height - expected.height));
+				errors.normal = std::max(errors.normal, acos(std::min(1.0, glm::dot(actual.normal_world, expected.normal_world))) * 180.0 / M_PI);
+				errors.sameSurfaceTypes = errors.sameSurfaceTypes && actual.surfaceType == expected.surfaceType;
+				errors.identical = errors.identical && errors.sameSurfaceTypes && memcmp(&actual.height, &expected.height, sizeof(double)) == 0 &&
+					memcmp(&actual.normal_world, &expected.normal_world, sizeof(glm::dvec3)) == 0;
+			}
+
+	return errors;
+}
+
+int main() {
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() /
+		("vds-test-terrain-compact-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+
+	const Terrain full;
+
+	Terrain::Settings settings;
+	settings.compact = true;
+	const Terrain compact(settings);
+
+	const Errors errors = measureErrors(full, compact);
+	printf("Compact terrain: max height error %.3g mm, max normal error %.3g degrees, %zu bytes (full precision %zu bytes, %.1fx)\n",
+		errors.height * 1000.0, errors.normal, compact.getMemoryBytes(), full.getMemoryBytes(), (double)full.getMemoryBytes() / compact.getMemoryBytes());
+
+	if (errors.height > MAX_HEIGHT_ERROR || errors.normal > MAX_NORMAL_ERROR || !errors.sameSurfaceTypes) {
+		printf("Failed: compact terrain is less accurate than documented\n");
+		return 1;
+	}
+
+	if (full.getMemoryBytes() < 5 * compact.getMemoryBytes()) {
+		printf("Failed: compact terrain is not at least 5x smaller\n");
+		return 1;
+	}
+
+	//Streamed compact tiles (quantised a tile at a time) keep the same bounds
+	Terrain::Settings streamedSettings = settings;
+	streamedSettings.streamed = true;
+	const Terrain streamed(streamedSettings);
+
+	const Errors streamedErrors = measureErrors(full, streamed);
+	if (streamedErrors.height > MAX_HEIGHT_ERROR || streamedErrors.normal > MAX_NORMAL_ERROR || !streamedErrors.sameSurfaceTypes) {
+		printf("Failed: streamed compact terrain is less accurate than documented (%.3g mm, %.3g degrees)\n", streamedErrors.height * 1000.0, streamedErrors.normal);
+		return 1;
+	}
+
+	//Compact terrain is cached apart from full precision, and maps back exactly as it was generated
+	settings.cacheDirectory = directory.string();
+	const Terrain saved(settings);
+
+	Terrain::Settings fullSettings;
+	fullSettings.cacheDirectory = directory.string();
+	const Terrain fullSaved(fullSettings);
+
+	{
+		const Terrain loaded(settings);
+
+		if (!loaded.isLoadedFromCache() || !loaded.isCompact() || loaded.getCachePath() == fullSaved.getCachePath() ||
+			!measureErrors(compact, loaded).identical) {
+			printf("Failed: compact terrain loaded from the cache\n");
+			return 1;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::remove_all(directory, error);
+
+	printf("Passed\n");
+	return 0;
+}
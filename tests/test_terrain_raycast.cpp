@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <math.h>
+#include <limits>
+#include <random>
+#include <vector>
+#include "Terrain.h"
+
+using External::Terrain;
+
+//Steps of the reference march along each ray, which is checked for the surface at every one
+static const double MARCH_STEP = 0.01; //m
+
+static double heightAbove(const Terrain& terrain, glm::dvec3 point) {
+	return point.y - terrain.getHeight(glm::dvec2(point.x, point.z));
+}
+
+//The first step at which the march finds the ray on the other side of the surface from its origin, or -1.0
+static double marchToSurface(const Terrain& terrain, glm::dvec3 origin, glm::dvec3 direction, double maxDistance) {
+	const bool startsAbove = heightAbove(terrain, origin) > 0.0;
+
+	for (double distance = MARCH_STEP; distance <= maxDistance; distance += MARCH_STEP)
+		if ((heightAbove(terrain, origin + direction * distance) > 0.0) != startsAbove)
+			return distance;
+
+	return -1.0;
+}
+
+//A hit is on the surface, with nothing nearer that the march can find, and no further than where the march first found
+//the surface
+static bool checkRay(const Terrain& terrain, glm::dvec3 origin, glm::dvec3 direction, double maxDistance, unsigned int& hits) {
+	Terrain::RayHit hit;
+	const bool wasHit = terrain.raycast(origin, direction, maxDistance, hit);
+	const double marched = marchToSurface(terrain, origin, direction, maxDistance);
+
+	if (!wasHit)
+		return marched < 0.0;
+
+	hits++;
+
+	const Terrain::Contact contact = terrain.sampleContact(glm::dvec2(hit.position_world.x, hit.position_world.z));
+	if (fabs(hit.position_world.y - contact.height) > 1e-8 || (marched >= 0.0 && hit.distance > marched + 1e-9) || hit.distance < 0.0 || hit.distance > maxDistance)
+		return false;
+
+	//The triangle under the hit, or (on the edge between two) the one next to it
+	if (fabs(glm::length(hit.normal_world) - 1.0) > 1e-6 || glm::dot(hit.normal_world, contact.normal_world) < 0.9)
+		return false;
+
+	const double marchedBefore = marchToSurface(terrain, origin, direction, hit.distance - 2.0 * MARCH_STEP);
+	return marchedBefore < 0.0;
+}
+
+static bool checkRandomRays(const Terrain& terrain, const char* name) {
+	std::mt19937 random(7);
+	std::uniform_real_distribution<double>
+		position(-80.0, 80.0),       //So rays stay within the terrain, where getHeight is not clamped
+		heading(0.0, 2.0 * M_PI),
+		slope(-0.3, 0.05),
+		height(-1.0, 6.0);
+
+	unsigned int hits = 0;
+	for (unsigned int i = 0; i < 400; i++) {
+		const glm::dvec2 start(position(random), position(random));
+		const double angle = heading(random);
+		const glm::dvec3
+			origin(start.x, terrain.getHeight(start) + height(random), start.y),
+			direction = glm::normalize(glm::dvec3(cos(angle), slope(random), sin(angle)));
+
+		if (!checkRay(terrain, origin, direction, 60.0, hits)) {
+			printf("Failed: %s ray %u from (%f, %f, %f)\n", name, i, origin.x, origin.y, origin.z);
+			return false;
+		}
+	}
+
+	//Most rays should meet the ground
+	if (hits < 200) {
+		printf("Failed: only %u of %s's rays hit\n", hits, name);
+		return false;
+	}
+
+	return true;
+}
+
+int main() {
+	const Terrain whole;
+
+	Terrain::Settings compactSettings;
+	compactSettings.compact = true;
+	const Terrain compact(compactSettings);
+
+	Terrain::Settings streamedSettings;
+	streamedSettings.streamed = true;
+	const Terrain streamed(streamedSettings);
+
+	if (!checkRandomRays(whole, "whole terrain") || !checkRandomRays(compact, "compact terrain") || !checkRandomRays(streamed, "streamed terrain"))
+		return 1;
+
+	Terrain::RayHit hit;
+
+	//Straight down is the same as getHeight, including through a square's corner
+	for (const glm::dvec2 point : { glm::dvec2(3.3, -7.8), glm::dvec2(12.0, 40.0), glm::dvec2(-101.9, 88.1) })
+		if (!whole.raycast(glm::dvec3(point.x, 50.0, point.y), glm::dvec3(0.0, -1.0, 0.0), 100.0, hit) ||
+			fabs(hit.position_world.y - whole.getHeight(point)) > 1e-9 || fabs(hit.distance - (50.0 - whole.getHeight(point))) > 1e-9) {
+			printf("Failed: straight down at (%f, %f)\n", point.x, point.y);
+			return 1;
+		}
+
+	//Missing: up and away, too short, and beyond the edges of whole terrain (which only streamed terrain has ground under)
+	if (whole.raycast(glm::dvec3(0.0, whole.getHeight(glm::dvec2(0.0)) + 1.0, 0.0), glm::dvec3(0.3, 1.0, 0.2), 1000.0, hit) ||
+		whole.raycast(glm::dvec3(0.0, 50.0, 0.0), glm::dvec3(0.0, -1.0, 0.0), 10.0, hit) ||
+		whole.raycast(glm::dvec3(500.0, 50.0, 0.0), glm::dvec3(0.0, -1.0, 0.0), 100.0, hit) ||
+		!streamed.raycast(glm::dvec3(500.0, 50.0, 0.0), glm::dvec3(0.0, -1.0, 0.0), 100.0, hit)) {
+		printf("Failed: a ray that should have missed hit, or the other way around\n");
+		return 1;
+	}
+
+	//With no limit on distance, rays up and away from streamed terrain still miss, rather than being followed for ever
+	const double infinity = std::numeric_limits<double>::infinity();
+	if (streamed.raycast(glm::dvec3(0.0, streamed.getHeight(glm::dvec2(0.0)) + 1.0, 0.0), glm::dvec3(0.3, 1.0, 0.2), infinity, hit) ||
+		streamed.raycast(glm::dvec3(10.0, streamed.getHeight(glm::dvec2(10.0)) + 1.0, 10.0), glm::dvec3(0.0, 1.0, 0.0), infinity, hit) ||
+		!streamed.raycast(glm::dvec3(10.0, streamed.getHeight(glm::dvec2(10.0)) + 1.0, 10.0), glm::dvec3(0.0, -1.0, 0.0), infinity, hit)) {
+		printf("Failed: unlimited ray over streamed terrain\n");
+		return 1;
+	}
+
+	//From outside whole terrain, coming down onto it
+	if (!whole.raycast(glm::dvec3(-400.0, 100.0, 3.0), glm::dvec3(1.0, -0.3, 0.0), 1000.0, hit) || hit.position_world.x < -145.0 ||
+		fabs(hit.position_world.y - whole.getHeight(glm::dvec2(hit.position_world.x, hit.position_world.z))) > 1e-8) {
+		printf("Failed: ray from outside the terrain\n");
+		return 1;
+	}
+
+	//Across many streamed tiles: a long ray clear of the ground, then one coming down onto it far away
+	const double farHeight = streamed.getHeight(glm::dvec2(3000.0, 10.0));
+	if (streamed.raycast(glm::dvec3(0.0, 200.0, 10.0), glm::dvec3(1.0, 0.0, 0.0), 3000.0, hit) ||
+		!streamed.raycast(glm::dvec3(2000.0, farHeight + 1000.0, 10.0), glm::dvec3(1.0, -1.0, 0.0), 2000.0, hit) ||
+		fabs(hit.position_world.x - 3000.0) > 50.0) {
+		printf("Failed: long ray over streamed terrain\n");
+		return 1;
+	}
+
+	printf("Passed\n");
+	return 0;
+}
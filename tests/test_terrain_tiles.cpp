@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "Terrain.h"
+
+using External::Terrain;
+using External::TerrainTileCache;
+
+static bool sameContact(const Terrain::Contact& a, const Terrain::Contact& b) {
+	return memcmp(&a.height, &b.height, sizeof(double)) == 0 && memcmp(&a.normal_world, &b.normal_world, sizeof(glm::dvec3)) == 0 && a.surfaceType == b.surfaceType;
+}
+
+int main() {
+	const Terrain whole;
+
+	//Room for two tiles, so covering the whole terrain (four tiles) evicts some
+	Terrain::Settings settings;
+	settings.streamed = true;
+	settings.tileMemoryBudget = 2 * TerrainTileCache::getTileBytes(false);
+	const Terrain streamed(settings);
+
+	//Every square of the whole terrain, and both of its triangles, are the same when streamed
+	const int halfTerrainSize = whole.getSize() / 2;
+	for (int x = -halfTerrainSize; x < halfTerrainSize; x++)
+		for (int z = -halfTerrainSize; z < halfTerrainSize; z++)
+			for (const glm::dvec2 withinSquare : { glm::dvec2(0.7, 0.2), glm::dvec2(0.2, 0.7), glm::dvec2(0.0) })
+				if (!sameContact(whole.sampleContact(glm::dvec2(x, z) + withinSquare), streamed.sampleContact(glm::dvec2(x, z) + withinSquare))) {
+					printf("Failed: streamed terrain differs at (%d, %d)\n", x, z);
+					return 1;
+				}
+
+	TerrainTileCache& tiles = *streamed.getTileCache();
+	if (tiles.getResidentCount() > 2 || tiles.getGeneratedCount() < 4) {
+		printf("Failed: %zu tiles resident, %zu generated, with a budget of 2\n", tiles.getResidentCount(), tiles.getGeneratedCount());
+		return 1;
+	}
+
+	//No edges: far from the origin, and continuous across the tiles' seams
+	const double seam = 3.0 * TerrainTileCache::TILE_SQUARES;
+	const Terrain::Contact far = streamed.sampleContact(glm::dvec2(1.0e6 + 0.3, -2.5e5 + 0.6));
+	if (!std::isfinite(far.height) || fabs(glm::length(far.normal_world) - 1.0) > 1e-9 || far.surfaceType != External::TerrainType::GRASS ||
+		fabs(streamed.getHeight(glm::dvec2(seam - 1e-9, 10.5)) - streamed.getHeight(glm::dvec2(seam, 10.5))) > 1e-6) {
+		printf("Failed: far away (height %f) or across a seam\n", far.height);
+		return 1;
+	}
+
+	//Threads sampling at once, each with its own hot tile and starting at a different point along the same route, see the
+	//same terrain as one thread with every tile resident
+	Terrain::Settings sharedSettings = settings;
+	sharedSettings.tileMemoryBudget = 6 * TerrainTileCache::getTileBytes(false);
+	const Terrain shared(sharedSettings);
+
+	Terrain::Settings referenceSettings = settings;
+	referenceSettings.tileMemoryBudget = 64 * TerrainTileCache::getTileBytes(false);
+	const Terrain reference(referenceSettings);
+
+	std::vector<glm::dvec2> points;
+	for (unsigned int i = 0; i < 4000; i++)
+		points.push_back(glm::dvec2(-900.0 + 0.45 * i, 300.0 * sin(i * 0.003)));
+
+	std::vector<Terrain::Contact> expected(points.size());
+	reference.sampleContacts(points.data(), points.size(), expected.data());
+
+	std::atomic<bool> threadsAgree(true);
+	std::vector<std::thread> threads;
+	for (unsigned int t = 0; t < 4; t++)
+		threads.emplace_back([&, t]() {
+			for (size_t step = 0; step < points.size(); step++) {
+				const size_t i = (step + t * 1000) % points.size();
+				if (!sameContact(shared.sampleContact(points[i]), expected[i]))
+					threadsAgree = false;
+
+				shared.prefetch(points[i]);
+			}
+		});
+
+	for (std::thread& thread : threads)
+		thread.join();
+
+	if (!threadsAgree || shared.getTileCache()->getResidentCount() > 6) {
+		printf("Failed: threads sampling streamed terrain at once\n");
+		return 1;
+	}
+
+	//Prefetch generates the tiles around a position in the background
+	const size_t generatedBefore = tiles.getGeneratedCount();
+	streamed.prefetch(glm::dvec2(-5.0e4, 7.0e4));
+
+	const std::chrono::steady_clock::time_point giveUp = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+	while (tiles.getGeneratedCount() == generatedBefore && std::chrono::steady_clock::now() < giveUp)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	if (tiles.getGeneratedCount() == generatedBefore) {
+		printf("Failed: nothing prefetched\n");
+		return 1;
+	}
+
+	printf("Passed\n");
+	return 0;
+}
@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <math.h>
+#include <random>
+#include "Terrain.h"
+
+using External::Terrain;
+using External::TrackCentreline;
+
+//The nearest point found by trying every segment
+static TrackCentreline::Nearest findNearestByScan(const TrackCentreline& centreline, glm::dvec2 position_world) {
+	TrackCentreline::Nearest nearest = centreline.findNearestOnSegment(position_world, 0);
+
+	for (size_t segment = 1; segment < centreline.getSegmentCount(); segment++) {
+		const TrackCentreline::Nearest candidate = centreline.findNearestOnSegment(position_world, segment);
+		if (fabs(candidate.lateralOffset) < fabs(nearest.lateralOffset))
+			nearest = candidate;
+	}
+
+	return nearest;
+}
+
+int main() {
+	const Terrain terrain;
+	const TrackCentreline& centreline = terrain.getTrackCentreline();
+	const double length = centreline.getLength();
+
+	if (centreline.isEmpty() || length < 500.0 || length > 2000.0) {
+		printf("Failed: centreline of %zu segments, %f m long\n", centreline.getSegmentCount(), length);
+		return 1;
+	}
+
+	//Along the whole loop: on tarmac, with unit tangents along the line, and turning once round in total
+	double turned = 0.0;
+	for (double distance = 0.0; distance < length; distance += 1.0) {
+		const TrackCentreline::Sample
+			sample = centreline.sampleAtDistance(distance),
+			ahead = centreline.sampleAtDistance(distance + 0.01),
+			wrapped = centreline.sampleAtDistance(distance - 3.0 * length);
+
+		const glm::dvec2 step = (ahead.position_world - sample.position_world) / 0.01;
+
+		if (terrain.sampleContact(sample.position_world).surfaceType != External::TARMAC || fabs(sample.distance - distance) > 1e-9 ||
+			fabs(glm::length(sample.tangent_world) - 1.0) > 1e-9 || glm::dot(step, sample.tangent_world) < 0.99 ||
+			glm::length(wrapped.position_world - sample.position_world) > 1e-6) {
+			printf("Failed: sample %f m along the centreline\n", distance);
+			return 1;
+		}
+
+		turned += sample.curvature * std::min(1.0, length - distance);
+	}
+
+	if (fabs(fabs(turned) - 2.0 * M_PI) > 0.1) {
+		printf("Failed: the centreline turns through %f rads\n", turned);
+		return 1;
+	}
+
+	//Nearest points agree with trying every segment, on and off the terrain
+	std::mt19937 random(3);
+	std::uniform_real_distribution<double> position(-300.0, 300.0);
+
+	for (unsigned int i = 0; i < 2000; i++) {
+		const glm::dvec2 position_world(position(random), position(random));
+		const TrackCentreline::Nearest
+			nearest = centreline.findNearest(position_world),
+			scanned = findNearestByScan(centreline, position_world);
+
+		if (fabs(nearest.lateralOffset - scanned.lateralOffset) > 1e-9 || fabs(glm::length(position_world - nearest.sample.position_world) - fabs(nearest.lateralOffset)) > 1e-9) {
+			printf("Failed: nearest point to (%f, %f) is %f m away, not %f m\n", position_world.x, position_world.y, nearest.lateralOffset, scanned.lateralOffset);
+			return 1;
+		}
+	}
+
+	//A point beside the line is found to that side, level with where it was put
+	const TrackCentreline::Sample sample = centreline.sampleAtDistance(0.25 * length);
+	const glm::dvec2 right(-sample.tangent_world.y, sample.tangent_world.x);
+	const TrackCentreline::Nearest beside = centreline.findNearest(sample.position_world + right * 3.0);
+
+	if (fabs(beside.lateralOffset - 3.0) > 0.05 || fabs(beside.sample.distance - sample.distance) > 0.5) {
+		printf("Failed: a point 3 m right of the line is %f m right of it, %f m along rather than %f m\n", beside.lateralOffset, beside.sample.distance, sample.distance);
+		return 1;
+	}
+
+	printf("Passed: %zu segments, %f m long\n", centreline.getSegmentCount(), length);
+	return 0;
+}
@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <math.h>
+#include "PacejkaMagicFormula.h"
+#include "TyreForceTable.h"
+
+using Internal::PacejkaMagicFormula;
+using Internal::PacejkaParams;
+using Internal::TyreForceTable;
+
+//Documents the accuracy of the default table sizes for both tyre parameter sets, and checks the table's bookkeeping
+static int checkParams(const PacejkaParams& params, const char* paramsName, TyreForceTable::Interpolation interpolation, double maxRelativeError) {
+	TyreForceTable::Settings settings;
+	settings.interpolation = interpolation;
+	const TyreForceTable table(std::make_shared<const PacejkaParams>(params), settings);
+
+	const TyreForceTable::MaxError error = table.measureMaxError();
+	const char* interpolationName = interpolation == TyreForceTable::Interpolation::BICUBIC ? "bicubic" : "bilinear";
+
+	printf("%s tyre, %s: max error %.2f N longitudinal (%.3f%%), %.2f N lateral (%.3f%%)\n", paramsName, interpolationName,
+		error.longitudinal_N, error.longitudinalRelative * 100.0, error.lateral_N, error.lateralRelative * 100.0);
+
+	if (!(error.longitudinalRelative <= maxRelativeError && error.lateralRelative <= maxRelativeError)) {
+		printf("Failed: expected at most %.3f%%\n", maxRelativeError * 100.0);
+		return 1;
+	}
+
+	//Exact zeros and out-of-range inputs behave as the formula does
+	double longitudinal, lateral;
+	//load, slip %, slip angle, camber, and whether the lateral force should also come from the formula
+	const double inputs[][5] = {
+		{ 0.0, 25.0, 4.0, 0.0, 1.0 },       //Airborne
+		{ 4000.0, 0.0, 0.0, 0.0, 1.0 },     //No slip
+		{ 4000.0, 40000.0, 3.0, 0.0, 0.0 }, //Slip beyond the table
+		{ 30000.0, 12.0, 3.0, 0.0, 1.0 },   //Load beyond the table
+		{ 4000.0, 12.0, 3.0, 1.5, 1.0 },    //Camber, which the table does not cover
+	};
+
+	for (const double* in : inputs) {
+		table.lookup(in[0], in[1], in[2], in[3], longitudinal, lateral);
+		if (longitudinal != PacejkaMagicFormula::calcLongitudinalForce(params, in[0] / 1000.0, in[1]) || (in[4] != 0.0 && lateral != PacejkaMagicFormula::calcLateralForce(params, in[0] / 1000.0, in[2], in[3]))) {
+			printf("Failed: lookup(%g, %g, %g, %g) does not fall back to the formula\n", in[0], in[1], in[2], in[3]);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+//One table per parameter set: built once, shared while anything holds it, and a new set gets a new table
+static int checkSharing() {
+	const std::shared_ptr<const PacejkaParams>
+		drifting = std::make_shared<const PacejkaParams>(PacejkaParams::driftingTyre()),
+		road = std::make_shared<const PacejkaParams>(PacejkaParams::roadTyre());
+
+	const unsigned int builds = TyreForceTable::getBuildCount();
+	const std::shared_ptr<const TyreForceTable>
+		first = TyreForceTable::getFor(drifting),
+		second = TyreForceTable::getFor(drifting),
+		other = TyreForceTable::getFor(road);
+
+	if (first != second || first == other || TyreForceTable::getBuildCount() != builds + 2) {
+		printf("Failed: expected one table per parameter set (%u builds)\n", TyreForceTable::getBuildCount() - builds);
+		return 1;
+	}
+
+	double longitudinal, lateral;
+	other->lookup(4000.0, 12.0, 3.0, 0.0, longitudinal, lateral);
+	const double expected = PacejkaMagicFormula::calcLongitudinalForce(*road, 4.0, 12.0);
+
+	if (fabs(longitudinal - expected) > fabs(expected) * 0.01) {
+		printf("Failed: table does not follow its own parameter set (%g N, expected %g N)\n", longitudinal, expected);
+		return 1;
+	}
+
+	return 0;
+}
+
+int main() {
+	const TyreForceTable::Interpolation
+		bilinear = TyreForceTable::Interpolation::BILINEAR,
+		bicubic = TyreForceTable::Interpolation::BICUBIC;
+
+	const PacejkaParams
+		drifting = PacejkaParams::driftingTyre(),
+		road = PacejkaParams::roadTyre();
+
+	if (checkParams(drifting, "drifting", bilinear, 0.02) || checkParams(drifting, "drifting", bicubic, 0.003))
+		return 1;
+
+	if (checkParams(road, "road", bilinear, 0.02) || checkParams(road, "road", bicubic, 0.003))
+		return 1;
+
+	if (checkSharing())
+		return 1;
+
+	printf("Passed\n");
+	return 0;
+}
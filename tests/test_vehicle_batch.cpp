@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <string.h>
+#include "Car.h"
+#include "VehicleBatch.h"
+
+//Driver inputs are changed every so often, so that steering, braking and reversing are all exercised
+struct ScriptedInputs {
+	double throttle, steeringWheelAngle, brakeTravel;
+	bool toggleReverse;
+};
+
+static ScriptedInputs inputsAt(unsigned int step, unsigned int variant) {
+	unsigned int phase = (step / 500 + variant) % 6;
+
+	switch (phase) {
+	case 0: return { 1.0, 0.0, 0.0, false };
+	case 1: return { 0.7, 180.0, 0.0, false };
+	case 2: return { 0.0, -90.0, 0.6, false };
+	case 3: return { 0.3, -360.0, 0.0, step % 500 == 0 };
+	case 4: return { 0.5, 45.0, 0.2, false };
+	default: return { 0.0, 0.0, 1.0, step % 500 == 0 };
+	}
+}
+
+template<typename T>
+static bool sameBits(const T& a, const T& b) {
+	return memcmp(&a, &b, sizeof(T)) == 0;
+}
+
+int main() {
+	const unsigned int
+		vehicleCount = 3,
+		steps = 6000;
+
+	const double dt = 1.0 / 120.0;
+
+	//Bit-for-bit equality is only promised for the scalar tyre force path
+	Internal::PacejkaMagicFormula::setSimdLevel(Internal::PacejkaMagicFormula::SimdLevel::SCALAR);
+
+	Internal::Car cars[vehicleCount];
+	Internal::VehicleBatch batch;
+
+	batch.reserve(vehicleCount);
+	for (Internal::Car& car : cars)
+		batch.addVehicle(car);
+
+	for (unsigned int step = 0; step < steps; step++) {
+		for (unsigned int v = 0; v < vehicleCount; v++) {
+			ScriptedInputs inputs = inputsAt(step, v);
+
+			cars[v].getTorqueGenerator().setThrottle(inputs.throttle);
+			cars[v].getControlSystem().setSteeringWheelAngle(inputs.steeringWheelAngle);
+			cars[v].getControlSystem().setBrakeTravel(inputs.brakeTravel);
+
+			batch.setThrottle(v, inputs.throttle);
+			batch.setSteeringWheelAngle(v, inputs.steeringWheelAngle);
+			batch.setBrakeTravel(v, inputs.brakeTravel);
+
+			if (inputs.toggleReverse) {
+				cars[v].getTorqueGenerator().toggleReverse();
+				batch.toggleReverse(v);
+			}
+
+			cars[v].update(step * dt, dt);
+		}
+
+		batch.step(dt);
+
+		for (unsigned int v = 0; v < vehicleCount; v++) {
+			Internal::Car& car = cars[v];
+			bool match =
+				sameBits(car.getState().getPosition_world(), batch.getPosition_world(v)) &&
+				sameBits(car.getState().getMomentum_world(), batch.getMomentum_world(v)) &&
+				sameBits(car.getState().getOrientation_world(), batch.getOrientation_world(v)) &&
+				sameBits(car.getState().getAngularMomentum_world(), batch.getAngularMomentum_world(v)) &&
+				sameBits(car.getAcceleration_world(), batch.getAcceleration_world(v));
+
+			for (unsigned char w = 0; w < Internal::VehicleBatch::mWheelsPerVehicle; w++) {
+				Internal::WheelInterface& wheelInterface = *car.getWheelSystem().getWheelInterface(w);
+				match = match &&
+					sameBits(wheelInterface.getWheel().getAngularVelocity(), batch.getWheelAngularVelocity(v, w)) &&
+					sameBits(wheelInterface.getSuspension().getLength(), batch.getSuspensionLength(v, w)) &&
+					sameBits(wheelInterface.getLoad(), batch.getLoad(v, w)) &&
+					sameBits(wheelInterface.getWheel().getTyre().getTotalForce_wheel(), batch.getTyreForce_wheel(v, w));
+			}
+
+			if (!match) {
+				glm::dvec3 carPosition = car.getState().getPosition_world(), batchPosition = batch.getPosition_world(v);
+				printf("Failed: vehicle %u diverged at step %u (car %.17g %.17g %.17g, batch %.17g %.17g %.17g)\n", v, step,
+					carPosition.x, carPosition.y, carPosition.z, batchPosition.x, batchPosition.y, batchPosition.z);
+				return 1;
+			}
+		}
+	}
+
+	glm::dvec3 finalPosition = batch.getPosition_world(0);
+	printf("Passed: %u vehicles, %u steps, vehicle 0 at (%.3f, %.3f, %.3f)\n", vehicleCount, steps, finalPosition.x, finalPosition.y, finalPosition.z);
+
+	return 0;
+}